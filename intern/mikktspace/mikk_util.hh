@@ -139,20 +139,4 @@ void radixsort(std::vector<T> &data, std::vector<T> &data2, KeyGetter getKey)
   }
 }
 
-static void float_add_atomic(float *val, float add)
-{
-  /* Hacky, but atomic floats are only supported from C++20 onward.
-   * This works in practice since `std::atomic<uint32_t>` is really just an `uint32_t` in memory,
-   * so this cast lets us do a 32-bit CAS operation (which is used to build the atomic float
-   * operation) without needing any external libraries or compiler-specific builtins. */
-  std::atomic<uint32_t> *atomic_val = reinterpret_cast<std::atomic<uint32_t> *>(val);
-  for (;;) {
-    uint32_t old_v = atomic_val->load();
-    uint32_t new_v = float_as_uint(uint_as_float(old_v) + add);
-    if (atomic_val->compare_exchange_weak(old_v, new_v)) {
-      return;
-    }
-  }
-}
-
 }  // namespace mikk
@@ -91,13 +91,6 @@ template<typename Mesh> class Mikktspace {
       tangent = tangent.normalize();
     }
 
-    void accumulateTSpaceAtomic(float3 v_tangent)
-    {
-      float_add_atomic(&tangent.x, v_tangent.x);
-      float_add_atomic(&tangent.y, v_tangent.y);
-      float_add_atomic(&tangent.z, v_tangent.z);
-    }
-
     void accumulateTSpace(float3 v_tangent)
     {
       tangent += v_tangent;
@@ -136,6 +129,9 @@ template<typename Mesh> class Mikktspace {
   std::vector<TSpace> tSpaces;
   std::vector<Group> groups;
 
+  /* Index of the first TSpace of every face, faces that are not triangles or quads have none. */
+  std::vector<uint> faceTSpaceOffsets;
+
   uint nrTSpaces, nrFaces, nrTriangles, totalTriangles;
 
   int nrThreads;
@@ -198,19 +194,15 @@ template<typename Mesh> class Mikktspace {
       degenEpilogue();
     }
 
-    uint index = 0;
-    for (uint f = 0; f < nrFaces; f++) {
-      const uint verts = mesh.GetNumVerticesOfFace(f);
-      if (verts != 3 && verts != 4) {
-        continue;
-      }
-
-      // set data
+    // set data
+    runParallel(0u, nrFaces, [&](uint f) {
+      const uint offset = faceTSpaceOffsets[f];
+      const uint verts = faceTSpaceOffsets[f + 1] - offset;
       for (uint i = 0; i < verts; i++) {
-        const TSpace &tSpace = tSpaces[index++];
+        const TSpace &tSpace = tSpaces[offset + i];
         mesh.SetTangentSpace(f, i, tSpace.tangent, tSpace.orientPreserving);
       }
-    }
+    });
   }
 
  protected:
@@ -258,37 +250,49 @@ template<typename Mesh> class Mikktspace {
 
   void generateInitialVerticesIndexList()
   {
-    nrTriangles = 0;
-    for (uint f = 0; f < nrFaces; f++) {
+    /* Count the triangles and TSpaces of every face first, so that the triangles can then be
+     * created in parallel at their final position. */
+    std::vector<uint> faceTriangleOffsets(nrFaces + 1);
+    faceTSpaceOffsets.resize(nrFaces + 1);
+    runParallel(0u, nrFaces, [&](uint f) {
       const uint verts = mesh.GetNumVerticesOfFace(f);
-      if (verts == 3) {
-        nrTriangles += 1;
-      }
-      else if (verts == 4) {
-        nrTriangles += 2;
-      }
-    }
-
-    triangles.reserve(nrTriangles);
+      const bool isValid = (verts == 3 || verts == 4);
+      faceTriangleOffsets[f] = isValid ? (verts - 2) : 0;
+      faceTSpaceOffsets[f] = isValid ? verts : 0;
+    });
 
+    nrTriangles = 0;
     nrTSpaces = 0;
     for (uint f = 0; f < nrFaces; f++) {
-      const uint verts = mesh.GetNumVerticesOfFace(f);
-      if (verts != 3 && verts != 4) {
-        continue;
+      const uint faceTriangles = faceTriangleOffsets[f];
+      const uint faceTSpaces = faceTSpaceOffsets[f];
+      faceTriangleOffsets[f] = nrTriangles;
+      faceTSpaceOffsets[f] = nrTSpaces;
+      nrTriangles += faceTriangles;
+      nrTSpaces += faceTSpaces;
+    }
+    faceTriangleOffsets[nrFaces] = nrTriangles;
+    faceTSpaceOffsets[nrFaces] = nrTSpaces;
+
+    triangles.resize(nrTriangles, Triangle(0, 0));
+
+    runParallel(0u, nrFaces, [&](uint f) {
+      const uint tA = faceTriangleOffsets[f];
+      const uint faceTriangles = faceTriangleOffsets[f + 1] - tA;
+      if (faceTriangles == 0) {
+        return;
       }
 
-      uint tA = uint(triangles.size());
-      triangles.emplace_back(f, nrTSpaces);
+      const uint tSpaceIdx = faceTSpaceOffsets[f];
       Triangle &triA = triangles[tA];
+      triA = Triangle(f, tSpaceIdx);
 
-      if (verts == 3) {
+      if (faceTriangles == 1) {
         triA.setVertices(0, 1, 2);
       }
       else {
-        uint tB = uint(triangles.size());
-        triangles.emplace_back(f, nrTSpaces);
-        Triangle &triB = triangles[tB];
+        Triangle &triB = triangles[tA + 1];
+        triB = Triangle(f, tSpaceIdx);
 
         // need an order independent way to evaluate
         // tspace on quads. This is done by splitting
@@ -314,9 +318,7 @@ template<typename Mesh> class Mikktspace {
           triB.setVertices(1, 2, 3);
         }
       }
-
-      nrTSpaces += verts;
-    }
+    });
   }
 
   struct VertexHash {
@@ -589,11 +591,6 @@ template<typename Mesh> class Mikktspace {
     };
     std::vector<Entry> entries;
 
-    NeighborShard(size_t capacity)
-    {
-      entries.reserve(capacity);
-    }
-
     void buildNeighbors(Mikktspace<Mesh> *mikk)
     {
       /* Entries are added by iterating over t, so by using a stable sort,
@@ -646,7 +643,6 @@ template<typename Mesh> class Mikktspace {
      * key go into the same shard.
      * This is done by hashing the key to get the shard index of each vertex.
      */
-    // TODO: Two-step filling that first counts and then fills? Could be parallel then.
     uint targetNrShards = isParallel ? uint(4 * nrThreads) : 1;
     uint nrShards = 1, hashShift = 32;
     while (nrShards < targetNrShards) {
@@ -654,23 +650,60 @@ template<typename Mesh> class Mikktspace {
       hashShift -= 1;
     }
 
-    /* Reserve 25% extra to account for variation due to hashing. */
-    size_t reserveSize = size_t(double(3 * nrTriangles) * 1.25 / nrShards);
-    std::vector<NeighborShard> shards(nrShards, {reserveSize});
+    auto edgeHash = [&](const Triangle &triangle, uint i) {
+      const uint i0 = triangle.vertices[i];
+      const uint i1 = triangle.vertices[(i != 2) ? (i + 1) : 0];
+      const uint high = std::max(i0, i1), low = std::min(i0, i1);
+      return hash_uint3(high, low, 0);
+    };
+    /* TODO: Reusing the hash here means less hash space inside each shard.
+     * Computing a second hash with a different seed it probably not worth it? */
+    auto shardOfHash = [&](uint hash) { return isParallel ? (hash >> hashShift) : 0; };
+
+    /* The shards are filled in two steps, so that it can be done in parallel: first the entries
+     * of every shard are counted for chunks of triangles, then every chunk adds its entries
+     * starting at its offset in the shard. This keeps the entries in the order of t. */
+    const uint nrChunks = isParallel ? uint(4 * nrThreads) : 1;
+    const uint chunkSize = (nrTriangles + nrChunks - 1) / nrChunks;
+    auto chunkTriangles = [&](uint c) {
+      return std::make_pair(std::min(c * chunkSize, nrTriangles),
+                            std::min((c + 1) * chunkSize, nrTriangles));
+    };
 
-    for (uint t = 0; t < nrTriangles; t++) {
-      Triangle &triangle = triangles[t];
-      for (uint i = 0; i < 3; i++) {
-        const uint i0 = triangle.vertices[i];
-        const uint i1 = triangle.vertices[(i != 2) ? (i + 1) : 0];
-        const uint high = std::max(i0, i1), low = std::min(i0, i1);
-        const uint hash = hash_uint3(high, low, 0);
-        /* TODO: Reusing the hash here means less hash space inside each shard.
-         * Computing a second hash with a different seed it probably not worth it? */
-        const uint shard = isParallel ? (hash >> hashShift) : 0;
-        shards[shard].entries.emplace_back(hash, pack_index(t, i));
+    std::vector<uint> chunkShardOffsets(size_t(nrChunks) * nrShards, 0);
+    runParallel(0u, nrChunks, [&](uint c) {
+      uint *counts = &chunkShardOffsets[size_t(c) * nrShards];
+      const auto [tStart, tEnd] = chunkTriangles(c);
+      for (uint t = tStart; t < tEnd; t++) {
+        for (uint i = 0; i < 3; i++) {
+          counts[shardOfHash(edgeHash(triangles[t], i))]++;
+        }
       }
-    }
+    });
+
+    std::vector<NeighborShard> shards(nrShards);
+    for (uint s = 0; s < nrShards; s++) {
+      uint offset = 0;
+      for (uint c = 0; c < nrChunks; c++) {
+        uint &chunkOffset = chunkShardOffsets[size_t(c) * nrShards + s];
+        const uint count = chunkOffset;
+        chunkOffset = offset;
+        offset += count;
+      }
+      shards[s].entries.resize(offset, {0, 0});
+    }
+
+    runParallel(0u, nrChunks, [&](uint c) {
+      uint *offsets = &chunkShardOffsets[size_t(c) * nrShards];
+      const auto [tStart, tEnd] = chunkTriangles(c);
+      for (uint t = tStart; t < tEnd; t++) {
+        for (uint i = 0; i < 3; i++) {
+          const uint hash = edgeHash(triangles[t], i);
+          const uint shard = shardOfHash(hash);
+          shards[shard].entries[offsets[shard]++] = {hash, pack_index(t, i)};
+        }
+      }
+    });
 
     runParallel(0u, nrShards, [&](uint s) { shards[s].buildNeighbors(this); });
   }
@@ -760,12 +793,14 @@ template<typename Mesh> class Mikktspace {
   ///////////////////////////////////////////////////////////////////////////////////////////////////
   ///////////////////////////////////////////////////////////////////////////////////////////////////
 
-  template<bool atomic> void accumulateTSpaces(uint t)
+  /* Compute the contribution of every vertex of the triangle to the tangent of its group. */
+  std::array<float3, 3> calcTSpaceContributions(uint t)
   {
     const Triangle &triangle = triangles[t];
+    std::array<float3, 3> contributions = {float3(0.0f), float3(0.0f), float3(0.0f)};
     // only valid triangles get to add their contribution
     if (triangle.groupWithAny) {
-      return;
+      return contributions;
     }
 
     /* TODO: Vectorize?
@@ -781,55 +816,88 @@ template<typename Mesh> class Mikktspace {
                                  dot(project(n[1], p[2] - p[1]), project(n[1], p[0] - p[1])),
                                  dot(project(n[2], p[0] - p[2]), project(n[2], p[1] - p[2]))};
 
+    for (uint i = 0; i < 3; i++) {
+      if (triangle.group[i] != UNSET_ENTRY) {
+        contributions[i] = project(n[i], triangle.tangent) *
+                           fast_acosf(std::clamp(fCos[i], -1.0f, 1.0f));
+      }
+    }
+    return contributions;
+  }
+
+  void accumulateTSpaces(uint t, const std::array<float3, 3> &contributions)
+  {
+    const Triangle &triangle = triangles[t];
+    if (triangle.groupWithAny) {
+      return;
+    }
     for (uint i = 0; i < 3; i++) {
       uint groupId = triangle.group[i];
       if (groupId != UNSET_ENTRY) {
-        float3 tangent = project(n[i], triangle.tangent) *
-                         fast_acosf(std::clamp(fCos[i], -1.0f, 1.0f));
-        if constexpr (atomic) {
-          groups[groupId].accumulateTSpaceAtomic(tangent);
-        }
-        else {
-          groups[groupId].accumulateTSpace(tangent);
-        }
+        groups[groupId].accumulateTSpace(contributions[i]);
       }
     }
   }
 
+  /* Assign the groups of the triangle's vertices to their TSpaces. */
+  void assignTSpaces(uint t)
+  {
+    const Triangle &triangle = triangles[t];
+    for (uint i = 0; i < 3; i++) {
+      uint groupId = triangle.group[i];
+      if (groupId == UNSET_ENTRY) {
+        continue;
+      }
+      const Group group = groups[groupId];
+      assert(triangle.orientPreserving == group.orientPreserving);
+
+      // output tspace
+      const uint offset = triangle.tSpaceIdx;
+      const uint faceVertex = triangle.faceVertex[i];
+      tSpaces[offset + faceVertex].accumulateGroup(group);
+    }
+  }
+
   void generateTSpaces()
   {
+    /* The contributions of the triangles are computed in parallel, but they are always added to
+     * the groups in the order of t, so that the resulting tangents don't depend on the threading.
+     * Blocks of triangles are used to limit the memory used for the contributions. */
     if (isParallel) {
-      runParallel(0u, nrTriangles, [&](uint t) { accumulateTSpaces<true>(t); });
+      const uint blockSize = 1u << 16;
+      std::vector<std::array<float3, 3>> contributions(std::min(blockSize, nrTriangles));
+      for (uint blockStart = 0; blockStart < nrTriangles; blockStart += blockSize) {
+        const uint blockEnd = std::min(blockStart + blockSize, nrTriangles);
+        runParallel(blockStart, blockEnd, [&](uint t) {
+          contributions[t - blockStart] = calcTSpaceContributions(t);
+        });
+        for (uint t = blockStart; t < blockEnd; t++) {
+          accumulateTSpaces(t, contributions[t - blockStart]);
+        }
+      }
     }
     else {
       for (uint t = 0; t < nrTriangles; t++) {
-        accumulateTSpaces<false>(t);
+        accumulateTSpaces(t, calcTSpaceContributions(t));
       }
     }
 
-    /* TODO: Worth parallelizing? Probably not. */
-    for (Group &group : groups) {
-      group.normalizeTSpace();
-    }
+    runParallel(0u, uint(groups.size()), [&](uint g) { groups[g].normalizeTSpace(); });
 
     tSpaces.resize(nrTSpaces);
 
-    for (uint t = 0; t < nrTriangles; t++) {
-      Triangle &triangle = triangles[t];
-      for (uint i = 0; i < 3; i++) {
-        uint groupId = triangle.group[i];
-        if (groupId == UNSET_ENTRY) {
-          continue;
-        }
-        const Group group = groups[groupId];
-        assert(triangle.orientPreserving == group.orientPreserving);
-
-        // output tspace
-        const uint offset = triangle.tSpaceIdx;
-        const uint faceVertex = triangle.faceVertex[i];
-        tSpaces[offset + faceVertex].accumulateGroup(group);
+    /* The TSpaces of a face are only used by its triangles, so faces are independent. The two
+     * triangles of a quad are next to each other and are handled by the same task, since the
+     * result of #TSpace::accumulateGroup depends on the order. */
+    runParallel(0u, nrTriangles, [&](uint t) {
+      if (t > 0 && triangles[t - 1].faceIdx == triangles[t].faceIdx) {
+        return;
       }
-    }
+      assignTSpaces(t);
+      if (t + 1 < nrTriangles && triangles[t + 1].faceIdx == triangles[t].faceIdx) {
+        assignTSpaces(t + 1);
+      }
+    });
   }
 };
 
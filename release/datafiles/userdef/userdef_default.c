@@ -236,6 +236,8 @@ const UserDef U_default = {
     .sequencer_disk_cache_size_limit = 100,
     .sequencer_disk_cache_flag = 0,
     .sequencer_proxy_setup = USER_SEQ_PROXY_SETUP_AUTOMATIC,
+    .sequencer_proxy_workers = 1,
+    .sequencer_prefetch_workers = 1,
 
     .collection_instance_empty_size = 1.0f,
 
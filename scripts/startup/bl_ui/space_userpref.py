@@ -836,6 +836,8 @@ class USERPREF_PT_system_video_sequencer(SystemPanel, CenterAlignMixIn, Panel):
         layout.separator()
 
         layout.prop(system, "sequencer_proxy_setup")
+        layout.prop(system, "sequencer_proxy_workers")
+        layout.prop(system, "sequencer_prefetch_workers")
 
 
 # -----------------------------------------------------------------------------
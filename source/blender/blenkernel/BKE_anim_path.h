@@ -11,6 +11,7 @@
 extern "C" {
 #endif
 
+struct AnimPathLookup;
 struct CurveCache;
 struct Object;
 
@@ -43,6 +44,28 @@ bool BKE_where_on_path(const struct Object *ob,
                        float *r_radius,
                        float *r_weight);
 
+/**
+ * Create a lookup table to evaluate many points on the path of \a ob,
+ * see #BKE_anim_path_lookup_eval.
+ *
+ * \return null if the object has no valid path, see #BKE_where_on_path.
+ */
+struct AnimPathLookup *BKE_anim_path_lookup_create(const struct Object *ob);
+void BKE_anim_path_lookup_free(struct AnimPathLookup *lookup);
+
+/**
+ * Same as #BKE_where_on_path, but faster when evaluating many points on the same path.
+ * The lookup is read-only, it can be used from multiple threads.
+ */
+bool BKE_anim_path_lookup_eval(const struct AnimPathLookup *lookup,
+                               float ctime,
+                               float r_vec[4],
+                               float r_dir[3],
+                               float r_quat[4],
+                               float *r_radius,
+                               float *r_weight);
+float BKE_anim_path_lookup_get_length(const struct AnimPathLookup *lookup);
+
 #ifdef __cplusplus
 }
 #endif
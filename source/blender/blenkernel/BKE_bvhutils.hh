@@ -16,6 +16,7 @@
 #include "BLI_kdopbvh.h"
 #include "BLI_math_vector_types.hh"
 #include "BLI_span.hh"
+#include "BLI_wide_bvh.hh"
 
 struct BVHCache;
 struct BVHTree;
@@ -142,6 +143,21 @@ void BKE_bvhtree_from_mesh_verts_init(const Mesh &mesh,
                                       const blender::IndexMask &verts_mask,
                                       BVHTreeFromMesh &r_data);
 
+namespace blender::bke {
+
+/**
+ * Wide BVH of all triangles of the mesh, faster than #BVHTREE_FROM_CORNER_TRIS for many ray casts
+ * or nearest point queries. The tree is cached on the mesh, hit indices are triangle indices.
+ */
+const bvh::TriangleBVH &bvh_corner_tris_wide(const Mesh &mesh);
+
+/**
+ * Build a wide BVH of the triangles in the mesh that correspond to the faces in the given mask.
+ */
+bvh::TriangleBVH bvh_corner_tris_wide(const Mesh &mesh, const IndexMask &faces_mask);
+
+}  // namespace blender::bke
+
 /**
  * Frees data allocated by a call to `bvhtree_from_mesh_*`.
  */
@@ -179,6 +179,12 @@ struct Global {
    * Set using `--debug-gpu-scope-capture "debug_scope"`.
    */
   char gpu_debug_scope_name[200];
+
+  /**
+   * Only record execution times of geometry nodes and write them to this file on exit.
+   * Set using `--debug-geometry-nodes-trace <filepath>`.
+   */
+  char geometry_nodes_trace_filepath[/*FILE_MAX*/ 1024];
 };
 
 /* **************** GLOBAL ********************* */
@@ -175,6 +175,7 @@ void normals_calc_corners(Span<float3> vert_positions,
                           Span<int> corner_verts,
                           Span<int> corner_edges,
                           Span<int> corner_to_face_map,
+                          GroupedSpan<int> vert_to_corner_map,
                           Span<float3> vert_normals,
                           Span<float3> face_normals,
                           Span<bool> sharp_edges,
@@ -221,11 +222,12 @@ void normals_corner_custom_set_from_verts(Span<float3> vert_positions,
  *
  * \param sharp_faces: Optional array used to mark specific faces for sharp shading.
  */
-void edges_sharp_from_angle_set(OffsetIndices<int> faces,
+void edges_sharp_from_angle_set(Span<int2> edges,
                                 Span<int> corner_verts,
                                 Span<int> corner_edges,
                                 Span<float3> face_normals,
                                 Span<int> corner_to_face,
+                                GroupedSpan<int> vert_to_corner_map,
                                 Span<bool> sharp_faces,
                                 const float split_angle,
                                 MutableSpan<bool> sharp_edges);
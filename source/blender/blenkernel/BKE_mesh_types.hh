@@ -30,6 +30,9 @@ struct SubsurfRuntimeData;
 namespace blender::bke {
 struct EditMeshData;
 }
+namespace blender::bvh {
+class TriangleBVH;
+}
 namespace blender::bke::bake {
 struct BakeMaterialsList;
 }
@@ -160,6 +163,8 @@ struct MeshRuntime {
 
   /** Cache for BVH trees generated for the mesh. Defined in 'BKE_bvhutil.c' */
   BVHCache *bvh_cache = nullptr;
+  /** Cache for the wide BVH of all triangles, accessed with #bvh_corner_tris_wide(). */
+  SharedCache<bvh::TriangleBVH> corner_tris_wide_bvh_cache;
 
   /** Needed in case we need to lazily initialize the mesh. */
   CustomData_MeshMasks cd_mask_extra = {};
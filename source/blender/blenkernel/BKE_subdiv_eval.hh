@@ -93,4 +93,33 @@ void eval_displacement(Subdiv *subdiv,
 /* Evaluate point on a limit surface with displacement applied to it. */
 void eval_final_point(Subdiv *subdiv, int ptex_face_index, float u, float v, float r_P[3]);
 
+/* Batched queries.
+ *
+ * These evaluate many points with a single call to the evaluator per block of points, instead of
+ * paying for the patch lookup and evaluator dispatch of every point separately. Points are sorted
+ * by ptex face so that every block touches few patches, and blocks are evaluated in parallel. */
+
+/* Location on a ptex face. */
+struct PtexCoord {
+  int ptex_face_index;
+  float u;
+  float v;
+};
+
+/* Batched version of #eval_limit_point_and_derivatives. The derivative spans may be empty. */
+void eval_limit_points(Subdiv *subdiv,
+                       Span<PtexCoord> coords,
+                       MutableSpan<float3> r_P,
+                       MutableSpan<float3> r_dPdu,
+                       MutableSpan<float3> r_dPdv);
+
+/* Batched version of #eval_limit_point_and_normal. */
+void eval_limit_points_and_normals(Subdiv *subdiv,
+                                   Span<PtexCoord> coords,
+                                   MutableSpan<float3> r_P,
+                                   MutableSpan<float3> r_N);
+
+/* Batched version of #eval_final_point. */
+void eval_final_points(Subdiv *subdiv, Span<PtexCoord> coords, MutableSpan<float3> r_P);
+
 }  // namespace blender::bke::subdiv
@@ -75,6 +75,11 @@ struct UndoStep {
   const UndoType *type;
   /** Size in bytes of all data in step (not including the step). */
   size_t data_size;
+  /**
+   * Size in bytes of the data before it was compressed, zero for step types that don't compress
+   * their data. Only used for reporting, #data_size is used for the memory limit.
+   */
+  size_t data_size_uncompressed;
   /** Users should never see this step (only use for internal consistency). */
   bool skip;
   /** Some situations require the global state to be stored, edge cases when exiting modes. */
@@ -8,12 +8,14 @@
 
 #include "MEM_guardedalloc.h"
 
+#include <algorithm>
 #include <cfloat>
 
 #include "DNA_curve_types.h"
 #include "DNA_key_types.h"
 #include "DNA_object_types.h"
 
+#include "BLI_array.hh"
 #include "BLI_math_rotation.h"
 #include "BLI_math_vector.h"
 
@@ -218,18 +220,22 @@ static bool binary_search_anim_path(const float *accum_len_arr,
   }
 }
 
-bool BKE_where_on_path(const Object *ob,
-                       float ctime,
-                       float r_vec[4],
-                       float r_dir[3],
-                       float r_quat[4],
-                       float *r_radius,
-                       float *r_weight)
+/** Validated path data of a curve object, as used by #BKE_where_on_path. */
+struct AnimPathData {
+  const BevList *bl;
+  const float *accum_len_arr;
+  int seg_size;
+  bool is_cyclic;
+  /** Type of the first curve, deciding how positions are interpolated. */
+  short nurb_type;
+};
+
+static bool anim_path_data_get(const Object *ob, AnimPathData *r_path)
 {
   if (ob == nullptr || ob->type != OB_CURVES_LEGACY) {
     return false;
   }
-  Curve *cu = static_cast<Curve *>(ob->data);
+  const Curve *cu = static_cast<const Curve *>(ob->data);
   if (ob->runtime->curve_cache == nullptr) {
     CLOG_WARN(&LOG, "No curve cache!");
     return false;
@@ -239,14 +245,90 @@ bool BKE_where_on_path(const Object *ob,
     return false;
   }
   /* We only use the first curve. */
-  BevList *bl = static_cast<BevList *>(ob->runtime->curve_cache->bev.first);
+  const BevList *bl = static_cast<const BevList *>(ob->runtime->curve_cache->bev.first);
   if (bl == nullptr || !bl->nr) {
     CLOG_WARN(&LOG, "No bev list data!");
     return false;
   }
 
+  const ListBase *nurbs = BKE_curve_editNurbs_get_for_read(cu);
+  if (!nurbs) {
+    nurbs = &cu->nurb;
+  }
+  const Nurb *nu = static_cast<const Nurb *>(nurbs->first);
+
+  r_path->bl = bl;
+  r_path->accum_len_arr = ob->runtime->curve_cache->anim_path_accum_length;
+  r_path->seg_size = get_bevlist_seg_array_size(bl);
   /* Test for cyclic curve. */
-  const bool is_cyclic = bl->poly >= 0;
+  r_path->is_cyclic = bl->poly >= 0;
+  r_path->nurb_type = nu->type;
+  return true;
+}
+
+struct AnimPathLookup {
+  AnimPathData path;
+  /** First segment for each bucket, see #lookup_anim_path. */
+  blender::Array<int> bucket_segments;
+  /** Number of buckets per unit of length. */
+  float bucket_scale;
+};
+
+/**
+ * Find the segment containing \a goal_len using the lookup table: the bucket of the length gives
+ * the first candidate segment, which is usually the right one or very close to it.
+ * Gives the same result as #binary_search_anim_path.
+ */
+static bool lookup_anim_path(const AnimPathLookup *lookup,
+                             const float goal_len,
+                             int *r_idx,
+                             float *r_frac)
+{
+  const float *accum_len_arr = lookup->path.accum_len_arr;
+  const int seg_size = lookup->path.seg_size;
+  if (lookup->bucket_segments.is_empty()) {
+    return binary_search_anim_path(accum_len_arr, seg_size, goal_len, r_idx, r_frac);
+  }
+
+  const int bucket = std::clamp(
+      int(goal_len * lookup->bucket_scale), 0, int(lookup->bucket_segments.size()) - 1);
+  int idx = lookup->bucket_segments[bucket];
+  /* Find the first segment ending after the goal. Float rounding of the bucket may require a
+   * step back. */
+  while (idx > 0 && accum_len_arr[idx - 1] > goal_len) {
+    idx--;
+  }
+  while (idx < seg_size && accum_len_arr[idx] <= goal_len) {
+    idx++;
+  }
+
+  if (UNLIKELY(idx == seg_size)) {
+    CLOG_ERROR(&LOG, "Couldn't find any valid point on the animation path!");
+    BLI_assert_msg(0, "Couldn't find any valid point on the animation path!");
+    return false;
+  }
+
+  *r_idx = idx;
+  if (idx == 0) {
+    *r_frac = goal_len / accum_len_arr[0];
+  }
+  else {
+    *r_frac = (goal_len - accum_len_arr[idx - 1]) / (accum_len_arr[idx] - accum_len_arr[idx - 1]);
+  }
+  return true;
+}
+
+static bool where_on_path_eval(const AnimPathData &path,
+                               const AnimPathLookup *lookup,
+                               float ctime,
+                               float r_vec[4],
+                               float r_dir[3],
+                               float r_quat[4],
+                               float *r_radius,
+                               float *r_weight)
+{
+  const BevList *bl = path.bl;
+  const bool is_cyclic = path.is_cyclic;
 
   if (is_cyclic) {
     /* Wrap the time into a 0.0 - 1.0 range. */
@@ -259,8 +341,8 @@ bool BKE_where_on_path(const Object *ob,
   const BevPoint *p0, *p1, *p2, *p3;
 
   float frac;
-  const int seg_size = get_bevlist_seg_array_size(bl);
-  const float *accum_len_arr = ob->runtime->curve_cache->anim_path_accum_length;
+  const int seg_size = path.seg_size;
+  const float *accum_len_arr = path.accum_len_arr;
   const float goal_len = ctime * accum_len_arr[seg_size - 1];
 
   /* Are we simply trying to get the start/end point? */
@@ -277,9 +359,11 @@ bool BKE_where_on_path(const Object *ob,
     }
   }
   else {
-    /* Do binary search to get the correct segment. */
+    /* Look up or do binary search to get the correct segment. */
     int idx;
-    const bool found_idx = binary_search_anim_path(accum_len_arr, seg_size, goal_len, &idx, &frac);
+    const bool found_idx = lookup ? lookup_anim_path(lookup, goal_len, &idx, &frac) :
+                                    binary_search_anim_path(
+                                        accum_len_arr, seg_size, goal_len, &idx, &frac);
 
     if (UNLIKELY(!found_idx)) {
       return false;
@@ -307,14 +391,8 @@ bool BKE_where_on_path(const Object *ob,
   }
   //}
 
-  const ListBase *nurbs = BKE_curve_editNurbs_get(cu);
-  if (!nurbs) {
-    nurbs = &cu->nurb;
-  }
-  const Nurb *nu = static_cast<const Nurb *>(nurbs->first);
-
   /* Make sure that first and last frame are included in the vectors here. */
-  if (ELEM(nu->type, CU_POLY, CU_BEZIER, CU_NURBS)) {
+  if (ELEM(path.nurb_type, CU_POLY, CU_BEZIER, CU_NURBS)) {
     key_curve_position_weights(frac, w, KEY_LINEAR);
   }
   else if (p2 == p3) {
@@ -377,3 +455,84 @@ bool BKE_where_on_path(const Object *ob,
 
   return true;
 }
+
+bool BKE_where_on_path(const Object *ob,
+                       float ctime,
+                       float r_vec[4],
+                       float r_dir[3],
+                       float r_quat[4],
+                       float *r_radius,
+                       float *r_weight)
+{
+  AnimPathData path;
+  if (!anim_path_data_get(ob, &path)) {
+    return false;
+  }
+  return where_on_path_eval(path, nullptr, ctime, r_vec, r_dir, r_quat, r_radius, r_weight);
+}
+
+/* -------------------------------------------------------------------- */
+/** \name Path Lookup
+ *
+ * Evaluating many points on the same path (e.g. curve deform) spends a lot of time finding the
+ * segment of each point. The lookup table splits the path length in buckets of equal length,
+ * each storing the first segment ending after the start of the bucket.
+ * \{ */
+
+AnimPathLookup *BKE_anim_path_lookup_create(const Object *ob)
+{
+  AnimPathData path;
+  if (!anim_path_data_get(ob, &path)) {
+    return nullptr;
+  }
+
+  AnimPathLookup *lookup = MEM_new<AnimPathLookup>(__func__);
+  lookup->path = path;
+
+  const int seg_size = path.seg_size;
+  const float *accum_len_arr = path.accum_len_arr;
+  const float total_len = accum_len_arr[seg_size - 1];
+  if (!(total_len > 0.0f)) {
+    /* Degenerate path, #lookup_anim_path falls back to a binary search. */
+    lookup->bucket_scale = 0.0f;
+    return lookup;
+  }
+
+  /* About one segment per bucket, so that most lookups do not need to scan. */
+  const int buckets_num = seg_size;
+  lookup->bucket_segments.reinitialize(buckets_num);
+  lookup->bucket_scale = float(buckets_num) / total_len;
+  int seg = 0;
+  for (const int bucket : lookup->bucket_segments.index_range()) {
+    const float bucket_start = float(bucket) / lookup->bucket_scale;
+    while (seg < seg_size - 1 && accum_len_arr[seg] <= bucket_start) {
+      seg++;
+    }
+    lookup->bucket_segments[bucket] = seg;
+  }
+  return lookup;
+}
+
+void BKE_anim_path_lookup_free(AnimPathLookup *lookup)
+{
+  MEM_delete(lookup);
+}
+
+bool BKE_anim_path_lookup_eval(const AnimPathLookup *lookup,
+                               const float ctime,
+                               float r_vec[4],
+                               float r_dir[3],
+                               float r_quat[4],
+                               float *r_radius,
+                               float *r_weight)
+{
+  return where_on_path_eval(
+      lookup->path, lookup, ctime, r_vec, r_dir, r_quat, r_radius, r_weight);
+}
+
+float BKE_anim_path_lookup_get_length(const AnimPathLookup *lookup)
+{
+  return lookup->path.accum_len_arr[lookup->path.seg_size - 1];
+}
+
+/** \} */
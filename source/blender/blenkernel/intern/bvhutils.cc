@@ -1153,6 +1153,50 @@ void BKE_bvhtree_from_mesh_verts_init(const Mesh &mesh,
 
 /** \} */
 
+/* -------------------------------------------------------------------- */
+/** \name Wide BVH
+ * \{ */
+
+namespace blender::bke {
+
+static bvh::TriangleBVH build_corner_tris_wide_bvh(const Mesh &mesh, const IndexMask &tris_mask)
+{
+  const Span<float3> positions = mesh.vert_positions();
+  const Span<int> corner_verts = mesh.corner_verts();
+  const Span<int3> corner_tris = mesh.corner_tris();
+  return bvh::TriangleBVH(tris_mask, [&](const int tri) -> std::array<float3, 3> {
+    const int3 &tri_corners = corner_tris[tri];
+    return {positions[corner_verts[tri_corners[0]]],
+            positions[corner_verts[tri_corners[1]]],
+            positions[corner_verts[tri_corners[2]]]};
+  });
+}
+
+const bvh::TriangleBVH &bvh_corner_tris_wide(const Mesh &mesh)
+{
+  mesh.runtime->corner_tris_wide_bvh_cache.ensure([&](bvh::TriangleBVH &r_data) {
+    r_data = build_corner_tris_wide_bvh(mesh, mesh.corner_tris().index_range());
+  });
+  return mesh.runtime->corner_tris_wide_bvh_cache.data();
+}
+
+bvh::TriangleBVH bvh_corner_tris_wide(const Mesh &mesh, const IndexMask &faces_mask)
+{
+  Array<bool> face_selection(mesh.faces_num, false);
+  faces_mask.to_bools(face_selection);
+  const Span<int> tri_faces = mesh.corner_tri_faces();
+  IndexMaskMemory memory;
+  const IndexMask tris_mask = IndexMask::from_predicate(
+      tri_faces.index_range(), GrainSize(4096), memory, [&](const int tri) {
+        return face_selection[tri_faces[tri]];
+      });
+  return build_corner_tris_wide_bvh(mesh, tris_mask);
+}
+
+}  // namespace blender::bke
+
+/** \} */
+
 /* -------------------------------------------------------------------- */
 /** \name Free Functions
  * \{ */
@@ -13,9 +13,12 @@
 #include <cstdlib>
 #include <cstring>
 
+#include "BLI_array.hh"
 #include "BLI_math_matrix.h"
 #include "BLI_math_rotation.h"
 #include "BLI_math_vector.h"
+#include "BLI_math_vector.hh"
+#include "BLI_task.hh"
 #include "BLI_utildefines.h"
 
 #include "DNA_curve_types.h"
@@ -42,6 +45,8 @@ struct CurveDeform {
   float dmin[3], dmax[3];
   float curvespace[4][4], objectspace[4][4], objectspace3[3][3];
   int no_rot_axis;
+  /** Optional, used instead of #BKE_where_on_path when deforming many points. */
+  const AnimPathLookup *path_lookup;
 };
 
 static void init_curve_deform(const Object *ob_curve, const Object *ob_target, CurveDeform *cd)
@@ -52,6 +57,7 @@ static void init_curve_deform(const Object *ob_curve, const Object *ob_target, C
   invert_m4_m4(cd->curvespace, cd->objectspace);
   copy_m3_m4(cd->objectspace3, cd->objectspace);
   cd->no_rot_axis = 0;
+  cd->path_lookup = nullptr;
 }
 
 /**
@@ -92,7 +98,8 @@ static bool calc_curve_deform(
     }
     else {
       const CurveCache *cc = ob_curve->runtime->curve_cache;
-      float totdist = BKE_anim_path_get_length(cc);
+      float totdist = cd->path_lookup ? BKE_anim_path_lookup_get_length(cd->path_lookup) :
+                                        BKE_anim_path_get_length(cc);
       if (LIKELY(totdist > FLT_EPSILON)) {
         fac = -(co[index] - cd->dmax[index]) / totdist;
       }
@@ -114,7 +121,8 @@ static bool calc_curve_deform(
     }
     else {
       const CurveCache *cc = ob_curve->runtime->curve_cache;
-      float totdist = BKE_anim_path_get_length(cc);
+      float totdist = cd->path_lookup ? BKE_anim_path_lookup_get_length(cd->path_lookup) :
+                                        BKE_anim_path_get_length(cc);
       if (LIKELY(totdist > FLT_EPSILON)) {
         fac = +(co[index] - cd->dmin[index]) / totdist;
       }
@@ -124,7 +132,11 @@ static bool calc_curve_deform(
     }
   }
 
-  if (BKE_where_on_path(ob_curve, fac, loc, dir, new_quat, &radius, nullptr)) { /* returns OK */
+  const bool found = cd->path_lookup ?
+                        BKE_anim_path_lookup_eval(
+                            cd->path_lookup, fac, loc, dir, new_quat, &radius, nullptr) :
+                        BKE_where_on_path(ob_curve, fac, loc, dir, new_quat, &radius, nullptr);
+  if (found) {
     float quat[4], cent[3];
 
     if (cd->no_rot_axis) { /* set by caller */
@@ -206,13 +218,11 @@ static void curve_deform_coords_impl(const Object *ob_curve,
                                      const short defaxis,
                                      const BMEditMesh *em_target)
 {
+  using namespace blender;
   Curve *cu;
-  int a;
   CurveDeform cd;
   const bool is_neg_axis = (defaxis > 2);
   const bool invert_vgroup = (flag & MOD_CURVE_INVERT_VGROUP) != 0;
-  bool use_dverts = false;
-  int cd_dvert_offset;
 
   if (ob_curve->type != OB_CURVES_LEGACY) {
     return;
@@ -239,128 +249,94 @@ static void curve_deform_coords_impl(const Object *ob_curve,
     INIT_MINMAX(cd.dmin, cd.dmax);
   }
 
+  /* Vertex group weights, empty when all vertices are fully deformed. Edit-mesh weights are
+   * gathered up-front so that the deformation below is the same for both kinds of input. */
+  Array<float> weights;
+  const auto get_weight = [&](const MDeformVert *dv) {
+    const float weight = BKE_defvert_find_weight(dv, defgrp_index);
+    return invert_vgroup ? 1.0f - weight : weight;
+  };
   if (em_target != nullptr) {
-    cd_dvert_offset = CustomData_get_offset(&em_target->bm->vdata, CD_MDEFORMVERT);
+    const int cd_dvert_offset = CustomData_get_offset(&em_target->bm->vdata, CD_MDEFORMVERT);
     if (cd_dvert_offset != -1) {
-      use_dverts = true;
+      weights.reinitialize(vert_coords_len);
+      BMIter iter;
+      BMVert *v;
+      int a;
+      BM_ITER_MESH_INDEX (v, &iter, em_target->bm, BM_VERTS_OF_MESH, a) {
+        weights[a] = get_weight(
+            static_cast<const MDeformVert *>(BM_ELEM_CD_GET_VOID_P(v, cd_dvert_offset)));
+      }
     }
   }
-  else {
-    if (dvert != nullptr) {
-      use_dverts = true;
-    }
+  else if (dvert != nullptr) {
+    weights.reinitialize(vert_coords_len);
+    threading::parallel_for(IndexRange(vert_coords_len), 4096, [&](const IndexRange range) {
+      for (const int a : range) {
+        weights[a] = get_weight(&dvert[a]);
+      }
+    });
   }
+  const bool use_weights = !weights.is_empty();
+  const auto is_deformed = [&](const int a) { return !use_weights || weights[a] > 0.0f; };
 
-  if (use_dverts) {
-    if (cu->flag & CU_DEFORM_BOUNDS_OFF) {
-
-#define DEFORM_OP(dvert) \
-  { \
-    const float weight = invert_vgroup ? 1.0f - BKE_defvert_find_weight(dvert, defgrp_index) : \
-                                         BKE_defvert_find_weight(dvert, defgrp_index); \
-    if (weight > 0.0f) { \
-      float vec[3]; \
-      mul_m4_v3(cd.curvespace, vert_coords[a]); \
-      copy_v3_v3(vec, vert_coords[a]); \
-      calc_curve_deform(ob_curve, vec, defaxis, &cd, nullptr); \
-      interp_v3_v3v3(vert_coords[a], vert_coords[a], vec, weight); \
-      mul_m4_v3(cd.objectspace, vert_coords[a]); \
-    } \
-  } \
-  ((void)0)
-
-      if (em_target != nullptr) {
-        BMIter iter;
-        BMVert *v;
-        BM_ITER_MESH_INDEX (v, &iter, em_target->bm, BM_VERTS_OF_MESH, a) {
-          dvert = static_cast<const MDeformVert *>(BM_ELEM_CD_GET_VOID_P(v, cd_dvert_offset));
-          DEFORM_OP(dvert);
-        }
-      }
-      else {
-        for (a = 0; a < vert_coords_len; a++) {
-          DEFORM_OP(&dvert[a]);
-        }
+  /* Move to curve space. */
+  threading::parallel_for(IndexRange(vert_coords_len), 4096, [&](const IndexRange range) {
+    for (const int a : range) {
+      if (is_deformed(a)) {
+        mul_m4_v3(cd.curvespace, vert_coords[a]);
       }
-
-#undef DEFORM_OP
     }
-    else {
-
-#define DEFORM_OP_MINMAX(dvert) \
-  { \
-    const float weight = invert_vgroup ? 1.0f - BKE_defvert_find_weight(dvert, defgrp_index) : \
-                                         BKE_defvert_find_weight(dvert, defgrp_index); \
-    if (weight > 0.0f) { \
-      mul_m4_v3(cd.curvespace, vert_coords[a]); \
-      minmax_v3v3_v3(cd.dmin, cd.dmax, vert_coords[a]); \
-    } \
-  } \
-  ((void)0)
-
-/* Already in 'cd.curvespace', previous for loop. */
-#define DEFORM_OP_CLAMPED(dvert) \
-  { \
-    const float weight = invert_vgroup ? 1.0f - BKE_defvert_find_weight(dvert, defgrp_index) : \
-                                         BKE_defvert_find_weight(dvert, defgrp_index); \
-    if (weight > 0.0f) { \
-      float vec[3]; \
-      copy_v3_v3(vec, vert_coords[a]); \
-      calc_curve_deform(ob_curve, vec, defaxis, &cd, nullptr); \
-      interp_v3_v3v3(vert_coords[a], vert_coords[a], vec, weight); \
-      mul_m4_v3(cd.objectspace, vert_coords[a]); \
-    } \
-  } \
-  ((void)0)
-
-      if (em_target != nullptr) {
-        BMIter iter;
-        BMVert *v;
-        BM_ITER_MESH_INDEX (v, &iter, em_target->bm, BM_VERTS_OF_MESH, a) {
-          dvert = static_cast<const MDeformVert *>(BM_ELEM_CD_GET_VOID_P(v, cd_dvert_offset));
-          DEFORM_OP_MINMAX(dvert);
-        }
-
-        BM_ITER_MESH_INDEX (v, &iter, em_target->bm, BM_VERTS_OF_MESH, a) {
-          dvert = static_cast<const MDeformVert *>(BM_ELEM_CD_GET_VOID_P(v, cd_dvert_offset));
-          DEFORM_OP_CLAMPED(dvert);
-        }
-      }
-      else {
-
-        for (a = 0; a < vert_coords_len; a++) {
-          DEFORM_OP_MINMAX(&dvert[a]);
-        }
+  });
+
+  if (!(cu->flag & CU_DEFORM_BOUNDS_OFF)) {
+    struct Bounds {
+      float3 min, max;
+    };
+    const Bounds bounds = threading::parallel_reduce(
+        IndexRange(vert_coords_len),
+        4096,
+        Bounds{float3(cd.dmin), float3(cd.dmax)},
+        [&](const IndexRange range, Bounds bounds) {
+          for (const int a : range) {
+            if (is_deformed(a)) {
+              minmax_v3v3_v3(bounds.min, bounds.max, vert_coords[a]);
+            }
+          }
+          return bounds;
+        },
+        [](const Bounds &a, const Bounds &b) {
+          return Bounds{math::min(a.min, b.min), math::max(a.max, b.max)};
+        });
+    copy_v3_v3(cd.dmin, bounds.min);
+    copy_v3_v3(cd.dmax, bounds.max);
+  }
 
-        for (a = 0; a < vert_coords_len; a++) {
-          DEFORM_OP_CLAMPED(&dvert[a]);
-        }
-      }
-    }
+  /* The path lookup avoids searching the whole path for every vertex. */
+  AnimPathLookup *path_lookup = ob_curve->runtime->curve_cache &&
+                                        ob_curve->runtime->curve_cache->anim_path_accum_length ?
+                                    BKE_anim_path_lookup_create(ob_curve) :
+                                    nullptr;
+  cd.path_lookup = path_lookup;
 
-#undef DEFORM_OP_MINMAX
-#undef DEFORM_OP_CLAMPED
-  }
-  else {
-    if (cu->flag & CU_DEFORM_BOUNDS_OFF) {
-      for (a = 0; a < vert_coords_len; a++) {
-        mul_m4_v3(cd.curvespace, vert_coords[a]);
+  threading::parallel_for(IndexRange(vert_coords_len), 512, [&](const IndexRange range) {
+    for (const int a : range) {
+      if (!use_weights) {
         calc_curve_deform(ob_curve, vert_coords[a], defaxis, &cd, nullptr);
         mul_m4_v3(cd.objectspace, vert_coords[a]);
       }
-    }
-    else {
-      for (a = 0; a < vert_coords_len; a++) {
-        mul_m4_v3(cd.curvespace, vert_coords[a]);
-        minmax_v3v3_v3(cd.dmin, cd.dmax, vert_coords[a]);
-      }
-
-      for (a = 0; a < vert_coords_len; a++) {
-        /* Already in 'cd.curvespace', previous for loop. */
-        calc_curve_deform(ob_curve, vert_coords[a], defaxis, &cd, nullptr);
+      else if (weights[a] > 0.0f) {
+        float vec[3];
+        copy_v3_v3(vec, vert_coords[a]);
+        calc_curve_deform(ob_curve, vec, defaxis, &cd, nullptr);
+        interp_v3_v3v3(vert_coords[a], vert_coords[a], vec, weights[a]);
         mul_m4_v3(cd.objectspace, vert_coords[a]);
       }
     }
+  });
+
+  if (path_lookup) {
+    BKE_anim_path_lookup_free(path_lookup);
   }
 }
 
@@ -36,6 +36,7 @@
 #include "BLI_string_ref.hh"
 #include "BLI_string_utf8.h"
 #include "BLI_string_utils.hh"
+#include "BLI_task.hh"
 #include "BLI_utildefines.h"
 
 #ifndef NDEBUG
@@ -5178,7 +5179,8 @@ void customdata_data_transfer_interp_normal_normals(const CustomDataTransferLaye
 void CustomData_data_transfer(const MeshPairRemap *me_remap,
                               const CustomDataTransferLayerMap *laymap)
 {
-  MeshPairRemapItem *mapit = me_remap->items;
+  using namespace blender;
+  const MeshPairRemapItem *items = me_remap->items;
   const int totelem = me_remap->items_num;
 
   const int data_type = laymap->data_type;
@@ -5191,19 +5193,11 @@ void CustomData_data_transfer(const MeshPairRemap *me_remap,
 
   cd_datatransfer_interp interp = nullptr;
 
-  size_t tmp_buff_size = 32;
-  const void **tmp_data_src = nullptr;
-
   /* NOTE: null data_src may happen and be valid (see vgroups...). */
   if (!data_dst) {
     return;
   }
 
-  if (data_src) {
-    tmp_data_src = (const void **)MEM_malloc_arrayN(
-        tmp_buff_size, sizeof(*tmp_data_src), __func__);
-  }
-
   if (int(data_type) & CD_FAKE) {
     data_step = laymap->elem_size;
     data_size = laymap->data_size;
@@ -5220,38 +5214,36 @@ void CustomData_data_transfer(const MeshPairRemap *me_remap,
 
   interp = laymap->interp ? laymap->interp : customdata_data_transfer_interp_generic;
 
-  for (int i = 0; i < totelem; i++, data_dst = POINTER_OFFSET(data_dst, data_step), mapit++) {
-    const int sources_num = mapit->sources_num;
-    const float mix_factor = laymap->mix_factor *
-                             (laymap->mix_weights ? laymap->mix_weights[i] : 1.0f);
-
-    if (!sources_num) {
-      /* No sources for this element, skip it. */
-      continue;
-    }
-
-    if (tmp_data_src) {
-      if (UNLIKELY(sources_num > tmp_buff_size)) {
-        tmp_buff_size = size_t(sources_num);
-        tmp_data_src = (const void **)MEM_reallocN((void *)tmp_data_src,
-                                                   sizeof(*tmp_data_src) * tmp_buff_size);
+  /* Every destination element is only written by its own interpolation callback, so the
+   * elements can be processed in parallel. Each task keeps its own source pointer buffer. */
+  threading::parallel_for(IndexRange(totelem), 1024, [&](const IndexRange range) {
+    Vector<const void *, 32> tmp_data_src;
+    for (const int i : range) {
+      const MeshPairRemapItem &mapit = items[i];
+      const int sources_num = mapit.sources_num;
+      if (!sources_num) {
+        /* No sources for this element, skip it. */
+        continue;
       }
-
-      for (int j = 0; j < sources_num; j++) {
-        const size_t src_idx = size_t(mapit->indices_src[j]);
-        tmp_data_src[j] = POINTER_OFFSET(data_src, (data_step * src_idx) + data_offset);
+      const float mix_factor = laymap->mix_factor *
+                               (laymap->mix_weights ? laymap->mix_weights[i] : 1.0f);
+
+      if (data_src) {
+        tmp_data_src.resize(sources_num);
+        for (int j = 0; j < sources_num; j++) {
+          const size_t src_idx = size_t(mapit.indices_src[j]);
+          tmp_data_src[j] = POINTER_OFFSET(data_src, (data_step * src_idx) + data_offset);
+        }
       }
-    }
 
-    interp(laymap,
-           POINTER_OFFSET(data_dst, data_offset),
-           tmp_data_src,
-           mapit->weights_src,
-           sources_num,
-           mix_factor);
-  }
-
-  MEM_SAFE_FREE(tmp_data_src);
+      interp(laymap,
+             POINTER_OFFSET(data_dst, (data_step * size_t(i)) + data_offset),
+             data_src ? tmp_data_src.data() : nullptr,
+             mapit.weights_src,
+             sources_num,
+             mix_factor);
+    }
+  });
 }
 
 /** \} */
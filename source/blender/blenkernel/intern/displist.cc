@@ -16,6 +16,7 @@
 #include "DNA_mesh_types.h"
 #include "DNA_object_types.h"
 
+#include "BLI_array.hh"
 #include "BLI_index_range.hh"
 #include "BLI_listbase.h"
 #include "BLI_math_rotation.h"
@@ -23,7 +24,9 @@
 #include "BLI_scanfill.h"
 #include "BLI_span.hh"
 #include "BLI_string.h"
+#include "BLI_task.hh"
 #include "BLI_utildefines.h"
+#include "BLI_vector.hh"
 
 #include "BKE_anim_path.h"
 #include "BKE_curve.hh"
@@ -43,7 +46,10 @@
 #include "DEG_depsgraph.hh"
 #include "DEG_depsgraph_query.hh"
 
+using blender::Array;
 using blender::IndexRange;
+using blender::Span;
+using blender::Vector;
 
 static void displist_elem_free(DispList *dl)
 {
@@ -109,6 +115,32 @@ bool BKE_displist_surfindex_get(
   return true;
 }
 
+/**
+ * Evaluate the display lists of independent splines in parallel. Every spline writes to its own
+ * list, these are appended to \a r_dispbase afterwards to keep the order of serial evaluation.
+ */
+template<typename T, typename SizeFn, typename EvalFn>
+static void displist_eval_splines_parallel(const Span<T> splines,
+                                           const SizeFn &size_fn,
+                                           const EvalFn &eval_fn,
+                                           ListBase *r_dispbase)
+{
+  Array<ListBase> dispbases(splines.size(), ListBase{nullptr, nullptr});
+  blender::threading::parallel_for(
+      splines.index_range(),
+      1024,
+      [&](const IndexRange range) {
+        for (const int64_t i : range) {
+          eval_fn(splines[i], &dispbases[i]);
+        }
+      },
+      blender::threading::individual_task_sizes(
+          [&](const int64_t i) { return size_fn(splines[i]); }));
+  for (ListBase &dispbase : dispbases) {
+    BLI_movelisttolist(r_dispbase, &dispbase);
+  }
+}
+
 #ifdef __INTEL_COMPILER
 /* ICC with the optimization -02 causes crashes. */
 #  pragma intel optimization_level 1
@@ -121,13 +153,18 @@ static void curve_to_displist(const Curve *cu,
 {
   const bool editmode = (!for_render && (cu->editnurb || cu->editfont));
 
-  LISTBASE_FOREACH (Nurb *, nu, nubase) {
+  Vector<const Nurb *> nurbs;
+  LISTBASE_FOREACH (const Nurb *, nu, nubase) {
     if (nu->hide != 0 && editmode) {
       continue;
     }
     if (!BKE_nurb_check_valid_u(nu)) {
       continue;
     }
+    nurbs.append(nu);
+  }
+
+  const auto eval_nurb = [&](const Nurb *nu, ListBase *dispbase) {
 
     const int resolution = (for_render && cu->resolu_ren != 0) ? cu->resolu_ren : nu->resolu;
     const bool is_cyclic = nu->flagu & CU_NURB_CYCLIC;
@@ -168,7 +205,7 @@ static void curve_to_displist(const Curve *cu,
       DispList *dl = MEM_cnew<DispList>(__func__);
       /* Add one to the length because of 'BKE_curve_forward_diff_bezier'. */
       dl->verts = (float *)MEM_mallocN(sizeof(float[3]) * (samples_len + 1), __func__);
-      BLI_addtail(r_dispbase, dl);
+      BLI_addtail(dispbase, dl);
       dl->parts = 1;
       dl->nr = samples_len;
       dl->col = nu->mat_nr;
@@ -222,7 +259,7 @@ static void curve_to_displist(const Curve *cu,
       const int len = (resolution * SEGMENTSU(nu));
       DispList *dl = MEM_cnew<DispList>(__func__);
       dl->verts = (float *)MEM_mallocN(len * sizeof(float[3]), __func__);
-      BLI_addtail(r_dispbase, dl);
+      BLI_addtail(dispbase, dl);
       dl->parts = 1;
       dl->nr = len;
       dl->col = nu->mat_nr;
@@ -235,7 +272,7 @@ static void curve_to_displist(const Curve *cu,
       const int len = nu->pntsu;
       DispList *dl = MEM_cnew<DispList>(__func__);
       dl->verts = (float *)MEM_mallocN(len * sizeof(float[3]), __func__);
-      BLI_addtail(r_dispbase, dl);
+      BLI_addtail(dispbase, dl);
       dl->parts = 1;
       dl->nr = len;
       dl->col = nu->mat_nr;
@@ -248,7 +285,13 @@ static void curve_to_displist(const Curve *cu,
         copy_v3_v3(coords[i], bp->vec);
       }
     }
-  }
+  };
+
+  displist_eval_splines_parallel(
+      nurbs.as_span(),
+      [&](const Nurb *nu) { return int64_t(nu->pntsu) * nu->resolu; },
+      eval_nurb,
+      r_dispbase);
 }
 
 void BKE_displist_fill(const ListBase *dispbase,
@@ -495,6 +538,19 @@ static float displist_calc_taper(Depsgraph *depsgraph,
   return 1.0;
 }
 
+/**
+ * Create the display list of the taper object if needed, so that #displist_calc_taper can be
+ * called from multiple threads afterwards. Returns false when that is not possible.
+ */
+static bool displist_taper_ensure(Depsgraph *depsgraph, const Scene *scene, Object *taperobj)
+{
+  if (taperobj == nullptr || taperobj->type != OB_CURVES_LEGACY) {
+    return true;
+  }
+  displist_calc_taper(depsgraph, scene, taperobj, 0.0f);
+  return taperobj->runtime->curve_cache && taperobj->runtime->curve_cache->disp.first;
+}
+
 float BKE_displist_calc_taper(
     Depsgraph *depsgraph, const Scene *scene, Object *taperobj, int cur, int tot)
 {
@@ -809,10 +865,15 @@ static blender::bke::GeometrySet evaluate_surface_object(Depsgraph *depsgraph,
 
   BKE_curve_calc_modifiers_pre(depsgraph, scene, ob, deformed_nurbs, deformed_nurbs, for_render);
 
+  Vector<const Nurb *> nurbs;
   LISTBASE_FOREACH (const Nurb *, nu, deformed_nurbs) {
     if (!(for_render || nu->hide == 0) || !BKE_nurb_check_valid_uv(nu)) {
       continue;
     }
+    nurbs.append(nu);
+  }
+
+  const auto eval_nurb = [&](const Nurb *nu, ListBase *dispbase) {
 
     const int resolu = (for_render && cu->resolu_ren) ? cu->resolu_ren : nu->resolu;
     const int resolv = (for_render && cu->resolv_ren) ? cu->resolv_ren : nu->resolv;
@@ -823,7 +884,7 @@ static blender::bke::GeometrySet evaluate_surface_object(Depsgraph *depsgraph,
       DispList *dl = MEM_cnew<DispList>(__func__);
       dl->verts = (float *)MEM_mallocN(len * sizeof(float[3]), __func__);
 
-      BLI_addtail(r_dispbase, dl);
+      BLI_addtail(dispbase, dl);
       dl->parts = 1;
       dl->nr = len;
       dl->col = nu->mat_nr;
@@ -845,7 +906,7 @@ static blender::bke::GeometrySet evaluate_surface_object(Depsgraph *depsgraph,
 
       DispList *dl = MEM_cnew<DispList>(__func__);
       dl->verts = (float *)MEM_mallocN(len * sizeof(float[3]), __func__);
-      BLI_addtail(r_dispbase, dl);
+      BLI_addtail(dispbase, dl);
 
       dl->col = nu->mat_nr;
       dl->charidx = nu->charidx;
@@ -868,7 +929,13 @@ static blender::bke::GeometrySet evaluate_surface_object(Depsgraph *depsgraph,
       /* gl array drawing: using indices */
       displist_surf_indices(dl);
     }
-  }
+  };
+
+  displist_eval_splines_parallel(
+      nurbs.as_span(),
+      [&](const Nurb *nu) { return int64_t(nu->pntsu) * nu->resolu * nu->pntsv * nu->resolv; },
+      eval_nurb,
+      r_dispbase);
 
   curve_to_filledpoly(cu, r_dispbase);
   blender::bke::GeometrySet geometry_set = curve_calc_modifiers_post(
@@ -1136,20 +1203,31 @@ static blender::bke::GeometrySet evaluate_curve_type_object(Depsgraph *depsgraph
   else {
     const float widfac = cu->offset - 1.0f;
 
-    const BevList *bl = (BevList *)ob->runtime->curve_cache->bev.first;
-    const Nurb *nu = (Nurb *)deformed_nurbs->first;
-    for (; bl && nu; bl = bl->next, nu = nu->next) {
-      float *data;
+    /* The taper curve is evaluated on demand, make sure that is done before the splines are
+     * evaluated in parallel. */
+    const bool use_threading = displist_taper_ensure(depsgraph, scene, cu->taperobj);
 
-      if (bl->nr == 0) { /* blank bevel lists can happen */
+    using BevSpline = std::pair<const BevList *, const Nurb *>;
+    Vector<BevSpline> splines;
+    const BevList *bl_iter = (BevList *)ob->runtime->curve_cache->bev.first;
+    const Nurb *nu_iter = (Nurb *)deformed_nurbs->first;
+    for (; bl_iter && nu_iter; bl_iter = bl_iter->next, nu_iter = nu_iter->next) {
+      if (bl_iter->nr == 0) { /* blank bevel lists can happen */
         continue;
       }
+      splines.append({bl_iter, nu_iter});
+    }
+
+    const auto eval_spline = [&](const BevSpline &spline, ListBase *dispbase) {
+      const BevList *bl = spline.first;
+      const Nurb *nu = spline.second;
+      float *data;
 
       /* exception handling; curve without bevel or extrude, with width correction */
       if (BLI_listbase_is_empty(&dlbev)) {
         DispList *dl = MEM_cnew<DispList>("makeDispListbev");
         dl->verts = (float *)MEM_mallocN(sizeof(float[3]) * bl->nr, "dlverts");
-        BLI_addtail(r_dispbase, dl);
+        BLI_addtail(dispbase, dl);
 
         if (bl->poly != -1) {
           dl->type = DL_POLY;
@@ -1189,7 +1267,7 @@ static blender::bke::GeometrySet evaluate_curve_type_object(Depsgraph *depsgraph
         }
         else {
           if (fabsf(cu->bevfac2 - cu->bevfac1) < FLT_EPSILON) {
-            continue;
+            return;
           }
 
           calc_bevfac_mapping(cu, bl, nu, &start, &first_blend, &steps, &last_blend);
@@ -1199,7 +1277,7 @@ static blender::bke::GeometrySet evaluate_curve_type_object(Depsgraph *depsgraph
           /* For each part of the bevel use a separate display-block. */
           DispList *dl = MEM_cnew<DispList>(__func__);
           dl->verts = data = (float *)MEM_mallocN(sizeof(float[3]) * dlb->nr * steps, __func__);
-          BLI_addtail(r_dispbase, dl);
+          BLI_addtail(dispbase, dl);
 
           dl->type = DL_SURF;
 
@@ -1295,12 +1373,25 @@ static blender::bke::GeometrySet evaluate_curve_type_object(Depsgraph *depsgraph
         }
 
         if (bottom_capbase.first) {
-          BKE_displist_fill(&bottom_capbase, r_dispbase, bottom_no, false);
-          BKE_displist_fill(&top_capbase, r_dispbase, top_no, false);
+          BKE_displist_fill(&bottom_capbase, dispbase, bottom_no, false);
+          BKE_displist_fill(&top_capbase, dispbase, top_no, false);
           BKE_displist_free(&bottom_capbase);
           BKE_displist_free(&top_capbase);
         }
       }
+    };
+
+    if (use_threading) {
+      displist_eval_splines_parallel(
+          splines.as_span(),
+          [&](const BevSpline &spline) { return int64_t(spline.first->nr); },
+          eval_spline,
+          r_dispbase);
+    }
+    else {
+      for (const BevSpline &spline : splines) {
+        eval_spline(spline, r_dispbase);
+      }
     }
   }
 
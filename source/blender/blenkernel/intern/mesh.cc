@@ -148,6 +148,7 @@ static void mesh_copy_data(Main *bmain,
   mesh_dst->runtime->verts_no_face_cache = mesh_src->runtime->verts_no_face_cache;
   mesh_dst->runtime->loose_edges_cache = mesh_src->runtime->loose_edges_cache;
   mesh_dst->runtime->corner_tris_cache = mesh_src->runtime->corner_tris_cache;
+  mesh_dst->runtime->corner_tris_wide_bvh_cache = mesh_src->runtime->corner_tris_wide_bvh_cache;
   mesh_dst->runtime->corner_tri_faces_cache = mesh_src->runtime->corner_tri_faces_cache;
   mesh_dst->runtime->vert_to_face_offset_cache = mesh_src->runtime->vert_to_face_offset_cache;
   mesh_dst->runtime->vert_to_face_map_cache = mesh_src->runtime->vert_to_face_map_cache;
@@ -1214,11 +1215,12 @@ void mesh_sharp_edges_set_from_angle(Mesh &mesh, const float angle, const bool k
   SpanAttributeWriter<bool> sharp_edges = attributes.lookup_or_add_for_write_span<bool>(
       "sharp_edge", AttrDomain::Edge);
   const VArraySpan<bool> sharp_faces = *attributes.lookup<bool>("sharp_face", AttrDomain::Face);
-  mesh::edges_sharp_from_angle_set(mesh.faces(),
+  mesh::edges_sharp_from_angle_set(mesh.edges(),
                                    mesh.corner_verts(),
                                    mesh.corner_edges(),
                                    mesh.face_normals(),
                                    mesh.corner_to_face_map(),
+                                   mesh.vert_to_corner_map(),
                                    sharp_faces,
                                    angle,
                                    sharp_edges.span);
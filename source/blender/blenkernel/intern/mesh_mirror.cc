@@ -414,6 +414,7 @@ Mesh *BKE_mesh_mirror_apply_mirror_on_axis_for_modifier(MirrorModifierData *mmd,
                                              result_corner_verts,
                                              result_corner_edges,
                                              result->corner_to_face_map(),
+                                             result->vert_to_corner_map(),
                                              result->vert_normals(),
                                              result->face_normals(),
                                              sharp_edges,
@@ -19,6 +19,7 @@
 
 #include "BLI_array_utils.hh"
 #include "BLI_bit_vector.hh"
+#include "BLI_index_mask.hh"
 #include "BLI_linklist.h"
 #include "BLI_math_base.hh"
 #include "BLI_math_vector.hh"
@@ -296,6 +297,7 @@ blender::Span<blender::float3> Mesh::corner_normals() const
                                    this->corner_verts(),
                                    this->corner_edges(),
                                    this->corner_to_face_map(),
+                                   this->vert_to_corner_map(),
                                    this->vert_normals(),
                                    this->face_normals(),
                                    sharp_edges,
@@ -636,6 +638,7 @@ struct CornerSplitTaskDataCommon {
   OffsetIndices<int> faces;
   Span<int2> edge_to_corners;
   Span<int> corner_to_face;
+  GroupedSpan<int> vert_to_corner_map;
   Span<float3> face_normals;
   Span<float3> vert_normals;
   Span<short2> clnors_data;
@@ -646,15 +649,58 @@ struct CornerSplitTaskDataCommon {
 /* See comment about edge_to_corners below. */
 #define IS_EDGE_SHARP(_e2l) ELEM((_e2l)[1], INDEX_UNSET, INDEX_INVALID)
 
-static void mesh_edges_sharp_tag(const OffsetIndices<int> faces,
+/**
+ * The number of corners using an edge, and the two of them with the lowest indices. The corners
+ * using an edge are found among the corners of its vertices.
+ */
+struct EdgeCornerUsers {
+  int num = 0;
+  int first = INT_MAX;
+  int second = INT_MAX;
+};
+
+static EdgeCornerUsers edge_corner_users_find(const int2 &edge_verts,
+                                              const int edge,
+                                              const Span<int> corner_edges,
+                                              const GroupedSpan<int> vert_to_corner_map)
+{
+  EdgeCornerUsers users;
+  auto add_vert_corners = [&](const int vert) {
+    for (const int corner : vert_to_corner_map[vert]) {
+      if (corner_edges[corner] != edge) {
+        continue;
+      }
+      users.num++;
+      if (corner < users.first) {
+        users.second = users.first;
+        users.first = corner;
+      }
+      else if (corner < users.second) {
+        users.second = corner;
+      }
+    }
+  };
+  add_vert_corners(edge_verts[0]);
+  if (edge_verts[1] != edge_verts[0]) {
+    add_vert_corners(edge_verts[1]);
+  }
+  return users;
+}
+
+/**
+ * Tag edges as sharp when the angle between the normals of their two faces is above
+ * \a split_angle. Smooth edges used by more than two faces are untagged, since they are sharp
+ * for other reasons than the angle.
+ */
+static void mesh_edges_sharp_tag(const Span<int2> edges,
                                  const Span<int> corner_verts,
                                  const Span<int> corner_edges,
                                  const Span<int> corner_to_face_map,
+                                 const GroupedSpan<int> vert_to_corner_map,
                                  const Span<float3> face_normals,
                                  const Span<bool> sharp_faces,
                                  const Span<bool> sharp_edges,
                                  const float split_angle,
-                                 MutableSpan<int2> edge_to_corners,
                                  MutableSpan<bool> r_sharp_edges)
 {
   const float split_angle_cos = cosf(split_angle);
@@ -662,64 +708,52 @@ static void mesh_edges_sharp_tag(const OffsetIndices<int> faces,
     return sharp_faces.is_empty() || !sharp_faces[face_i];
   };
 
-  for (const int face_i : faces.index_range()) {
-    for (const int corner : faces[face_i]) {
-      const int vert = corner_verts[corner];
-      const int edge = corner_edges[corner];
-
-      int2 &e2l = edge_to_corners[edge];
-
-      /* Check whether current edge might be smooth or sharp */
-      if ((e2l[0] | e2l[1]) == 0) {
-        /* 'Empty' edge until now, set e2l[0] (and e2l[1] to INDEX_UNSET to tag it as unset). */
-        e2l[0] = corner;
-        /* We have to check this here too, else we might miss some flat faces!!! */
-        e2l[1] = face_is_smooth(face_i) ? INDEX_UNSET : INDEX_INVALID;
+  threading::parallel_for(edges.index_range(), 1024, [&](const IndexRange range) {
+    for (const int edge : range) {
+      const EdgeCornerUsers users = edge_corner_users_find(
+          edges[edge], edge, corner_edges, vert_to_corner_map);
+      if (users.num < 2) {
+        continue;
       }
-      else if (e2l[1] == INDEX_UNSET) {
-        const bool is_angle_sharp = math::dot(face_normals[corner_to_face_map[e2l[0]]],
-                                              face_normals[face_i]) < split_angle_cos;
-
-        /* Second corner using this edge, time to test its sharpness.
-         * An edge is sharp if it is tagged as such, or its face is not smooth,
-         * or both faces have opposed (flipped) normals, i.e. both corners on the same edge share
-         * the same vertex, or angle between both its faces' normals is above split_angle value. */
-        if (!face_is_smooth(face_i) || (!sharp_edges.is_empty() && sharp_edges[edge]) ||
-            vert == corner_verts[e2l[0]] || is_angle_sharp)
-        {
-          /* NOTE: we are sure that corner != 0 here ;). */
-          e2l[1] = INDEX_INVALID;
-
-          /* We want to avoid tagging edges as sharp when it is already defined as such by
-           * other causes than angle threshold. */
-          if (is_angle_sharp) {
-            r_sharp_edges[edge] = true;
-          }
-        }
-        else {
-          e2l[1] = corner;
-        }
+      const int face_first = corner_to_face_map[users.first];
+      const int face_second = corner_to_face_map[users.second];
+      if (!face_is_smooth(face_first)) {
+        /* The edge is sharp already because of its first face. */
+        continue;
       }
-      else if (!IS_EDGE_SHARP(e2l)) {
-        /* More than two corners using this edge, tag as sharp if not yet done. */
-        e2l[1] = INDEX_INVALID;
-
+      const bool is_angle_sharp = math::dot(face_normals[face_first],
+                                            face_normals[face_second]) < split_angle_cos;
+
+      /* An edge is sharp if it is tagged as such, or its face is not smooth,
+       * or both faces have opposed (flipped) normals, i.e. both corners on the same edge share
+       * the same vertex, or angle between both its faces' normals is above split_angle value. */
+      if (!face_is_smooth(face_second) || (!sharp_edges.is_empty() && sharp_edges[edge]) ||
+          corner_verts[users.first] == corner_verts[users.second] || is_angle_sharp)
+      {
         /* We want to avoid tagging edges as sharp when it is already defined as such by
          * other causes than angle threshold. */
+        if (is_angle_sharp) {
+          r_sharp_edges[edge] = true;
+        }
+      }
+      else if (users.num > 2) {
+        /* More than two corners using this edge, it is sharp but not because of the angle. */
         r_sharp_edges[edge] = false;
       }
-      /* Else, edge is already 'disqualified' (i.e. sharp)! */
     }
-  }
+  });
 }
 
 /**
  * Builds a simplified map from edges to face corners, marking special values when
  * it encounters sharp edges or borders between faces with flipped winding orders.
+ * See #normals_calc_corners for details.
  */
-static void build_edge_to_corner_map_with_flip_and_sharp(const OffsetIndices<int> faces,
+static void build_edge_to_corner_map_with_flip_and_sharp(const Span<int2> edges,
                                                          const Span<int> corner_verts,
                                                          const Span<int> corner_edges,
+                                                         const Span<int> corner_to_face,
+                                                         const GroupedSpan<int> vert_to_corner_map,
                                                          const Span<bool> sharp_faces,
                                                          const Span<bool> sharp_edges,
                                                          MutableSpan<int2> edge_to_corners)
@@ -728,49 +762,49 @@ static void build_edge_to_corner_map_with_flip_and_sharp(const OffsetIndices<int
     return sharp_faces.is_empty() || !sharp_faces[face_i];
   };
 
-  for (const int face_i : faces.index_range()) {
-    for (const int corner : faces[face_i]) {
-      const int vert = corner_verts[corner];
-      const int edge = corner_edges[corner];
-
+  threading::parallel_for(edges.index_range(), 1024, [&](const IndexRange range) {
+    for (const int edge : range) {
+      const EdgeCornerUsers users = edge_corner_users_find(
+          edges[edge], edge, corner_edges, vert_to_corner_map);
       int2 &e2l = edge_to_corners[edge];
-
-      /* Check whether current edge might be smooth or sharp */
-      if ((e2l[0] | e2l[1]) == 0) {
-        /* 'Empty' edge until now, set e2l[0] (and e2l[1] to INDEX_UNSET to tag it as unset). */
-        e2l[0] = corner;
-        /* We have to check this here too, else we might miss some flat faces!!! */
-        e2l[1] = !face_is_smooth(face_i) ? INDEX_INVALID : INDEX_UNSET;
+      if (users.num == 0) {
+        /* Loose edge. */
+        e2l = int2(0);
+        continue;
       }
-      else if (e2l[1] == INDEX_UNSET) {
-        /* Second corner using this edge, time to test its sharpness.
-         * An edge is sharp if it is tagged as such, or its face is not smooth,
-         * or both face have opposed (flipped) normals, i.e. both corners on the same edge share
-         * the same vertex. */
-        if (!face_is_smooth(face_i) || (!sharp_edges.is_empty() && sharp_edges[edge]) ||
-            vert == corner_verts[e2l[0]])
-        {
-          /* NOTE: we are sure that corner != 0 here ;). */
-          e2l[1] = INDEX_INVALID;
-        }
-        else {
-          e2l[1] = corner;
-        }
+      e2l[0] = users.first;
+      if (!face_is_smooth(corner_to_face[users.first])) {
+        e2l[1] = INDEX_INVALID;
+      }
+      else if (users.num == 1) {
+        e2l[1] = INDEX_UNSET;
+      }
+      else if (users.num > 2) {
+        /* More than two corners using this edge, it is sharp. */
+        e2l[1] = INDEX_INVALID;
       }
-      else if (!IS_EDGE_SHARP(e2l)) {
-        /* More than two corners using this edge, tag as sharp if not yet done. */
+      /* An edge is sharp if it is tagged as such, or its face is not smooth,
+       * or both face have opposed (flipped) normals, i.e. both corners on the same edge share
+       * the same vertex. */
+      else if (!face_is_smooth(corner_to_face[users.second]) ||
+               (!sharp_edges.is_empty() && sharp_edges[edge]) ||
+               corner_verts[users.first] == corner_verts[users.second])
+      {
         e2l[1] = INDEX_INVALID;
       }
-      /* Else, edge is already 'disqualified' (i.e. sharp)! */
+      else {
+        e2l[1] = users.second;
+      }
     }
-  }
+  });
 }
 
-void edges_sharp_from_angle_set(const OffsetIndices<int> faces,
+void edges_sharp_from_angle_set(const Span<int2> edges,
                                 const Span<int> corner_verts,
                                 const Span<int> corner_edges,
                                 const Span<float3> face_normals,
                                 const Span<int> corner_to_face,
+                                const GroupedSpan<int> vert_to_corner_map,
                                 const Span<bool> sharp_faces,
                                 const float split_angle,
                                 MutableSpan<bool> sharp_edges)
@@ -780,18 +814,15 @@ void edges_sharp_from_angle_set(const OffsetIndices<int> faces,
     return;
   }
 
-  /* Mapping edge -> corners. See #bke::mesh::normals_calc_corners for details. */
-  Array<int2> edge_to_corners(sharp_edges.size(), int2(0));
-
-  mesh_edges_sharp_tag(faces,
+  mesh_edges_sharp_tag(edges,
                        corner_verts,
                        corner_edges,
                        corner_to_face,
+                       vert_to_corner_map,
                        face_normals,
                        sharp_faces,
                        sharp_edges,
                        split_angle,
-                       edge_to_corners,
                        sharp_edges);
 }
 
@@ -1030,7 +1061,7 @@ static bool corner_split_generator_check_cyclic_smooth_fan(const Span<int> corne
                                                            const Span<int2> edge_to_corners,
                                                            const Span<int> corner_to_face,
                                                            const int2 e2l_prev,
-                                                           MutableBitSpan skip_corners,
+                                                           MutableSpan<bool> skip_corners,
                                                            const int corner,
                                                            const int corner_prev)
 {
@@ -1053,7 +1084,7 @@ static bool corner_split_generator_check_cyclic_smooth_fan(const Span<int> corne
   BLI_assert(vert_corner >= 0);
 
   BLI_assert(!skip_corners[vert_corner]);
-  skip_corners[vert_corner].set();
+  skip_corners[vert_corner] = true;
 
   while (true) {
     /* Find next corner of the smooth fan. */
@@ -1078,21 +1109,33 @@ static bool corner_split_generator_check_cyclic_smooth_fan(const Span<int> corne
     }
 
     /* We can skip it in future, and keep checking the smooth fan. */
-    skip_corners[vert_corner].set();
+    skip_corners[vert_corner] = true;
   }
 }
 
+/**
+ * Find the corners that are the start of a new fan, whose normal and space are computed by a
+ * single task. Corners around a vertex are processed in the order of their indices, so that the
+ * same corners are chosen for every vertex as if all corners were processed in order. Only corners
+ * of the vertex are tagged in \a skip_corners, so different vertices can be processed in parallel.
+ */
 static void corner_split_generator(CornerSplitTaskDataCommon *common_data,
-                                   Vector<int, 32> &r_single_corners,
-                                   Vector<int, 32> &r_fan_corners)
+                                   IndexMaskMemory &memory,
+                                   IndexMask &r_single_corners,
+                                   IndexMask &r_fan_corners)
 {
   const Span<int> corner_verts = common_data->corner_verts;
   const Span<int> corner_edges = common_data->corner_edges;
   const OffsetIndices faces = common_data->faces;
   const Span<int> corner_to_face = common_data->corner_to_face;
+  const GroupedSpan<int> vert_to_corner_map = common_data->vert_to_corner_map;
   const Span<int2> edge_to_corners = common_data->edge_to_corners;
 
-  BitVector<> skip_corners(corner_verts.size(), false);
+  enum class CornerType : int8_t { Skip, Single, Fan };
+
+  /* Bytes instead of bits to avoid writing to the same memory from different threads. */
+  Array<bool> skip_corners(corner_verts.size(), false);
+  Array<CornerType> corner_types(corner_verts.size(), CornerType::Skip);
 
 #ifdef DEBUG_TIME
   SCOPED_TIMER_AVERAGED(__func__);
@@ -1101,66 +1144,64 @@ static void corner_split_generator(CornerSplitTaskDataCommon *common_data,
   /* We now know edges that can be smoothed (with their vector, and their two corners),
    * and edges that will be hard! Now, time to generate the normals.
    */
-  for (const int face_index : faces.index_range()) {
-    const IndexRange face = faces[face_index];
-
-    for (const int corner : face) {
-      const int corner_prev = mesh::face_corner_prev(face, corner);
-
-#if 0
-      printf("Checking corner %d / edge %u / vert %u (sharp edge: %d, skiploop: %d)",
-             corner,
-             corner_edges[corner],
-             corner_verts[corner],
-             IS_EDGE_SHARP(edge_to_corners[corner_edges[corner]]),
-             skip_corners[corner]);
-#endif
-
-      /* A smooth edge, we have to check for cyclic smooth fan case.
-       * If we find a new, never-processed cyclic smooth fan, we can do it now using that
-       * corner/edge as 'entry point', otherwise we can skip it. */
-
-      /* NOTE: In theory, we could make #corner_split_generator_check_cyclic_smooth_fan() store
-       * vert_corner'es and edge indexes in two stacks, to avoid having to fan again around
-       * the vert during actual computation of `clnor` & `clnorspace`.
-       * However, this would complicate the code, add more memory usage, and despite its logical
-       * complexity, #corner_manifold_fan_around_vert_next() is quite cheap in term of CPU cycles,
-       * so really think it's not worth it. */
-      if (!IS_EDGE_SHARP(edge_to_corners[corner_edges[corner]]) &&
-          (skip_corners[corner] || !corner_split_generator_check_cyclic_smooth_fan(
-                                       corner_verts,
-                                       corner_edges,
-                                       faces,
-                                       edge_to_corners,
-                                       corner_to_face,
-                                       edge_to_corners[corner_edges[corner_prev]],
-                                       skip_corners,
-                                       corner,
-                                       corner_prev)))
-      {
-        // printf("SKIPPING!\n");
-      }
-      else {
+  threading::parallel_for(vert_to_corner_map.index_range(), 1024, [&](const IndexRange range) {
+    for (const int vert : range) {
+      for (const int corner : vert_to_corner_map[vert]) {
+        const int corner_prev = mesh::face_corner_prev(faces[corner_to_face[corner]], corner);
+
+        /* A smooth edge, we have to check for cyclic smooth fan case.
+         * If we find a new, never-processed cyclic smooth fan, we can do it now using that
+         * corner/edge as 'entry point', otherwise we can skip it. */
+
+        /* NOTE: In theory, we could make #corner_split_generator_check_cyclic_smooth_fan() store
+         * vert_corner'es and edge indexes in two stacks, to avoid having to fan again around
+         * the vert during actual computation of `clnor` & `clnorspace`.
+         * However, this would complicate the code, add more memory usage, and despite its
+         * logical complexity, #corner_manifold_fan_around_vert_next() is quite cheap in term of
+         * CPU cycles, so really think it's not worth it. */
+        if (!IS_EDGE_SHARP(edge_to_corners[corner_edges[corner]]) &&
+            (skip_corners[corner] || !corner_split_generator_check_cyclic_smooth_fan(
+                                         corner_verts,
+                                         corner_edges,
+                                         faces,
+                                         edge_to_corners,
+                                         corner_to_face,
+                                         edge_to_corners[corner_edges[corner_prev]],
+                                         skip_corners,
+                                         corner,
+                                         corner_prev)))
+        {
+          continue;
+        }
         if (IS_EDGE_SHARP(edge_to_corners[corner_edges[corner]]) &&
             IS_EDGE_SHARP(edge_to_corners[corner_edges[corner_prev]]))
         {
           /* Simple case (both edges around that vertex are sharp in current face),
            * this corner just takes its face normal. */
-          r_single_corners.append(corner);
+          corner_types[corner] = CornerType::Single;
         }
         else {
-          /* We do not need to check/tag corners as already computed. Due to the fact that a corner
-           * only points to one of its two edges, the same fan will never be walked more than once.
-           * Since we consider edges that have neighbor faces with inverted (flipped) normals as
-           * sharp, we are sure that no fan will be skipped, even only considering the case (sharp
-           * current edge, smooth previous edge), and not the alternative (smooth current edge,
-           * sharp previous edge). All this due/thanks to the link between normals and corner
-           * ordering (i.e. winding). */
-          r_fan_corners.append(corner);
+          /* We do not need to check/tag corners as already computed. Due to the fact that a
+           * corner only points to one of its two edges, the same fan will never be walked more
+           * than once. Since we consider edges that have neighbor faces with inverted (flipped)
+           * normals as sharp, we are sure that no fan will be skipped, even only considering the
+           * case (sharp current edge, smooth previous edge), and not the alternative (smooth
+           * current edge, sharp previous edge). All this due/thanks to the link between normals
+           * and corner ordering (i.e. winding). */
+          corner_types[corner] = CornerType::Fan;
         }
       }
     }
-  }
+  });
+
+  r_single_corners = IndexMask::from_predicate(
+      corner_types.index_range(), GrainSize(4096), memory, [&](const int corner) {
+        return corner_types[corner] == CornerType::Single;
+      });
+  r_fan_corners = IndexMask::from_predicate(
+      corner_types.index_range(), GrainSize(4096), memory, [&](const int corner) {
+        return corner_types[corner] == CornerType::Fan;
+      });
 }
 
 void normals_calc_corners(const Span<float3> vert_positions,
@@ -1169,6 +1210,7 @@ void normals_calc_corners(const Span<float3> vert_positions,
                           const Span<int> corner_verts,
                           const Span<int> corner_edges,
                           const Span<int> corner_to_face_map,
+                          const GroupedSpan<int> vert_to_corner_map,
                           const Span<float3> vert_normals,
                           const Span<float3> face_normals,
                           const Span<bool> sharp_edges,
@@ -1216,6 +1258,7 @@ void normals_calc_corners(const Span<float3> vert_positions,
   common_data.corner_edges = corner_edges;
   common_data.edge_to_corners = edge_to_corners;
   common_data.corner_to_face = corner_to_face_map;
+  common_data.vert_to_corner_map = vert_to_corner_map;
   common_data.face_normals = face_normals;
   common_data.vert_normals = vert_normals;
 
@@ -1224,12 +1267,19 @@ void normals_calc_corners(const Span<float3> vert_positions,
   array_utils::gather(vert_normals, corner_verts, r_corner_normals, 1024);
 
   /* This first corner check which edges are actually smooth, and compute edge vectors. */
-  build_edge_to_corner_map_with_flip_and_sharp(
-      faces, corner_verts, corner_edges, sharp_faces, sharp_edges, edge_to_corners);
-
-  Vector<int, 32> single_corners;
-  Vector<int, 32> fan_corners;
-  corner_split_generator(&common_data, single_corners, fan_corners);
+  build_edge_to_corner_map_with_flip_and_sharp(edges,
+                                               corner_verts,
+                                               corner_edges,
+                                               corner_to_face_map,
+                                               vert_to_corner_map,
+                                               sharp_faces,
+                                               sharp_edges,
+                                               edge_to_corners);
+
+  IndexMaskMemory memory;
+  IndexMask single_corners;
+  IndexMask fan_corners;
+  corner_split_generator(&common_data, memory, single_corners, fan_corners);
 
   if (r_lnors_spacearr) {
     r_lnors_spacearr->spaces.reinitialize(single_corners.size() + fan_corners.size());
@@ -1239,20 +1289,18 @@ void normals_calc_corners(const Span<float3> vert_positions,
     }
   }
 
-  threading::parallel_for(single_corners.index_range(), 1024, [&](const IndexRange range) {
-    for (const int i : range) {
-      const int corner = single_corners[i];
-      lnor_space_for_single_fan(&common_data, corner, i);
-    }
+  /* Spaces are indexed by the position of their corner in the masks, so they are the same
+   * independent of the order in which the tasks are executed. */
+  single_corners.foreach_index(GrainSize(1024), [&](const int corner, const int64_t pos) {
+    lnor_space_for_single_fan(&common_data, corner, int(pos));
   });
 
   threading::parallel_for(fan_corners.index_range(), 1024, [&](const IndexRange range) {
     Vector<float3, 16> edge_vectors;
-    for (const int i : range) {
-      const int corner = fan_corners[i];
-      const int space_index = single_corners.size() + i;
+    fan_corners.slice(range).foreach_index([&](const int corner, const int64_t pos) {
+      const int space_index = int(single_corners.size() + range.start() + pos);
       split_corner_normal_fan_do(&common_data, corner, space_index, &edge_vectors);
-    }
+    });
   });
 }
 
@@ -1294,6 +1342,10 @@ static void mesh_normals_corner_custom_set(const Span<float3> positions,
   BitVector<> done_corners(corner_verts.size(), false);
   Array<float3> corner_normals(corner_verts.size());
   const Array<int> corner_to_face = build_corner_to_face_map(faces);
+  Array<int> vert_to_corner_offsets;
+  Array<int> vert_to_corner_indices;
+  const GroupedSpan<int> vert_to_corner_map = build_vert_to_corner_map(
+      corner_verts, positions.size(), vert_to_corner_offsets, vert_to_corner_indices);
 
   /* Compute current lnor spacearr. */
   normals_calc_corners(positions,
@@ -1302,6 +1354,7 @@ static void mesh_normals_corner_custom_set(const Span<float3> positions,
                        corner_verts,
                        corner_edges,
                        corner_to_face,
+                       vert_to_corner_map,
                        vert_normals,
                        face_normals,
                        sharp_edges,
@@ -1423,6 +1476,7 @@ static void mesh_normals_corner_custom_set(const Span<float3> positions,
                          corner_verts,
                          corner_edges,
                          corner_to_face,
+                         vert_to_corner_map,
                          vert_normals,
                          face_normals,
                          sharp_edges,
@@ -0,0 +1,213 @@
+/* SPDX-FileCopyrightText: 2025 Blender Authors
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later */
+#include "testing/testing.h"
+
+#include "BLI_array.hh"
+#include "BLI_function_ref.hh"
+#include "BLI_math_rotation.h"
+#include "BLI_math_vector.hh"
+#include "BLI_rand.hh"
+#include "BLI_task.hh"
+#include "BLI_timeit.hh"
+
+#include "BKE_attribute.hh"
+#include "BKE_customdata.hh"
+#include "BKE_idtype.hh"
+#include "BKE_lib_id.hh"
+#include "BKE_mesh.h"
+#include "BKE_mesh.hh"
+#include "BKE_mesh_tangent.hh"
+
+#include "DNA_mesh_types.h"
+
+#define DO_PERF_TESTS 0
+
+namespace blender::bke::tests {
+
+/**
+ * Create a grid of quads in the XY plane, with enough noise on Z that some of its edges are
+ * sharp by angle.
+ */
+static Mesh *test_mesh_normals_grid_create(const int size, const uint32_t seed)
+{
+  const int verts_num = size * size;
+  const int faces_num = (size - 1) * (size - 1);
+  Mesh *mesh = BKE_mesh_new_nomain(verts_num, 0, faces_num, faces_num * 4);
+
+  RandomNumberGenerator rng(seed);
+  MutableSpan<float3> positions = mesh->vert_positions_for_write();
+  for (const int y : IndexRange(size)) {
+    for (const int x : IndexRange(size)) {
+      positions[y * size + x] = float3(float(x), float(y), rng.get_float() - 0.5f);
+    }
+  }
+
+  MutableSpan<int> face_offsets = mesh->face_offsets_for_write();
+  MutableSpan<int> corner_verts = mesh->corner_verts_for_write();
+  for (const int y : IndexRange(size - 1)) {
+    for (const int x : IndexRange(size - 1)) {
+      const int face = y * (size - 1) + x;
+      face_offsets[face] = face * 4;
+      corner_verts[face * 4 + 0] = y * size + x;
+      corner_verts[face * 4 + 1] = y * size + x + 1;
+      corner_verts[face * 4 + 2] = (y + 1) * size + x + 1;
+      corner_verts[face * 4 + 3] = (y + 1) * size + x;
+    }
+  }
+  face_offsets.last() = faces_num * 4;
+  mesh_calc_edges(*mesh, false, false);
+  return mesh;
+}
+
+/** Call \a fn with a single thread, to compare its result with the multi-threaded one. */
+static void run_single_threaded(const FunctionRef<void()> fn)
+{
+#ifdef WITH_TBB
+  tbb::task_arena arena(1);
+  arena.execute([&]() { fn(); });
+#else
+  fn();
+#endif
+}
+
+class mesh_normals : public testing::Test {
+ protected:
+  static void SetUpTestSuite()
+  {
+    BKE_idtype_init();
+  }
+};
+
+TEST_F(mesh_normals, corner_normals_match_single_threaded)
+{
+  Mesh *mesh = test_mesh_normals_grid_create(200, 0);
+
+  /* Mix explicitly sharp edges and faces with edges that are sharp by angle. */
+  RandomNumberGenerator rng(1);
+  MutableAttributeAccessor attributes = mesh->attributes_for_write();
+  SpanAttributeWriter<bool> sharp_edges = attributes.lookup_or_add_for_write_span<bool>(
+      "sharp_edge", AttrDomain::Edge);
+  for (const int edge : sharp_edges.span.index_range()) {
+    sharp_edges.span[edge] = rng.get_float() < 0.05f;
+  }
+  sharp_edges.finish();
+  SpanAttributeWriter<bool> sharp_faces = attributes.lookup_or_add_for_write_span<bool>(
+      "sharp_face", AttrDomain::Face);
+  for (const int face : sharp_faces.span.index_range()) {
+    sharp_faces.span[face] = rng.get_float() < 0.05f;
+  }
+  sharp_faces.finish();
+  mesh_sharp_edges_set_from_angle(*mesh, DEG2RADF(30.0f), true);
+
+  /* Custom normals that differ from the automatic normals of the smooth fans. */
+  Array<float3> custom_normals(mesh->corners_num);
+  for (const int corner : custom_normals.index_range()) {
+    custom_normals[corner] = math::normalize(
+        float3(rng.get_float() - 0.5f, rng.get_float() - 0.5f, 1.0f));
+  }
+
+  Mesh *mesh_single_threaded = BKE_mesh_copy_for_eval(*mesh);
+
+  Array<float3> custom_normals_copy = custom_normals;
+  BKE_mesh_set_custom_normals(mesh, reinterpret_cast<float(*)[3]>(custom_normals_copy.data()));
+  const Span<float3> corner_normals = mesh->corner_normals();
+
+  Span<float3> corner_normals_single_threaded;
+  run_single_threaded([&]() {
+    BKE_mesh_set_custom_normals(mesh_single_threaded,
+                                reinterpret_cast<float(*)[3]>(custom_normals.data()));
+    corner_normals_single_threaded = mesh_single_threaded->corner_normals();
+  });
+
+  /* The encoded custom normals depend on the corner normal spaces. */
+  const short2 *clnors = static_cast<const short2 *>(
+      CustomData_get_layer(&mesh->corner_data, CD_CUSTOMLOOPNORMAL));
+  const short2 *clnors_single_threaded = static_cast<const short2 *>(
+      CustomData_get_layer(&mesh_single_threaded->corner_data, CD_CUSTOMLOOPNORMAL));
+  ASSERT_NE(clnors, nullptr);
+  ASSERT_NE(clnors_single_threaded, nullptr);
+  EXPECT_EQ_ARRAY(clnors_single_threaded, clnors, mesh->corners_num);
+
+  ASSERT_EQ(corner_normals.size(), corner_normals_single_threaded.size());
+  EXPECT_EQ_ARRAY(
+      corner_normals_single_threaded.data(), corner_normals.data(), corner_normals.size());
+
+  BKE_id_free(nullptr, mesh_single_threaded);
+  BKE_id_free(nullptr, mesh);
+}
+
+#if DO_PERF_TESTS
+
+class mesh_normals_performance : public testing::Test {
+ protected:
+  Mesh *mesh_ = nullptr;
+
+  static void SetUpTestSuite()
+  {
+    BKE_idtype_init();
+  }
+
+  void SetUp() override
+  {
+    /* About 10 million face corners. */
+    mesh_ = test_mesh_normals_grid_create(1583, 0);
+    {
+      SCOPED_TIMER("mesh normals: sharp edges from angle");
+      mesh_sharp_edges_set_from_angle(*mesh_, DEG2RADF(30.0f));
+    }
+  }
+
+  void TearDown() override
+  {
+    BKE_id_free(nullptr, mesh_);
+  }
+};
+
+TEST_F(mesh_normals_performance, corner_normals_10M)
+{
+  for ([[maybe_unused]] const int i : IndexRange(5)) {
+    mesh_->tag_positions_changed();
+    SCOPED_TIMER_AVERAGED("mesh normals: corner normals");
+    EXPECT_EQ(mesh_->corner_normals().size(), mesh_->corners_num);
+  }
+}
+
+TEST_F(mesh_normals_performance, tangents_10M)
+{
+  const Span<float3> positions = mesh_->vert_positions();
+  const Span<float3> corner_normals = mesh_->corner_normals();
+  Array<float2> uvs(mesh_->corners_num);
+  for (const int corner : uvs.index_range()) {
+    uvs[corner] = positions[mesh_->corner_verts()[corner]].xy() * 0.01f;
+  }
+
+  Array<float4> first_tangents;
+  for ([[maybe_unused]] const int i : IndexRange(3)) {
+    Array<float4> tangents(mesh_->corners_num);
+    {
+      SCOPED_TIMER_AVERAGED("mesh normals: tangents");
+      BKE_mesh_calc_loop_tangent_single_ex(
+          reinterpret_cast<const float(*)[3]>(positions.data()),
+          mesh_->verts_num,
+          mesh_->corner_verts().data(),
+          reinterpret_cast<float(*)[4]>(tangents.data()),
+          reinterpret_cast<const float(*)[3]>(corner_normals.data()),
+          reinterpret_cast<const float(*)[2]>(uvs.data()),
+          mesh_->corners_num,
+          mesh_->faces(),
+          nullptr);
+    }
+    /* The result must not depend on how the work is distributed between threads. */
+    if (first_tangents.is_empty()) {
+      first_tangents = std::move(tangents);
+    }
+    else {
+      EXPECT_TRUE(first_tangents.as_span() == tangents.as_span());
+    }
+  }
+}
+
+#endif
+
+}  // namespace blender::bke::tests
@@ -8,6 +8,7 @@
  * Functions for mapping data between meshes.
  */
 
+#include <algorithm>
 #include <climits>
 
 #include "CLG_log.h"
@@ -17,6 +18,8 @@
 #include "BLI_array.hh"
 #include "BLI_astar.h"
 #include "BLI_bit_vector.hh"
+#include "BLI_enumerable_thread_specific.hh"
+#include "BLI_map.hh"
 #include "BLI_math_geom.h"
 #include "BLI_math_matrix.h"
 #include "BLI_math_solvers.h"
@@ -25,6 +28,7 @@
 #include "BLI_memarena.h"
 #include "BLI_polyfill_2d.h"
 #include "BLI_rand.h"
+#include "BLI_task.hh"
 #include "BLI_utildefines.h"
 
 #include "BKE_bvhutils.hh"
@@ -446,6 +450,81 @@ struct IslandResult {
 /* Will be enough in 99% of cases. */
 #define MREMAP_DEFAULT_BUFSIZE 32
 
+/** Scratch buffers for #mesh_remap_interp_face_data_get, owned by a single task or thread. */
+struct FaceInterpBuffers {
+  size_t size = MREMAP_DEFAULT_BUFSIZE;
+  float (*vcos)[3];
+  int *indices;
+  float *weights;
+
+  FaceInterpBuffers()
+  {
+    vcos = static_cast<float(*)[3]>(MEM_mallocN(sizeof(*vcos) * size, __func__));
+    indices = static_cast<int *>(MEM_mallocN(sizeof(*indices) * size, __func__));
+    weights = static_cast<float *>(MEM_mallocN(sizeof(*weights) * size, __func__));
+  }
+  FaceInterpBuffers(const FaceInterpBuffers &) = delete;
+  FaceInterpBuffers &operator=(const FaceInterpBuffers &) = delete;
+  ~FaceInterpBuffers()
+  {
+    MEM_freeN(vcos);
+    MEM_freeN(indices);
+    MEM_freeN(weights);
+  }
+
+  int face_data_get(const blender::IndexRange face,
+                    const blender::Span<int> corner_verts,
+                    const blender::Span<blender::float3> positions_src,
+                    const float point[3],
+                    const bool use_loops,
+                    const bool do_weights,
+                    int *r_closest_index)
+  {
+    return mesh_remap_interp_face_data_get(face,
+                                           corner_verts,
+                                           positions_src,
+                                           point,
+                                           &size,
+                                           &vcos,
+                                           use_loops,
+                                           &indices,
+                                           &weights,
+                                           do_weights,
+                                           r_closest_index);
+  }
+};
+
+/**
+ * Call \a fn for chunks of \a range in parallel.
+ *
+ * #mesh_remap_item_define allocates the sources of each item from the map's #MemArena, which is
+ * not thread-safe. Each thread therefore gets a copy of \a map sharing its items array but with
+ * its own arena, and these arenas are merged back into \a map once all items are defined.
+ * Items must only be defined by the task handling them.
+ */
+template<typename Fn>
+static void mesh_remap_parallel_for(MeshPairRemap *map,
+                                    const blender::IndexRange range,
+                                    const int64_t grain_size,
+                                    const Fn &fn)
+{
+  using namespace blender;
+  threading::EnumerableThreadSpecific<MeshPairRemap> local_maps([&]() {
+    MeshPairRemap local_map = *map;
+    local_map.mem = BLI_memarena_new(BLI_MEMARENA_STD_BUFSIZE, __func__);
+    return local_map;
+  });
+
+  threading::parallel_for(range, grain_size, [&](const IndexRange sub_range) {
+    fn(sub_range, &local_maps.local());
+  });
+
+  for (MeshPairRemap &local_map : local_maps) {
+    BLI_memarena_merge(map->mem, local_map.mem);
+    BLI_memarena_free(local_map.mem);
+  }
+}
+
 void BKE_mesh_remap_calc_verts_from_mesh(const int mode,
                                          const SpaceTransform *space_transform,
                                          const float max_dist,
@@ -458,7 +537,6 @@ void BKE_mesh_remap_calc_verts_from_mesh(const int mode,
 {
   const float full_weight = 1.0f;
   const float max_dist_sq = max_dist * max_dist;
-  int i;
 
   BLI_assert(mode & MREMAP_MODE_VERT);
 
@@ -466,200 +544,212 @@ void BKE_mesh_remap_calc_verts_from_mesh(const int mode,
 
   if (mode == MREMAP_MODE_TOPOLOGY) {
     BLI_assert(numverts_dst == me_src->verts_num);
-    for (i = 0; i < numverts_dst; i++) {
+    for (int i = 0; i < numverts_dst; i++) {
       mesh_remap_item_define(r_map, i, FLT_MAX, 0, 1, &i, &full_weight);
     }
   }
   else {
+    using namespace blender;
     BVHTreeFromMesh treedata = {nullptr};
-    BVHTreeNearest nearest = {0};
-    BVHTreeRayHit rayhit = {0};
-    float hit_dist;
-    float tmp_co[3], tmp_no[3];
+    const IndexRange verts_range(numverts_dst);
+    /* BVH queries are by far the most expensive part, so the destination vertices are processed
+     * in parallel. The nearest query state is kept per task: consecutive vertices are usually
+     * close to each other, so the previous result is a good starting guess for the search. */
+    const int64_t grain_size = 512;
 
     if (mode == MREMAP_MODE_VERT_NEAREST) {
       BKE_bvhtree_from_mesh_get(&treedata, me_src, BVHTREE_FROM_VERTS, 2);
-      nearest.index = -1;
 
-      for (i = 0; i < numverts_dst; i++) {
-        copy_v3_v3(tmp_co, vert_positions_dst[i]);
+      mesh_remap_parallel_for(
+          r_map, verts_range, grain_size, [&](const IndexRange range, MeshPairRemap *map) {
+            BVHTreeNearest nearest = {0};
+            nearest.index = -1;
+            float hit_dist;
+            float tmp_co[3];
 
-        /* Convert the vertex to tree coordinates, if needed. */
-        if (space_transform) {
-          BLI_space_transform_apply(space_transform, tmp_co);
-        }
+            for (const int64_t i : range) {
+              copy_v3_v3(tmp_co, vert_positions_dst[i]);
 
-        if (mesh_remap_bvhtree_query_nearest(&treedata, &nearest, tmp_co, max_dist_sq, &hit_dist))
-        {
-          mesh_remap_item_define(r_map, i, hit_dist, 0, 1, &nearest.index, &full_weight);
-        }
-        else {
-          /* No source for this dest vertex! */
-          BKE_mesh_remap_item_define_invalid(r_map, i);
-        }
-      }
+              /* Convert the vertex to tree coordinates, if needed. */
+              if (space_transform) {
+                BLI_space_transform_apply(space_transform, tmp_co);
+              }
+
+              if (mesh_remap_bvhtree_query_nearest(
+                      &treedata, &nearest, tmp_co, max_dist_sq, &hit_dist))
+              {
+                mesh_remap_item_define(map, int(i), hit_dist, 0, 1, &nearest.index, &full_weight);
+              }
+              else {
+                /* No source for this dest vertex! */
+                BKE_mesh_remap_item_define_invalid(map, int(i));
+              }
+            }
+          });
     }
     else if (ELEM(mode, MREMAP_MODE_VERT_EDGE_NEAREST, MREMAP_MODE_VERT_EDGEINTERP_NEAREST)) {
-      const blender::Span<blender::int2> edges_src = me_src->edges();
-      const blender::Span<blender::float3> positions_src = me_src->vert_positions();
+      const Span<int2> edges_src = me_src->edges();
+      const Span<float3> positions_src = me_src->vert_positions();
 
       BKE_bvhtree_from_mesh_get(&treedata, me_src, BVHTREE_FROM_EDGES, 2);
-      nearest.index = -1;
 
-      for (i = 0; i < numverts_dst; i++) {
-        copy_v3_v3(tmp_co, vert_positions_dst[i]);
+      mesh_remap_parallel_for(
+          r_map, verts_range, grain_size, [&](const IndexRange range, MeshPairRemap *map) {
+            BVHTreeNearest nearest = {0};
+            nearest.index = -1;
+            float hit_dist;
+            float tmp_co[3];
 
-        /* Convert the vertex to tree coordinates, if needed. */
-        if (space_transform) {
-          BLI_space_transform_apply(space_transform, tmp_co);
-        }
+            for (const int64_t i : range) {
+              copy_v3_v3(tmp_co, vert_positions_dst[i]);
 
-        if (mesh_remap_bvhtree_query_nearest(&treedata, &nearest, tmp_co, max_dist_sq, &hit_dist))
-        {
-          const blender::int2 &edge = edges_src[nearest.index];
-          const float *v1cos = positions_src[edge[0]];
-          const float *v2cos = positions_src[edge[1]];
-
-          if (mode == MREMAP_MODE_VERT_EDGE_NEAREST) {
-            const float dist_v1 = len_squared_v3v3(tmp_co, v1cos);
-            const float dist_v2 = len_squared_v3v3(tmp_co, v2cos);
-            const int index = (dist_v1 > dist_v2) ? edge[1] : edge[0];
-            mesh_remap_item_define(r_map, i, hit_dist, 0, 1, &index, &full_weight);
-          }
-          else if (mode == MREMAP_MODE_VERT_EDGEINTERP_NEAREST) {
-            int indices[2];
-            float weights[2];
+              /* Convert the vertex to tree coordinates, if needed. */
+              if (space_transform) {
+                BLI_space_transform_apply(space_transform, tmp_co);
+              }
 
-            indices[0] = edge[0];
-            indices[1] = edge[1];
+              if (mesh_remap_bvhtree_query_nearest(
+                      &treedata, &nearest, tmp_co, max_dist_sq, &hit_dist))
+              {
+                const int2 &edge = edges_src[nearest.index];
+                const float *v1cos = positions_src[edge[0]];
+                const float *v2cos = positions_src[edge[1]];
+
+                if (mode == MREMAP_MODE_VERT_EDGE_NEAREST) {
+                  const float dist_v1 = len_squared_v3v3(tmp_co, v1cos);
+                  const float dist_v2 = len_squared_v3v3(tmp_co, v2cos);
+                  const int index = (dist_v1 > dist_v2) ? edge[1] : edge[0];
+                  mesh_remap_item_define(map, int(i), hit_dist, 0, 1, &index, &full_weight);
+                }
+                else if (mode == MREMAP_MODE_VERT_EDGEINTERP_NEAREST) {
+                  int indices[2];
+                  float weights[2];
 
-            /* Weight is inverse of point factor here... */
-            weights[0] = line_point_factor_v3(tmp_co, v2cos, v1cos);
-            CLAMP(weights[0], 0.0f, 1.0f);
-            weights[1] = 1.0f - weights[0];
+                  indices[0] = edge[0];
+                  indices[1] = edge[1];
 
-            mesh_remap_item_define(r_map, i, hit_dist, 0, 2, indices, weights);
-          }
-        }
-        else {
-          /* No source for this dest vertex! */
-          BKE_mesh_remap_item_define_invalid(r_map, i);
-        }
-      }
+                  /* Weight is inverse of point factor here... */
+                  weights[0] = line_point_factor_v3(tmp_co, v2cos, v1cos);
+                  CLAMP(weights[0], 0.0f, 1.0f);
+                  weights[1] = 1.0f - weights[0];
+
+                  mesh_remap_item_define(map, int(i), hit_dist, 0, 2, indices, weights);
+                }
+              }
+              else {
+                /* No source for this dest vertex! */
+                BKE_mesh_remap_item_define_invalid(map, int(i));
+              }
+            }
+          });
     }
     else if (ELEM(mode,
                   MREMAP_MODE_VERT_FACE_NEAREST,
                   MREMAP_MODE_VERT_POLYINTERP_NEAREST,
                   MREMAP_MODE_VERT_POLYINTERP_VNORPROJ))
     {
-      const blender::OffsetIndices faces_src = me_src->faces();
-      const blender::Span<int> corner_verts_src = me_src->corner_verts();
-      const blender::Span<blender::float3> positions_src = me_src->vert_positions();
-      const blender::Span<blender::float3> vert_normals_dst = me_dst->vert_normals();
-      const blender::Span<int> tri_faces = me_src->corner_tri_faces();
-
-      size_t tmp_buff_size = MREMAP_DEFAULT_BUFSIZE;
-      float(*vcos)[3] = static_cast<float(*)[3]>(
-          MEM_mallocN(sizeof(*vcos) * tmp_buff_size, __func__));
-      int *indices = static_cast<int *>(MEM_mallocN(sizeof(*indices) * tmp_buff_size, __func__));
-      float *weights = static_cast<float *>(
-          MEM_mallocN(sizeof(*weights) * tmp_buff_size, __func__));
+      const OffsetIndices faces_src = me_src->faces();
+      const Span<int> corner_verts_src = me_src->corner_verts();
+      const Span<float3> positions_src = me_src->vert_positions();
+      const Span<float3> vert_normals_dst = me_dst->vert_normals();
+      const Span<int> tri_faces = me_src->corner_tri_faces();
 
       BKE_bvhtree_from_mesh_get(&treedata, me_src, BVHTREE_FROM_CORNER_TRIS, 2);
 
       if (mode == MREMAP_MODE_VERT_POLYINTERP_VNORPROJ) {
-        for (i = 0; i < numverts_dst; i++) {
-          copy_v3_v3(tmp_co, vert_positions_dst[i]);
-          copy_v3_v3(tmp_no, vert_normals_dst[i]);
-
-          /* Convert the vertex to tree coordinates, if needed. */
-          if (space_transform) {
-            BLI_space_transform_apply(space_transform, tmp_co);
-            BLI_space_transform_apply_normal(space_transform, tmp_no);
-          }
+        mesh_remap_parallel_for(
+            r_map, verts_range, grain_size, [&](const IndexRange range, MeshPairRemap *map) {
+              FaceInterpBuffers buffers;
+              BVHTreeRayHit rayhit = {0};
+              float hit_dist;
+              float tmp_co[3], tmp_no[3];
+
+              for (const int64_t i : range) {
+                copy_v3_v3(tmp_co, vert_positions_dst[i]);
+                copy_v3_v3(tmp_no, vert_normals_dst[i]);
+
+                /* Convert the vertex to tree coordinates, if needed. */
+                if (space_transform) {
+                  BLI_space_transform_apply(space_transform, tmp_co);
+                  BLI_space_transform_apply_normal(space_transform, tmp_no);
+                }
 
-          if (mesh_remap_bvhtree_query_raycast(
-                  &treedata, &rayhit, tmp_co, tmp_no, ray_radius, max_dist, &hit_dist))
-          {
-            const int face_index = tri_faces[rayhit.index];
-            const int sources_num = mesh_remap_interp_face_data_get(faces_src[face_index],
-                                                                    corner_verts_src,
-                                                                    positions_src,
-                                                                    rayhit.co,
-                                                                    &tmp_buff_size,
-                                                                    &vcos,
-                                                                    false,
-                                                                    &indices,
-                                                                    &weights,
-                                                                    true,
-                                                                    nullptr);
-
-            mesh_remap_item_define(r_map, i, hit_dist, 0, sources_num, indices, weights);
-          }
-          else {
-            /* No source for this dest vertex! */
-            BKE_mesh_remap_item_define_invalid(r_map, i);
-          }
-        }
+                if (mesh_remap_bvhtree_query_raycast(
+                        &treedata, &rayhit, tmp_co, tmp_no, ray_radius, max_dist, &hit_dist))
+                {
+                  const int face_index = tri_faces[rayhit.index];
+                  const int sources_num = buffers.face_data_get(faces_src[face_index],
+                                                                corner_verts_src,
+                                                                positions_src,
+                                                                rayhit.co,
+                                                                false,
+                                                                true,
+                                                                nullptr);
+
+                  mesh_remap_item_define(
+                      map, int(i), hit_dist, 0, sources_num, buffers.indices, buffers.weights);
+                }
+                else {
+                  /* No source for this dest vertex! */
+                  BKE_mesh_remap_item_define_invalid(map, int(i));
+                }
+              }
+            });
       }
       else {
-        nearest.index = -1;
+        mesh_remap_parallel_for(
+            r_map, verts_range, grain_size, [&](const IndexRange range, MeshPairRemap *map) {
+              FaceInterpBuffers buffers;
+              BVHTreeNearest nearest = {0};
+              nearest.index = -1;
+              float hit_dist;
+              float tmp_co[3];
 
-        for (i = 0; i < numverts_dst; i++) {
-          copy_v3_v3(tmp_co, vert_positions_dst[i]);
+              for (const int64_t i : range) {
+                copy_v3_v3(tmp_co, vert_positions_dst[i]);
 
-          /* Convert the vertex to tree coordinates, if needed. */
-          if (space_transform) {
-            BLI_space_transform_apply(space_transform, tmp_co);
-          }
-
-          if (mesh_remap_bvhtree_query_nearest(
-                  &treedata, &nearest, tmp_co, max_dist_sq, &hit_dist))
-          {
-            const int face_index = tri_faces[nearest.index];
-
-            if (mode == MREMAP_MODE_VERT_FACE_NEAREST) {
-              int index;
-              mesh_remap_interp_face_data_get(faces_src[face_index],
-                                              corner_verts_src,
-                                              positions_src,
-                                              nearest.co,
-                                              &tmp_buff_size,
-                                              &vcos,
-                                              false,
-                                              &indices,
-                                              &weights,
-                                              false,
-                                              &index);
+                /* Convert the vertex to tree coordinates, if needed. */
+                if (space_transform) {
+                  BLI_space_transform_apply(space_transform, tmp_co);
+                }
 
-              mesh_remap_item_define(r_map, i, hit_dist, 0, 1, &index, &full_weight);
-            }
-            else if (mode == MREMAP_MODE_VERT_POLYINTERP_NEAREST) {
-              const int sources_num = mesh_remap_interp_face_data_get(faces_src[face_index],
-                                                                      corner_verts_src,
-                                                                      positions_src,
-                                                                      nearest.co,
-                                                                      &tmp_buff_size,
-                                                                      &vcos,
-                                                                      false,
-                                                                      &indices,
-                                                                      &weights,
-                                                                      true,
-                                                                      nullptr);
-
-              mesh_remap_item_define(r_map, i, hit_dist, 0, sources_num, indices, weights);
-            }
-          }
-          else {
-            /* No source for this dest vertex! */
-            BKE_mesh_remap_item_define_invalid(r_map, i);
-          }
-        }
+                if (mesh_remap_bvhtree_query_nearest(
+                        &treedata, &nearest, tmp_co, max_dist_sq, &hit_dist))
+                {
+                  const int face_index = tri_faces[nearest.index];
+
+                  if (mode == MREMAP_MODE_VERT_FACE_NEAREST) {
+                    int index;
+                    buffers.face_data_get(faces_src[face_index],
+                                          corner_verts_src,
+                                          positions_src,
+                                          nearest.co,
+                                          false,
+                                          false,
+                                          &index);
+
+                    mesh_remap_item_define(map, int(i), hit_dist, 0, 1, &index, &full_weight);
+                  }
+                  else if (mode == MREMAP_MODE_VERT_POLYINTERP_NEAREST) {
+                    const int sources_num = buffers.face_data_get(faces_src[face_index],
+                                                                  corner_verts_src,
+                                                                  positions_src,
+                                                                  nearest.co,
+                                                                  false,
+                                                                  true,
+                                                                  nullptr);
+
+                    mesh_remap_item_define(
+                        map, int(i), hit_dist, 0, sources_num, buffers.indices, buffers.weights);
+                  }
+                }
+                else {
+                  /* No source for this dest vertex! */
+                  BKE_mesh_remap_item_define_invalid(map, int(i));
+                }
+              }
+            });
       }
-
-      MEM_freeN(vcos);
-      MEM_freeN(indices);
-      MEM_freeN(weights);
     }
     else {
       CLOG_WARN(&LOG, "Unsupported mesh-to-mesh vertex mapping mode (%d)!", mode);
@@ -1240,11 +1330,7 @@ void BKE_mesh_remap_calc_loops_from_mesh(const int mode,
   }
   else {
     BVHTreeFromMesh *treedata = nullptr;
-    BVHTreeNearest nearest = {0};
-    BVHTreeRayHit rayhit = {0};
     int num_trees = 0;
-    float hit_dist;
-    float tmp_co[3], tmp_no[3];
 
     const bool use_from_vert = (mode & MREMAP_USE_VERT);
 
@@ -1252,7 +1338,6 @@ void BKE_mesh_remap_calc_loops_from_mesh(const int mode,
     bool use_islands = false;
 
     BLI_AStarGraph *as_graphdata = nullptr;
-    BLI_AStarSolution as_solution = {0};
     const int isld_steps_src = (islands_precision_src ?
                                     max_ii(int(ASTAR_STEPS_MAX * islands_precision_src + 0.499f),
                                            1) :
@@ -1288,25 +1373,6 @@ void BKE_mesh_remap_calc_loops_from_mesh(const int mode,
     blender::Span<blender::int3> corner_tris_src;
     blender::Span<int> tri_faces_src;
 
-    size_t buff_size_interp = MREMAP_DEFAULT_BUFSIZE;
-    float(*vcos_interp)[3] = nullptr;
-    int *indices_interp = nullptr;
-    float *weights_interp = nullptr;
-
-    int tindex, pidx_dst, lidx_dst, plidx_dst, pidx_src, lidx_src, plidx_src;
-
-    IslandResult **islands_res;
-    size_t islands_res_buff_size = MREMAP_DEFAULT_BUFSIZE;
-
-    if (!use_from_vert) {
-      vcos_interp = static_cast<float(*)[3]>(
-          MEM_mallocN(sizeof(*vcos_interp) * buff_size_interp, __func__));
-      indices_interp = static_cast<int *>(
-          MEM_mallocN(sizeof(*indices_interp) * buff_size_interp, __func__));
-      weights_interp = static_cast<float *>(
-          MEM_mallocN(sizeof(*weights_interp) * buff_size_interp, __func__));
-    }
-
     {
       const bool need_lnors_src = (mode & MREMAP_USE_LOOP) && (mode & MREMAP_USE_NORMAL);
       const bool need_lnors_dst = need_lnors_src || (mode & MREMAP_USE_NORPROJ);
@@ -1400,7 +1466,7 @@ void BKE_mesh_remap_calc_loops_from_mesh(const int mode,
 
     /* Build our AStar graphs. */
     if (isld_steps_src) {
-      for (tindex = 0; tindex < num_trees; tindex++) {
+      for (int tindex = 0; tindex < num_trees; tindex++) {
         mesh_island_to_astar_graph(use_islands ? &island_store : nullptr,
                                    tindex,
                                    positions_src,
@@ -1418,7 +1484,7 @@ void BKE_mesh_remap_calc_loops_from_mesh(const int mode,
       if (use_islands) {
         blender::BitVector<> verts_active(num_verts_src);
 
-        for (tindex = 0; tindex < num_trees; tindex++) {
+        for (int tindex = 0; tindex < num_trees; tindex++) {
           MeshElemMap *isld = island_store.islands[tindex];
           int num_verts_active = 0;
           verts_active.fill(false);
@@ -1445,7 +1511,7 @@ void BKE_mesh_remap_calc_loops_from_mesh(const int mode,
         tri_faces_src = me_src->corner_tri_faces();
         blender::BitVector<> corner_tris_active(corner_tris_src.size());
 
-        for (tindex = 0; tindex < num_trees; tindex++) {
+        for (int tindex = 0; tindex < num_trees; tindex++) {
           int corner_tris_num_active = 0;
           corner_tris_active.fill(false);
           for (const int64_t i : corner_tris_src.index_range()) {
@@ -1472,183 +1538,224 @@ void BKE_mesh_remap_calc_loops_from_mesh(const int mode,
       }
     }
 
-    /* And check each dest face! */
-    islands_res = static_cast<IslandResult **>(
-        MEM_mallocN(sizeof(*islands_res) * size_t(num_trees), __func__));
-    for (tindex = 0; tindex < num_trees; tindex++) {
-      islands_res[tindex] = static_cast<IslandResult *>(
-          MEM_mallocN(sizeof(**islands_res) * islands_res_buff_size, __func__));
+    /* Pre-compute the on-demand data, it is read from all threads in the loop below. */
+    if (isld_steps_src && !use_from_vert) {
+      BKE_mesh_origindex_map_create_corner_tri(&face_to_corner_tri_map_src,
+                                               &face_to_corner_tri_map_src_buff,
+                                               faces_src,
+                                               tri_faces_src.data(),
+                                               int(tri_faces_src.size()));
     }
-    const blender::Span<int> tri_faces = me_src->corner_tri_faces();
 
-    for (pidx_dst = 0; pidx_dst < faces_dst.size(); pidx_dst++) {
-      const blender::IndexRange face_dst = faces_dst[pidx_dst];
-      float pnor_dst[3];
+    const blender::Span<int> tri_faces = me_src->corner_tri_faces();
 
-      /* Only in use_from_vert case, we may need faces' centers as fallback
-       * in case we cannot decide which corner to use from normals only. */
-      blender::float3 pcent_dst;
-      bool pcent_dst_valid = false;
+    /* And check each dest face! Faces are independent from each other (A* paths only go
+     * between the sources of a same dest face), so they are processed in parallel, with
+     * per-task query state and scratch buffers. */
+    const auto remap_faces = [&](const IndexRange range, MeshPairRemap *map) {
+      Array<Vector<IslandResult>> islands_res(num_trees);
+      FaceInterpBuffers interp_buffers;
+      BLI_AStarSolution as_solution = {0};
+      BVHTreeNearest nearest = {0};
+      BVHTreeRayHit rayhit = {0};
+      float hit_dist;
+      float tmp_co[3], tmp_no[3];
+      int lidx_dst, plidx_dst, pidx_src, lidx_src, plidx_src;
+
+      for (const int64_t pidx_dst : range) {
+        const blender::IndexRange face_dst = faces_dst[pidx_dst];
+        float pnor_dst[3];
+
+        /* Only in use_from_vert case, we may need faces' centers as fallback
+         * in case we cannot decide which corner to use from normals only. */
+        blender::float3 pcent_dst;
+        bool pcent_dst_valid = false;
 
-      if (mode == MREMAP_MODE_LOOP_NEAREST_POLYNOR) {
-        copy_v3_v3(pnor_dst, face_normals_dst[pidx_dst]);
-        if (space_transform) {
-          BLI_space_transform_apply_normal(space_transform, pnor_dst);
+        if (mode == MREMAP_MODE_LOOP_NEAREST_POLYNOR) {
+          copy_v3_v3(pnor_dst, face_normals_dst[pidx_dst]);
+          if (space_transform) {
+            BLI_space_transform_apply_normal(space_transform, pnor_dst);
+          }
         }
-      }
 
-      if (size_t(face_dst.size()) > islands_res_buff_size) {
-        islands_res_buff_size = size_t(face_dst.size()) + MREMAP_DEFAULT_BUFSIZE;
-        for (tindex = 0; tindex < num_trees; tindex++) {
-          islands_res[tindex] = static_cast<IslandResult *>(
-              MEM_reallocN(islands_res[tindex], sizeof(**islands_res) * islands_res_buff_size));
+        for (Vector<IslandResult> &tree_res : islands_res) {
+          tree_res.resize(face_dst.size());
         }
-      }
-
-      for (tindex = 0; tindex < num_trees; tindex++) {
-        BVHTreeFromMesh *tdata = &treedata[tindex];
 
-        for (plidx_dst = 0; plidx_dst < face_dst.size(); plidx_dst++) {
-          const int vert_dst = corner_verts_dst[face_dst.start() + plidx_dst];
-          if (use_from_vert) {
-            blender::Span<int> vert_to_refelem_map_src;
+        for (int tindex = 0; tindex < num_trees; tindex++) {
+          BVHTreeFromMesh *tdata = &treedata[tindex];
 
-            copy_v3_v3(tmp_co, vert_positions_dst[vert_dst]);
-            nearest.index = -1;
+          for (plidx_dst = 0; plidx_dst < face_dst.size(); plidx_dst++) {
+            const int vert_dst = corner_verts_dst[face_dst.start() + plidx_dst];
+            if (use_from_vert) {
+              blender::Span<int> vert_to_refelem_map_src;
 
-            /* Convert the vertex to tree coordinates, if needed. */
-            if (space_transform) {
-              BLI_space_transform_apply(space_transform, tmp_co);
-            }
+              copy_v3_v3(tmp_co, vert_positions_dst[vert_dst]);
+              nearest.index = -1;
 
-            if (mesh_remap_bvhtree_query_nearest(tdata, &nearest, tmp_co, max_dist_sq, &hit_dist))
-            {
-              float(*nor_dst)[3];
-              blender::Span<blender::float3> nors_src;
-              float best_nor_dot = -2.0f;
-              float best_sqdist_fallback = FLT_MAX;
-              int best_index_src = -1;
-
-              if (mode == MREMAP_MODE_LOOP_NEAREST_LOOPNOR) {
-                copy_v3_v3(tmp_no, loop_normals_dst[plidx_dst + face_dst.start()]);
-                if (space_transform) {
-                  BLI_space_transform_apply_normal(space_transform, tmp_no);
-                }
-                nor_dst = &tmp_no;
-                nors_src = loop_normals_src;
-                vert_to_refelem_map_src = vert_to_loop_map_src[nearest.index];
-              }
-              else { /* if (mode == MREMAP_MODE_LOOP_NEAREST_POLYNOR) { */
-                nor_dst = &pnor_dst;
-                nors_src = face_normals_src;
-                vert_to_refelem_map_src = vert_to_face_map_src[nearest.index];
+              /* Convert the vertex to tree coordinates, if needed. */
+              if (space_transform) {
+                BLI_space_transform_apply(space_transform, tmp_co);
               }
 
-              for (const int index_src : vert_to_refelem_map_src) {
-                BLI_assert(index_src != -1);
-                const float dot = dot_v3v3(nors_src[index_src], *nor_dst);
-
-                pidx_src = ((mode == MREMAP_MODE_LOOP_NEAREST_LOOPNOR) ?
-                                loop_to_face_map_src[index_src] :
-                                index_src);
-                /* WARNING! This is not the *real* lidx_src in case of POLYNOR, we only use it
-                 *          to check we stay on current island (all loops from a given face are
-                 *          on same island!). */
-                lidx_src = ((mode == MREMAP_MODE_LOOP_NEAREST_LOOPNOR) ?
-                                index_src :
-                                int(faces_src[pidx_src].start()));
-
-                /* A same vert may be at the boundary of several islands! Hence, we have to ensure
-                 * face/loop we are currently considering *belongs* to current island! */
-                if (use_islands && island_store.items_to_islands[lidx_src] != tindex) {
-                  continue;
+              if (mesh_remap_bvhtree_query_nearest(
+                      tdata, &nearest, tmp_co, max_dist_sq, &hit_dist))
+              {
+                float(*nor_dst)[3];
+                blender::Span<blender::float3> nors_src;
+                float best_nor_dot = -2.0f;
+                float best_sqdist_fallback = FLT_MAX;
+                int best_index_src = -1;
+
+                if (mode == MREMAP_MODE_LOOP_NEAREST_LOOPNOR) {
+                  copy_v3_v3(tmp_no, loop_normals_dst[plidx_dst + face_dst.start()]);
+                  if (space_transform) {
+                    BLI_space_transform_apply_normal(space_transform, tmp_no);
+                  }
+                  nor_dst = &tmp_no;
+                  nors_src = loop_normals_src;
+                  vert_to_refelem_map_src = vert_to_loop_map_src[nearest.index];
+                }
+                else { /* if (mode == MREMAP_MODE_LOOP_NEAREST_POLYNOR) { */
+                  nor_dst = &pnor_dst;
+                  nors_src = face_normals_src;
+                  vert_to_refelem_map_src = vert_to_face_map_src[nearest.index];
                 }
 
-                if (dot > best_nor_dot - 1e-6f) {
-                  /* We need something as fallback decision in case dest normal matches several
-                   * source normals (see #44522), using distance between faces' centers here. */
-                  float *pcent_src;
-                  float sqdist;
-
-                  if (!pcent_dst_valid) {
-                    pcent_dst = blender::bke::mesh::face_center_calc(
-                        {reinterpret_cast<const blender::float3 *>(vert_positions_dst),
-                         numverts_dst},
-                        blender::Span(corner_verts_dst, numloops_dst).slice(face_dst));
-                    pcent_dst_valid = true;
+                for (const int index_src : vert_to_refelem_map_src) {
+                  BLI_assert(index_src != -1);
+                  const float dot = dot_v3v3(nors_src[index_src], *nor_dst);
+
+                  pidx_src = ((mode == MREMAP_MODE_LOOP_NEAREST_LOOPNOR) ?
+                                  loop_to_face_map_src[index_src] :
+                                  index_src);
+                  /* WARNING! This is not the *real* lidx_src in case of POLYNOR, we only use it
+                   *          to check we stay on current island (all loops from a given face are
+                   *          on same island!). */
+                  lidx_src = ((mode == MREMAP_MODE_LOOP_NEAREST_LOOPNOR) ?
+                                  index_src :
+                                  int(faces_src[pidx_src].start()));
+
+                  /* A same vert may be at the boundary of several islands! Hence, we have to
+                   * ensure face/loop we are currently considering *belongs* to current island! */
+                  if (use_islands && island_store.items_to_islands[lidx_src] != tindex) {
+                    continue;
                   }
-                  pcent_src = face_cents_src[pidx_src];
-                  sqdist = len_squared_v3v3(pcent_dst, pcent_src);
 
-                  if ((dot > best_nor_dot + 1e-6f) || (sqdist < best_sqdist_fallback)) {
-                    best_nor_dot = dot;
-                    best_sqdist_fallback = sqdist;
-                    best_index_src = index_src;
+                  if (dot > best_nor_dot - 1e-6f) {
+                    /* We need something as fallback decision in case dest normal matches several
+                     * source normals (see #44522), using distance between faces' centers here. */
+                    float *pcent_src;
+                    float sqdist;
+
+                    if (!pcent_dst_valid) {
+                      pcent_dst = blender::bke::mesh::face_center_calc(
+                          {reinterpret_cast<const blender::float3 *>(vert_positions_dst),
+                           numverts_dst},
+                          blender::Span(corner_verts_dst, numloops_dst).slice(face_dst));
+                      pcent_dst_valid = true;
+                    }
+                    pcent_src = face_cents_src[pidx_src];
+                    sqdist = len_squared_v3v3(pcent_dst, pcent_src);
+
+                    if ((dot > best_nor_dot + 1e-6f) || (sqdist < best_sqdist_fallback)) {
+                      best_nor_dot = dot;
+                      best_sqdist_fallback = sqdist;
+                      best_index_src = index_src;
+                    }
                   }
                 }
-              }
-              if (best_index_src == -1) {
-                /* We found no item to map back from closest vertex... */
-                best_nor_dot = -1.0f;
-                hit_dist = FLT_MAX;
-              }
-              else if (mode == MREMAP_MODE_LOOP_NEAREST_POLYNOR) {
-                /* Our best_index_src is a face one for now!
-                 * Have to find its loop matching our closest vertex. */
-                const blender::IndexRange face_src = faces_src[best_index_src];
-                for (plidx_src = 0; plidx_src < face_src.size(); plidx_src++) {
-                  const int vert_src = corner_verts_src[face_src.start() + plidx_src];
-                  if (vert_src == nearest.index) {
-                    best_index_src = plidx_src + int(face_src.start());
-                    break;
+                if (best_index_src == -1) {
+                  /* We found no item to map back from closest vertex... */
+                  best_nor_dot = -1.0f;
+                  hit_dist = FLT_MAX;
+                }
+                else if (mode == MREMAP_MODE_LOOP_NEAREST_POLYNOR) {
+                  /* Our best_index_src is a face one for now!
+                   * Have to find its loop matching our closest vertex. */
+                  const blender::IndexRange face_src = faces_src[best_index_src];
+                  for (plidx_src = 0; plidx_src < face_src.size(); plidx_src++) {
+                    const int vert_src = corner_verts_src[face_src.start() + plidx_src];
+                    if (vert_src == nearest.index) {
+                      best_index_src = plidx_src + int(face_src.start());
+                      break;
+                    }
                   }
                 }
+                best_nor_dot = (best_nor_dot + 1.0f) * 0.5f;
+                islands_res[tindex][plidx_dst].factor = hit_dist ? (best_nor_dot / hit_dist) :
+                                                                   1e18f;
+                islands_res[tindex][plidx_dst].hit_dist = hit_dist;
+                islands_res[tindex][plidx_dst].index_src = best_index_src;
+              }
+              else {
+                /* No source for this dest loop! */
+                islands_res[tindex][plidx_dst].factor = 0.0f;
+                islands_res[tindex][plidx_dst].hit_dist = FLT_MAX;
+                islands_res[tindex][plidx_dst].index_src = -1;
               }
-              best_nor_dot = (best_nor_dot + 1.0f) * 0.5f;
-              islands_res[tindex][plidx_dst].factor = hit_dist ? (best_nor_dot / hit_dist) : 1e18f;
-              islands_res[tindex][plidx_dst].hit_dist = hit_dist;
-              islands_res[tindex][plidx_dst].index_src = best_index_src;
-            }
-            else {
-              /* No source for this dest loop! */
-              islands_res[tindex][plidx_dst].factor = 0.0f;
-              islands_res[tindex][plidx_dst].hit_dist = FLT_MAX;
-              islands_res[tindex][plidx_dst].index_src = -1;
             }
-          }
-          else if (mode & MREMAP_USE_NORPROJ) {
-            int n = (ray_radius > 0.0f) ? MREMAP_RAYCAST_APPROXIMATE_NR : 1;
-            float w = 1.0f;
+            else if (mode & MREMAP_USE_NORPROJ) {
+              int n = (ray_radius > 0.0f) ? MREMAP_RAYCAST_APPROXIMATE_NR : 1;
+              float w = 1.0f;
 
-            copy_v3_v3(tmp_co, vert_positions_dst[vert_dst]);
-            copy_v3_v3(tmp_no, loop_normals_dst[plidx_dst + face_dst.start()]);
+              copy_v3_v3(tmp_co, vert_positions_dst[vert_dst]);
+              copy_v3_v3(tmp_no, loop_normals_dst[plidx_dst + face_dst.start()]);
 
-            /* We do our transform here, since we may do several raycast/nearest queries. */
-            if (space_transform) {
-              BLI_space_transform_apply(space_transform, tmp_co);
-              BLI_space_transform_apply_normal(space_transform, tmp_no);
-            }
+              /* We do our transform here, since we may do several raycast/nearest queries. */
+              if (space_transform) {
+                BLI_space_transform_apply(space_transform, tmp_co);
+                BLI_space_transform_apply_normal(space_transform, tmp_no);
+              }
 
-            while (n--) {
-              if (mesh_remap_bvhtree_query_raycast(
-                      tdata, &rayhit, tmp_co, tmp_no, ray_radius / w, max_dist, &hit_dist))
-              {
-                islands_res[tindex][plidx_dst].factor = (hit_dist ? (1.0f / hit_dist) : 1e18f) * w;
-                islands_res[tindex][plidx_dst].hit_dist = hit_dist;
-                islands_res[tindex][plidx_dst].index_src = tri_faces[rayhit.index];
-                copy_v3_v3(islands_res[tindex][plidx_dst].hit_point, rayhit.co);
-                break;
+              while (n--) {
+                if (mesh_remap_bvhtree_query_raycast(
+                        tdata, &rayhit, tmp_co, tmp_no, ray_radius / w, max_dist, &hit_dist))
+                {
+                  islands_res[tindex][plidx_dst].factor = (hit_dist ? (1.0f / hit_dist) : 1e18f) *
+                                                          w;
+                  islands_res[tindex][plidx_dst].hit_dist = hit_dist;
+                  islands_res[tindex][plidx_dst].index_src = tri_faces[rayhit.index];
+                  copy_v3_v3(islands_res[tindex][plidx_dst].hit_point, rayhit.co);
+                  break;
+                }
+                /* Next iteration will get bigger radius but smaller weight! */
+                w /= MREMAP_RAYCAST_APPROXIMATE_FAC;
+              }
+              if (n == -1) {
+                /* Fallback to 'nearest' hit here, loops usually comes in 'face group', not good to
+                 * have only part of one dest face's loops to map to source.
+                 * Note that since we give this a null weight, if whole weight for a given face
+                 * is null, it means none of its loop mapped to this source island,
+                 * hence we can skip it later.
+                 */
+                copy_v3_v3(tmp_co, vert_positions_dst[vert_dst]);
+                nearest.index = -1;
+
+                /* Convert the vertex to tree coordinates, if needed. */
+                if (space_transform) {
+                  BLI_space_transform_apply(space_transform, tmp_co);
+                }
+
+                /* In any case, this fallback nearest hit should have no weight at all
+                 * in 'best island' decision! */
+                islands_res[tindex][plidx_dst].factor = 0.0f;
+
+                if (mesh_remap_bvhtree_query_nearest(
+                        tdata, &nearest, tmp_co, max_dist_sq, &hit_dist))
+                {
+                  islands_res[tindex][plidx_dst].hit_dist = hit_dist;
+                  islands_res[tindex][plidx_dst].index_src = tri_faces[nearest.index];
+                  copy_v3_v3(islands_res[tindex][plidx_dst].hit_point, nearest.co);
+                }
+                else {
+                  /* No source for this dest loop! */
+                  islands_res[tindex][plidx_dst].hit_dist = FLT_MAX;
+                  islands_res[tindex][plidx_dst].index_src = -1;
+                }
               }
-              /* Next iteration will get bigger radius but smaller weight! */
-              w /= MREMAP_RAYCAST_APPROXIMATE_FAC;
             }
-            if (n == -1) {
-              /* Fallback to 'nearest' hit here, loops usually comes in 'face group', not good to
-               * have only part of one dest face's loops to map to source.
-               * Note that since we give this a null weight, if whole weight for a given face
-               * is null, it means none of its loop mapped to this source island,
-               * hence we can skip it later.
-               */
+            else { /* Nearest face either to use all its loops/verts or just closest one. */
               copy_v3_v3(tmp_co, vert_positions_dst[vert_dst]);
               nearest.index = -1;
 
@@ -1657,359 +1764,314 @@ void BKE_mesh_remap_calc_loops_from_mesh(const int mode,
                 BLI_space_transform_apply(space_transform, tmp_co);
               }
 
-              /* In any case, this fallback nearest hit should have no weight at all
-               * in 'best island' decision! */
-              islands_res[tindex][plidx_dst].factor = 0.0f;
-
               if (mesh_remap_bvhtree_query_nearest(
                       tdata, &nearest, tmp_co, max_dist_sq, &hit_dist))
               {
+                islands_res[tindex][plidx_dst].factor = hit_dist ? (1.0f / hit_dist) : 1e18f;
                 islands_res[tindex][plidx_dst].hit_dist = hit_dist;
                 islands_res[tindex][plidx_dst].index_src = tri_faces[nearest.index];
                 copy_v3_v3(islands_res[tindex][plidx_dst].hit_point, nearest.co);
               }
               else {
                 /* No source for this dest loop! */
+                islands_res[tindex][plidx_dst].factor = 0.0f;
                 islands_res[tindex][plidx_dst].hit_dist = FLT_MAX;
                 islands_res[tindex][plidx_dst].index_src = -1;
               }
             }
           }
-          else { /* Nearest face either to use all its loops/verts or just closest one. */
-            copy_v3_v3(tmp_co, vert_positions_dst[vert_dst]);
-            nearest.index = -1;
+        }
 
-            /* Convert the vertex to tree coordinates, if needed. */
-            if (space_transform) {
-              BLI_space_transform_apply(space_transform, tmp_co);
-            }
+        /* And now, find best island to use! */
+        /* We have to first select the 'best source island' for given dst face and its loops.
+         * Then, we have to check that face does not 'spread' across some island's limits
+         * (like inner seams for UVs, etc.).
+         * Note we only still partially support that kind of situation here, i.e.
+         * Faces spreading over actual cracks
+         * (like a narrow space without faces on src, splitting a 'tube-like' geometry).
+         * That kind of situation should be relatively rare, though.
+         */
+        /* XXX This block in itself is big and complex enough to be a separate function but...
+         *     it uses a bunch of locale vars.
+         *     Not worth sending all that through parameters (for now at least). */
+        {
+          BLI_AStarGraph *as_graph = nullptr;
+          int *face_island_index_map = nullptr;
+          int pidx_src_prev = -1;
 
-            if (mesh_remap_bvhtree_query_nearest(tdata, &nearest, tmp_co, max_dist_sq, &hit_dist))
-            {
-              islands_res[tindex][plidx_dst].factor = hit_dist ? (1.0f / hit_dist) : 1e18f;
-              islands_res[tindex][plidx_dst].hit_dist = hit_dist;
-              islands_res[tindex][plidx_dst].index_src = tri_faces[nearest.index];
-              copy_v3_v3(islands_res[tindex][plidx_dst].hit_point, nearest.co);
-            }
-            else {
-              /* No source for this dest loop! */
-              islands_res[tindex][plidx_dst].factor = 0.0f;
-              islands_res[tindex][plidx_dst].hit_dist = FLT_MAX;
-              islands_res[tindex][plidx_dst].index_src = -1;
-            }
-          }
-        }
-      }
+          MeshElemMap *best_island = nullptr;
+          float best_island_fac = 0.0f;
+          int best_island_index = -1;
 
-      /* And now, find best island to use! */
-      /* We have to first select the 'best source island' for given dst face and its loops.
-       * Then, we have to check that face does not 'spread' across some island's limits
-       * (like inner seams for UVs, etc.).
-       * Note we only still partially support that kind of situation here, i.e.
-       * Faces spreading over actual cracks
-       * (like a narrow space without faces on src, splitting a 'tube-like' geometry).
-       * That kind of situation should be relatively rare, though.
-       */
-      /* XXX This block in itself is big and complex enough to be a separate function but...
-       *     it uses a bunch of locale vars.
-       *     Not worth sending all that through parameters (for now at least). */
-      {
-        BLI_AStarGraph *as_graph = nullptr;
-        int *face_island_index_map = nullptr;
-        int pidx_src_prev = -1;
-
-        MeshElemMap *best_island = nullptr;
-        float best_island_fac = 0.0f;
-        int best_island_index = -1;
-
-        for (tindex = 0; tindex < num_trees; tindex++) {
-          float island_fac = 0.0f;
+          for (int tindex = 0; tindex < num_trees; tindex++) {
+            float island_fac = 0.0f;
 
-          for (plidx_dst = 0; plidx_dst < face_dst.size(); plidx_dst++) {
-            island_fac += islands_res[tindex][plidx_dst].factor;
-          }
-          island_fac /= float(face_dst.size());
+            for (plidx_dst = 0; plidx_dst < face_dst.size(); plidx_dst++) {
+              island_fac += islands_res[tindex][plidx_dst].factor;
+            }
+            island_fac /= float(face_dst.size());
 
-          if (island_fac > best_island_fac) {
-            best_island_fac = island_fac;
-            best_island_index = tindex;
+            if (island_fac > best_island_fac) {
+              best_island_fac = island_fac;
+              best_island_index = tindex;
+            }
           }
-        }
 
-        if (best_island_index != -1 && isld_steps_src) {
-          best_island = use_islands ? island_store.islands[best_island_index] : nullptr;
-          as_graph = &as_graphdata[best_island_index];
-          face_island_index_map = (int *)as_graph->custom_data;
-          BLI_astar_solution_init(as_graph, &as_solution, nullptr);
-        }
+          if (best_island_index != -1 && isld_steps_src) {
+            best_island = use_islands ? island_store.islands[best_island_index] : nullptr;
+            as_graph = &as_graphdata[best_island_index];
+            face_island_index_map = (int *)as_graph->custom_data;
+            BLI_astar_solution_init(as_graph, &as_solution, nullptr);
+          }
 
-        for (plidx_dst = 0; plidx_dst < face_dst.size(); plidx_dst++) {
-          IslandResult *isld_res;
-          lidx_dst = plidx_dst + int(face_dst.start());
+          for (plidx_dst = 0; plidx_dst < face_dst.size(); plidx_dst++) {
+            IslandResult *isld_res;
+            lidx_dst = plidx_dst + int(face_dst.start());
 
-          if (best_island_index == -1) {
-            /* No source for any loops of our dest face in any source islands. */
-            BKE_mesh_remap_item_define_invalid(r_map, lidx_dst);
-            continue;
-          }
+            if (best_island_index == -1) {
+              /* No source for any loops of our dest face in any source islands. */
+              BKE_mesh_remap_item_define_invalid(map, lidx_dst);
+              continue;
+            }
 
-          as_solution.custom_data = POINTER_FROM_INT(false);
-
-          isld_res = &islands_res[best_island_index][plidx_dst];
-          if (use_from_vert) {
-            /* Indices stored in islands_res are those of loops, one per dest loop. */
-            lidx_src = isld_res->index_src;
-            if (lidx_src >= 0) {
-              pidx_src = loop_to_face_map_src[lidx_src];
-              /* If prev and curr face are the same, no need to do anything more!!! */
-              if (!ELEM(pidx_src_prev, -1, pidx_src) && isld_steps_src) {
-                int pidx_isld_src, pidx_isld_src_prev;
-                if (face_island_index_map) {
-                  pidx_isld_src = face_island_index_map[pidx_src];
-                  pidx_isld_src_prev = face_island_index_map[pidx_src_prev];
-                }
-                else {
-                  pidx_isld_src = pidx_src;
-                  pidx_isld_src_prev = pidx_src_prev;
-                }
+            as_solution.custom_data = POINTER_FROM_INT(false);
+
+            isld_res = &islands_res[best_island_index][plidx_dst];
+            if (use_from_vert) {
+              /* Indices stored in islands_res are those of loops, one per dest loop. */
+              lidx_src = isld_res->index_src;
+              if (lidx_src >= 0) {
+                pidx_src = loop_to_face_map_src[lidx_src];
+                /* If prev and curr face are the same, no need to do anything more!!! */
+                if (!ELEM(pidx_src_prev, -1, pidx_src) && isld_steps_src) {
+                  int pidx_isld_src, pidx_isld_src_prev;
+                  if (face_island_index_map) {
+                    pidx_isld_src = face_island_index_map[pidx_src];
+                    pidx_isld_src_prev = face_island_index_map[pidx_src_prev];
+                  }
+                  else {
+                    pidx_isld_src = pidx_src;
+                    pidx_isld_src_prev = pidx_src_prev;
+                  }
 
-                BLI_astar_graph_solve(as_graph,
-                                      pidx_isld_src_prev,
-                                      pidx_isld_src,
-                                      mesh_remap_calc_loops_astar_f_cost,
-                                      &as_solution,
-                                      isld_steps_src);
-                if (POINTER_AS_INT(as_solution.custom_data) && (as_solution.steps > 0)) {
-                  /* Find first 'cutting edge' on path, and bring back lidx_src on face just
-                   * before that edge.
-                   * Note we could try to be much smarter, g.g. Storing a whole face's indices,
-                   * and making decision (on which side of cutting edge(s!) to be) on the end,
-                   * but this is one more level of complexity, better to first see if
-                   * simple solution works!
-                   */
-                  int last_valid_pidx_isld_src = -1;
-                  /* Note we go backward here, from dest to src face. */
-                  for (int i = as_solution.steps - 1; i--;) {
-                    BLI_AStarGNLink *as_link = as_solution.prev_links[pidx_isld_src];
-                    const int eidx = POINTER_AS_INT(as_link->custom_data);
-                    pidx_isld_src = as_solution.prev_nodes[pidx_isld_src];
-                    BLI_assert(pidx_isld_src != -1);
-                    if (eidx != -1) {
-                      /* we are 'crossing' a cutting edge. */
-                      last_valid_pidx_isld_src = pidx_isld_src;
+                  BLI_astar_graph_solve(as_graph,
+                                        pidx_isld_src_prev,
+                                        pidx_isld_src,
+                                        mesh_remap_calc_loops_astar_f_cost,
+                                        &as_solution,
+                                        isld_steps_src);
+                  if (POINTER_AS_INT(as_solution.custom_data) && (as_solution.steps > 0)) {
+                    /* Find first 'cutting edge' on path, and bring back lidx_src on face just
+                     * before that edge.
+                     * Note we could try to be much smarter, g.g. Storing a whole face's indices,
+                     * and making decision (on which side of cutting edge(s!) to be) on the end,
+                     * but this is one more level of complexity, better to first see if
+                     * simple solution works!
+                     */
+                    int last_valid_pidx_isld_src = -1;
+                    /* Note we go backward here, from dest to src face. */
+                    for (int i = as_solution.steps - 1; i--;) {
+                      BLI_AStarGNLink *as_link = as_solution.prev_links[pidx_isld_src];
+                      const int eidx = POINTER_AS_INT(as_link->custom_data);
+                      pidx_isld_src = as_solution.prev_nodes[pidx_isld_src];
+                      BLI_assert(pidx_isld_src != -1);
+                      if (eidx != -1) {
+                        /* we are 'crossing' a cutting edge. */
+                        last_valid_pidx_isld_src = pidx_isld_src;
+                      }
                     }
-                  }
-                  if (last_valid_pidx_isld_src != -1) {
-                    /* Find a new valid loop in that new face (nearest one for now).
-                     * Note we could be much more subtle here, again that's for later... */
-                    float best_dist_sq = FLT_MAX;
+                    if (last_valid_pidx_isld_src != -1) {
+                      /* Find a new valid loop in that new face (nearest one for now).
+                       * Note we could be much more subtle here, again that's for later... */
+                      float best_dist_sq = FLT_MAX;
 
-                    copy_v3_v3(tmp_co, vert_positions_dst[corner_verts_dst[lidx_dst]]);
+                      copy_v3_v3(tmp_co, vert_positions_dst[corner_verts_dst[lidx_dst]]);
 
-                    /* We do our transform here,
-                     * since we may do several raycast/nearest queries. */
-                    if (space_transform) {
-                      BLI_space_transform_apply(space_transform, tmp_co);
-                    }
+                      /* We do our transform here,
+                       * since we may do several raycast/nearest queries. */
+                      if (space_transform) {
+                        BLI_space_transform_apply(space_transform, tmp_co);
+                      }
 
-                    pidx_src = (use_islands ? best_island->indices[last_valid_pidx_isld_src] :
-                                              last_valid_pidx_isld_src);
-                    const blender::IndexRange face_src = faces_src[pidx_src];
-                    for (const int64_t corner : face_src) {
-                      const int vert_src = corner_verts_src[corner];
-                      const float dist_sq = len_squared_v3v3(positions_src[vert_src], tmp_co);
-                      if (dist_sq < best_dist_sq) {
-                        best_dist_sq = dist_sq;
-                        lidx_src = int(corner);
+                      pidx_src = (use_islands ? best_island->indices[last_valid_pidx_isld_src] :
+                                                last_valid_pidx_isld_src);
+                      const blender::IndexRange face_src = faces_src[pidx_src];
+                      for (const int64_t corner : face_src) {
+                        const int vert_src = corner_verts_src[corner];
+                        const float dist_sq = len_squared_v3v3(positions_src[vert_src], tmp_co);
+                        if (dist_sq < best_dist_sq) {
+                          best_dist_sq = dist_sq;
+                          lidx_src = int(corner);
+                        }
                       }
                     }
                   }
                 }
+                mesh_remap_item_define(map,
+                                       lidx_dst,
+                                       isld_res->hit_dist,
+                                       best_island_index,
+                                       1,
+                                       &lidx_src,
+                                       &full_weight);
+                pidx_src_prev = pidx_src;
+              }
+              else {
+                /* No source for this loop in this island. */
+                /* TODO: would probably be better to get a source
+                 * at all cost in best island anyway? */
+                mesh_remap_item_define(
+                    map, lidx_dst, FLT_MAX, best_island_index, 0, nullptr, nullptr);
               }
-              mesh_remap_item_define(r_map,
-                                     lidx_dst,
-                                     isld_res->hit_dist,
-                                     best_island_index,
-                                     1,
-                                     &lidx_src,
-                                     &full_weight);
-              pidx_src_prev = pidx_src;
             }
             else {
-              /* No source for this loop in this island. */
-              /* TODO: would probably be better to get a source
-               * at all cost in best island anyway? */
-              mesh_remap_item_define(
-                  r_map, lidx_dst, FLT_MAX, best_island_index, 0, nullptr, nullptr);
-            }
-          }
-          else {
-            /* Else, we use source face, indices stored in islands_res are those of faces. */
-            pidx_src = isld_res->index_src;
-            if (pidx_src >= 0) {
-              float *hit_co = isld_res->hit_point;
-              int best_loop_index_src;
-
-              const blender::IndexRange face_src = faces_src[pidx_src];
-              /* If prev and curr face are the same, no need to do anything more!!! */
-              if (!ELEM(pidx_src_prev, -1, pidx_src) && isld_steps_src) {
-                int pidx_isld_src, pidx_isld_src_prev;
-                if (face_island_index_map) {
-                  pidx_isld_src = face_island_index_map[pidx_src];
-                  pidx_isld_src_prev = face_island_index_map[pidx_src_prev];
-                }
-                else {
-                  pidx_isld_src = pidx_src;
-                  pidx_isld_src_prev = pidx_src_prev;
-                }
-
-                BLI_astar_graph_solve(as_graph,
-                                      pidx_isld_src_prev,
-                                      pidx_isld_src,
-                                      mesh_remap_calc_loops_astar_f_cost,
-                                      &as_solution,
-                                      isld_steps_src);
-                if (POINTER_AS_INT(as_solution.custom_data) && (as_solution.steps > 0)) {
-                  /* Find first 'cutting edge' on path, and bring back lidx_src on face just
-                   * before that edge.
-                   * Note we could try to be much smarter: e.g. Storing a whole face's indices,
-                   * and making decision (one which side of cutting edge(s)!) to be on the end,
-                   * but this is one more level of complexity, better to first see if
-                   * simple solution works!
-                   */
-                  int last_valid_pidx_isld_src = -1;
-                  /* Note we go backward here, from dest to src face. */
-                  for (int i = as_solution.steps - 1; i--;) {
-                    BLI_AStarGNLink *as_link = as_solution.prev_links[pidx_isld_src];
-                    int eidx = POINTER_AS_INT(as_link->custom_data);
-
-                    pidx_isld_src = as_solution.prev_nodes[pidx_isld_src];
-                    BLI_assert(pidx_isld_src != -1);
-                    if (eidx != -1) {
-                      /* we are 'crossing' a cutting edge. */
-                      last_valid_pidx_isld_src = pidx_isld_src;
-                    }
+              /* Else, we use source face, indices stored in islands_res are those of faces. */
+              pidx_src = isld_res->index_src;
+              if (pidx_src >= 0) {
+                float *hit_co = isld_res->hit_point;
+                int best_loop_index_src;
+
+                const blender::IndexRange face_src = faces_src[pidx_src];
+                /* If prev and curr face are the same, no need to do anything more!!! */
+                if (!ELEM(pidx_src_prev, -1, pidx_src) && isld_steps_src) {
+                  int pidx_isld_src, pidx_isld_src_prev;
+                  if (face_island_index_map) {
+                    pidx_isld_src = face_island_index_map[pidx_src];
+                    pidx_isld_src_prev = face_island_index_map[pidx_src_prev];
+                  }
+                  else {
+                    pidx_isld_src = pidx_src;
+                    pidx_isld_src_prev = pidx_src_prev;
                   }
-                  if (last_valid_pidx_isld_src != -1) {
-                    /* Find a new valid loop in that new face (nearest point on face for now).
-                     * Note we could be much more subtle here, again that's for later... */
-                    float best_dist_sq = FLT_MAX;
-                    int j;
-
-                    const int vert_dst = corner_verts_dst[lidx_dst];
-                    copy_v3_v3(tmp_co, vert_positions_dst[vert_dst]);
-
-                    /* We do our transform here,
-                     * since we may do several raycast/nearest queries. */
-                    if (space_transform) {
-                      BLI_space_transform_apply(space_transform, tmp_co);
-                    }
-
-                    pidx_src = (use_islands ? best_island->indices[last_valid_pidx_isld_src] :
-                                              last_valid_pidx_isld_src);
 
-                    /* Create that one on demand. */
-                    if (face_to_corner_tri_map_src == nullptr) {
-                      BKE_mesh_origindex_map_create_corner_tri(&face_to_corner_tri_map_src,
-                                                               &face_to_corner_tri_map_src_buff,
-                                                               faces_src,
-                                                               tri_faces_src.data(),
-                                                               int(tri_faces_src.size()));
+                  BLI_astar_graph_solve(as_graph,
+                                        pidx_isld_src_prev,
+                                        pidx_isld_src,
+                                        mesh_remap_calc_loops_astar_f_cost,
+                                        &as_solution,
+                                        isld_steps_src);
+                  if (POINTER_AS_INT(as_solution.custom_data) && (as_solution.steps > 0)) {
+                    /* Find first 'cutting edge' on path, and bring back lidx_src on face just
+                     * before that edge.
+                     * Note we could try to be much smarter: e.g. Storing a whole face's indices,
+                     * and making decision (one which side of cutting edge(s)!) to be on the end,
+                     * but this is one more level of complexity, better to first see if
+                     * simple solution works!
+                     */
+                    int last_valid_pidx_isld_src = -1;
+                    /* Note we go backward here, from dest to src face. */
+                    for (int i = as_solution.steps - 1; i--;) {
+                      BLI_AStarGNLink *as_link = as_solution.prev_links[pidx_isld_src];
+                      int eidx = POINTER_AS_INT(as_link->custom_data);
+
+                      pidx_isld_src = as_solution.prev_nodes[pidx_isld_src];
+                      BLI_assert(pidx_isld_src != -1);
+                      if (eidx != -1) {
+                        /* we are 'crossing' a cutting edge. */
+                        last_valid_pidx_isld_src = pidx_isld_src;
+                      }
                     }
+                    if (last_valid_pidx_isld_src != -1) {
+                      /* Find a new valid loop in that new face (nearest point on face for now).
+                       * Note we could be much more subtle here, again that's for later... */
+                      float best_dist_sq = FLT_MAX;
+                      int j;
+
+                      const int vert_dst = corner_verts_dst[lidx_dst];
+                      copy_v3_v3(tmp_co, vert_positions_dst[vert_dst]);
+
+                      /* We do our transform here,
+                       * since we may do several raycast/nearest queries. */
+                      if (space_transform) {
+                        BLI_space_transform_apply(space_transform, tmp_co);
+                      }
 
-                    for (j = face_to_corner_tri_map_src[pidx_src].count; j--;) {
-                      float h[3];
-                      const blender::int3 &tri =
-                          corner_tris_src[face_to_corner_tri_map_src[pidx_src].indices[j]];
-                      float dist_sq;
-
-                      closest_on_tri_to_point_v3(h,
-                                                 tmp_co,
-                                                 positions_src[corner_verts_src[tri[0]]],
-                                                 positions_src[corner_verts_src[tri[1]]],
-                                                 positions_src[corner_verts_src[tri[2]]]);
-                      dist_sq = len_squared_v3v3(tmp_co, h);
-                      if (dist_sq < best_dist_sq) {
-                        copy_v3_v3(hit_co, h);
-                        best_dist_sq = dist_sq;
+                      pidx_src = (use_islands ? best_island->indices[last_valid_pidx_isld_src] :
+                                                last_valid_pidx_isld_src);
+
+                      for (j = face_to_corner_tri_map_src[pidx_src].count; j--;) {
+                        float h[3];
+                        const blender::int3 &tri =
+                            corner_tris_src[face_to_corner_tri_map_src[pidx_src].indices[j]];
+                        float dist_sq;
+
+                        closest_on_tri_to_point_v3(h,
+                                                   tmp_co,
+                                                   positions_src[corner_verts_src[tri[0]]],
+                                                   positions_src[corner_verts_src[tri[1]]],
+                                                   positions_src[corner_verts_src[tri[2]]]);
+                        dist_sq = len_squared_v3v3(tmp_co, h);
+                        if (dist_sq < best_dist_sq) {
+                          copy_v3_v3(hit_co, h);
+                          best_dist_sq = dist_sq;
+                        }
                       }
                     }
                   }
                 }
-              }
 
-              if (mode == MREMAP_MODE_LOOP_POLY_NEAREST) {
-                mesh_remap_interp_face_data_get(face_src,
-                                                corner_verts_src,
-                                                positions_src,
-                                                hit_co,
-                                                &buff_size_interp,
-                                                &vcos_interp,
-                                                true,
-                                                &indices_interp,
-                                                &weights_interp,
-                                                false,
-                                                &best_loop_index_src);
-
-                mesh_remap_item_define(r_map,
-                                       lidx_dst,
-                                       isld_res->hit_dist,
-                                       best_island_index,
-                                       1,
-                                       &best_loop_index_src,
-                                       &full_weight);
+                if (mode == MREMAP_MODE_LOOP_POLY_NEAREST) {
+                  interp_buffers.face_data_get(face_src,
+                                               corner_verts_src,
+                                               positions_src,
+                                               hit_co,
+                                               true,
+                                               false,
+                                               &best_loop_index_src);
+
+                  mesh_remap_item_define(map,
+                                         lidx_dst,
+                                         isld_res->hit_dist,
+                                         best_island_index,
+                                         1,
+                                         &best_loop_index_src,
+                                         &full_weight);
+                }
+                else {
+                  const int sources_num = interp_buffers.face_data_get(
+                      face_src, corner_verts_src, positions_src, hit_co, true, true, nullptr);
+
+                  mesh_remap_item_define(map,
+                                         lidx_dst,
+                                         isld_res->hit_dist,
+                                         best_island_index,
+                                         sources_num,
+                                         interp_buffers.indices,
+                                         interp_buffers.weights);
+                }
+
+                pidx_src_prev = pidx_src;
               }
               else {
-                const int sources_num = mesh_remap_interp_face_data_get(face_src,
-                                                                        corner_verts_src,
-                                                                        positions_src,
-                                                                        hit_co,
-                                                                        &buff_size_interp,
-                                                                        &vcos_interp,
-                                                                        true,
-                                                                        &indices_interp,
-                                                                        &weights_interp,
-                                                                        true,
-                                                                        nullptr);
-
-                mesh_remap_item_define(r_map,
-                                       lidx_dst,
-                                       isld_res->hit_dist,
-                                       best_island_index,
-                                       sources_num,
-                                       indices_interp,
-                                       weights_interp);
+                /* No source for this loop in this island. */
+                /* TODO: would probably be better to get a source
+                 * at all cost in best island anyway? */
+                mesh_remap_item_define(
+                    map, lidx_dst, FLT_MAX, best_island_index, 0, nullptr, nullptr);
               }
-
-              pidx_src_prev = pidx_src;
-            }
-            else {
-              /* No source for this loop in this island. */
-              /* TODO: would probably be better to get a source
-               * at all cost in best island anyway? */
-              mesh_remap_item_define(
-                  r_map, lidx_dst, FLT_MAX, best_island_index, 0, nullptr, nullptr);
             }
           }
+
+          BLI_astar_solution_clear(&as_solution);
         }
+      }
 
-        BLI_astar_solution_clear(&as_solution);
+      if (isld_steps_src) {
+        BLI_astar_solution_free(&as_solution);
       }
-    }
+    };
+    mesh_remap_parallel_for(r_map, faces_dst.index_range(), 128, remap_faces);
 
-    for (tindex = 0; tindex < num_trees; tindex++) {
-      MEM_freeN(islands_res[tindex]);
+    for (int tindex = 0; tindex < num_trees; tindex++) {
       free_bvhtree_from_mesh(&treedata[tindex]);
       if (isld_steps_src) {
         BLI_astar_graph_free(&as_graphdata[tindex]);
       }
     }
-    MEM_freeN(islands_res);
     BKE_mesh_loop_islands_free(&island_store);
     MEM_freeN(treedata);
     if (isld_steps_src) {
       MEM_freeN(as_graphdata);
-      BLI_astar_solution_free(&as_solution);
     }
 
     if (face_to_corner_tri_map_src) {
@@ -2018,15 +2080,6 @@ void BKE_mesh_remap_calc_loops_from_mesh(const int mode,
     if (face_to_corner_tri_map_src_buff) {
       MEM_freeN(face_to_corner_tri_map_src_buff);
     }
-    if (vcos_interp) {
-      MEM_freeN(vcos_interp);
-    }
-    if (indices_interp) {
-      MEM_freeN(indices_interp);
-    }
-    if (weights_interp) {
-      MEM_freeN(weights_interp);
-    }
   }
 }
 
@@ -2045,7 +2098,6 @@ void BKE_mesh_remap_calc_faces_from_mesh(const int mode,
   const float full_weight = 1.0f;
   const float max_dist_sq = max_dist * max_dist;
   blender::Span<blender::float3> face_normals_dst;
-  blender::float3 tmp_co, tmp_no;
 
   BLI_assert(mode & MREMAP_MODE_POLY);
 
@@ -2063,246 +2115,258 @@ void BKE_mesh_remap_calc_faces_from_mesh(const int mode,
     }
   }
   else {
+    using namespace blender;
     BVHTreeFromMesh treedata = {nullptr};
-    BVHTreeNearest nearest = {0};
-    BVHTreeRayHit rayhit = {0};
-    float hit_dist;
-    const blender::Span<int> tri_faces = me_src->corner_tri_faces();
+    const Span<int> tri_faces = me_src->corner_tri_faces();
+    const Span<float3> positions_dst(reinterpret_cast<const float3 *>(vert_positions_dst),
+                                     numverts_dst);
+    const Span<int> corner_verts_dst_span(corner_verts_dst, faces_dst.total_size());
 
     BKE_bvhtree_from_mesh_get(&treedata, me_src, BVHTREE_FROM_CORNER_TRIS, 2);
 
     if (mode == MREMAP_MODE_POLY_NEAREST) {
-      nearest.index = -1;
+      mesh_remap_parallel_for(
+          r_map, faces_dst.index_range(), 512, [&](const IndexRange range, MeshPairRemap *map) {
+            BVHTreeNearest nearest = {0};
+            nearest.index = -1;
+            float hit_dist;
 
-      for (const int64_t i : faces_dst.index_range()) {
-        const blender::IndexRange face = faces_dst[i];
-        tmp_co = blender::bke::mesh::face_center_calc(
-            {reinterpret_cast<const blender::float3 *>(vert_positions_dst), numverts_dst},
-            {&corner_verts_dst[face.start()], face.size()});
+            for (const int64_t i : range) {
+              float3 tmp_co = bke::mesh::face_center_calc(
+                  positions_dst, corner_verts_dst_span.slice(faces_dst[i]));
 
-        /* Convert the vertex to tree coordinates, if needed. */
-        if (space_transform) {
-          BLI_space_transform_apply(space_transform, tmp_co);
-        }
+              /* Convert the vertex to tree coordinates, if needed. */
+              if (space_transform) {
+                BLI_space_transform_apply(space_transform, tmp_co);
+              }
 
-        if (mesh_remap_bvhtree_query_nearest(&treedata, &nearest, tmp_co, max_dist_sq, &hit_dist))
-        {
-          const int face_index = tri_faces[nearest.index];
-          mesh_remap_item_define(r_map, int(i), hit_dist, 0, 1, &face_index, &full_weight);
-        }
-        else {
-          /* No source for this dest face! */
-          BKE_mesh_remap_item_define_invalid(r_map, int(i));
-        }
-      }
+              if (mesh_remap_bvhtree_query_nearest(
+                      &treedata, &nearest, tmp_co, max_dist_sq, &hit_dist))
+              {
+                const int face_index = tri_faces[nearest.index];
+                mesh_remap_item_define(map, int(i), hit_dist, 0, 1, &face_index, &full_weight);
+              }
+              else {
+                /* No source for this dest face! */
+                BKE_mesh_remap_item_define_invalid(map, int(i));
+              }
+            }
+          });
     }
     else if (mode == MREMAP_MODE_POLY_NOR) {
-      for (const int64_t i : faces_dst.index_range()) {
-        const blender::IndexRange face = faces_dst[i];
+      mesh_remap_parallel_for(
+          r_map, faces_dst.index_range(), 512, [&](const IndexRange range, MeshPairRemap *map) {
+            BVHTreeRayHit rayhit = {0};
+            float hit_dist;
 
-        tmp_co = blender::bke::mesh::face_center_calc(
-            {reinterpret_cast<const blender::float3 *>(vert_positions_dst), numverts_dst},
-            {&corner_verts_dst[face.start()], face.size()});
-        copy_v3_v3(tmp_no, face_normals_dst[i]);
+            for (const int64_t i : range) {
+              float3 tmp_co = bke::mesh::face_center_calc(
+                  positions_dst, corner_verts_dst_span.slice(faces_dst[i]));
+              float3 tmp_no = face_normals_dst[i];
 
-        /* Convert the vertex to tree coordinates, if needed. */
-        if (space_transform) {
-          BLI_space_transform_apply(space_transform, tmp_co);
-          BLI_space_transform_apply_normal(space_transform, tmp_no);
-        }
+              /* Convert the vertex to tree coordinates, if needed. */
+              if (space_transform) {
+                BLI_space_transform_apply(space_transform, tmp_co);
+                BLI_space_transform_apply_normal(space_transform, tmp_no);
+              }
 
-        if (mesh_remap_bvhtree_query_raycast(
-                &treedata, &rayhit, tmp_co, tmp_no, ray_radius, max_dist, &hit_dist))
-        {
-          const int face_index = tri_faces[rayhit.index];
-          mesh_remap_item_define(r_map, int(i), hit_dist, 0, 1, &face_index, &full_weight);
-        }
-        else {
-          /* No source for this dest face! */
-          BKE_mesh_remap_item_define_invalid(r_map, int(i));
-        }
-      }
+              if (mesh_remap_bvhtree_query_raycast(
+                      &treedata, &rayhit, tmp_co, tmp_no, ray_radius, max_dist, &hit_dist))
+              {
+                const int face_index = tri_faces[rayhit.index];
+                mesh_remap_item_define(map, int(i), hit_dist, 0, 1, &face_index, &full_weight);
+              }
+              else {
+                /* No source for this dest face! */
+                BKE_mesh_remap_item_define_invalid(map, int(i));
+              }
+            }
+          });
     }
     else if (mode == MREMAP_MODE_POLY_POLYINTERP_PNORPROJ) {
       /* We cast our rays randomly, with a pseudo-even distribution
        * (since we spread across tessellated triangles,
-       * with additional weighting based on each triangle's relative area). */
-      RNG *rng = BLI_rng_new(0);
-
-      const size_t numfaces_src = size_t(me_src->faces_num);
-
-      /* Here it's simpler to just allocate for all faces :/ */
-      int *indices = static_cast<int *>(MEM_mallocN(sizeof(*indices) * numfaces_src, __func__));
-      float *weights = static_cast<float *>(
-          MEM_mallocN(sizeof(*weights) * numfaces_src, __func__));
-
-      size_t tmp_face_size = MREMAP_DEFAULT_BUFSIZE;
-      float(*face_vcos_2d)[2] = static_cast<float(*)[2]>(
-          MEM_mallocN(sizeof(*face_vcos_2d) * tmp_face_size, __func__));
-      /* Tessellated 2D face, always (num_loops - 2) triangles. */
-      int(*tri_vidx_2d)[3] = static_cast<int(*)[3]>(
-          MEM_mallocN(sizeof(*tri_vidx_2d) * (tmp_face_size - 2), __func__));
-
-      for (const int64_t i : faces_dst.index_range()) {
-        /* For each dst face, we sample some rays from it (2D grid in pnor space)
-         * and use their hits to interpolate from source faces. */
-        /* NOTE: dst face is early-converted into src space! */
-        const blender::IndexRange face = faces_dst[i];
-
-        int tot_rays, done_rays = 0;
-        float face_area_2d_inv, done_area = 0.0f;
-
-        blender::float3 pcent_dst;
-        float to_pnor_2d_mat[3][3], from_pnor_2d_mat[3][3];
-        float faces_dst_2d_min[2], faces_dst_2d_max[2], faces_dst_2d_z;
-        float faces_dst_2d_size[2];
-
-        float totweights = 0.0f;
-        float hit_dist_accum = 0.0f;
-        int sources_num = 0;
-        const int tris_num = int(face.size()) - 2;
-        int j;
-
-        pcent_dst = blender::bke::mesh::face_center_calc(
-            {reinterpret_cast<const blender::float3 *>(vert_positions_dst), numverts_dst},
-            {&corner_verts_dst[face.start()], face.size()});
-
-        copy_v3_v3(tmp_no, face_normals_dst[i]);
-
-        /* We do our transform here, else it'd be redone by raycast helper for each ray, ugh! */
-        if (space_transform) {
-          BLI_space_transform_apply(space_transform, pcent_dst);
-          BLI_space_transform_apply_normal(space_transform, tmp_no);
-        }
-
-        copy_vn_fl(weights, int(numfaces_src), 0.0f);
-
-        if (UNLIKELY(size_t(face.size()) > tmp_face_size)) {
-          tmp_face_size = size_t(face.size());
-          face_vcos_2d = static_cast<float(*)[2]>(
-              MEM_reallocN(face_vcos_2d, sizeof(*face_vcos_2d) * tmp_face_size));
-          tri_vidx_2d = static_cast<int(*)[3]>(
-              MEM_reallocN(tri_vidx_2d, sizeof(*tri_vidx_2d) * (tmp_face_size - 2)));
-        }
-
-        axis_dominant_v3_to_m3(to_pnor_2d_mat, tmp_no);
-        invert_m3_m3(from_pnor_2d_mat, to_pnor_2d_mat);
-
-        mul_m3_v3(to_pnor_2d_mat, pcent_dst);
-        faces_dst_2d_z = pcent_dst[2];
-
-        /* Get (2D) bounding square of our face. */
-        INIT_MINMAX2(faces_dst_2d_min, faces_dst_2d_max);
-
-        for (j = 0; j < face.size(); j++) {
-          const int vert = corner_verts_dst[face[j]];
-          copy_v3_v3(tmp_co, vert_positions_dst[vert]);
-          if (space_transform) {
-            BLI_space_transform_apply(space_transform, tmp_co);
-          }
-          mul_v2_m3v3(face_vcos_2d[j], to_pnor_2d_mat, tmp_co);
-          minmax_v2v2_v2(faces_dst_2d_min, faces_dst_2d_max, face_vcos_2d[j]);
-        }
+       * with additional weighting based on each triangle's relative area).
+       * The generator is re-seeded for each dest face, so that the result does not depend on
+       * how faces are distributed over threads. */
+      mesh_remap_parallel_for(
+          r_map, faces_dst.index_range(), 64, [&](const IndexRange range, MeshPairRemap *map) {
+            /* Accumulated hit weights of the source faces, only a few of them are hit by the
+             * rays of a given dest face. */
+            Map<int, float> weights_src;
+            Vector<int> indices;
+            Vector<float> weights;
+            Vector<float2> face_vcos_2d;
+            /* Tessellated 2D face, always (num_loops - 2) triangles. */
+            Vector<uint3> tri_vidx_2d;
+            RNG *rng = BLI_rng_new(0);
+            float hit_dist;
+            float3 tmp_co, tmp_no;
+            BVHTreeRayHit rayhit = {0};
+
+            for (const int64_t i : range) {
+              /* For each dst face, we sample some rays from it (2D grid in pnor space)
+               * and use their hits to interpolate from source faces. */
+              /* NOTE: dst face is early-converted into src space! */
+              const IndexRange face = faces_dst[i];
+
+              int tot_rays, done_rays = 0;
+              float face_area_2d_inv, done_area = 0.0f;
+
+              float3 pcent_dst;
+              float to_pnor_2d_mat[3][3], from_pnor_2d_mat[3][3];
+              float faces_dst_2d_min[2], faces_dst_2d_max[2], faces_dst_2d_z;
+              float faces_dst_2d_size[2];
+
+              float totweights = 0.0f;
+              float hit_dist_accum = 0.0f;
+              const int tris_num = int(face.size()) - 2;
+              int j;
+
+              BLI_rng_seed(rng, uint(i));
+              weights_src.clear();
+
+              pcent_dst = bke::mesh::face_center_calc(positions_dst,
+                                                      corner_verts_dst_span.slice(face));
+
+              copy_v3_v3(tmp_no, face_normals_dst[i]);
+
+              /* We do our transform here, else it'd be redone by raycast helper for each ray,
+               * ugh! */
+              if (space_transform) {
+                BLI_space_transform_apply(space_transform, pcent_dst);
+                BLI_space_transform_apply_normal(space_transform, tmp_no);
+              }
 
-        /* We adjust our ray-casting grid to ray_radius (the smaller, the more rays are cast),
-         * with lower/upper bounds. */
-        sub_v2_v2v2(faces_dst_2d_size, faces_dst_2d_max, faces_dst_2d_min);
+              face_vcos_2d.resize(face.size());
+              tri_vidx_2d.resize(tris_num);
 
-        if (ray_radius) {
-          tot_rays = int((max_ff(faces_dst_2d_size[0], faces_dst_2d_size[1]) / ray_radius) + 0.5f);
-          CLAMP(tot_rays, MREMAP_RAYCAST_TRI_SAMPLES_MIN, MREMAP_RAYCAST_TRI_SAMPLES_MAX);
-        }
-        else {
-          /* If no radius (pure rays), give max number of rays! */
-          tot_rays = MREMAP_RAYCAST_TRI_SAMPLES_MIN;
-        }
-        tot_rays *= tot_rays;
+              axis_dominant_v3_to_m3(to_pnor_2d_mat, tmp_no);
+              invert_m3_m3(from_pnor_2d_mat, to_pnor_2d_mat);
 
-        face_area_2d_inv = area_poly_v2(face_vcos_2d, uint(face.size()));
-        /* In case we have a null-area degenerated face... */
-        face_area_2d_inv = 1.0f / max_ff(face_area_2d_inv, 1e-9f);
+              mul_m3_v3(to_pnor_2d_mat, pcent_dst);
+              faces_dst_2d_z = pcent_dst[2];
 
-        /* Tessellate our face. */
-        if (face.size() == 3) {
-          tri_vidx_2d[0][0] = 0;
-          tri_vidx_2d[0][1] = 1;
-          tri_vidx_2d[0][2] = 2;
-        }
-        if (face.size() == 4) {
-          tri_vidx_2d[0][0] = 0;
-          tri_vidx_2d[0][1] = 1;
-          tri_vidx_2d[0][2] = 2;
-          tri_vidx_2d[1][0] = 0;
-          tri_vidx_2d[1][1] = 2;
-          tri_vidx_2d[1][2] = 3;
-        }
-        else {
-          BLI_polyfill_calc(face_vcos_2d, uint(face.size()), -1, (uint(*)[3])tri_vidx_2d);
-        }
+              /* Get (2D) bounding square of our face. */
+              INIT_MINMAX2(faces_dst_2d_min, faces_dst_2d_max);
 
-        for (j = 0; j < tris_num; j++) {
-          float *v1 = face_vcos_2d[tri_vidx_2d[j][0]];
-          float *v2 = face_vcos_2d[tri_vidx_2d[j][1]];
-          float *v3 = face_vcos_2d[tri_vidx_2d[j][2]];
-          int rays_num;
+              for (j = 0; j < face.size(); j++) {
+                const int vert = corner_verts_dst[face[j]];
+                copy_v3_v3(tmp_co, vert_positions_dst[vert]);
+                if (space_transform) {
+                  BLI_space_transform_apply(space_transform, tmp_co);
+                }
+                mul_v2_m3v3(face_vcos_2d[j], to_pnor_2d_mat, tmp_co);
+                minmax_v2v2_v2(faces_dst_2d_min, faces_dst_2d_max, face_vcos_2d[j]);
+              }
 
-          /* All this allows us to get 'absolute' number of rays for each tri,
-           * avoiding accumulating errors over iterations, and helping better even distribution. */
-          done_area += area_tri_v2(v1, v2, v3);
-          rays_num = max_ii(int(float(tot_rays) * done_area * face_area_2d_inv + 0.5f) - done_rays,
-                            0);
-          done_rays += rays_num;
+              /* We adjust our ray-casting grid to ray_radius (the smaller, the more rays are
+               * cast), with lower/upper bounds. */
+              sub_v2_v2v2(faces_dst_2d_size, faces_dst_2d_max, faces_dst_2d_min);
 
-          while (rays_num--) {
-            int n = (ray_radius > 0.0f) ? MREMAP_RAYCAST_APPROXIMATE_NR : 1;
-            float w = 1.0f;
+              if (ray_radius) {
+                tot_rays = int((max_ff(faces_dst_2d_size[0], faces_dst_2d_size[1]) / ray_radius) +
+                               0.5f);
+                CLAMP(tot_rays, MREMAP_RAYCAST_TRI_SAMPLES_MIN, MREMAP_RAYCAST_TRI_SAMPLES_MAX);
+              }
+              else {
+                /* If no radius (pure rays), give max number of rays! */
+                tot_rays = MREMAP_RAYCAST_TRI_SAMPLES_MIN;
+              }
+              tot_rays *= tot_rays;
 
-            BLI_rng_get_tri_sample_float_v2(rng, v1, v2, v3, tmp_co);
+              face_area_2d_inv = area_poly_v2(
+                  reinterpret_cast<const float(*)[2]>(face_vcos_2d.data()), uint(face.size()));
+              /* In case we have a null-area degenerated face... */
+              face_area_2d_inv = 1.0f / max_ff(face_area_2d_inv, 1e-9f);
 
-            tmp_co[2] = faces_dst_2d_z;
-            mul_m3_v3(from_pnor_2d_mat, tmp_co);
+              /* Tessellate our face. */
+              if (face.size() == 3) {
+                tri_vidx_2d[0] = uint3(0, 1, 2);
+              }
+              if (face.size() == 4) {
+                tri_vidx_2d[0] = uint3(0, 1, 2);
+                tri_vidx_2d[1] = uint3(0, 2, 3);
+              }
+              else {
+                BLI_polyfill_calc(reinterpret_cast<const float(*)[2]>(face_vcos_2d.data()),
+                                  uint(face.size()),
+                                  -1,
+                                  reinterpret_cast<uint(*)[3]>(tri_vidx_2d.data()));
+              }
 
-            /* At this point, tmp_co is a point on our face surface, in mesh_src space! */
-            while (n--) {
-              if (mesh_remap_bvhtree_query_raycast(
-                      &treedata, &rayhit, tmp_co, tmp_no, ray_radius / w, max_dist, &hit_dist))
-              {
-                const int face_index = tri_faces[rayhit.index];
-                weights[face_index] += w;
-                totweights += w;
-                hit_dist_accum += hit_dist;
-                break;
+              for (j = 0; j < tris_num; j++) {
+                float *v1 = face_vcos_2d[tri_vidx_2d[j][0]];
+                float *v2 = face_vcos_2d[tri_vidx_2d[j][1]];
+                float *v3 = face_vcos_2d[tri_vidx_2d[j][2]];
+                int rays_num;
+
+                /* All this allows us to get 'absolute' number of rays for each tri,
+                 * avoiding accumulating errors over iterations, and helping better even
+                 * distribution. */
+                done_area += area_tri_v2(v1, v2, v3);
+                rays_num = max_ii(
+                    int(float(tot_rays) * done_area * face_area_2d_inv + 0.5f) - done_rays, 0);
+                done_rays += rays_num;
+
+                while (rays_num--) {
+                  int n = (ray_radius > 0.0f) ? MREMAP_RAYCAST_APPROXIMATE_NR : 1;
+                  float w = 1.0f;
+
+                  BLI_rng_get_tri_sample_float_v2(rng, v1, v2, v3, tmp_co);
+
+                  tmp_co[2] = faces_dst_2d_z;
+                  mul_m3_v3(from_pnor_2d_mat, tmp_co);
+
+                  /* At this point, tmp_co is a point on our face surface, in mesh_src space! */
+                  while (n--) {
+                    if (mesh_remap_bvhtree_query_raycast(&treedata,
+                                                         &rayhit,
+                                                         tmp_co,
+                                                         tmp_no,
+                                                         ray_radius / w,
+                                                         max_dist,
+                                                         &hit_dist))
+                    {
+                      const int face_index = tri_faces[rayhit.index];
+                      weights_src.lookup_or_add(face_index, 0.0f) += w;
+                      totweights += w;
+                      hit_dist_accum += hit_dist;
+                      break;
+                    }
+                    /* Next iteration will get bigger radius but smaller weight! */
+                    w /= MREMAP_RAYCAST_APPROXIMATE_FAC;
+                  }
+                }
               }
-              /* Next iteration will get bigger radius but smaller weight! */
-              w /= MREMAP_RAYCAST_APPROXIMATE_FAC;
-            }
-          }
-        }
 
-        if (totweights > 0.0f) {
-          for (j = 0; j < int(numfaces_src); j++) {
-            if (!weights[j]) {
-              continue;
+              if (totweights > 0.0f) {
+                indices.clear();
+                weights.clear();
+                for (const int face_index : weights_src.keys()) {
+                  indices.append(face_index);
+                }
+                /* Keep the sources sorted by index, independently from the hit order. */
+                std::sort(indices.begin(), indices.end());
+                for (const int face_index : indices) {
+                  weights.append(weights_src.lookup(face_index) / totweights);
+                }
+                mesh_remap_item_define(map,
+                                       int(i),
+                                       hit_dist_accum / totweights,
+                                       0,
+                                       int(indices.size()),
+                                       indices.data(),
+                                       weights.data());
+              }
+              else {
+                /* No source for this dest face! */
+                BKE_mesh_remap_item_define_invalid(map, int(i));
+              }
             }
-            /* NOTE: sources_num is always <= j! */
-            weights[sources_num] = weights[j] / totweights;
-            indices[sources_num] = j;
-            sources_num++;
-          }
-          mesh_remap_item_define(
-              r_map, int(i), hit_dist_accum / totweights, 0, sources_num, indices, weights);
-        }
-        else {
-          /* No source for this dest face! */
-          BKE_mesh_remap_item_define_invalid(r_map, int(i));
-        }
-      }
 
-      MEM_freeN(tri_vidx_2d);
-      MEM_freeN(face_vcos_2d);
-      MEM_freeN(indices);
-      MEM_freeN(weights);
-      BLI_rng_free(rng);
+            BLI_rng_free(rng);
+          });
     }
     else {
       CLOG_WARN(&LOG, "Unsupported mesh-to-mesh face mapping mode (%d)!", mode);
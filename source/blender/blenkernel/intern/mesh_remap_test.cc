@@ -0,0 +1,164 @@
+/* SPDX-FileCopyrightText: 2024 Blender Authors
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later */
+#include "testing/testing.h"
+
+#define DO_PERF_TESTS 0
+
+#if DO_PERF_TESTS
+
+#  include "BLI_array.hh"
+#  include "BLI_math_vector.hh"
+#  include "BLI_rand.hh"
+#  include "BLI_timeit.hh"
+
+#  include "BKE_customdata.hh"
+#  include "BKE_idtype.hh"
+#  include "BKE_lib_id.hh"
+#  include "BKE_mesh.hh"
+#  include "BKE_mesh_remap.hh"
+
+#  include "DNA_mesh_types.h"
+
+namespace blender::bke::tests {
+
+/**
+ * Create a grid of quads in the XY plane, with some noise on Z so that BVH queries are not all
+ * resolved by the same nodes.
+ */
+static Mesh *test_mesh_remap_grid_create(const int size, const float offset, const uint32_t seed)
+{
+  const int verts_num = size * size;
+  const int faces_num = (size - 1) * (size - 1);
+  Mesh *mesh = BKE_mesh_new_nomain(verts_num, 0, faces_num, faces_num * 4);
+
+  RandomNumberGenerator rng(seed);
+  MutableSpan<float3> positions = mesh->vert_positions_for_write();
+  for (const int y : IndexRange(size)) {
+    for (const int x : IndexRange(size)) {
+      positions[y * size + x] = float3(
+          float(x) + offset, float(y) + offset, (rng.get_float() - 0.5f) * 0.1f);
+    }
+  }
+
+  MutableSpan<int> face_offsets = mesh->face_offsets_for_write();
+  MutableSpan<int> corner_verts = mesh->corner_verts_for_write();
+  for (const int y : IndexRange(size - 1)) {
+    for (const int x : IndexRange(size - 1)) {
+      const int face = y * (size - 1) + x;
+      face_offsets[face] = face * 4;
+      corner_verts[face * 4 + 0] = y * size + x;
+      corner_verts[face * 4 + 1] = y * size + x + 1;
+      corner_verts[face * 4 + 2] = (y + 1) * size + x + 1;
+      corner_verts[face * 4 + 3] = (y + 1) * size + x;
+    }
+  }
+  face_offsets.last() = faces_num * 4;
+  return mesh;
+}
+
+/** Time both the mapping and the copy phases of a float attribute transfer. */
+static void test_mesh_remap_transfer_float(const int mode,
+                                           const Mesh *mesh_src,
+                                           Mesh *mesh_dst,
+                                           const bool use_faces)
+{
+  MeshPairRemap remap = {0};
+  const float max_dist = 10.0f;
+  const float ray_radius = 0.5f;
+
+  {
+    SCOPED_TIMER("mesh remap: mapping");
+    if (use_faces) {
+      BKE_mesh_remap_calc_faces_from_mesh(
+          mode,
+          nullptr,
+          max_dist,
+          ray_radius,
+          mesh_dst,
+          reinterpret_cast<const float(*)[3]>(mesh_dst->vert_positions().data()),
+          mesh_dst->verts_num,
+          mesh_dst->corner_verts().data(),
+          mesh_dst->faces(),
+          mesh_src,
+          &remap);
+    }
+    else {
+      BKE_mesh_remap_calc_verts_from_mesh(
+          mode,
+          nullptr,
+          max_dist,
+          ray_radius,
+          reinterpret_cast<const float(*)[3]>(mesh_dst->vert_positions().data()),
+          mesh_dst->verts_num,
+          mesh_src,
+          mesh_dst,
+          &remap);
+    }
+  }
+
+  const int src_num = use_faces ? mesh_src->faces_num : mesh_src->verts_num;
+  Array<float> values_src(src_num);
+  for (const int i : values_src.index_range()) {
+    values_src[i] = float(i);
+  }
+  Array<float> values_dst(remap.items_num, 0.0f);
+
+  CustomDataTransferLayerMap laymap = {nullptr};
+  laymap.data_type = CD_PROP_FLOAT;
+  laymap.mix_mode = CDT_MIX_TRANSFER;
+  laymap.mix_factor = 1.0f;
+  laymap.data_src = values_src.data();
+  laymap.data_dst = values_dst.data();
+  laymap.elem_size = sizeof(float);
+  laymap.data_size = sizeof(float);
+
+  {
+    SCOPED_TIMER("mesh remap: copy");
+    CustomData_data_transfer(&remap, &laymap);
+  }
+
+  /* Both meshes overlap, every destination element must have found a source. */
+  for (const int i : IndexRange(remap.items_num)) {
+    EXPECT_GT(remap.items[i].sources_num, 0);
+  }
+
+  BKE_mesh_remap_free(&remap);
+}
+
+class mesh_remap_performance : public testing::Test {
+ protected:
+  static void SetUpTestSuite()
+  {
+    BKE_idtype_init();
+  }
+
+  void run(const int mode, const int size_src, const int size_dst, const bool use_faces)
+  {
+    Mesh *mesh_src = test_mesh_remap_grid_create(size_src, 0.0f, 0);
+    Mesh *mesh_dst = test_mesh_remap_grid_create(size_dst, 0.25f, 1);
+    test_mesh_remap_transfer_float(mode, mesh_src, mesh_dst, use_faces);
+    BKE_id_free(nullptr, mesh_src);
+    BKE_id_free(nullptr, mesh_dst);
+  }
+};
+
+TEST_F(mesh_remap_performance, verts_polyinterp_nearest_1M)
+{
+  run(MREMAP_MODE_VERT_POLYINTERP_NEAREST, 1000, 1000, false);
+}
+TEST_F(mesh_remap_performance, verts_polyinterp_nearest_10M)
+{
+  run(MREMAP_MODE_VERT_POLYINTERP_NEAREST, 3163, 1000, false);
+}
+TEST_F(mesh_remap_performance, faces_nearest_1M)
+{
+  run(MREMAP_MODE_POLY_NEAREST, 1000, 1000, true);
+}
+TEST_F(mesh_remap_performance, faces_polyinterp_pnorproj_1M)
+{
+  run(MREMAP_MODE_POLY_POLYINTERP_PNORPROJ, 1000, 300, true);
+}
+
+}  // namespace blender::bke::tests
+#endif
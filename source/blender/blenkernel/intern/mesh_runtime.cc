@@ -11,6 +11,7 @@
 #include "BLI_array_utils.hh"
 #include "BLI_math_geom.h"
 #include "BLI_task.hh"
+#include "BLI_wide_bvh.hh"
 
 #include "BKE_bake_data_block_id.hh"
 #include "BKE_bvhutils.hh"
@@ -327,6 +328,7 @@ void BKE_mesh_runtime_clear_geometry(Mesh *mesh)
   mesh->runtime->verts_no_face_cache.tag_dirty();
   mesh->runtime->corner_tris_cache.data.tag_dirty();
   mesh->runtime->corner_tri_faces_cache.tag_dirty();
+  mesh->runtime->corner_tris_wide_bvh_cache.tag_dirty();
   mesh->runtime->shrinkwrap_boundary_cache.tag_dirty();
   mesh->runtime->subsurf_face_dot_tags.clear_and_shrink();
   mesh->runtime->subsurf_optimal_display_edges.clear_and_shrink();
@@ -393,6 +395,7 @@ void Mesh::tag_positions_changed()
 void Mesh::tag_positions_changed_no_normals()
 {
   free_bvh_cache(*this->runtime);
+  this->runtime->corner_tris_wide_bvh_cache.tag_dirty();
   this->runtime->corner_tris_cache.tag_dirty();
   this->runtime->bounds_cache.tag_dirty();
   this->runtime->shrinkwrap_boundary_cache.tag_dirty();
@@ -402,6 +405,7 @@ void Mesh::tag_positions_changed_uniformly()
 {
   /* The normals and triangulation didn't change, since all verts moved by the same amount. */
   free_bvh_cache(*this->runtime);
+  this->runtime->corner_tris_wide_bvh_cache.tag_dirty();
   this->runtime->bounds_cache.tag_dirty();
 }
 
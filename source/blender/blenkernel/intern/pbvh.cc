@@ -65,14 +65,64 @@ static Bounds<float3> merge_bounds(const Bounds<float3> &a, const Bounds<float3>
   return bounds::merge(a, b);
 }
 
+/** Below this size, partitioning on a single thread is faster than the parallel version. */
+static constexpr int parallel_partition_threshold = 65536;
+
+/**
+ * Stable partition of large arrays, done by counting the elements that satisfy the predicate in
+ * chunks, and then scattering every chunk to its final position in parallel.
+ */
+template<typename Predicate>
+static int partition_parallel(MutableSpan<int> faces, const Predicate &predicate)
+{
+  constexpr int chunk_size = 16384;
+  const int chunks_num = divide_ceil_u(faces.size(), chunk_size);
+  const auto chunk_range = [&](const int chunk) {
+    const int start = chunk * chunk_size;
+    return IndexRange(start, std::min<int>(chunk_size, faces.size() - start));
+  };
+
+  Array<int> true_offset_data(chunks_num + 1);
+  threading::parallel_for(IndexRange(chunks_num), 1, [&](const IndexRange range) {
+    for (const int chunk : range) {
+      const Span<int> chunk_faces = faces.slice(chunk_range(chunk));
+      true_offset_data[chunk] = std::count_if(chunk_faces.begin(), chunk_faces.end(), predicate);
+    }
+  });
+  const OffsetIndices<int> true_offsets = offset_indices::accumulate_counts_to_offsets(
+      true_offset_data);
+  const int split = true_offsets.total_size();
+
+  Array<int> result(faces.size());
+  threading::parallel_for(IndexRange(chunks_num), 1, [&](const IndexRange range) {
+    for (const int chunk : range) {
+      const IndexRange chunk_faces = chunk_range(chunk);
+      int true_index = true_offsets[chunk].start();
+      int false_index = split + chunk_faces.start() - true_index;
+      for (const int face : faces.slice(chunk_faces)) {
+        if (predicate(face)) {
+          result[true_index++] = face;
+        }
+        else {
+          result[false_index++] = face;
+        }
+      }
+    }
+  });
+  array_utils::copy(result.as_span(), faces);
+  return split;
+}
+
 static int partition_along_axis(const Span<float3> face_centers,
                                 MutableSpan<int> faces,
                                 const int axis,
                                 const float middle)
 {
-  const int *split = std::partition(faces.begin(), faces.end(), [&](const int face) {
-    return face_centers[face][axis] >= middle;
-  });
+  const auto predicate = [&](const int face) { return face_centers[face][axis] >= middle; };
+  if (faces.size() >= parallel_partition_threshold) {
+    return partition_parallel(faces, predicate);
+  }
+  const int *split = std::partition(faces.begin(), faces.end(), predicate);
   return split - faces.begin();
 }
 
@@ -84,6 +134,18 @@ static int partition_material_indices(const Span<int> material_indices, MutableS
   return split - faces.begin();
 }
 
+static void atomic_min_int32(int32_t *value, const int32_t new_value)
+{
+  int32_t old_value = *value;
+  while (new_value < old_value) {
+    const int32_t prev_value = atomic_cas_int32(value, old_value, new_value);
+    if (prev_value == old_value) {
+      break;
+    }
+    old_value = prev_value;
+  }
+}
+
 BLI_NOINLINE static void build_mesh_leaf_nodes(const int verts_num,
                                                const OffsetIndices<int> faces,
                                                const Span<int> corner_verts,
@@ -113,28 +175,43 @@ BLI_NOINLINE static void build_mesh_leaf_nodes(const int verts_num,
     }
   });
 
-  Vector<int> owned_verts;
-  Vector<int> shared_verts;
-  BitVector<> vert_used(verts_num);
-  for (const int i : nodes.index_range()) {
-    MeshNode &node = nodes[i];
-
-    owned_verts.clear();
-    shared_verts.clear();
-    for (const int vert : verts_per_node[i]) {
-      if (vert_used[vert]) {
-        shared_verts.append(vert);
+  /* Every vertex is owned by the first node that uses it. Finding that node with an atomic
+   * minimum gives the same result as processing the nodes in order, but allows building the
+   * vertex maps of all nodes in parallel. */
+  Array<int> vert_owner(verts_num, NoInitialization());
+  threading::parallel_for(vert_owner.index_range(), 4096, [&](const IndexRange range) {
+    vert_owner.as_mutable_span().slice(range).fill(std::numeric_limits<int>::max());
+  });
+  threading::parallel_for(nodes.index_range(), 8, [&](const IndexRange range) {
+    for (const int i : range) {
+      for (const int vert : verts_per_node[i]) {
+        atomic_min_int32(&vert_owner[vert], i);
       }
-      else {
-        vert_used[vert].set();
-        owned_verts.append(vert);
+    }
+  });
+
+  threading::parallel_for(nodes.index_range(), 8, [&](const IndexRange range) {
+    Vector<int> owned_verts;
+    Vector<int> shared_verts;
+    for (const int i : range) {
+      MeshNode &node = nodes[i];
+
+      owned_verts.clear();
+      shared_verts.clear();
+      for (const int vert : verts_per_node[i]) {
+        if (vert_owner[vert] == i) {
+          owned_verts.append(vert);
+        }
+        else {
+          shared_verts.append(vert);
+        }
       }
+      node.unique_verts_num_ = owned_verts.size();
+      node.vert_indices_.reserve(owned_verts.size() + shared_verts.size());
+      node.vert_indices_.add_multiple(owned_verts);
+      node.vert_indices_.add_multiple(shared_verts);
     }
-    node.unique_verts_num_ = owned_verts.size();
-    node.vert_indices_.reserve(owned_verts.size() + shared_verts.size());
-    node.vert_indices_.add_multiple(owned_verts);
-    node.vert_indices_.add_multiple(shared_verts);
-  }
+  });
 }
 
 static bool leaf_needs_material_split(const Span<int> faces, const Span<int> material_indices)
@@ -148,30 +225,40 @@ static bool leaf_needs_material_split(const Span<int> faces, const Span<int> mat
   return false;
 }
 
-static void build_nodes_recursive_mesh(const Span<int> material_indices,
-                                       const int leaf_limit,
-                                       const int node_index,
-                                       const std::optional<Bounds<float3>> &bounds_precalc,
-                                       const Span<float3> face_centers,
-                                       const int depth,
-                                       MutableSpan<int> faces,
-                                       Vector<MeshNode> &nodes)
+/**
+ * Temporary node used while building the tree top-down. Subtrees are built in parallel, so their
+ * nodes are only given a final position in the node array afterwards, which keeps the node order
+ * independent from the order in which the tasks finish.
+ */
+struct BuildNode {
+  /** The number of faces in the node, stored contiguously in the partitioned face array. */
+  int faces_num = 0;
+  /** Both children are null for leaf nodes. */
+  std::unique_ptr<BuildNode> children[2];
+};
+
+/** Subtrees with fewer faces than this are built on the current thread. */
+static constexpr int parallel_build_threshold = 1024;
+
+static std::unique_ptr<BuildNode> build_nodes_recursive(
+    const Span<int> material_indices,
+    const int leaf_limit,
+    const std::optional<Bounds<float3>> &bounds_precalc,
+    const Span<float3> face_centers,
+    const int depth,
+    MutableSpan<int> faces)
 {
+  std::unique_ptr<BuildNode> node = std::make_unique<BuildNode>();
+  node->faces_num = faces.size();
+
   /* Decide whether this is a leaf or not */
   const bool below_leaf_limit = faces.size() <= leaf_limit || depth >= STACK_FIXED_DEPTH - 1;
   if (below_leaf_limit) {
     if (!leaf_needs_material_split(faces, material_indices)) {
-      MeshNode &node = nodes[node_index];
-      node.flag_ |= PBVH_Leaf;
-      node.face_indices_ = faces;
-      return;
+      return node;
     }
   }
 
-  /* Add two child nodes */
-  nodes[node_index].children_offset_ = nodes.size();
-  nodes.resize(nodes.size() + 2);
-
   int split;
   if (!below_leaf_limit) {
     Bounds<float3> bounds;
@@ -203,22 +290,61 @@ static void build_nodes_recursive_mesh(const Span<int> material_indices,
   }
 
   /* Build children */
-  build_nodes_recursive_mesh(material_indices,
-                             leaf_limit,
-                             nodes[node_index].children_offset_,
-                             std::nullopt,
-                             face_centers,
-                             depth + 1,
-                             faces.take_front(split),
-                             nodes);
-  build_nodes_recursive_mesh(material_indices,
-                             leaf_limit,
-                             nodes[node_index].children_offset_ + 1,
-                             std::nullopt,
-                             face_centers,
-                             depth + 1,
-                             faces.drop_front(split),
-                             nodes);
+  threading::parallel_invoke(
+      faces.size() >= parallel_build_threshold,
+      [&]() {
+        node->children[0] = build_nodes_recursive(material_indices,
+                                                  leaf_limit,
+                                                  std::nullopt,
+                                                  face_centers,
+                                                  depth + 1,
+                                                  faces.take_front(split));
+      },
+      [&]() {
+        node->children[1] = build_nodes_recursive(material_indices,
+                                                  leaf_limit,
+                                                  std::nullopt,
+                                                  face_centers,
+                                                  depth + 1,
+                                                  faces.drop_front(split));
+      });
+  return node;
+}
+
+static void set_leaf_faces(MeshNode &node, const Span<int> faces)
+{
+  node.face_indices_ = faces;
+}
+
+static void set_leaf_faces(GridsNode &node, const Span<int> faces)
+{
+  node.prim_indices_ = faces;
+}
+
+/**
+ * Create the final nodes in depth-first order, with the two children of every node stored next to
+ * each other at the end of the array.
+ */
+template<typename NodeT>
+static void build_nodes_flatten(const BuildNode &build_node,
+                                const int node_index,
+                                const Span<int> faces,
+                                Vector<NodeT> &nodes)
+{
+  if (!build_node.children[0]) {
+    NodeT &node = nodes[node_index];
+    node.flag_ |= PBVH_Leaf;
+    set_leaf_faces(node, faces);
+    return;
+  }
+
+  const int children_offset = nodes.size();
+  nodes[node_index].children_offset_ = children_offset;
+  nodes.resize(nodes.size() + 2);
+
+  const int split = build_node.children[0]->faces_num;
+  build_nodes_flatten(*build_node.children[0], children_offset, faces.take_front(split), nodes);
+  build_nodes_flatten(*build_node.children[1], children_offset + 1, faces.drop_front(split), nodes);
 }
 
 inline Bounds<float3> calc_face_bounds(const Span<float3> vert_positions,
@@ -275,10 +401,11 @@ Tree Tree::from_mesh(const Mesh &mesh)
   nodes.resize(1);
   {
 #ifdef DEBUG_BUILD_TIME
-    SCOPED_TIMER_AVERAGED("build_nodes_recursive_mesh");
+    SCOPED_TIMER_AVERAGED("build_nodes_recursive");
 #endif
-    build_nodes_recursive_mesh(
-        material_index, leaf_limit, 0, bounds, face_centers, 0, pbvh.prim_indices_, nodes);
+    const std::unique_ptr<BuildNode> root = build_nodes_recursive(
+        material_index, leaf_limit, bounds, face_centers, 0, pbvh.prim_indices_);
+    build_nodes_flatten(*root, 0, pbvh.prim_indices_, nodes);
   }
 
   build_mesh_leaf_nodes(mesh.verts_num, faces, corner_verts, nodes);
@@ -301,79 +428,6 @@ Tree Tree::from_mesh(const Mesh &mesh)
   return pbvh;
 }
 
-static void build_nodes_recursive_grids(const Span<int> material_indices,
-                                        const int leaf_limit,
-                                        const int node_index,
-                                        const std::optional<Bounds<float3>> &bounds_precalc,
-                                        const Span<float3> face_centers,
-                                        const int depth,
-                                        MutableSpan<int> faces,
-                                        Vector<GridsNode> &nodes)
-{
-  /* Decide whether this is a leaf or not */
-  const bool below_leaf_limit = faces.size() <= leaf_limit || depth >= STACK_FIXED_DEPTH - 1;
-  if (below_leaf_limit) {
-    if (!leaf_needs_material_split(faces, material_indices)) {
-      GridsNode &node = nodes[node_index];
-      node.flag_ |= PBVH_Leaf;
-      node.prim_indices_ = faces;
-      return;
-    }
-  }
-
-  /* Add two child nodes */
-  nodes[node_index].children_offset_ = nodes.size();
-  nodes.resize(nodes.size() + 2);
-
-  int split;
-  if (!below_leaf_limit) {
-    Bounds<float3> bounds;
-    if (bounds_precalc) {
-      bounds = *bounds_precalc;
-    }
-    else {
-      bounds = threading::parallel_reduce(
-          faces.index_range(),
-          1024,
-          negative_bounds(),
-          [&](const IndexRange range, Bounds<float3> value) {
-            for (const int face : faces.slice(range)) {
-              math::min_max(face_centers[face], value.min, value.max);
-            }
-            return value;
-          },
-          merge_bounds);
-    }
-    const int axis = math::dominant_axis(bounds.max - bounds.min);
-
-    /* Partition primitives along that axis */
-    split = partition_along_axis(
-        face_centers, faces, axis, math::midpoint(bounds.min[axis], bounds.max[axis]));
-  }
-  else {
-    /* Partition primitives by material */
-    split = partition_material_indices(material_indices, faces);
-  }
-
-  /* Build children */
-  build_nodes_recursive_grids(material_indices,
-                              leaf_limit,
-                              nodes[node_index].children_offset_,
-                              std::nullopt,
-                              face_centers,
-                              depth + 1,
-                              faces.take_front(split),
-                              nodes);
-  build_nodes_recursive_grids(material_indices,
-                              leaf_limit,
-                              nodes[node_index].children_offset_ + 1,
-                              std::nullopt,
-                              face_centers,
-                              depth + 1,
-                              faces.drop_front(split),
-                              nodes);
-}
-
 static Bounds<float3> calc_face_grid_bounds(const OffsetIndices<int> faces,
                                             const Span<float3> positions,
                                             const CCGKey &key,
@@ -431,22 +485,27 @@ Tree Tree::from_grids(const Mesh &base_mesh, const SubdivCCG &subdiv_ccg)
   nodes.resize(1);
   {
 #ifdef DEBUG_BUILD_TIME
-    SCOPED_TIMER_AVERAGED("build_nodes_recursive_grids");
+    SCOPED_TIMER_AVERAGED("build_nodes_recursive");
 #endif
-    build_nodes_recursive_grids(
-        material_index, leaf_limit, 0, bounds, face_centers, 0, face_indices, nodes);
+    const std::unique_ptr<BuildNode> root = build_nodes_recursive(
+        material_index, leaf_limit, bounds, face_centers, 0, face_indices);
+    build_nodes_flatten(*root, 0, face_indices, nodes);
   }
 
   /* Convert face indices into grid indices. */
   pbvh.prim_indices_.reinitialize(faces.total_size());
   {
-    int offset = 0;
-    for (const int face : face_indices) {
-      for (const int corner : faces[face]) {
-        pbvh.prim_indices_[offset] = corner;
-        offset++;
+    Array<int> grid_offset_data(faces.size() + 1);
+    offset_indices::gather_group_sizes(faces, face_indices, grid_offset_data);
+    const OffsetIndices<int> grid_offsets = offset_indices::accumulate_counts_to_offsets(
+        grid_offset_data);
+    MutableSpan<int> prim_indices = pbvh.prim_indices_;
+    threading::parallel_for(face_indices.index_range(), 1024, [&](const IndexRange range) {
+      for (const int i : range) {
+        array_utils::fill_index_range<int>(prim_indices.slice(grid_offsets[i]),
+                                           faces[face_indices[i]].start());
       }
-    }
+    });
   }
 
   /* Change the nodes to reference the BVH prim_indices array instead of the local face indices. */
@@ -101,84 +101,80 @@ static void subdiv_ccg_alloc_elements(SubdivCCG &subdiv_ccg,
 /** \name Grids evaluation
  * \{ */
 
-static void subdiv_ccg_eval_grid_element_limit(Subdiv &subdiv,
-                                               SubdivCCG &subdiv_ccg,
-                                               const int ptex_face_index,
-                                               const float u,
-                                               const float v,
-                                               const int element)
+static void subdiv_ccg_eval_grid_limit(Subdiv &subdiv,
+                                       SubdivCCG &subdiv_ccg,
+                                       const Span<PtexCoord> coords,
+                                       const IndexRange range)
 {
+  MutableSpan<float3> positions = subdiv_ccg.positions.as_mutable_span().slice(range);
   if (subdiv.displacement_evaluator != nullptr) {
-    eval_final_point(&subdiv, ptex_face_index, u, v, subdiv_ccg.positions[element]);
+    eval_final_points(&subdiv, coords, positions);
   }
   else if (!subdiv_ccg.normals.is_empty()) {
-    eval_limit_point_and_normal(&subdiv,
-                                ptex_face_index,
-                                u,
-                                v,
-                                subdiv_ccg.positions[element],
-                                subdiv_ccg.normals[element]);
+    eval_limit_points_and_normals(
+        &subdiv, coords, positions, subdiv_ccg.normals.as_mutable_span().slice(range));
   }
   else {
-    eval_limit_point(&subdiv, ptex_face_index, u, v, subdiv_ccg.positions[element]);
+    eval_limit_points(&subdiv, coords, positions, {}, {});
   }
 }
 
-static void subdiv_ccg_eval_grid_element_mask(SubdivCCG &subdiv_ccg,
-                                              SubdivCCGMaskEvaluator *mask_evaluator,
-                                              const int ptex_face_index,
-                                              const float u,
-                                              const float v,
-                                              const int element)
+static void subdiv_ccg_eval_grid_mask(SubdivCCG &subdiv_ccg,
+                                      SubdivCCGMaskEvaluator *mask_evaluator,
+                                      const Span<PtexCoord> coords,
+                                      const IndexRange range)
 {
   if (subdiv_ccg.masks.is_empty()) {
     return;
   }
+  MutableSpan<float> masks = subdiv_ccg.masks.as_mutable_span().slice(range);
   if (mask_evaluator != nullptr) {
-    subdiv_ccg.masks[element] = mask_evaluator->eval_mask(mask_evaluator, ptex_face_index, u, v);
+    for (const int i : coords.index_range()) {
+      const PtexCoord &coord = coords[i];
+      masks[i] = mask_evaluator->eval_mask(
+          mask_evaluator, coord.ptex_face_index, coord.u, coord.v);
+    }
   }
   else {
-    subdiv_ccg.masks[element] = 0.0f;
+    masks.fill(0.0f);
   }
 }
 
-static void subdiv_ccg_eval_grid_element(Subdiv &subdiv,
-                                         SubdivCCG &subdiv_ccg,
-                                         SubdivCCGMaskEvaluator *mask_evaluator,
-                                         const int ptex_face_index,
-                                         const float u,
-                                         const float v,
-                                         const int element)
+static void subdiv_ccg_eval_grid(Subdiv &subdiv,
+                                 SubdivCCG &subdiv_ccg,
+                                 SubdivCCGMaskEvaluator *mask_evaluator,
+                                 const Span<PtexCoord> coords,
+                                 const int grid_index)
 {
-  subdiv_ccg_eval_grid_element_limit(subdiv, subdiv_ccg, ptex_face_index, u, v, element);
-  subdiv_ccg_eval_grid_element_mask(subdiv_ccg, mask_evaluator, ptex_face_index, u, v, element);
+  const IndexRange range = grid_range(subdiv_ccg.grid_area, grid_index);
+  subdiv_ccg_eval_grid_limit(subdiv, subdiv_ccg, coords, range);
+  subdiv_ccg_eval_grid_mask(subdiv_ccg, mask_evaluator, coords, range);
 }
 
 static void subdiv_ccg_eval_regular_grid(Subdiv &subdiv,
                                          SubdivCCG &subdiv_ccg,
                                          const Span<int> face_ptex_offset,
                                          SubdivCCGMaskEvaluator *mask_evaluator,
-                                         const int face_index)
+                                         const int face_index,
+                                         Vector<PtexCoord> &coords)
 {
   const int ptex_face_index = face_ptex_offset[face_index];
   const int grid_size = subdiv_ccg.grid_size;
-  const int grid_area = subdiv_ccg.grid_area;
   const float grid_size_1_inv = 1.0f / (grid_size - 1);
   const IndexRange face = subdiv_ccg.faces[face_index];
+  coords.resize(subdiv_ccg.grid_area);
   for (int corner = 0; corner < face.size(); corner++) {
     const int grid_index = face.start() + corner;
-    const IndexRange range = grid_range(grid_area, grid_index);
     for (int y = 0; y < grid_size; y++) {
       const float grid_v = y * grid_size_1_inv;
       for (int x = 0; x < grid_size; x++) {
         const float grid_u = x * grid_size_1_inv;
-        float u, v;
-        rotate_grid_to_quad(corner, grid_u, grid_v, &u, &v);
-        const int element = range[CCG_grid_xy_to_index(grid_size, x, y)];
-        subdiv_ccg_eval_grid_element(
-            subdiv, subdiv_ccg, mask_evaluator, ptex_face_index, u, v, element);
+        PtexCoord &coord = coords[CCG_grid_xy_to_index(grid_size, x, y)];
+        coord.ptex_face_index = ptex_face_index;
+        rotate_grid_to_quad(corner, grid_u, grid_v, &coord.u, &coord.v);
       }
     }
+    subdiv_ccg_eval_grid(subdiv, subdiv_ccg, mask_evaluator, coords, grid_index);
   }
 }
 
@@ -186,25 +182,24 @@ static void subdiv_ccg_eval_special_grid(Subdiv &subdiv,
                                          SubdivCCG &subdiv_ccg,
                                          const Span<int> face_ptex_offset,
                                          SubdivCCGMaskEvaluator *mask_evaluator,
-                                         const int face_index)
+                                         const int face_index,
+                                         Vector<PtexCoord> &coords)
 {
   const int grid_size = subdiv_ccg.grid_size;
-  const int grid_area = subdiv_ccg.grid_area;
   const float grid_size_1_inv = 1.0f / (grid_size - 1);
   const IndexRange face = subdiv_ccg.faces[face_index];
+  coords.resize(subdiv_ccg.grid_area);
   for (int corner = 0; corner < face.size(); corner++) {
     const int grid_index = face.start() + corner;
     const int ptex_face_index = face_ptex_offset[face_index] + corner;
-    const IndexRange range = grid_range(grid_area, grid_index);
     for (int y = 0; y < grid_size; y++) {
       const float u = 1.0f - (y * grid_size_1_inv);
       for (int x = 0; x < grid_size; x++) {
         const float v = 1.0f - (x * grid_size_1_inv);
-        const int element = range[CCG_grid_xy_to_index(grid_size, x, y)];
-        subdiv_ccg_eval_grid_element(
-            subdiv, subdiv_ccg, mask_evaluator, ptex_face_index, u, v, element);
+        coords[CCG_grid_xy_to_index(grid_size, x, y)] = {ptex_face_index, u, v};
       }
     }
+    subdiv_ccg_eval_grid(subdiv, subdiv_ccg, mask_evaluator, coords, grid_index);
   }
 }
 
@@ -217,14 +212,15 @@ static bool subdiv_ccg_evaluate_grids(SubdivCCG &subdiv_ccg,
   const int num_faces = topology_refiner->base_level().GetNumFaces();
   const Span<int> face_ptex_offset(face_ptex_offset_get(&subdiv), subdiv_ccg.faces.size());
   threading::parallel_for(IndexRange(num_faces), 1024, [&](const IndexRange range) {
+    Vector<PtexCoord> coords;
     for (const int face_index : range) {
       if (subdiv_ccg.faces[face_index].size() == 4) {
         subdiv_ccg_eval_regular_grid(
-            subdiv, subdiv_ccg, face_ptex_offset, mask_evaluator, face_index);
+            subdiv, subdiv_ccg, face_ptex_offset, mask_evaluator, face_index, coords);
       }
       else {
         subdiv_ccg_eval_special_grid(
-            subdiv, subdiv_ccg, face_ptex_offset, mask_evaluator, face_index);
+            subdiv, subdiv_ccg, face_ptex_offset, mask_evaluator, face_index, coords);
       }
     }
   });
@@ -8,8 +8,12 @@
 
 #include "BKE_subdiv_eval.hh"
 
+#include "BLI_array.hh"
 #include "BLI_math_vector.h"
+#include "BLI_math_vector.hh"
+#include "BLI_sort.hh"
 #include "BLI_task.h"
+#include "BLI_task.hh"
 #include "BLI_utildefines.h"
 
 #include "BKE_customdata.hh"
@@ -381,4 +385,127 @@ void eval_final_point(
   }
 }
 
+/* --------------------------------------------------------------------
+ * Batched queries.
+ */
+
+/* Number of points passed to the evaluator at once. Small enough for the temporary buffers to stay
+ * in the CPU caches. */
+static constexpr int64_t batch_size = 256;
+
+/* Evaluate the limit surface in blocks of points sorted by ptex face. The output callback receives
+ * the index of every point with its position and (optional) derivatives. */
+template<typename Fn>
+static void eval_limit_batched(Subdiv *subdiv,
+                               const Span<PtexCoord> coords,
+                               const bool use_derivatives,
+                               const Fn &fn)
+{
+  if (coords.is_empty()) {
+    return;
+  }
+  const auto ptex_face_less = [&](const int a, const int b) {
+    return coords[a].ptex_face_index < coords[b].ptex_face_index;
+  };
+  Array<int> sorted_indices(coords.size());
+  threading::parallel_for(coords.index_range(), 4096, [&](const IndexRange range) {
+    for (const int i : range) {
+      sorted_indices[i] = i;
+    }
+  });
+  if (!std::is_sorted(sorted_indices.begin(), sorted_indices.end(), ptex_face_less)) {
+    parallel_sort(sorted_indices.begin(), sorted_indices.end(), ptex_face_less);
+  }
+
+  OpenSubdiv_Evaluator *evaluator = subdiv->evaluator;
+  /* Only the CPU evaluator can be used from multiple threads. */
+  const int64_t grain_size = evaluator->type == OPENSUBDIV_EVALUATOR_CPU ? 8 : coords.size();
+  const int64_t batches_num = divide_ceil_ul(coords.size(), batch_size);
+  threading::parallel_for(IndexRange(batches_num), grain_size, [&](const IndexRange range) {
+    OpenSubdiv_PatchCoord patch_coords[batch_size];
+    float3 P[batch_size];
+    float3 dPdu[batch_size];
+    float3 dPdv[batch_size];
+    for (const int64_t batch : range) {
+      const Span<int> indices = sorted_indices.as_span().slice_safe(batch * batch_size,
+                                                                     batch_size);
+      for (const int64_t i : indices.index_range()) {
+        const PtexCoord &coord = coords[indices[i]];
+        patch_coords[i] = {coord.ptex_face_index, coord.u, coord.v};
+      }
+      evaluator->evaluatePatchesLimit(evaluator,
+                                      patch_coords,
+                                      indices.size(),
+                                      &P[0].x,
+                                      use_derivatives ? &dPdu[0].x : nullptr,
+                                      use_derivatives ? &dPdv[0].x : nullptr);
+      for (const int64_t i : indices.index_range()) {
+        if (use_derivatives) {
+          if (math::is_zero(dPdu[i]) || math::is_zero(dPdv[i]) || dPdu[i] == dPdv[i]) {
+            /* Rare degenerate derivatives are handled by the single point query. */
+            const PtexCoord &coord = coords[indices[i]];
+            eval_limit_point_and_derivatives(
+                subdiv, coord.ptex_face_index, coord.u, coord.v, P[i], dPdu[i], dPdv[i]);
+          }
+        }
+        fn(indices[i], P[i], dPdu[i], dPdv[i]);
+      }
+    }
+  });
+}
+
+void eval_limit_points(Subdiv *subdiv,
+                       const Span<PtexCoord> coords,
+                       MutableSpan<float3> r_P,
+                       MutableSpan<float3> r_dPdu,
+                       MutableSpan<float3> r_dPdv)
+{
+  BLI_assert(r_dPdu.is_empty() == r_dPdv.is_empty());
+  const bool use_derivatives = !r_dPdu.is_empty();
+  eval_limit_batched(
+      subdiv,
+      coords,
+      use_derivatives,
+      [&](const int i, const float3 &P, const float3 &dPdu, const float3 &dPdv) {
+        r_P[i] = P;
+        if (use_derivatives) {
+          r_dPdu[i] = dPdu;
+          r_dPdv[i] = dPdv;
+        }
+      });
+}
+
+void eval_limit_points_and_normals(Subdiv *subdiv,
+                                   const Span<PtexCoord> coords,
+                                   MutableSpan<float3> r_P,
+                                   MutableSpan<float3> r_N)
+{
+  eval_limit_batched(
+      subdiv,
+      coords,
+      true,
+      [&](const int i, const float3 &P, const float3 &dPdu, const float3 &dPdv) {
+        r_P[i] = P;
+        r_N[i] = math::normalize(math::cross(dPdu, dPdv));
+      });
+}
+
+void eval_final_points(Subdiv *subdiv, const Span<PtexCoord> coords, MutableSpan<float3> r_P)
+{
+  if (subdiv->displacement_evaluator == nullptr) {
+    eval_limit_points(subdiv, coords, r_P, {}, {});
+    return;
+  }
+  eval_limit_batched(
+      subdiv,
+      coords,
+      true,
+      [&](const int i, const float3 &P, const float3 &dPdu, const float3 &dPdv) {
+        const PtexCoord &coord = coords[i];
+        float3 D;
+        eval_displacement(subdiv, coord.ptex_face_index, coord.u, coord.v, dPdu, dPdv, D);
+        r_P[i] = P + D;
+      });
+}
+
 }  // namespace blender::bke::subdiv
@@ -444,7 +444,12 @@ static void loop_interpolation_end(LoopsForInterpolation *loop_interpolation)
 /** \name TLS
  * \{ */
 
+/* Number of inner vertices collected before their positions are evaluated together. */
+static constexpr int inner_vertex_batch_size = 256;
+
 struct SubdivMeshTLS {
+  const SubdivMeshContext *ctx;
+
   bool vertex_interpolation_initialized;
   VerticesForInterpolation vertex_interpolation;
   int vertex_interpolation_coarse_face_index;
@@ -454,11 +459,33 @@ struct SubdivMeshTLS {
   LoopsForInterpolation loop_interpolation;
   int loop_interpolation_coarse_face_index;
   int loop_interpolation_coarse_corner;
+
+  /* Inner vertices waiting for the evaluation of their position. */
+  int inner_vertices_num;
+  PtexCoord inner_vertex_coords[inner_vertex_batch_size];
+  int inner_vertex_indices[inner_vertex_batch_size];
 };
 
+static void subdiv_mesh_flush_inner_vertices(SubdivMeshTLS *tls)
+{
+  if (tls->inner_vertices_num == 0) {
+    return;
+  }
+  const SubdivMeshContext *ctx = tls->ctx;
+  const Span<PtexCoord> coords(tls->inner_vertex_coords, tls->inner_vertices_num);
+  const Span<int> vertex_indices(tls->inner_vertex_indices, tls->inner_vertices_num);
+  float3 positions[inner_vertex_batch_size];
+  eval_final_points(ctx->subdiv, coords, MutableSpan<float3>(positions, coords.size()));
+  for (const int i : vertex_indices.index_range()) {
+    ctx->subdiv_positions[vertex_indices[i]] = positions[i];
+  }
+  tls->inner_vertices_num = 0;
+}
+
 static void subdiv_mesh_tls_free(void *tls_v)
 {
   SubdivMeshTLS *tls = static_cast<SubdivMeshTLS *>(tls_v);
+  subdiv_mesh_flush_inner_vertices(tls);
   if (tls->vertex_interpolation_initialized) {
     vertex_interpolation_end(&tls->vertex_interpolation);
   }
@@ -826,13 +853,17 @@ static void subdiv_mesh_vertex_inner(const ForeachContext *foreach_context,
 {
   SubdivMeshContext *ctx = static_cast<SubdivMeshContext *>(foreach_context->user_data);
   SubdivMeshTLS *tls = static_cast<SubdivMeshTLS *>(tls_v);
-  Subdiv *subdiv = ctx->subdiv;
   const IndexRange coarse_face = ctx->coarse_faces[coarse_face_index];
   Mesh *subdiv_mesh = ctx->subdiv_mesh;
-  float3 &subdiv_position = ctx->subdiv_positions[subdiv_vertex_index];
   subdiv_mesh_ensure_vertex_interpolation(ctx, tls, coarse_face_index, coarse_corner);
   subdiv_vertex_data_interpolate(ctx, subdiv_vertex_index, &tls->vertex_interpolation, u, v);
-  eval_final_point(subdiv, ptex_face_index, u, v, subdiv_position);
+  /* The position is evaluated later, together with other inner vertices. */
+  if (tls->inner_vertices_num == inner_vertex_batch_size) {
+    subdiv_mesh_flush_inner_vertices(tls);
+  }
+  tls->inner_vertex_coords[tls->inner_vertices_num] = {ptex_face_index, u, v};
+  tls->inner_vertex_indices[tls->inner_vertices_num] = subdiv_vertex_index;
+  tls->inner_vertices_num++;
   subdiv_mesh_tag_center_vertex(coarse_face, subdiv_vertex_index, u, v, subdiv_mesh);
   subdiv_vertex_orco_evaluate(ctx, ptex_face_index, u, v, subdiv_vertex_index);
 }
@@ -1197,6 +1228,7 @@ Mesh *subdiv_to_mesh(Subdiv *subdiv, const ToMeshSettings *settings, const Mesh
   ForeachContext foreach_context;
   setup_foreach_callbacks(&subdiv_context, &foreach_context);
   SubdivMeshTLS tls{};
+  tls.ctx = &subdiv_context;
   foreach_context.user_data = &subdiv_context;
   foreach_context.user_data_tls_size = sizeof(SubdivMeshTLS);
   foreach_context.user_data_tls = &tls;
@@ -997,7 +997,7 @@ void BKE_undosys_print(UndoStack *ustack)
          BLI_listbase_count(&ustack->steps));
   int index = 0;
   LISTBASE_FOREACH (UndoStep *, us, &ustack->steps) {
-    printf("[%c%c%c%c] %3d {%p} type='%s', name='%s'\n",
+    printf("[%c%c%c%c] %3d {%p} type='%s', name='%s', size=%zu",
            (us == ustack->step_active) ? '*' : ' ',
            us->is_applied ? '#' : ' ',
            (us == ustack->step_active_memfile) ? 'M' : ' ',
@@ -1005,7 +1005,12 @@ void BKE_undosys_print(UndoStack *ustack)
            index,
            (void *)us,
            us->type->name,
-           us->name);
+           us->name,
+           us->data_size);
+    if (us->data_size_uncompressed != 0) {
+      printf(", uncompressed_size=%zu", us->data_size_uncompressed);
+    }
+    printf("\n");
     index++;
   }
 }
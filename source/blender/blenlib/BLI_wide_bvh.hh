@@ -0,0 +1,139 @@
+/* SPDX-FileCopyrightText: 2024 Blender Authors
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later */
+
+#pragma once
+
+/** \file
+ * \ingroup bli
+ *
+ * Bounding volume hierarchies with four children per node, for ray casts and nearest point
+ * queries on many triangles or points. The bounds of the children of a node are stored by axis,
+ * so that a ray or a point is tested against all of them at once with SIMD instructions. Unlike
+ * #BVHTree, primitive data is copied into the tree in the order of its leaves, so queries don't
+ * call back into the caller and read memory mostly sequentially.
+ *
+ * Trees can't be changed after they are built. Queries are thread-safe, the batched versions
+ * process spans of queries in parallel.
+ */
+
+#include <array>
+#include <cfloat>
+
+#include "BLI_array.hh"
+#include "BLI_function_ref.hh"
+#include "BLI_index_mask_fwd.hh"
+#include "BLI_math_vector_types.hh"
+#include "BLI_span.hh"
+
+namespace blender::bvh {
+
+struct RayHit {
+  /** Index of the hit primitive, -1 when nothing was hit. */
+  int index = -1;
+  /** Distance along the ray direction to the hit. */
+  float dist = 0.0f;
+  float3 position = float3(0.0f);
+  /** Normalized normal of the hit triangle. */
+  float3 normal = float3(0.0f);
+};
+
+struct NearestHit {
+  /** Index of the nearest primitive, -1 when nothing was found within the maximum distance. */
+  int index = -1;
+  float dist_sq = 0.0f;
+  /** Nearest position on the primitive. */
+  float3 position = float3(0.0f);
+};
+
+namespace detail {
+
+/** Bounds of the four children of a node, stored by axis. */
+struct alignas(16) WideNode {
+  float bounds_min[3][4];
+  float bounds_max[3][4];
+  /** Index of the child node, or of the first primitive of a leaf. -1 for unused children. */
+  int children[4];
+  /** Number of primitives of leaf children, zero for child nodes. */
+  int prims_num[4];
+};
+
+/** Nodes of a tree, built with a median split on the largest axis of primitive centers. */
+struct WideTree {
+  /** The root is the first node. Empty when there are no primitives. */
+  Array<WideNode> nodes;
+  /** Indices of the primitives passed to #build in the order of the leaves. */
+  Array<int> order;
+
+  void build(Span<float3> bounds_min, Span<float3> bounds_max);
+};
+
+}  // namespace detail
+
+class TriangleBVH {
+  detail::WideTree tree_;
+  /** Original indices of the triangles in the order of the leaves. */
+  Array<int> tri_indices_;
+  /** First vertex and edges of the triangles, as needed by ray intersection. */
+  Array<float3> v0_;
+  Array<float3> e1_;
+  Array<float3> e2_;
+
+ public:
+  TriangleBVH() = default;
+  /**
+   * Build a tree of the triangles in the mask.
+   * \param tri_fn: Gives the vertex positions of a triangle, called from multiple threads.
+   */
+  TriangleBVH(const IndexMask &tris, FunctionRef<std::array<float3, 3>(int tri)> tri_fn);
+
+  bool is_empty() const
+  {
+    return tri_indices_.is_empty();
+  }
+
+  /**
+   * Find the closest triangle hit by a ray within \a max_dist.
+   * \param direction: Must be normalized for the hit distance to be a distance.
+   */
+  RayHit ray_cast(const float3 &origin, const float3 &direction, float max_dist) const;
+  /** Find the nearest position on a triangle within the square root of \a max_dist_sq. */
+  NearestHit find_nearest(const float3 &position, float max_dist_sq = FLT_MAX) const;
+
+  /** Cast the rays in the mask in parallel, the hits are written at the same indices. */
+  void ray_cast(const IndexMask &mask,
+                Span<float3> origins,
+                Span<float3> directions,
+                Span<float> max_dists,
+                MutableSpan<RayHit> r_hits) const;
+  /** Find the nearest positions of the points in the mask in parallel. */
+  void find_nearest(const IndexMask &mask,
+                    Span<float3> positions,
+                    MutableSpan<NearestHit> r_hits) const;
+};
+
+class PointBVH {
+  detail::WideTree tree_;
+  /** Original indices of the points in the order of the leaves. */
+  Array<int> point_indices_;
+  Array<float3> positions_;
+
+ public:
+  PointBVH() = default;
+  /** Build a tree of the positions in the mask. */
+  PointBVH(const IndexMask &mask, Span<float3> positions);
+
+  bool is_empty() const
+  {
+    return point_indices_.is_empty();
+  }
+
+  /** Find the nearest point within the square root of \a max_dist_sq. */
+  NearestHit find_nearest(const float3 &position, float max_dist_sq = FLT_MAX) const;
+  /** Find the nearest points of the positions in the mask in parallel. */
+  void find_nearest(const IndexMask &mask,
+                    Span<float3> positions,
+                    MutableSpan<NearestHit> r_hits) const;
+};
+
+}  // namespace blender::bvh
@@ -0,0 +1,570 @@
+/* SPDX-FileCopyrightText: 2024 Blender Authors
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later */
+
+/** \file
+ * \ingroup bli
+ */
+
+#include <algorithm>
+
+#include "BLI_array_utils.hh"
+#include "BLI_index_mask.hh"
+#include "BLI_map.hh"
+#include "BLI_math_geom.h"
+#include "BLI_math_vector.hh"
+#include "BLI_simd.hh"
+#include "BLI_task.hh"
+#include "BLI_vector.hh"
+#include "BLI_wide_bvh.hh"
+
+namespace blender::bvh {
+
+namespace detail {
+
+/** Largest number of primitives in a leaf. */
+static constexpr int64_t leaf_size = 4;
+/** Nodes with more primitives build their children in parallel. */
+static constexpr int64_t parallel_build_size = 4096;
+
+/**
+ * Split the primitives of a node into up to four children, by splitting the largest range in half
+ * until there are four or all of them fit in a leaf. The ranges only depend on the number of
+ * primitives, so that the number of nodes of every subtree is known before it is built.
+ * \param partition_fn: Called for every split, to order the primitives of the range so that the
+ * ones before \a mid are on one side of the split.
+ */
+static Vector<IndexRange, 4> split_node(
+    const IndexRange range, const FunctionRef<void(IndexRange range, int64_t mid)> partition_fn)
+{
+  Vector<IndexRange, 4> children = {range};
+  while (children.size() < 4) {
+    int largest = 0;
+    for (const int i : children.index_range()) {
+      if (children[i].size() > children[largest].size()) {
+        largest = i;
+      }
+    }
+    const IndexRange child = children[largest];
+    if (child.size() <= leaf_size) {
+      break;
+    }
+    const int64_t half = child.size() / 2;
+    if (partition_fn) {
+      partition_fn(child, child.start() + half);
+    }
+    children[largest] = child.take_front(half);
+    children.insert(largest + 1, child.drop_front(half));
+  }
+  return children;
+}
+
+/**
+ * Count the nodes of a subtree with the given number of primitives. Subtrees of the same size have
+ * the same layout, and splitting in half only creates a few different sizes per level. So the
+ * counts are computed once per size and remembered in \a r_nodes_num_by_size.
+ */
+static int64_t subtree_nodes_num(const int64_t prims_num,
+                                 Map<int64_t, int64_t> &r_nodes_num_by_size)
+{
+  if (const int64_t *nodes_num = r_nodes_num_by_size.lookup_ptr(prims_num)) {
+    return *nodes_num;
+  }
+  int64_t nodes_num = 1;
+  for (const IndexRange child : split_node(IndexRange(prims_num), {})) {
+    if (child.size() > leaf_size) {
+      nodes_num += subtree_nodes_num(child.size(), r_nodes_num_by_size);
+    }
+  }
+  r_nodes_num_by_size.add_new(prims_num, nodes_num);
+  return nodes_num;
+}
+
+struct BuildData {
+  Span<float3> bounds_min;
+  Span<float3> bounds_max;
+  MutableSpan<int> order;
+  MutableSpan<WideNode> nodes;
+  /** Number of nodes of every subtree size that is built, see #subtree_nodes_num. */
+  const Map<int64_t, int64_t> *nodes_num_by_size;
+};
+
+/** Order the primitives of the range by the position of their centers on the largest axis. */
+static void partition_prims(const BuildData &data, const IndexRange range, const int64_t mid)
+{
+  MutableSpan<int> order = data.order.slice(range);
+  /* Centers are compared scaled by two. */
+  auto center = [&](const int prim) { return data.bounds_min[prim] + data.bounds_max[prim]; };
+
+  float3 centers_min(FLT_MAX);
+  float3 centers_max(-FLT_MAX);
+  for (const int prim : order) {
+    math::min_max(center(prim), centers_min, centers_max);
+  }
+  const int axis = math::dominant_axis(centers_max - centers_min);
+
+  std::nth_element(
+      order.begin(), order.begin() + (mid - range.start()), order.end(), [&](int a, int b) {
+        return center(a)[axis] < center(b)[axis];
+      });
+}
+
+static void build_node(const BuildData &data,
+                       const int node_index,
+                       const IndexRange range,
+                       float3 &r_min,
+                       float3 &r_max)
+{
+  auto partition_fn = [&](const IndexRange split, const int64_t mid) {
+    partition_prims(data, split, mid);
+  };
+  const Vector<IndexRange, 4> children = split_node(range, partition_fn);
+
+  /* Child nodes are stored after their parent in depth-first order. */
+  std::array<int, 4> child_nodes;
+  int next_node = node_index + 1;
+  for (const int i : children.index_range()) {
+    if (children[i].size() > leaf_size) {
+      child_nodes[i] = next_node;
+      next_node += data.nodes_num_by_size->lookup(children[i].size());
+    }
+    else {
+      child_nodes[i] = -1;
+    }
+  }
+
+  std::array<float3, 4> children_min;
+  std::array<float3, 4> children_max;
+  auto build_child = [&](const int i) {
+    if (child_nodes[i] != -1) {
+      build_node(data, child_nodes[i], children[i], children_min[i], children_max[i]);
+      return;
+    }
+    children_min[i] = float3(FLT_MAX);
+    children_max[i] = float3(-FLT_MAX);
+    for (const int prim : data.order.slice(children[i])) {
+      children_min[i] = math::min(children_min[i], data.bounds_min[prim]);
+      children_max[i] = math::max(children_max[i], data.bounds_max[prim]);
+    }
+  };
+  if (range.size() > parallel_build_size) {
+    threading::parallel_for(children.index_range(), 1, [&](const IndexRange children_range) {
+      for (const int i : children_range) {
+        build_child(i);
+      }
+    });
+  }
+  else {
+    for (const int i : children.index_range()) {
+      build_child(i);
+    }
+  }
+
+  WideNode &node = data.nodes[node_index];
+  r_min = float3(FLT_MAX);
+  r_max = float3(-FLT_MAX);
+  for (const int i : IndexRange(4)) {
+    if (i >= children.size()) {
+      for (const int axis : IndexRange(3)) {
+        node.bounds_min[axis][i] = FLT_MAX;
+        node.bounds_max[axis][i] = -FLT_MAX;
+      }
+      node.children[i] = -1;
+      node.prims_num[i] = 0;
+      continue;
+    }
+    for (const int axis : IndexRange(3)) {
+      node.bounds_min[axis][i] = children_min[i][axis];
+      node.bounds_max[axis][i] = children_max[i][axis];
+    }
+    if (child_nodes[i] == -1) {
+      node.children[i] = int(children[i].start());
+      node.prims_num[i] = int(children[i].size());
+    }
+    else {
+      node.children[i] = child_nodes[i];
+      node.prims_num[i] = 0;
+    }
+    r_min = math::min(r_min, children_min[i]);
+    r_max = math::max(r_max, children_max[i]);
+  }
+}
+
+void WideTree::build(const Span<float3> bounds_min, const Span<float3> bounds_max)
+{
+  BLI_assert(bounds_min.size() == bounds_max.size());
+  const int64_t prims_num = bounds_min.size();
+  this->order.reinitialize(prims_num);
+  array_utils::fill_index_range<int>(this->order);
+  if (prims_num == 0) {
+    this->nodes.reinitialize(0);
+    return;
+  }
+  Map<int64_t, int64_t> nodes_num_by_size;
+  this->nodes.reinitialize(subtree_nodes_num(prims_num, nodes_num_by_size));
+  const BuildData data{bounds_min, bounds_max, this->order, this->nodes, &nodes_num_by_size};
+  float3 min;
+  float3 max;
+  build_node(data, 0, IndexRange(prims_num), min, max);
+}
+
+struct StackItem {
+  /** Node index, or first primitive of a leaf. */
+  int child;
+  int prims_num;
+  /** Distance to the bounds of the child, as given by the node test. */
+  float dist;
+};
+
+/**
+ * Visit the leaves whose bounds are within the maximum distance, from near to far.
+ * \param node_fn: Writes the distances to the bounds of the children of a node and returns a bit
+ * mask of the children within the given distance.
+ * \param leaf_fn: Tests the primitives of a leaf and returns the new maximum distance.
+ */
+template<typename NodeFn, typename LeafFn>
+static void traverse(const Span<WideNode> nodes,
+                     float max_dist,
+                     const NodeFn &node_fn,
+                     const LeafFn &leaf_fn)
+{
+  if (nodes.is_empty()) {
+    return;
+  }
+  Vector<StackItem, 64> stack;
+  stack.append({0, 0, 0.0f});
+  while (!stack.is_empty()) {
+    const StackItem item = stack.pop_last();
+    if (item.dist > max_dist) {
+      continue;
+    }
+    if (item.prims_num > 0) {
+      max_dist = leaf_fn(IndexRange(item.child, item.prims_num), max_dist);
+      continue;
+    }
+    const WideNode &node = nodes[item.child];
+    alignas(16) float dists[4];
+    const int hit_mask = node_fn(node, max_dist, dists);
+
+    /* Push the children from far to near, so that the nearest is visited first. */
+    std::array<StackItem, 4> items;
+    int items_num = 0;
+    for (const int i : IndexRange(4)) {
+      if (node.children[i] == -1 || !(hit_mask & (1 << i))) {
+        continue;
+      }
+      int j = items_num++;
+      while (j > 0 && items[j - 1].dist < dists[i]) {
+        items[j] = items[j - 1];
+        j--;
+      }
+      items[j] = {node.children[i], node.prims_num[i], dists[i]};
+    }
+    stack.extend(Span(items.data(), items_num));
+  }
+}
+
+}  // namespace detail
+
+using detail::WideNode;
+
+struct RayPrecalc {
+  float3 origin;
+  float3 inv_dir;
+
+  RayPrecalc(const float3 &origin, const float3 &direction) : origin(origin)
+  {
+    for (const int axis : IndexRange(3)) {
+      /* Avoid infinite values, which would give NaN for bounds at the ray origin. */
+      const float d = direction[axis];
+      this->inv_dir[axis] = std::abs(d) > 1e-30f ? 1.0f / d : FLT_MAX;
+    }
+  }
+};
+
+/** Slab test of the ray against the bounds of all children, giving the entry distances. */
+static int ray_node_test(const WideNode &node,
+                         const RayPrecalc &ray,
+                         const float max_dist,
+                         float r_dists[4])
+{
+#if BLI_HAVE_SSE2
+  __m128 t_near = _mm_setzero_ps();
+  __m128 t_far = _mm_set1_ps(max_dist);
+  for (const int axis : IndexRange(3)) {
+    const __m128 origin = _mm_set1_ps(ray.origin[axis]);
+    const __m128 inv_dir = _mm_set1_ps(ray.inv_dir[axis]);
+    const __m128 t0 = _mm_mul_ps(_mm_sub_ps(_mm_load_ps(node.bounds_min[axis]), origin), inv_dir);
+    const __m128 t1 = _mm_mul_ps(_mm_sub_ps(_mm_load_ps(node.bounds_max[axis]), origin), inv_dir);
+    t_near = _mm_max_ps(t_near, _mm_min_ps(t0, t1));
+    t_far = _mm_min_ps(t_far, _mm_max_ps(t0, t1));
+  }
+  _mm_store_ps(r_dists, t_near);
+  return _mm_movemask_ps(_mm_cmple_ps(t_near, t_far));
+#else
+  int hit_mask = 0;
+  for (const int i : IndexRange(4)) {
+    float t_near = 0.0f;
+    float t_far = max_dist;
+    for (const int axis : IndexRange(3)) {
+      const float t0 = (node.bounds_min[axis][i] - ray.origin[axis]) * ray.inv_dir[axis];
+      const float t1 = (node.bounds_max[axis][i] - ray.origin[axis]) * ray.inv_dir[axis];
+      t_near = std::max(t_near, std::min(t0, t1));
+      t_far = std::min(t_far, std::max(t0, t1));
+    }
+    r_dists[i] = t_near;
+    if (t_near <= t_far) {
+      hit_mask |= 1 << i;
+    }
+  }
+  return hit_mask;
+#endif
+}
+
+/** Squared distance from the position to the bounds of all children. */
+static int point_node_test(const WideNode &node,
+                           const float3 &position,
+                           const float max_dist_sq,
+                           float r_dists_sq[4])
+{
+#if BLI_HAVE_SSE2
+  const __m128 zero = _mm_setzero_ps();
+  __m128 dist_sq = zero;
+  for (const int axis : IndexRange(3)) {
+    const __m128 p = _mm_set1_ps(position[axis]);
+    const __m128 below = _mm_sub_ps(_mm_load_ps(node.bounds_min[axis]), p);
+    const __m128 above = _mm_sub_ps(p, _mm_load_ps(node.bounds_max[axis]));
+    const __m128 d = _mm_max_ps(_mm_max_ps(below, above), zero);
+    dist_sq = _mm_add_ps(dist_sq, _mm_mul_ps(d, d));
+  }
+  _mm_store_ps(r_dists_sq, dist_sq);
+  return _mm_movemask_ps(_mm_cmplt_ps(dist_sq, _mm_set1_ps(max_dist_sq)));
+#else
+  int hit_mask = 0;
+  for (const int i : IndexRange(4)) {
+    float dist_sq = 0.0f;
+    for (const int axis : IndexRange(3)) {
+      const float below = node.bounds_min[axis][i] - position[axis];
+      const float above = position[axis] - node.bounds_max[axis][i];
+      const float d = std::max(std::max(below, above), 0.0f);
+      dist_sq += d * d;
+    }
+    r_dists_sq[i] = dist_sq;
+    if (dist_sq < max_dist_sq) {
+      hit_mask |= 1 << i;
+    }
+  }
+  return hit_mask;
+#endif
+}
+
+/* -------------------------------------------------------------------- */
+/** \name Triangles
+ * \{ */
+
+TriangleBVH::TriangleBVH(const IndexMask &tris,
+                         const FunctionRef<std::array<float3, 3>(int tri)> tri_fn)
+{
+  const int64_t tris_num = tris.size();
+  Array<float3> v0(tris_num);
+  Array<float3> e1(tris_num);
+  Array<float3> e2(tris_num);
+  Array<float3> bounds_min(tris_num);
+  Array<float3> bounds_max(tris_num);
+  tris.foreach_index(GrainSize(4096), [&](const int tri, const int64_t pos) {
+    const std::array<float3, 3> verts = tri_fn(tri);
+    v0[pos] = verts[0];
+    e1[pos] = verts[1] - verts[0];
+    e2[pos] = verts[2] - verts[0];
+    bounds_min[pos] = math::min(math::min(verts[0], verts[1]), verts[2]);
+    bounds_max[pos] = math::max(math::max(verts[0], verts[1]), verts[2]);
+  });
+  tree_.build(bounds_min, bounds_max);
+
+  Array<int> tri_indices(tris_num);
+  tris.to_indices<int>(tri_indices);
+  tri_indices_.reinitialize(tris_num);
+  v0_.reinitialize(tris_num);
+  e1_.reinitialize(tris_num);
+  e2_.reinitialize(tris_num);
+  const Span<int> order = tree_.order;
+  array_utils::gather(tri_indices.as_span(), order, tri_indices_.as_mutable_span());
+  array_utils::gather(v0.as_span(), order, v0_.as_mutable_span());
+  array_utils::gather(e1.as_span(), order, e1_.as_mutable_span());
+  array_utils::gather(e2.as_span(), order, e2_.as_mutable_span());
+}
+
+RayHit TriangleBVH::ray_cast(const float3 &origin,
+                             const float3 &direction,
+                             const float max_dist) const
+{
+  const RayPrecalc ray(origin, direction);
+  int best = -1;
+  float best_dist = max_dist;
+  detail::traverse(
+      tree_.nodes,
+      max_dist,
+      [&](const WideNode &node, const float dist, float r_dists[4]) {
+        return ray_node_test(node, ray, dist, r_dists);
+      },
+      [&](const IndexRange leaf, const float /*dist*/) {
+        for (const int i : leaf) {
+          /* Same as #isect_ray_tri_epsilon_v3, with the edges computed in advance. */
+          const float3 p = math::cross(direction, e2_[i]);
+          const float det = math::dot(e1_[i], p);
+          if (det == 0.0f) {
+            continue;
+          }
+          const float inv_det = 1.0f / det;
+          const float3 s = origin - v0_[i];
+          const float u = inv_det * math::dot(s, p);
+          if (u < -FLT_EPSILON || u > 1.0f + FLT_EPSILON) {
+            continue;
+          }
+          const float3 q = math::cross(s, e1_[i]);
+          const float v = inv_det * math::dot(direction, q);
+          if (v < -FLT_EPSILON || u + v > 1.0f + FLT_EPSILON) {
+            continue;
+          }
+          const float dist = inv_det * math::dot(e2_[i], q);
+          if (dist >= 0.0f && dist < best_dist) {
+            best = i;
+            best_dist = dist;
+          }
+        }
+        return best_dist;
+      });
+
+  RayHit hit;
+  if (best == -1) {
+    return hit;
+  }
+  hit.index = tri_indices_[best];
+  hit.dist = best_dist;
+  hit.position = origin + direction * best_dist;
+  hit.normal = math::normalize(math::cross(e1_[best], e2_[best]));
+  return hit;
+}
+
+NearestHit TriangleBVH::find_nearest(const float3 &position, const float max_dist_sq) const
+{
+  int best = -1;
+  float best_dist_sq = max_dist_sq;
+  float3 best_position;
+  detail::traverse(
+      tree_.nodes,
+      max_dist_sq,
+      [&](const WideNode &node, const float dist_sq, float r_dists_sq[4]) {
+        return point_node_test(node, position, dist_sq, r_dists_sq);
+      },
+      [&](const IndexRange leaf, const float /*dist_sq*/) {
+        for (const int i : leaf) {
+          float3 nearest;
+          closest_on_tri_to_point_v3(nearest, position, v0_[i], v0_[i] + e1_[i], v0_[i] + e2_[i]);
+          const float dist_sq = math::distance_squared(position, nearest);
+          if (dist_sq < best_dist_sq) {
+            best = i;
+            best_dist_sq = dist_sq;
+            best_position = nearest;
+          }
+        }
+        return best_dist_sq;
+      });
+
+  NearestHit hit;
+  if (best == -1) {
+    return hit;
+  }
+  hit.index = tri_indices_[best];
+  hit.dist_sq = best_dist_sq;
+  hit.position = best_position;
+  return hit;
+}
+
+void TriangleBVH::ray_cast(const IndexMask &mask,
+                           const Span<float3> origins,
+                           const Span<float3> directions,
+                           const Span<float> max_dists,
+                           MutableSpan<RayHit> r_hits) const
+{
+  mask.foreach_index(GrainSize(1024), [&](const int64_t i) {
+    r_hits[i] = this->ray_cast(origins[i], directions[i], max_dists[i]);
+  });
+}
+
+void TriangleBVH::find_nearest(const IndexMask &mask,
+                               const Span<float3> positions,
+                               MutableSpan<NearestHit> r_hits) const
+{
+  mask.foreach_index(GrainSize(1024), [&](const int64_t i) {
+    r_hits[i] = this->find_nearest(positions[i]);
+  });
+}
+
+/** \} */
+
+/* -------------------------------------------------------------------- */
+/** \name Points
+ * \{ */
+
+PointBVH::PointBVH(const IndexMask &mask, const Span<float3> positions)
+{
+  const int64_t points_num = mask.size();
+  Array<float3> masked_positions(points_num);
+  Array<int> point_indices(points_num);
+  mask.foreach_index(GrainSize(4096), [&](const int i, const int64_t pos) {
+    masked_positions[pos] = positions[i];
+    point_indices[pos] = i;
+  });
+  tree_.build(masked_positions, masked_positions);
+
+  point_indices_.reinitialize(points_num);
+  positions_.reinitialize(points_num);
+  const Span<int> order = tree_.order;
+  array_utils::gather(point_indices.as_span(), order, point_indices_.as_mutable_span());
+  array_utils::gather(masked_positions.as_span(), order, positions_.as_mutable_span());
+}
+
+NearestHit PointBVH::find_nearest(const float3 &position, const float max_dist_sq) const
+{
+  int best = -1;
+  float best_dist_sq = max_dist_sq;
+  detail::traverse(
+      tree_.nodes,
+      max_dist_sq,
+      [&](const WideNode &node, const float dist_sq, float r_dists_sq[4]) {
+        return point_node_test(node, position, dist_sq, r_dists_sq);
+      },
+      [&](const IndexRange leaf, const float /*dist_sq*/) {
+        for (const int i : leaf) {
+          const float dist_sq = math::distance_squared(position, positions_[i]);
+          if (dist_sq < best_dist_sq) {
+            best = i;
+            best_dist_sq = dist_sq;
+          }
+        }
+        return best_dist_sq;
+      });
+
+  NearestHit hit;
+  if (best == -1) {
+    return hit;
+  }
+  hit.index = point_indices_[best];
+  hit.dist_sq = best_dist_sq;
+  hit.position = positions_[best];
+  return hit;
+}
+
+void PointBVH::find_nearest(const IndexMask &mask,
+                            const Span<float3> positions,
+                            MutableSpan<NearestHit> r_hits) const
+{
+  mask.foreach_index(GrainSize(1024), [&](const int64_t i) {
+    r_hits[i] = this->find_nearest(positions[i]);
+  });
+}
+
+/** \} */
+
+}  // namespace blender::bvh
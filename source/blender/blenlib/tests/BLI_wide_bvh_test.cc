@@ -0,0 +1,153 @@
+/* SPDX-FileCopyrightText: 2024 Blender Authors
+ *
+ * SPDX-License-Identifier: Apache-2.0 */
+
+#include "testing/testing.h"
+
+#include "BLI_index_mask.hh"
+#include "BLI_math_geom.h"
+#include "BLI_math_vector.hh"
+#include "BLI_rand.hh"
+#include "BLI_wide_bvh.hh"
+
+namespace blender::bvh::tests {
+
+static float3 random_position(RandomNumberGenerator &rng)
+{
+  return float3(rng.get_float(), rng.get_float(), rng.get_float()) * 2.0f - 1.0f;
+}
+
+static Array<std::array<float3, 3>> random_triangles(RandomNumberGenerator &rng, const int num)
+{
+  Array<std::array<float3, 3>> tris(num);
+  for (std::array<float3, 3> &tri : tris) {
+    const float3 center = random_position(rng);
+    for (float3 &vert : tri) {
+      vert = center + random_position(rng) * 0.1f;
+    }
+  }
+  return tris;
+}
+
+TEST(wide_bvh, Empty)
+{
+  const TriangleBVH tris_bvh;
+  EXPECT_TRUE(tris_bvh.is_empty());
+  EXPECT_EQ(tris_bvh.ray_cast(float3(0.0f), float3(0.0f, 0.0f, 1.0f), FLT_MAX).index, -1);
+  EXPECT_EQ(tris_bvh.find_nearest(float3(0.0f)).index, -1);
+
+  const PointBVH points_bvh(IndexMask(0), {});
+  EXPECT_TRUE(points_bvh.is_empty());
+  EXPECT_EQ(points_bvh.find_nearest(float3(0.0f)).index, -1);
+}
+
+TEST(wide_bvh, RayCast)
+{
+  RandomNumberGenerator rng(0);
+  const Array<std::array<float3, 3>> tris = random_triangles(rng, 1000);
+  IndexMaskMemory memory;
+  /* Leave out some triangles, to check that the original indices are returned. */
+  const IndexMask mask = IndexMask::from_predicate(
+      tris.index_range(), GrainSize(256), memory, [](const int i) { return i % 3 != 0; });
+  const TriangleBVH bvh(mask, [&](const int tri) { return tris[tri]; });
+
+  const int rays_num = 500;
+  Array<float3> origins(rays_num);
+  Array<float3> directions(rays_num);
+  Array<float> max_dists(rays_num);
+  for (const int i : IndexRange(rays_num)) {
+    origins[i] = random_position(rng) * 2.0f;
+    directions[i] = math::normalize(random_position(rng));
+    max_dists[i] = i % 2 ? FLT_MAX : 1.0f;
+  }
+  Array<RayHit> hits(rays_num);
+  bvh.ray_cast(IndexRange(rays_num), origins, directions, max_dists, hits);
+
+  int hits_num = 0;
+  for (const int i : IndexRange(rays_num)) {
+    float expected_dist = max_dists[i];
+    int expected_index = -1;
+    mask.foreach_index([&](const int tri) {
+      float dist;
+      if (isect_ray_tri_epsilon_v3(origins[i],
+                                   directions[i],
+                                   tris[tri][0],
+                                   tris[tri][1],
+                                   tris[tri][2],
+                                   &dist,
+                                   nullptr,
+                                   FLT_EPSILON) &&
+          dist < expected_dist)
+      {
+        expected_dist = dist;
+        expected_index = tri;
+      }
+    });
+    EXPECT_EQ(hits[i].index, expected_index);
+    if (expected_index != -1) {
+      hits_num++;
+      EXPECT_NEAR(hits[i].dist, expected_dist, 1e-5f);
+      const float3 expected_position = origins[i] + directions[i] * expected_dist;
+      EXPECT_V3_NEAR(hits[i].position, expected_position, 1e-5f);
+    }
+  }
+  EXPECT_GT(hits_num, 0);
+}
+
+TEST(wide_bvh, NearestTriangle)
+{
+  RandomNumberGenerator rng(1);
+  const Array<std::array<float3, 3>> tris = random_triangles(rng, 1000);
+  const TriangleBVH bvh(tris.index_range(), [&](const int tri) { return tris[tri]; });
+
+  const int points_num = 500;
+  Array<float3> positions(points_num);
+  for (float3 &position : positions) {
+    position = random_position(rng) * 1.5f;
+  }
+  Array<NearestHit> hits(points_num);
+  bvh.find_nearest(IndexRange(points_num), positions, hits);
+
+  for (const int i : IndexRange(points_num)) {
+    float expected_dist_sq = FLT_MAX;
+    for (const int tri : tris.index_range()) {
+      float3 nearest;
+      closest_on_tri_to_point_v3(nearest, positions[i], tris[tri][0], tris[tri][1], tris[tri][2]);
+      expected_dist_sq = std::min(expected_dist_sq, math::distance_squared(positions[i], nearest));
+    }
+    EXPECT_NE(hits[i].index, -1);
+    EXPECT_NEAR(hits[i].dist_sq, expected_dist_sq, 1e-5f);
+  }
+}
+
+TEST(wide_bvh, NearestPoint)
+{
+  RandomNumberGenerator rng(2);
+  Array<float3> points(2000);
+  for (float3 &point : points) {
+    point = random_position(rng);
+  }
+  const PointBVH bvh(points.index_range(), points);
+
+  for ([[maybe_unused]] const int i : IndexRange(500)) {
+    const float3 position = random_position(rng) * 1.5f;
+    int expected_index = -1;
+    float expected_dist_sq = FLT_MAX;
+    for (const int point : points.index_range()) {
+      const float dist_sq = math::distance_squared(position, points[point]);
+      if (dist_sq < expected_dist_sq) {
+        expected_index = point;
+        expected_dist_sq = dist_sq;
+      }
+    }
+    const NearestHit hit = bvh.find_nearest(position);
+    EXPECT_EQ(hit.index, expected_index);
+    EXPECT_FLOAT_EQ(hit.dist_sq, expected_dist_sq);
+    EXPECT_EQ(hit.position, points[expected_index]);
+
+    /* Points further than the maximum distance are not found. */
+    EXPECT_EQ(bvh.find_nearest(position, expected_dist_sq * 0.5f).index, -1);
+  }
+}
+
+}  // namespace blender::bvh::tests
@@ -1068,6 +1068,14 @@ void blo_do_versions_userdef(UserDef *userdef)
     userdef->uiflag |= USER_FILTER_BRUSHES_BY_TOOL;
   }
 
+  if (!USER_VERSION_ATLEAST(404, 2)) {
+    userdef->sequencer_prefetch_workers = 1;
+  }
+
+  if (!USER_VERSION_ATLEAST(404, 3)) {
+    userdef->sequencer_proxy_workers = 1;
+  }
+
   /**
    * Always bump subversion in BKE_blender_version.h when adding versioning
    * code here, and wrap it inside a USER_VERSION_ATLEAST check.
@@ -219,6 +219,15 @@ class CompositorContext {
     return rd_->size * 0.01f;
   }
 
+  /**
+   * Whether intermediate buffers are stored with half precision until read, reducing memory
+   * usage.
+   */
+  bool use_half_precision() const
+  {
+    return rd_->compositor_precision == SCE_COMPOSITOR_PRECISION_HALF;
+  }
+
   Size2f get_render_size() const;
 };
 
@@ -0,0 +1,261 @@
+/* SPDX-FileCopyrightText: 2024 Blender Authors
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later */
+
+#include <algorithm>
+#include <mutex>
+
+#if defined(WITH_FFTW3)
+#  include <fftw3.h>
+#endif
+
+#include "BLI_fftw.hh"
+#include "BLI_map.hh"
+#include "BLI_math_base.hh"
+#include "BLI_math_vector.hh"
+#include "BLI_rect.h"
+#include "BLI_task.hh"
+
+#include "COM_FFTConvolution.h"
+#include "COM_MemoryBuffer.h"
+
+namespace blender::compositor {
+
+#if defined(WITH_FFTW3)
+
+/* Smallest transform size, below it the cost of transforms is dominated by their overhead. */
+static constexpr int min_fft_size = 256;
+
+struct FFTPlans {
+  fftwf_plan forward;
+  fftwf_plan backward;
+};
+
+static std::mutex plans_mutex;
+
+static Map<int2, FFTPlans> &get_plans_map()
+{
+  static Map<int2, FFTPlans> plans;
+  return plans;
+}
+
+/* Get the plans of real transforms of the given size. Plans are executed with the new-array
+ * interface, so all arrays must be allocated by FFTW to have the alignment the plans expect. */
+static FFTPlans get_plans(const int2 size)
+{
+  std::scoped_lock lock(plans_mutex);
+  return get_plans_map().lookup_or_add_cb(size, [&]() {
+    const int64_t spatial_len = int64_t(size.x) * size.y;
+    const int64_t frequency_len = int64_t(size.x / 2 + 1) * size.y;
+    float *spatial = fftwf_alloc_real(spatial_len);
+    fftwf_complex *frequency = fftwf_alloc_complex(frequency_len);
+
+    FFTPlans plans;
+    plans.forward = fftwf_plan_dft_r2c_2d(size.y, size.x, spatial, frequency, FFTW_ESTIMATE);
+    plans.backward = fftwf_plan_dft_c2r_2d(size.y, size.x, frequency, spatial, FFTW_ESTIMATE);
+
+    fftwf_free(spatial);
+    fftwf_free(frequency);
+    return plans;
+  });
+}
+
+#endif
+
+FFTConvolution::FFTConvolution(Span<float> kernel,
+                               const int2 kernel_size,
+                               const int kernel_channels_num,
+                               const int2 image_size)
+    : kernel_size_(kernel_size), kernel_channels_num_(kernel_channels_num)
+{
+  BLI_assert(kernel_size.x % 2 == 1 && kernel_size.y % 2 == 1);
+  BLI_assert(kernel.size() == int64_t(kernel_size.x) * kernel_size.y * kernel_channels_num);
+
+#if defined(WITH_FFTW3)
+  fftw::initialize_float();
+
+  /* Transforms of about twice the kernel size spend as much work on the tile as on its margin,
+   * images smaller than that are transformed as a single tile. */
+  const int2 margin = kernel_size - 1;
+  const int2 preferred_size = math::max(margin * 2, int2(min_fft_size));
+  const int2 needed_size = math::max(image_size, int2(1)) + margin;
+  fft_size_ = fftw::optimal_size_for_real_transform(math::min(preferred_size, needed_size));
+  tile_size_ = fft_size_ - margin;
+
+  const int64_t spatial_len = int64_t(fft_size_.x) * fft_size_.y;
+  const int64_t frequency_len = int64_t(fft_size_.x / 2 + 1) * fft_size_.y;
+  const FFTPlans plans = get_plans(fft_size_);
+  float *spatial = fftwf_alloc_real(spatial_len);
+  fftwf_complex *frequency = fftwf_alloc_complex(frequency_len);
+
+  /* The inverse transform is not normalized, its result is scaled by the number of values. */
+  const float scale = 1.0f / float(spatial_len);
+  kernel_spectrum_.reinitialize(frequency_len * kernel_channels_num);
+  for (const int channel : IndexRange(kernel_channels_num)) {
+    /* Place the kernel reversed around the origin with wrap around, so that the circular
+     * convolution weights every pixel by the kernel value at the same offset from its center. The
+     * tile is then at the origin of the filtered region. */
+    std::fill_n(spatial, spatial_len, 0.0f);
+    for (const int y : IndexRange(kernel_size.y)) {
+      for (const int x : IndexRange(kernel_size.x)) {
+        const int spatial_x = mod_i(-x, fft_size_.x);
+        const int spatial_y = mod_i(-y, fft_size_.y);
+        const int64_t kernel_index = (int64_t(y) * kernel_size.x + x) * kernel_channels_num;
+        spatial[spatial_x + int64_t(spatial_y) * fft_size_.x] = kernel[kernel_index + channel] *
+                                                                 scale;
+      }
+    }
+
+    fftwf_execute_dft_r2c(plans.forward, spatial, frequency);
+    std::copy_n(reinterpret_cast<std::complex<float> *>(frequency),
+                frequency_len,
+                kernel_spectrum_.data() + frequency_len * channel);
+  }
+
+  fftwf_free(spatial);
+  fftwf_free(frequency);
+#else
+  UNUSED_VARS(kernel, image_size);
+  fft_size_ = int2(0);
+  tile_size_ = int2(0);
+#endif
+}
+
+bool FFTConvolution::is_faster(const int2 kernel_size)
+{
+#if defined(WITH_FFTW3)
+  return int64_t(kernel_size.x) * kernel_size.y >= min_kernel_area;
+#else
+  UNUSED_VARS(kernel_size);
+  return false;
+#endif
+}
+
+void FFTConvolution::filter(const MemoryBuffer &image,
+                            MemoryBuffer &output,
+                            const rcti &area,
+                            const int channels_num,
+                            const Boundary boundary) const
+{
+#if defined(WITH_FFTW3)
+  BLI_assert(boundary != Boundary::Normalize || kernel_channels_num_ == 1);
+  BLI_assert(kernel_channels_num_ == 1 || kernel_channels_num_ >= channels_num);
+  if (BLI_rcti_is_empty(&area)) {
+    return;
+  }
+
+  const FFTPlans plans = get_plans(fft_size_);
+  const int64_t spatial_len = int64_t(fft_size_.x) * fft_size_.y;
+  const int64_t frequency_len = int64_t(fft_size_.x / 2 + 1) * fft_size_.y;
+  const int2 radius = kernel_size_ / 2;
+  const rcti &image_rect = image.get_rect();
+
+  const int2 area_size = int2(BLI_rcti_size_x(&area), BLI_rcti_size_y(&area));
+  const int2 tiles_num = (area_size + tile_size_ - 1) / tile_size_;
+  const int64_t tiles_count = int64_t(tiles_num.x) * tiles_num.y;
+  threading::parallel_for(IndexRange(tiles_count), 1, [&](const IndexRange tiles_range) {
+    float *spatial = fftwf_alloc_real(spatial_len);
+    float *coverage = boundary == Boundary::Normalize ? fftwf_alloc_real(spatial_len) : nullptr;
+    fftwf_complex *frequency = fftwf_alloc_complex(frequency_len);
+    std::complex<float> *frequency_values = reinterpret_cast<std::complex<float> *>(frequency);
+
+    for (const int64_t tile_index : tiles_range) {
+      const int xmin = area.xmin + int(tile_index % tiles_num.x) * tile_size_.x;
+      const int ymin = area.ymin + int(tile_index / tiles_num.x) * tile_size_.y;
+      rcti tile;
+      BLI_rcti_init(&tile,
+                    xmin,
+                    std::min(xmin + tile_size_.x, area.xmax),
+                    ymin,
+                    std::min(ymin + tile_size_.y, area.ymax));
+
+      /* The filtered region starts at the first input pixel the tile needs and is zero padded to
+       * the transform size. */
+      const int2 origin = int2(tile.xmin, tile.ymin) - radius;
+      const int2 input_size = int2(BLI_rcti_size_x(&tile), BLI_rcti_size_y(&tile)) +
+                              kernel_size_ - 1;
+
+      /* Filter a channel of the region into the given array, the coverage of the image if the
+       * channel is negative. */
+      auto filter_channel = [&](const int channel, float *r_values) {
+        for (const int y : IndexRange(fft_size_.y)) {
+          float *row = r_values + int64_t(y) * fft_size_.x;
+          if (y >= input_size.y) {
+            std::fill_n(row, fft_size_.x, 0.0f);
+            continue;
+          }
+          const int image_y = origin.y + y;
+          for (const int x : IndexRange(fft_size_.x)) {
+            const int image_x = origin.x + x;
+            if (x >= input_size.x) {
+              row[x] = 0.0f;
+            }
+            else if (boundary == Boundary::Extend) {
+              const int clamped_x = math::clamp(image_x, image_rect.xmin, image_rect.xmax - 1);
+              const int clamped_y = math::clamp(image_y, image_rect.ymin, image_rect.ymax - 1);
+              row[x] = image.get_elem(clamped_x, clamped_y)[channel];
+            }
+            else if (image_x < image_rect.xmin || image_x >= image_rect.xmax ||
+                     image_y < image_rect.ymin || image_y >= image_rect.ymax)
+            {
+              row[x] = 0.0f;
+            }
+            else {
+              row[x] = channel < 0 ? 1.0f : image.get_elem(image_x, image_y)[channel];
+            }
+          }
+        }
+
+        fftwf_execute_dft_r2c(plans.forward, r_values, frequency);
+        const std::complex<float> *kernel_values = kernel_spectrum_.data() +
+                                                   (kernel_channels_num_ == 1 ?
+                                                        0 :
+                                                        frequency_len * channel);
+        for (const int64_t i : IndexRange(frequency_len)) {
+          frequency_values[i] *= kernel_values[i];
+        }
+        fftwf_execute_dft_c2r(plans.backward, frequency, r_values);
+      };
+
+      if (coverage) {
+        filter_channel(-1, coverage);
+      }
+      for (const int channel : IndexRange(channels_num)) {
+        filter_channel(channel, spatial);
+        for (int y = tile.ymin; y < tile.ymax; y++) {
+          for (int x = tile.xmin; x < tile.xmax; x++) {
+            const int64_t index = (x - tile.xmin) + int64_t(y - tile.ymin) * fft_size_.x;
+            output.get_elem(x, y)[channel] = coverage ?
+                                                 math::safe_divide(spatial[index],
+                                                                   coverage[index]) :
+                                                 spatial[index];
+          }
+        }
+      }
+    }
+
+    fftwf_free(spatial);
+    if (coverage) {
+      fftwf_free(coverage);
+    }
+    fftwf_free(frequency);
+  });
+#else
+  UNUSED_VARS(image, output, area, channels_num, boundary);
+  BLI_assert_unreachable();
+#endif
+}
+
+void FFTConvolution::free_plans()
+{
+#if defined(WITH_FFTW3)
+  std::scoped_lock lock(plans_mutex);
+  for (FFTPlans &plans : get_plans_map().values()) {
+    fftwf_destroy_plan(plans.forward);
+    fftwf_destroy_plan(plans.backward);
+  }
+  get_plans_map().clear();
+#endif
+}
+
+}  // namespace blender::compositor
@@ -0,0 +1,87 @@
+/* SPDX-FileCopyrightText: 2024 Blender Authors
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later */
+
+#pragma once
+
+#include <complex>
+
+#include "BLI_array.hh"
+#include "BLI_math_vector_types.hh"
+#include "BLI_span.hh"
+
+#include "DNA_vec_types.h"
+
+#ifdef WITH_CXX_GUARDEDALLOC
+#  include "MEM_guardedalloc.h"
+#endif
+
+namespace blender::compositor {
+
+class MemoryBuffer;
+
+/**
+ * Filters images with a kernel in the frequency domain, so the cost per pixel grows with the
+ * logarithm of the kernel size instead of its area. Areas are split into tiles that are
+ * transformed together with the margin of input the kernel needs, so every tile is independent
+ * and tiles are filtered in parallel. Transform sizes are the same for all tiles, so the kernel is
+ * transformed only once, and FFTW plans are kept for reuse across executions.
+ */
+class FFTConvolution {
+ public:
+  enum class Boundary {
+    /** Pixels outside the image have the value of the nearest pixel inside. */
+    Extend,
+    /**
+     * Only pixels inside the image contribute, the result is normalized by the sum of the kernel
+     * values covering the image. Requires a single channel kernel.
+     */
+    Normalize,
+  };
+
+  /** Smallest kernel area for which filtering in the frequency domain is faster than directly. */
+  static constexpr int64_t min_kernel_area = 33 * 33;
+
+ private:
+  int2 kernel_size_;
+  int kernel_channels_num_;
+  int2 fft_size_;
+  int2 tile_size_;
+  /** Spectrum of each kernel channel, scaled to normalize the inverse transform. */
+  Array<std::complex<float>> kernel_spectrum_;
+
+ public:
+  /**
+   * \param kernel: Kernel values by rows, with \a kernel_channels_num interleaved channels. The
+   * kernel has odd dimensions and its center is applied to the filtered pixel. A single channel
+   * kernel is used for all image channels.
+   * \param image_size: Size of the filtered image, used to avoid transforms larger than needed.
+   */
+  FFTConvolution(Span<float> kernel, int2 kernel_size, int kernel_channels_num, int2 image_size);
+
+  /**
+   * Whether filtering with a kernel of given size is faster in the frequency domain. Always false
+   * when built without FFTW.
+   */
+  static bool is_faster(int2 kernel_size);
+
+  /**
+   * Write to \a area of \a output the first \a channels_num channels of \a image filtered with
+   * the kernel. Every output pixel is the sum of the image pixels around it weighted by the kernel
+   * values at the same offset from the kernel center.
+   */
+  void filter(const MemoryBuffer &image,
+              MemoryBuffer &output,
+              const rcti &area,
+              int channels_num,
+              Boundary boundary) const;
+
+  /** Free the FFTW plans kept for reuse across executions. */
+  static void free_plans();
+
+#ifdef WITH_CXX_GUARDEDALLOC
+  MEM_CXX_CLASS_ALLOC_FUNCS("COM:FFTConvolution")
+#endif
+};
+
+}  // namespace blender::compositor
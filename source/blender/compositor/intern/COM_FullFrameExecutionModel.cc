@@ -9,6 +9,7 @@
 #include "BLT_translation.hh"
 
 #include "COM_Debug.h"
+#include "COM_OperationOutputCache.h"
 #include "COM_ViewerOperation.h"
 #include "COM_WorkScheduler.h"
 
@@ -24,9 +25,11 @@ namespace blender::compositor {
 
 FullFrameExecutionModel::FullFrameExecutionModel(CompositorContext &context,
                                                  SharedOperationBuffers &shared_buffers,
-                                                 Span<NodeOperation *> operations)
+                                                 Span<NodeOperation *> operations,
+                                                 OperationOutputCache *output_cache)
     : ExecutionModel(context, operations),
       active_buffers_(shared_buffers),
+      output_cache_(output_cache),
       num_operations_finished_(0)
 {
   priorities_.append(eCompositorPriority::High);
@@ -42,8 +45,16 @@ void FullFrameExecutionModel::execute(ExecutionSystem &exec_system)
 
   DebugInfo::graphviz(&exec_system, "compositor_prior_rendering");
 
+  if (output_cache_) {
+    output_cache_->begin_execution(operations_, context_.use_half_precision());
+  }
+
   determine_areas_to_render_and_reads();
   render_operations();
+
+  if (output_cache_) {
+    output_cache_->end_execution();
+  }
 }
 
 void FullFrameExecutionModel::determine_areas_to_render_and_reads()
@@ -52,16 +63,43 @@ void FullFrameExecutionModel::determine_areas_to_render_and_reads()
   const bNodeTree *node_tree = context_.get_bnodetree();
 
   rcti area;
+  Vector<NodeOperation *> output_ops;
   for (eCompositorPriority priority : priorities_) {
     for (NodeOperation *op : operations_) {
       op->set_bnodetree(node_tree);
       if (op->is_output_operation(is_rendering) && op->get_render_priority() == priority) {
         get_output_render_area(op, area);
         determine_areas_to_render(op, area);
-        determine_reads(op);
+        output_ops.append(op);
       }
     }
   }
+
+  /* Cached operations are known only once all areas to render are, reads depend on them. */
+  if (output_cache_) {
+    determine_cached_operations();
+  }
+  for (NodeOperation *op : output_ops) {
+    determine_reads(op);
+  }
+}
+
+void FullFrameExecutionModel::determine_cached_operations()
+{
+  const bool is_rendering = context_.is_rendering();
+  for (NodeOperation *op : operations_) {
+    if (op->is_output_operation(is_rendering)) {
+      continue;
+    }
+    const rcti &canvas = op->get_canvas();
+    const Vector<rcti> areas = active_buffers_.get_areas_to_render(op, -canvas.xmin, -canvas.ymin);
+    if (areas.is_empty()) {
+      continue;
+    }
+    if (std::shared_ptr<MemoryBuffer> buffer = output_cache_->lookup(op, areas)) {
+      cached_buffers_.add_new(op, std::move(buffer));
+    }
+  }
 }
 
 Vector<MemoryBuffer *> FullFrameExecutionModel::get_input_buffers(NodeOperation *op,
@@ -78,6 +116,11 @@ Vector<MemoryBuffer *> FullFrameExecutionModel::get_input_buffers(NodeOperation
 
     rcti rect = buf->get_rect();
     BLI_rcti_translate(&rect, offset_x, offset_y);
+    if (buf->is_compact()) {
+      /* Operations read a full precision copy, deleted with the other input buffers. */
+      inputs_buffers[i] = buf->expand(rect);
+      continue;
+    }
     inputs_buffers[i] = new MemoryBuffer(
         buf->get_buffer(), buf->get_num_channels(), rect, buf->is_a_single_elem());
   }
@@ -103,15 +146,25 @@ void FullFrameExecutionModel::render_operation(NodeOperation *op)
   constexpr int output_x = 0;
   constexpr int output_y = 0;
 
+  if (std::shared_ptr<MemoryBuffer> *cached_buffer = cached_buffers_.lookup_ptr(op)) {
+    /* Keep the operation in the map so that its inputs are still skipped, the buffer is owned by
+     * the active buffers from now on. */
+    active_buffers_.set_rendered_buffer(op, std::move(*cached_buffer));
+    num_operations_finished_++;
+    update_progress_bar();
+    return;
+  }
+
   const timeit::TimePoint before_time = timeit::Clock::now();
 
   const bool has_outputs = op->get_number_of_output_sockets() > 0;
   MemoryBuffer *op_buf = has_outputs ? create_operation_buffer(op, output_x, output_y) : nullptr;
+  Vector<rcti> areas;
   if (op->get_width() > 0 && op->get_height() > 0) {
     Vector<MemoryBuffer *> input_bufs = get_input_buffers(op, output_x, output_y);
     const int op_offset_x = output_x - op->get_canvas().xmin;
     const int op_offset_y = output_y - op->get_canvas().ymin;
-    Vector<rcti> areas = active_buffers_.get_areas_to_render(op, op_offset_x, op_offset_y);
+    areas = active_buffers_.get_areas_to_render(op, op_offset_x, op_offset_y);
     op->render(op_buf, areas, input_bufs);
     DebugInfo::operation_rendered(op, op_buf);
 
@@ -121,7 +174,19 @@ void FullFrameExecutionModel::render_operation(NodeOperation *op)
   }
   /* Even if operation has no resolution set the empty buffer. It will be clipped with a
    * TranslateOperation from convert resolutions if linked to an operation with resolution. */
-  active_buffers_.set_rendered_buffer(op, std::unique_ptr<MemoryBuffer>(op_buf));
+  /* Keep intermediate results with half precision until dependent operations read them. */
+  if (op_buf && context_.use_half_precision() &&
+      !op->is_output_operation(context_.is_rendering()))
+  {
+    op_buf->compact();
+  }
+
+  std::shared_ptr<MemoryBuffer> buffer(op_buf);
+  /* A cancelled execution may leave buffers partially rendered. */
+  if (output_cache_ && !op->is_braked()) {
+    output_cache_->add(op, buffer, areas);
+  }
+  active_buffers_.set_rendered_buffer(op, std::move(buffer));
 
   operation_finished(op);
 
@@ -156,11 +221,8 @@ void FullFrameExecutionModel::render_operations()
   WorkScheduler::stop();
 }
 
-/**
- * Returns all dependencies from inputs to outputs. A dependency may be repeated when
- * several operations depend on it.
- */
-static Vector<NodeOperation *> get_operation_dependencies(NodeOperation *operation)
+Vector<NodeOperation *> FullFrameExecutionModel::get_operation_dependencies(
+    NodeOperation *operation)
 {
   /* Get dependencies from outputs to inputs. */
   Vector<NodeOperation *> dependencies;
@@ -170,6 +232,9 @@ static Vector<NodeOperation *> get_operation_dependencies(NodeOperation *operati
     Vector<NodeOperation *> outputs(next_outputs);
     next_outputs.clear();
     for (NodeOperation *output : outputs) {
+      if (cached_buffers_.contains(output)) {
+        continue;
+      }
       for (int i = 0; i < output->get_number_of_input_sockets(); i++) {
         next_outputs.append(output->get_input_operation(i));
       }
@@ -238,7 +303,7 @@ void FullFrameExecutionModel::determine_reads(NodeOperation *output_op)
     const int num_inputs = operation->get_number_of_input_sockets();
     for (int i = 0; i < num_inputs; i++) {
       NodeOperation *input_op = operation->get_input_operation(i);
-      if (!active_buffers_.has_registered_reads(input_op)) {
+      if (!active_buffers_.has_registered_reads(input_op) && !cached_buffers_.contains(input_op)) {
         stack.append(input_op);
       }
       active_buffers_.register_read(input_op);
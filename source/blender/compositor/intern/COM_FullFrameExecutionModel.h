@@ -4,6 +4,9 @@
 
 #pragma once
 
+#include <memory>
+
+#include "BLI_map.hh"
 #include "BLI_vector.hh"
 
 #include "COM_Enums.h"
@@ -20,6 +23,7 @@ class CompositorContext;
 class ExecutionSystem;
 class MemoryBuffer;
 class NodeOperation;
+class OperationOutputCache;
 class SharedOperationBuffers;
 
 /**
@@ -33,6 +37,17 @@ class FullFrameExecutionModel : public ExecutionModel {
    */
   SharedOperationBuffers &active_buffers_;
 
+  /**
+   * Keeps operations buffers across executions, may be null.
+   */
+  OperationOutputCache *output_cache_;
+
+  /**
+   * Operations whose buffer is taken from #output_cache_ instead of being rendered. Their inputs
+   * are neither rendered nor read on their behalf.
+   */
+  Map<NodeOperation *, std::shared_ptr<MemoryBuffer>> cached_buffers_;
+
   /**
    * Number of operations finished.
    */
@@ -46,7 +61,8 @@ class FullFrameExecutionModel : public ExecutionModel {
  public:
   FullFrameExecutionModel(CompositorContext &context,
                           SharedOperationBuffers &shared_buffers,
-                          Span<NodeOperation *> operations);
+                          Span<NodeOperation *> operations,
+                          OperationOutputCache *output_cache = nullptr);
 
   void execute(ExecutionSystem &exec_system) override;
 
@@ -76,11 +92,20 @@ class FullFrameExecutionModel : public ExecutionModel {
    * Determines all operations areas needed to render given output area.
    */
   void determine_areas_to_render(NodeOperation *output_op, const rcti &output_area);
+  /**
+   * Finds operations whose buffer is in the output cache with all their areas to render.
+   */
+  void determine_cached_operations();
   /**
    * Determines reads to receive by operations in output operation tree (i.e: Number of dependent
    * operations each operation has).
    */
   void determine_reads(NodeOperation *output_op);
+  /**
+   * Returns all dependencies from inputs to outputs, not including the inputs of cached
+   * operations. A dependency may be repeated when several operations depend on it.
+   */
+  Vector<NodeOperation *> get_operation_dependencies(NodeOperation *operation);
 
   void update_progress_bar();
 
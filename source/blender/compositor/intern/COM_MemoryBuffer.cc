@@ -4,6 +4,9 @@
 
 #include "COM_MemoryBuffer.h"
 
+#include "BLI_math_half.hh"
+#include "BLI_task.hh"
+
 #include "IMB_colormanagement.hh"
 #include "IMB_imbuf_types.hh"
 
@@ -35,6 +38,7 @@ MemoryBuffer::MemoryBuffer(DataType data_type, int width, int height)
   num_channels_ = COM_data_type_num_channels(data_type);
   buffer_ = (float *)MEM_mallocN_aligned(
       sizeof(float) * buffer_len() * num_channels_, 16, "COM_MemoryBuffer");
+  half_buffer_ = nullptr;
   owns_data_ = true;
   datatype_ = data_type;
 
@@ -48,6 +52,7 @@ MemoryBuffer::MemoryBuffer(DataType data_type, const rcti &rect, bool is_a_singl
   num_channels_ = COM_data_type_num_channels(data_type);
   buffer_ = (float *)MEM_mallocN_aligned(
       sizeof(float) * buffer_len() * num_channels_, 16, "COM_MemoryBuffer");
+  half_buffer_ = nullptr;
   owns_data_ = true;
   datatype_ = data_type;
 
@@ -70,6 +75,7 @@ MemoryBuffer::MemoryBuffer(float *buffer,
   num_channels_ = num_channels;
   datatype_ = COM_num_channels_data_type(num_channels);
   buffer_ = buffer;
+  half_buffer_ = nullptr;
   owns_data_ = false;
 
   set_strides();
@@ -122,6 +128,40 @@ MemoryBuffer *MemoryBuffer::inflate() const
   return inflated;
 }
 
+/* Number of floats to convert per task when compacting or expanding buffers. */
+static constexpr int64_t convert_grain_size = 64 * 1024;
+
+void MemoryBuffer::compact()
+{
+  BLI_assert(owns_data_);
+  if (is_a_single_elem_ || is_compact()) {
+    return;
+  }
+
+  const int64_t floats_num = buffer_len() * num_channels_;
+  half_buffer_ = (uint16_t *)MEM_mallocN_aligned(
+      sizeof(uint16_t) * floats_num, 16, "COM_MemoryBuffer_half");
+  threading::parallel_for(IndexRange(floats_num), convert_grain_size, [&](const IndexRange range) {
+    math::float_to_half_array(buffer_ + range.start(), half_buffer_ + range.start(), range.size());
+  });
+  MEM_freeN(buffer_);
+  buffer_ = nullptr;
+}
+
+MemoryBuffer *MemoryBuffer::expand(const rcti &rect) const
+{
+  BLI_assert(is_compact());
+  BLI_assert(BLI_rcti_size_x(&rect) == get_width() && BLI_rcti_size_y(&rect) == get_height());
+
+  MemoryBuffer *expanded = new MemoryBuffer(datatype_, rect, false);
+  const int64_t floats_num = buffer_len() * num_channels_;
+  threading::parallel_for(IndexRange(floats_num), convert_grain_size, [&](const IndexRange range) {
+    math::half_to_float_array(
+        half_buffer_ + range.start(), expanded->buffer_ + range.start(), range.size());
+  });
+  return expanded;
+}
+
 float MemoryBuffer::get_max_value() const
 {
   float result = buffer_[0];
@@ -163,6 +203,10 @@ MemoryBuffer::~MemoryBuffer()
     MEM_freeN(buffer_);
     buffer_ = nullptr;
   }
+  if (half_buffer_) {
+    MEM_freeN(half_buffer_);
+    half_buffer_ = nullptr;
+  }
 }
 
 void MemoryBuffer::copy_from(const MemoryBuffer *src, const rcti &area)
@@ -68,6 +68,11 @@ class MemoryBuffer {
    */
   float *buffer_;
 
+  /**
+   * Data stored as half precision floats while the buffer is compact, see #compact.
+   */
+  uint16_t *half_buffer_;
+
   /**
    * \brief the number of channels of a single value in the buffer.
    * For value buffers this is 1, vector 3 and color 4
@@ -366,6 +371,7 @@ class MemoryBuffer {
    */
   float *get_buffer()
   {
+    BLI_assert(!is_compact());
     return buffer_;
   }
 
@@ -375,6 +381,32 @@ class MemoryBuffer {
    */
   MemoryBuffer *inflate() const;
 
+  /**
+   * Store the buffer data as half precision floats, halving its memory usage. Elements can't be
+   * accessed while the buffer is compact, readers get a full precision copy with #expand.
+   * Single element buffers are kept as they are.
+   */
+  void compact();
+
+  bool is_compact() const
+  {
+    return half_buffer_ != nullptr;
+  }
+
+  /**
+   * Get a full precision copy of a compact buffer, placed at given rectangle which must have the
+   * buffer size.
+   */
+  MemoryBuffer *expand(const rcti &rect) const;
+
+  /**
+   * Number of bytes used by the buffer data.
+   */
+  int64_t get_data_bytes_len() const
+  {
+    return buffer_len() * num_channels_ * (is_compact() ? sizeof(uint16_t) : sizeof(float));
+  }
+
   inline void wrap_pixel(float &x,
                          float &y,
                          MemoryBufferExtend extend_x,
@@ -51,6 +51,9 @@ class MultiThreadedOperation : public NodeOperation {
   void update_memory_buffer(MemoryBuffer *output,
                             const rcti &area,
                             Span<MemoryBuffer *> inputs) override;
+
+  /* Executes the partial updates of its fused operations. */
+  friend class FusedPixelOperation;
 };
 
 }  // namespace blender::compositor
@@ -206,6 +206,13 @@ struct NodeOperationFlags {
    */
   bool can_be_constant : 1;
 
+  /**
+   * Whether each output pixel only depends on the input pixels at the same coordinates, computed
+   * in a single #MultiThreadedOperation::update_memory_buffer_partial pass. Such operations can
+   * be fused with the operations they are linked to, see #FusedPixelOperation.
+   */
+  bool is_pixel_operation : 1;
+
   NodeOperationFlags()
   {
     use_render_border = false;
@@ -217,6 +224,7 @@ struct NodeOperationFlags {
     use_datatype_conversion = true;
     is_constant_operation = false;
     can_be_constant = false;
+    is_pixel_operation = false;
   }
 };
 
@@ -242,6 +250,22 @@ struct NodeOperationHash {
            params_hash_ == other.params_hash_;
   }
 
+  uint64_t get_type_hash() const
+  {
+    return type_hash_;
+  }
+
+  uint64_t get_params_hash() const
+  {
+    return params_hash_;
+  }
+
+  /** Hash of the operation type and parameters, ignoring the operations linked to its inputs. */
+  uint64_t get_operation_hash() const
+  {
+    return get_default_hash(type_hash_, params_hash_);
+  }
+
   bool operator!=(const NodeOperationHash &other) const
   {
     return !(*this == other);
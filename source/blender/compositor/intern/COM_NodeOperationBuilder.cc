@@ -11,6 +11,7 @@
 #include "COM_Converter.h"
 #include "COM_Debug.h"
 
+#include "COM_FusedPixelOperation.h"
 #include "COM_PreviewOperation.h"
 #include "COM_SetColorOperation.h"
 #include "COM_SetValueOperation.h"
@@ -90,6 +91,9 @@ void NodeOperationBuilder::convert_to_operations(ExecutionSystem *system)
   save_graphviz("compositor_prior_merging");
   merge_equal_operations();
 
+  save_graphviz("compositor_prior_fusing");
+  fuse_pixel_operations();
+
   /* links not available from here on */
   /* XXX make links_ a local variable to avoid confusion! */
   links_.clear();
@@ -493,6 +497,118 @@ void NodeOperationBuilder::merge_equal_operations(NodeOperation *from, NodeOpera
   delete from;
 }
 
+/**
+ * Whether \a input_op can be evaluated as part of \a op when fusing pixel operations. That is the
+ * case when both are pixel operations with the same canvas, and \a op is the only user of
+ * \a input_op, so its result is not needed anywhere else.
+ */
+static bool is_fusable_input(NodeOperation *op,
+                             NodeOperation *input_op,
+                             const MultiValueMap<NodeOperation *, NodeOperationInput *> &users)
+{
+  if (!op->get_flags().is_pixel_operation || !input_op->get_flags().is_pixel_operation) {
+    return false;
+  }
+  const Span<NodeOperationInput *> input_op_users = users.lookup(input_op);
+  return input_op_users.size() == 1 && &input_op_users[0]->get_operation() == op &&
+         BLI_rcti_compare(&op->get_canvas(), &input_op->get_canvas());
+}
+
+/** Gather the operations to fuse into \a op, inputs before the operations reading them. */
+static void gather_fused_operations_recursive(
+    NodeOperation *op,
+    const MultiValueMap<NodeOperation *, NodeOperationInput *> &users,
+    Vector<NodeOperation *> &r_operations)
+{
+  for (int i = 0; i < op->get_number_of_input_sockets(); i++) {
+    NodeOperation *input_op = op->get_input_operation(i);
+    if (input_op && is_fusable_input(op, input_op, users)) {
+      gather_fused_operations_recursive(input_op, users, r_operations);
+    }
+  }
+  r_operations.append(op);
+}
+
+void NodeOperationBuilder::fuse_pixel_operations()
+{
+  MultiValueMap<NodeOperation *, NodeOperationInput *> users;
+  for (const Link &link : links_) {
+    users.add(&link.from()->get_operation(), link.to());
+  }
+
+  /* Find the chains to fuse, starting from the operations whose result is needed outside of the
+   * chain. */
+  Vector<Vector<NodeOperation *>> fused_chains;
+  for (NodeOperation *op : operations_) {
+    if (!op->get_flags().is_pixel_operation) {
+      continue;
+    }
+    const Span<NodeOperationInput *> op_users = users.lookup(op);
+    if (op_users.size() == 1 && is_fusable_input(&op_users[0]->get_operation(), op, users)) {
+      continue;
+    }
+    Vector<NodeOperation *> chain;
+    gather_fused_operations_recursive(op, users, chain);
+    if (chain.size() > 1) {
+      fused_chains.append(std::move(chain));
+    }
+  }
+
+  for (Span<NodeOperation *> chain : fused_chains) {
+    NodeOperation *last_op = chain.last();
+    FusedPixelOperation *fused_op = new FusedPixelOperation(
+        last_op->get_output_socket()->get_data_type());
+
+    /* Map member inputs either to a previous member or to a new input of the fused operation. */
+    Map<NodeOperation *, int> member_indices;
+    Vector<std::pair<NodeOperationOutput *, int>> fused_input_links;
+    for (NodeOperation *op : chain) {
+      Vector<FusedPixelOperation::MemberInput> inputs;
+      for (int i = 0; i < op->get_number_of_input_sockets(); i++) {
+        NodeOperationInput *input = op->get_input_socket(i);
+        NodeOperation *input_op = op->get_input_operation(i);
+        if (const int *member_index = member_indices.lookup_ptr(input_op)) {
+          inputs.append({FusedPixelOperation::MemberInput::Type::Member, *member_index});
+        }
+        else {
+          const int fused_input = fused_op->add_fused_input(input->get_data_type());
+          fused_input_links.append({input->get_link(), fused_input});
+          inputs.append({FusedPixelOperation::MemberInput::Type::FusedInput, fused_input});
+        }
+      }
+      BLI_assert(dynamic_cast<MultiThreadedOperation *>(op));
+      fused_op->add_member(static_cast<MultiThreadedOperation *>(op), inputs);
+      member_indices.add_new(op, member_indices.size());
+    }
+
+    /* Move the links of the chain to the fused operation. */
+    const Vector<NodeOperationInput *> last_op_users = cache_output_links(
+        last_op->get_output_socket());
+    for (NodeOperation *op : chain) {
+      for (int i = 0; i < op->get_number_of_input_sockets(); i++) {
+        remove_input_link(op->get_input_socket(i));
+      }
+    }
+    for (const std::pair<NodeOperationOutput *, int> &link : fused_input_links) {
+      if (link.first) {
+        add_link(link.first, fused_op->get_input_socket(link.second));
+      }
+    }
+    for (NodeOperationInput *user : last_op_users) {
+      remove_input_link(user);
+      add_link(fused_op->get_output_socket(), user);
+    }
+
+    add_operation(fused_op);
+    fused_op->set_name(last_op->get_name());
+    fused_op->set_node_instance_key(last_op->get_node_instance_key());
+    fused_op->set_canvas(last_op->get_canvas());
+    for (NodeOperation *op : chain) {
+      operations_.remove_first_occurrence_and_reorder(op);
+    }
+  }
+}
+
 Vector<NodeOperationInput *> NodeOperationBuilder::cache_output_links(
     NodeOperationOutput *output) const
 {
@@ -143,6 +143,11 @@ class NodeOperationBuilder {
   /** Merge operations with same type, inputs and parameters that produce the same result. */
   void merge_equal_operations();
   void merge_equal_operations(NodeOperation *from, NodeOperation *into);
+  /**
+   * Replace chains of pixel operations by #FusedPixelOperation, so that intermediate results
+   * don't need full frame buffers.
+   */
+  void fuse_pixel_operations();
   void save_graphviz(StringRefNull name = "");
 #ifdef WITH_CXX_GUARDEDALLOC
   MEM_CXX_CLASS_ALLOC_FUNCS("COM:NodeCompilerImpl")
@@ -0,0 +1,188 @@
+/* SPDX-FileCopyrightText: 2024 Blender Authors
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later */
+
+#include <algorithm>
+#include <cstring>
+
+#include "BLI_ghash.h"
+#include "BLI_rect.h"
+
+#include "DNA_userdef_types.h"
+
+#include "COM_ConstantOperation.h"
+#include "COM_MemoryBuffer.h"
+#include "COM_NodeOperation.h"
+#include "COM_OperationOutputCache.h"
+
+namespace blender::compositor {
+
+uint64_t OperationOutputKey::hash() const
+{
+  /* Combine in order, so that swapped or repeated inputs give different hashes. */
+  uint64_t hash = BLI_ghashutil_combine_hash(type_hash, params_hash);
+  hash = BLI_ghashutil_combine_hash(hash, uint64_t(use_half_precision));
+  for (const uint64_t value : inputs) {
+    hash = BLI_ghashutil_combine_hash(hash, value);
+  }
+  return hash;
+}
+
+int64_t OperationOutputCache::max_size_in_bytes()
+{
+  return int64_t(U.memcachelimit) * 1024 * 1024;
+}
+
+std::optional<OperationOutputKey> OperationOutputCache::compute_key(
+    NodeOperation *op, Map<NodeOperation *, std::optional<OperationOutputKey>> &r_keys)
+{
+  if (const std::optional<OperationOutputKey> *key = r_keys.lookup_ptr(op)) {
+    return *key;
+  }
+
+  std::optional<OperationOutputKey> key;
+  const std::optional<NodeOperationHash> hash = op->get_flags().is_constant_operation ?
+                                                    std::nullopt :
+                                                    op->generate_hash();
+  if (hash) {
+    key.emplace();
+    key->type_hash = hash->get_type_hash();
+    key->params_hash = hash->get_params_hash();
+    key->use_half_precision = use_half_precision_;
+    for (int i = 0; i < op->get_number_of_input_sockets(); i++) {
+      NodeOperation *input_op = op->get_input_operation(i);
+      if (input_op == nullptr) {
+        key = std::nullopt;
+        break;
+      }
+      key->inputs.append(uint64_t(i));
+      if (input_op->get_flags().is_constant_operation &&
+          static_cast<ConstantOperation *>(input_op)->can_get_constant_elem())
+      {
+        const float *elem = static_cast<ConstantOperation *>(input_op)->get_constant_elem();
+        const int num_channels = COM_data_type_num_channels(
+            input_op->get_output_socket()->get_data_type());
+        for (const int channel : IndexRange(num_channels)) {
+          uint32_t bits;
+          memcpy(&bits, &elem[channel], sizeof(bits));
+          key->inputs.append(bits);
+        }
+        continue;
+      }
+      const std::optional<OperationOutputKey> input_key = compute_key(input_op, r_keys);
+      if (!input_key) {
+        key = std::nullopt;
+        break;
+      }
+      key->inputs.append(input_key->hash());
+    }
+  }
+
+  r_keys.add_new(op, key);
+  return key;
+}
+
+void OperationOutputCache::begin_execution(Span<NodeOperation *> operations,
+                                           const bool use_half_precision)
+{
+  executions_num_++;
+  operation_keys_.clear();
+  use_half_precision_ = use_half_precision;
+
+  Map<NodeOperation *, std::optional<OperationOutputKey>> keys;
+  for (NodeOperation *op : operations) {
+    if (std::optional<OperationOutputKey> key = compute_key(op, keys)) {
+      operation_keys_.add_new(op, std::move(*key));
+    }
+  }
+}
+
+void OperationOutputCache::end_execution()
+{
+  operation_keys_.clear();
+  const int64_t max_size = max_size_in_bytes();
+  if (size_in_bytes_ <= max_size) {
+    return;
+  }
+
+  Vector<std::pair<int64_t, const OperationOutputKey *>> outputs_by_use;
+  for (const auto item : outputs_.items()) {
+    outputs_by_use.append({item.value.last_used, &item.key});
+  }
+  std::sort(outputs_by_use.begin(),
+            outputs_by_use.end(),
+            [](const auto &a, const auto &b) { return a.first < b.first; });
+  Vector<OperationOutputKey> keys_to_remove;
+  int64_t remaining_size = size_in_bytes_;
+  for (const std::pair<int64_t, const OperationOutputKey *> &output : outputs_by_use) {
+    if (remaining_size <= max_size) {
+      break;
+    }
+    remaining_size -= outputs_.lookup(*output.second).size_in_bytes;
+    keys_to_remove.append(*output.second);
+  }
+  for (const OperationOutputKey &key : keys_to_remove) {
+    size_in_bytes_ -= outputs_.pop(key).size_in_bytes;
+  }
+}
+
+std::shared_ptr<MemoryBuffer> OperationOutputCache::lookup(const NodeOperation *op,
+                                                           Span<rcti> areas)
+{
+  const OperationOutputKey *key = operation_keys_.lookup_ptr(op);
+  if (key == nullptr) {
+    return nullptr;
+  }
+  CachedOutput *output = outputs_.lookup_ptr(*key);
+  if (output == nullptr) {
+    return nullptr;
+  }
+  for (const rcti &area : areas) {
+    if (BLI_rcti_is_empty(&area)) {
+      continue;
+    }
+    const bool is_rendered = std::any_of(
+        output->render_areas.begin(), output->render_areas.end(), [&](const rcti &rendered) {
+          return BLI_rcti_inside_rcti(&rendered, &area);
+        });
+    if (!is_rendered) {
+      return nullptr;
+    }
+  }
+  output->last_used = executions_num_;
+  return output->buffer;
+}
+
+void OperationOutputCache::add(const NodeOperation *op,
+                               std::shared_ptr<MemoryBuffer> buffer,
+                               Span<rcti> areas)
+{
+  const OperationOutputKey *key = operation_keys_.lookup_ptr(op);
+  if (key == nullptr || !buffer) {
+    return;
+  }
+
+  const int64_t size_in_bytes = buffer->get_data_bytes_len();
+  if (size_in_bytes > max_size_in_bytes()) {
+    return;
+  }
+
+  if (const std::optional<CachedOutput> old_output = outputs_.pop_try(*key)) {
+    size_in_bytes_ -= old_output->size_in_bytes;
+  }
+  CachedOutput output;
+  output.buffer = std::move(buffer);
+  output.render_areas = areas;
+  output.size_in_bytes = size_in_bytes;
+  output.last_used = executions_num_;
+  outputs_.add_new(*key, std::move(output));
+  size_in_bytes_ += size_in_bytes;
+}
+
+void OperationOutputCache::clear()
+{
+  outputs_.clear();
+  size_in_bytes_ = 0;
+}
+
+}  // namespace blender::compositor
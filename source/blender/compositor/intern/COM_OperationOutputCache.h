@@ -0,0 +1,115 @@
+/* SPDX-FileCopyrightText: 2024 Blender Authors
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later */
+
+#pragma once
+
+#include <memory>
+#include <optional>
+
+#include "BLI_map.hh"
+#include "BLI_span.hh"
+#include "BLI_vector.hh"
+
+#include "DNA_vec_types.h"
+
+#ifdef WITH_CXX_GUARDEDALLOC
+#  include "MEM_guardedalloc.h"
+#endif
+
+namespace blender::compositor {
+
+class MemoryBuffer;
+class NodeOperation;
+
+/**
+ * Identifies the output of an operation: its type and parameters, and for every input either the
+ * constant value or the key of the linked operation. The full key is compared on lookup, so
+ * colliding hashes never return the buffer of a different operation.
+ */
+struct OperationOutputKey {
+  uint64_t type_hash;
+  uint64_t params_hash;
+  /** Intermediate buffers are compacted to half precision, so they can't be used for both. */
+  bool use_half_precision;
+  /**
+   * For every input in order: its index, followed by the channels of a constant input or the hash
+   * of the key of the linked operation.
+   */
+  Vector<uint64_t, 16> inputs;
+
+  uint64_t hash() const;
+
+  friend bool operator==(const OperationOutputKey &a, const OperationOutputKey &b)
+  {
+    return a.type_hash == b.type_hash && a.params_hash == b.params_hash &&
+           a.use_half_precision == b.use_half_precision && a.inputs == b.inputs;
+  }
+};
+
+/**
+ * Keeps rendered operation buffers across compositor executions, so that after an edit only the
+ * operations depending on the edited node need to be rendered again.
+ *
+ * Buffers are identified by a key combining the operation type and parameters (see
+ * #NodeOperation::generate_hash) with the keys of its inputs. Operations that don't implement
+ * `hash_output_params`, and all operations depending on them, are not cached. The least recently
+ * used buffers are freed when the cache exceeds its memory budget.
+ */
+class OperationOutputCache {
+ private:
+  struct CachedOutput {
+    std::shared_ptr<MemoryBuffer> buffer;
+    /** Areas of the buffer that were rendered, relative to the buffer rectangle. */
+    Vector<rcti> render_areas;
+    int64_t size_in_bytes;
+    /** Last execution the buffer was used in. */
+    int64_t last_used;
+  };
+
+  Map<OperationOutputKey, CachedOutput> outputs_;
+  int64_t size_in_bytes_ = 0;
+
+  /** Number of executions, used to find the least recently used buffers. */
+  int64_t executions_num_ = 0;
+  /** Keys of the cacheable operations of the current execution. */
+  Map<const NodeOperation *, OperationOutputKey> operation_keys_;
+  /** Precision of the intermediate buffers of the current execution. */
+  bool use_half_precision_ = false;
+
+ public:
+  /**
+   * Compute the keys of the operations about to be executed, whose intermediate buffers are
+   * compacted when \a use_half_precision is set.
+   */
+  void begin_execution(Span<NodeOperation *> operations, bool use_half_precision);
+  /** Free the least recently used buffers until the cache fits in its memory budget. */
+  void end_execution();
+
+  /**
+   * Get the cached buffer of the operation, if all given areas have been rendered into it. Areas
+   * are relative to the buffer rectangle.
+   */
+  std::shared_ptr<MemoryBuffer> lookup(const NodeOperation *op, Span<rcti> areas);
+  /** Store the buffer rendered by the operation, if the operation can be cached. */
+  void add(const NodeOperation *op, std::shared_ptr<MemoryBuffer> buffer, Span<rcti> areas);
+
+  void clear();
+
+  int64_t size_in_bytes() const
+  {
+    return size_in_bytes_;
+  }
+
+ private:
+  std::optional<OperationOutputKey> compute_key(
+      NodeOperation *op, Map<NodeOperation *, std::optional<OperationOutputKey>> &r_keys);
+  /** The memory budget of the cache, from the memory cache limit preference. */
+  static int64_t max_size_in_bytes();
+
+#ifdef WITH_CXX_GUARDEDALLOC
+  MEM_CXX_CLASS_ALLOC_FUNCS("COM:OperationOutputCache")
+#endif
+};
+
+}  // namespace blender::compositor
@@ -4,6 +4,8 @@
 
 #pragma once
 
+#include <memory>
+
 #include "BLI_map.hh"
 #include "BLI_vector.hh"
 
@@ -27,7 +29,8 @@ class SharedOperationBuffers {
   typedef struct BufferData {
    public:
     BufferData();
-    std::unique_ptr<MemoryBuffer> buffer;
+    /** Shared with #OperationOutputCache when the buffer is kept across executions. */
+    std::shared_ptr<MemoryBuffer> buffer;
     blender::Vector<rcti> render_areas;
     int registered_reads;
     int received_reads;
@@ -66,7 +69,7 @@ class SharedOperationBuffers {
   /**
    * Stores given operation rendered buffer.
    */
-  void set_rendered_buffer(NodeOperation *op, std::unique_ptr<MemoryBuffer> buffer);
+  void set_rendered_buffer(NodeOperation *op, std::shared_ptr<MemoryBuffer> buffer);
   /**
    * Get given operation rendered buffer.
    */
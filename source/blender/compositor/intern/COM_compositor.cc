@@ -13,6 +13,8 @@
 #include "BKE_scene.hh"
 
 #include "COM_ExecutionSystem.h"
+#include "COM_FFTConvolution.h"
+#include "COM_OperationOutputCache.h"
 #include "COM_WorkScheduler.h"
 #include "COM_compositor.hh"
 
@@ -21,6 +23,8 @@
 static struct {
   bool is_initialized = false;
   ThreadMutex mutex;
+  /** Operations buffers kept across interactive executions of the CPU compositor. */
+  blender::compositor::OperationOutputCache *output_cache = nullptr;
 } g_compositor;
 
 /* Make sure node tree has previews.
@@ -94,19 +98,42 @@ void COM_execute(Render *render,
 
     /* Execute. */
     const bool is_rendering = render_context != nullptr;
-    blender::compositor::ExecutionSystem system(
-        render_data, scene, node_tree, is_rendering, view_name, render_context, profiler);
+    if (!is_rendering && g_compositor.output_cache == nullptr) {
+      g_compositor.output_cache = new blender::compositor::OperationOutputCache();
+    }
+    blender::compositor::ExecutionSystem system(render_data,
+                                                scene,
+                                                node_tree,
+                                                is_rendering,
+                                                view_name,
+                                                render_context,
+                                                profiler,
+                                                is_rendering ? nullptr : g_compositor.output_cache);
     system.execute();
   }
 
   BLI_mutex_unlock(&g_compositor.mutex);
 }
 
+void COM_clear_caches()
+{
+  if (g_compositor.is_initialized) {
+    BLI_mutex_lock(&g_compositor.mutex);
+    if (g_compositor.output_cache) {
+      g_compositor.output_cache->clear();
+    }
+    BLI_mutex_unlock(&g_compositor.mutex);
+  }
+}
+
 void COM_deinitialize()
 {
   if (g_compositor.is_initialized) {
     BLI_mutex_lock(&g_compositor.mutex);
     blender::compositor::WorkScheduler::deinitialize();
+    delete g_compositor.output_cache;
+    g_compositor.output_cache = nullptr;
+    blender::compositor::FFTConvolution::free_plans();
     g_compositor.is_initialized = false;
     BLI_mutex_unlock(&g_compositor.mutex);
     BLI_mutex_end(&g_compositor.mutex);
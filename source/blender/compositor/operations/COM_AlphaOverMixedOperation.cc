@@ -12,6 +12,12 @@ AlphaOverMixedOperation::AlphaOverMixedOperation()
   flags_.can_be_constant = true;
 }
 
+void AlphaOverMixedOperation::hash_output_params()
+{
+  MixBaseOperation::hash_output_params();
+  hash_param(x_);
+}
+
 void AlphaOverMixedOperation::update_memory_buffer_row(PixelCursor &p)
 {
   for (; p.out < p.row_end; p.next()) {
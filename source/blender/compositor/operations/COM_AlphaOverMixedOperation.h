@@ -27,6 +27,7 @@ class AlphaOverMixedOperation : public MixBaseOperation {
     x_ = x;
   }
 
+  void hash_output_params() override;
   void update_memory_buffer_row(PixelCursor &p) override;
 };
 
@@ -2,11 +2,13 @@
  *
  * SPDX-License-Identifier: GPL-2.0-or-later */
 
+#include "BLI_array.hh"
 #include "BLI_math_vector.h"
 #include "BLI_math_vector.hh"
 
 #include "COM_BokehBlurOperation.h"
 #include "COM_ConstantOperation.h"
+#include "COM_FFTConvolution.h"
 
 namespace blender::compositor {
 
@@ -29,6 +31,7 @@ BokehBlurOperation::BokehBlurOperation()
   sizeavailable_ = false;
 
   extend_bounds_ = false;
+  is_filtered_in_frequency_domain_ = false;
 }
 
 void BokehBlurOperation::init_data()
@@ -96,6 +99,51 @@ void BokehBlurOperation::get_area_of_interest(const int input_idx,
   }
 }
 
+/* Get the bokeh weight of the pixel at the given offset from the blurred pixel. */
+static float4 get_bokeh_weight(const MemoryBuffer *bokeh_input,
+                               const int2 offset,
+                               const int radius)
+{
+  const int2 bokeh_size = int2(bokeh_input->get_width(), bokeh_input->get_height());
+  const float2 normalized_texel = (float2(offset) + radius + 0.5f) / (radius * 2.0f + 1.0f);
+  const float2 weight_texel = (1.0f - normalized_texel) * float2(bokeh_size - 1);
+  return bokeh_input->get_elem(int(weight_texel.x), int(weight_texel.y));
+}
+
+void BokehBlurOperation::update_memory_buffer_started(MemoryBuffer *output,
+                                                      const rcti &area,
+                                                      Span<MemoryBuffer *> inputs)
+{
+  const float max_dim = std::max(this->get_width(), this->get_height());
+  const int radius = size_ * max_dim / 100.0f;
+  const int2 kernel_size = int2(radius * 2 + 1);
+  is_filtered_in_frequency_domain_ = FFTConvolution::is_faster(kernel_size);
+  if (!is_filtered_in_frequency_domain_) {
+    return;
+  }
+
+  /* Normalize each channel of the kernel, as done by the accumulated weights of the direct
+   * convolution. */
+  const MemoryBuffer *bokeh_input = inputs[BOKEH_INPUT_INDEX];
+  Array<float4> kernel(int64_t(kernel_size.x) * kernel_size.y);
+  float4 weights_sum = float4(0.0f);
+  for (const int yi : IndexRange(kernel_size.y)) {
+    for (const int xi : IndexRange(kernel_size.x)) {
+      const float4 weight = get_bokeh_weight(bokeh_input, int2(xi, yi) - radius, radius);
+      kernel[int64_t(yi) * kernel_size.x + xi] = weight;
+      weights_sum += weight;
+    }
+  }
+  for (float4 &weight : kernel) {
+    weight = math::safe_divide(weight, weights_sum);
+  }
+
+  const FFTConvolution convolution(
+      kernel.as_span().cast<float>(), kernel_size, 4, int2(get_width(), get_height()));
+  convolution.filter(
+      *inputs[IMAGE_INPUT_INDEX], *output, area, 4, FFTConvolution::Boundary::Extend);
+}
+
 void BokehBlurOperation::update_memory_buffer_partial(MemoryBuffer *output,
                                                       const rcti &area,
                                                       Span<MemoryBuffer *> inputs)
@@ -105,7 +153,6 @@ void BokehBlurOperation::update_memory_buffer_partial(MemoryBuffer *output,
 
   const MemoryBuffer *image_input = inputs[IMAGE_INPUT_INDEX];
   const MemoryBuffer *bokeh_input = inputs[BOKEH_INPUT_INDEX];
-  const int2 bokeh_size = int2(bokeh_input->get_width(), bokeh_input->get_height());
   MemoryBuffer *bounding_input = inputs[BOUNDING_BOX_INPUT_INDEX];
   BuffersIterator<float> it = output->iterate_with({bounding_input}, area);
   for (; !it.is_end(); ++it) {
@@ -116,14 +163,15 @@ void BokehBlurOperation::update_memory_buffer_partial(MemoryBuffer *output,
       image_input->read_elem(x, y, it.out);
       continue;
     }
+    if (is_filtered_in_frequency_domain_) {
+      continue;
+    }
 
     float4 accumulated_color = float4(0.0f);
     float4 accumulated_weight = float4(0.0f);
     for (int yi = -radius; yi <= radius; ++yi) {
       for (int xi = -radius; xi <= radius; ++xi) {
-        const float2 normalized_texel = (float2(xi, yi) + radius + 0.5f) / (radius * 2.0f + 1.0f);
-        const float2 weight_texel = (1.0f - normalized_texel) * float2(bokeh_size - 1);
-        const float4 weight = bokeh_input->get_elem(int(weight_texel.x), int(weight_texel.y));
+        const float4 weight = get_bokeh_weight(bokeh_input, int2(xi, yi), radius);
         const float4 color = float4(image_input->get_elem_clamped(x + xi, y + yi)) * weight;
         accumulated_color += color;
         accumulated_weight += weight;
@@ -16,6 +16,7 @@ BrightnessOperation::BrightnessOperation()
   this->add_output_socket(DataType::Color);
   use_premultiply_ = false;
   flags_.can_be_constant = true;
+  flags_.is_pixel_operation = true;
 }
 
 void BrightnessOperation::set_use_premultiply(bool use_premultiply)
@@ -23,6 +24,11 @@ void BrightnessOperation::set_use_premultiply(bool use_premultiply)
   use_premultiply_ = use_premultiply;
 }
 
+void BrightnessOperation::hash_output_params()
+{
+  hash_param(use_premultiply_);
+}
+
 void BrightnessOperation::update_memory_buffer_partial(MemoryBuffer *output,
                                                        const rcti &area,
                                                        Span<MemoryBuffer *> inputs)
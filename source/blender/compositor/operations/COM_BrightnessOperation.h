@@ -17,6 +17,7 @@ class BrightnessOperation : public MultiThreadedOperation {
 
   void set_use_premultiply(bool use_premultiply);
 
+  void hash_output_params() override;
   void update_memory_buffer_partial(MemoryBuffer *output,
                                     const rcti &area,
                                     Span<MemoryBuffer *> inputs) override;
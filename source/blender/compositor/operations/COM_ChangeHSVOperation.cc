@@ -14,8 +14,11 @@ ChangeHSVOperation::ChangeHSVOperation()
   this->add_input_socket(DataType::Value);
   this->add_output_socket(DataType::Color);
   flags_.can_be_constant = true;
+  flags_.is_pixel_operation = true;
 }
 
+void ChangeHSVOperation::hash_output_params() {}
+
 void ChangeHSVOperation::update_memory_buffer_partial(MemoryBuffer *output,
                                                       const rcti &area,
                                                       Span<MemoryBuffer *> inputs)
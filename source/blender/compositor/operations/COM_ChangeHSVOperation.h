@@ -16,6 +16,7 @@ class ChangeHSVOperation : public MultiThreadedOperation {
  public:
   ChangeHSVOperation();
 
+  void hash_output_params() override;
   void update_memory_buffer_partial(MemoryBuffer *output,
                                     const rcti &area,
                                     Span<MemoryBuffer *> inputs) override;
@@ -27,6 +27,13 @@ ColorBalanceASCCDLOperation::ColorBalanceASCCDLOperation()
   flags_.can_be_constant = true;
 }
 
+void ColorBalanceASCCDLOperation::hash_output_params()
+{
+  hash_params(offset_[0], offset_[1], offset_[2]);
+  hash_params(power_[0], power_[1], power_[2]);
+  hash_params(slope_[0], slope_[1], slope_[2]);
+}
+
 void ColorBalanceASCCDLOperation::update_memory_buffer_row(PixelCursor &p)
 {
   for (; p.out < p.row_end; p.next()) {
@@ -34,6 +34,7 @@ class ColorBalanceASCCDLOperation : public MultiThreadedRowOperation {
     copy_v3_v3(slope_, slope);
   }
 
+  void hash_output_params() override;
   void update_memory_buffer_row(PixelCursor &p) override;
 };
 
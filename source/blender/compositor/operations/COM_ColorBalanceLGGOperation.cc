@@ -34,6 +34,13 @@ ColorBalanceLGGOperation::ColorBalanceLGGOperation()
   flags_.can_be_constant = true;
 }
 
+void ColorBalanceLGGOperation::hash_output_params()
+{
+  hash_params(gain_[0], gain_[1], gain_[2]);
+  hash_params(lift_[0], lift_[1], lift_[2]);
+  hash_params(gamma_inv_[0], gamma_inv_[1], gamma_inv_[2]);
+}
+
 void ColorBalanceLGGOperation::update_memory_buffer_row(PixelCursor &p)
 {
   for (; p.out < p.row_end; p.next()) {
@@ -34,6 +34,7 @@ class ColorBalanceLGGOperation : public MultiThreadedRowOperation {
     copy_v3_v3(gamma_inv_, gamma_inv);
   }
 
+  void hash_output_params() override;
   void update_memory_buffer_row(PixelCursor &p) override;
 };
 
@@ -20,6 +20,12 @@ ColorBalanceWhitepointOperation::ColorBalanceWhitepointOperation()
   flags_.can_be_constant = true;
 }
 
+void ColorBalanceWhitepointOperation::hash_output_params()
+{
+  hash_params(input_temperature_, input_tint_);
+  hash_params(output_temperature_, output_tint_);
+}
+
 void ColorBalanceWhitepointOperation::init_execution()
 {
   float3x3 scene_to_xyz = IMB_colormanagement_get_scene_linear_to_xyz();
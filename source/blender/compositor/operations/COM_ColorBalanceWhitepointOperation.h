@@ -20,6 +20,7 @@ class ColorBalanceWhitepointOperation : public MultiThreadedRowOperation {
  public:
   ColorBalanceWhitepointOperation();
 
+  void hash_output_params() override;
   virtual void init_execution() override;
 
   void set_parameters(const float input_temperature,
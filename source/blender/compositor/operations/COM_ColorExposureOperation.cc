@@ -14,6 +14,8 @@ ExposureOperation::ExposureOperation()
   flags_.can_be_constant = true;
 }
 
+void ExposureOperation::hash_output_params() {}
+
 void ExposureOperation::update_memory_buffer_row(PixelCursor &p)
 {
   for (; p.out < p.row_end; p.next()) {
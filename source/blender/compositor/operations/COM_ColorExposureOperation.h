@@ -12,6 +12,7 @@ class ExposureOperation : public MultiThreadedRowOperation {
  public:
   ExposureOperation();
 
+  void hash_output_params() override;
   void update_memory_buffer_row(PixelCursor &p) override;
 };
 
@@ -13,6 +13,7 @@ namespace blender::compositor {
 ConvertBaseOperation::ConvertBaseOperation()
 {
   flags_.can_be_constant = true;
+  flags_.is_pixel_operation = true;
 }
 
 void ConvertBaseOperation::hash_output_params() {}
@@ -371,6 +372,12 @@ SeparateChannelOperation::SeparateChannelOperation()
   this->add_input_socket(DataType::Color);
   this->add_output_socket(DataType::Value);
   flags_.can_be_constant = true;
+  flags_.is_pixel_operation = true;
+}
+
+void SeparateChannelOperation::hash_output_params()
+{
+  hash_param(channel_);
 }
 
 void SeparateChannelOperation::update_memory_buffer_partial(MemoryBuffer *output,
@@ -394,8 +401,11 @@ CombineChannelsOperation::CombineChannelsOperation()
   this->set_canvas_input_index(0);
 
   flags_.can_be_constant = true;
+  flags_.is_pixel_operation = true;
 }
 
+void CombineChannelsOperation::hash_output_params() {}
+
 void CombineChannelsOperation::update_memory_buffer_partial(MemoryBuffer *output,
                                                             const rcti &area,
                                                             Span<MemoryBuffer *> inputs)
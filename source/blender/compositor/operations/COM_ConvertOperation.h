@@ -188,6 +188,7 @@ class SeparateChannelOperation : public MultiThreadedOperation {
     channel_ = channel;
   }
 
+  void hash_output_params() override;
   void update_memory_buffer_partial(MemoryBuffer *output,
                                     const rcti &area,
                                     Span<MemoryBuffer *> inputs) override;
@@ -197,6 +198,7 @@ class CombineChannelsOperation : public MultiThreadedOperation {
  public:
   CombineChannelsOperation();
 
+  void hash_output_params() override;
   void update_memory_buffer_partial(MemoryBuffer *output,
                                     const rcti &area,
                                     Span<MemoryBuffer *> inputs) override;
@@ -12,6 +12,7 @@ CurveBaseOperation::CurveBaseOperation()
 {
   curve_mapping_ = nullptr;
   flags_.can_be_constant = true;
+  flags_.is_pixel_operation = true;
 }
 
 CurveBaseOperation::~CurveBaseOperation()
@@ -0,0 +1,134 @@
+/* SPDX-FileCopyrightText: 2024 Blender Authors
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later */
+
+#include "BLI_array.hh"
+
+#include "COM_FusedPixelOperation.h"
+
+namespace blender::compositor {
+
+FusedPixelOperation::FusedPixelOperation(const DataType output_data_type)
+{
+  this->add_output_socket(output_data_type);
+}
+
+FusedPixelOperation::~FusedPixelOperation()
+{
+  for (Member &member : members_) {
+    delete member.operation;
+  }
+}
+
+int FusedPixelOperation::add_fused_input(const DataType data_type)
+{
+  this->add_input_socket(data_type, ResizeMode::None);
+  return this->get_number_of_input_sockets() - 1;
+}
+
+void FusedPixelOperation::add_member(MultiThreadedOperation *operation,
+                                     Span<MemberInput> inputs)
+{
+  BLI_assert(operation->get_flags().is_pixel_operation);
+  BLI_assert(inputs.size() == operation->get_number_of_input_sockets());
+#ifndef NDEBUG
+  for (const MemberInput &input : inputs) {
+    BLI_assert(input.type != MemberInput::Type::Member || input.index < members_.size());
+  }
+#endif
+
+  Member member;
+  member.operation = operation;
+  member.inputs = inputs;
+  member.num_channels = COM_data_type_num_channels(
+      operation->get_output_socket()->get_data_type());
+  members_.append(std::move(member));
+}
+
+void FusedPixelOperation::init_data()
+{
+  for (Member &member : members_) {
+    member.operation->init_data();
+  }
+}
+
+void FusedPixelOperation::init_execution()
+{
+  for (Member &member : members_) {
+    member.operation->init_execution();
+  }
+}
+
+void FusedPixelOperation::deinit_execution()
+{
+  for (Member &member : members_) {
+    member.operation->deinit_execution();
+  }
+}
+
+void FusedPixelOperation::hash_output_params()
+{
+  for (Member &member : members_) {
+    const std::optional<NodeOperationHash> member_hash = member.operation->generate_hash();
+    if (!member_hash) {
+      NodeOperation::hash_output_params();
+      return;
+    }
+    hash_param(member_hash->get_operation_hash());
+    for (const MemberInput &input : member.inputs) {
+      hash_params(input.type, input.index);
+    }
+  }
+}
+
+void FusedPixelOperation::update_memory_buffer_partial(MemoryBuffer *output,
+                                                       const rcti &area,
+                                                       Span<MemoryBuffer *> inputs)
+{
+  BLI_assert(!members_.is_empty());
+  const int width = BLI_rcti_size_x(&area);
+  const int height = BLI_rcti_size_y(&area);
+  if (width <= 0 || height <= 0) {
+    return;
+  }
+
+  /* Every member except the last one needs a buffer for its result, sized for a block of rows. */
+  const Span<Member> intermediate_members = members_.as_span().drop_back(1);
+  int64_t row_floats_num = 0;
+  for (const Member &member : intermediate_members) {
+    row_floats_num += int64_t(member.num_channels) * width;
+  }
+  const int block_height = std::clamp(
+      int(block_floats_num / std::max<int64_t>(row_floats_num, 1)), 1, height);
+  Array<float> block_data(row_floats_num * block_height);
+
+  Array<std::unique_ptr<MemoryBuffer>> results(intermediate_members.size());
+  Vector<MemoryBuffer *> member_inputs;
+  for (int ymin = area.ymin; ymin < area.ymax; ymin += block_height) {
+    rcti block;
+    BLI_rcti_init(&block, area.xmin, area.xmax, ymin, std::min(ymin + block_height, area.ymax));
+
+    float *data = block_data.data();
+    for (const int i : members_.index_range()) {
+      const Member &member = members_[i];
+
+      member_inputs.clear();
+      for (const MemberInput &input : member.inputs) {
+        member_inputs.append(input.type == MemberInput::Type::FusedInput ?
+                                 inputs[input.index] :
+                                 results[input.index].get());
+      }
+
+      MemoryBuffer *result = output;
+      if (i < intermediate_members.size()) {
+        results[i] = std::make_unique<MemoryBuffer>(data, member.num_channels, block);
+        data += int64_t(member.num_channels) * width * BLI_rcti_size_y(&block);
+        result = results[i].get();
+      }
+
+      member.operation->update_memory_buffer_partial(result, block, member_inputs);
+    }
+  }
+}
+
+}  // namespace blender::compositor
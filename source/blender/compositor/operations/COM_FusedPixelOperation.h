@@ -0,0 +1,74 @@
+/* SPDX-FileCopyrightText: 2024 Blender Authors
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later */
+
+#pragma once
+
+#include "COM_MultiThreadedOperation.h"
+
+namespace blender::compositor {
+
+/**
+ * Chain of pixel operations (see #NodeOperationFlags::is_pixel_operation) evaluated as a single
+ * operation. Areas are evaluated in blocks of rows small enough for the intermediate results of
+ * all member operations to stay in cache, so only the result of the last member is written to a
+ * full frame buffer.
+ */
+class FusedPixelOperation : public MultiThreadedOperation {
+ public:
+  /** Where a member operation reads one of its inputs from. */
+  struct MemberInput {
+    enum class Type {
+      /** Input socket of the fused operation. */
+      FusedInput,
+      /** Result of a previously added member operation. */
+      Member,
+    };
+    Type type;
+    int index;
+  };
+
+  /** Number of floats of intermediate results to evaluate at once for each block of rows. */
+  static constexpr int64_t block_floats_num = 32 * 1024;
+
+ private:
+  struct Member {
+    MultiThreadedOperation *operation;
+    Vector<MemberInput> inputs;
+    int num_channels;
+  };
+
+  /** Member operations in execution order, the last one writes to the output buffer. */
+  Vector<Member> members_;
+
+ public:
+  FusedPixelOperation(DataType output_data_type);
+  ~FusedPixelOperation();
+
+  /** Add an input socket to the fused operation, returning its index. */
+  int add_fused_input(DataType data_type);
+
+  /**
+   * Add an operation to evaluate after all previously added ones. Takes ownership of the
+   * operation. \a inputs must have an item for every input socket of the operation.
+   */
+  void add_member(MultiThreadedOperation *operation, Span<MemberInput> inputs);
+
+  int get_number_of_members() const
+  {
+    return members_.size();
+  }
+
+  void init_data() override;
+  void init_execution() override;
+  void deinit_execution() override;
+
+  void update_memory_buffer_partial(MemoryBuffer *output,
+                                    const rcti &area,
+                                    Span<MemoryBuffer *> inputs) override;
+
+ protected:
+  void hash_output_params() override;
+};
+
+}  // namespace blender::compositor
@@ -14,6 +14,8 @@ GammaOperation::GammaOperation()
   flags_.can_be_constant = true;
 }
 
+void GammaOperation::hash_output_params() {}
+
 void GammaOperation::update_memory_buffer_row(PixelCursor &p)
 {
   for (; p.out < p.row_end; p.next()) {
@@ -12,6 +12,7 @@ class GammaOperation : public MultiThreadedRowOperation {
  public:
   GammaOperation();
 
+  void hash_output_params() override;
   void update_memory_buffer_row(PixelCursor &p) override;
 };
 
@@ -7,6 +7,7 @@
 #include "BLI_index_range.hh"
 #include "BLI_math_vector.hh"
 
+#include "COM_FFTConvolution.h"
 #include "COM_GaussianBokehBlurOperation.h"
 
 #include "RE_pipeline.h"
@@ -16,6 +17,7 @@ namespace blender::compositor {
 GaussianBokehBlurOperation::GaussianBokehBlurOperation() : BlurBaseOperation(DataType::Color)
 {
   gausstab_ = nullptr;
+  is_filtered_in_frequency_domain_ = false;
 }
 
 void GaussianBokehBlurOperation::init_data()
@@ -112,10 +114,35 @@ void GaussianBokehBlurOperation::get_area_of_interest(const int input_idx,
   r_input_area.ymin = output_area.ymin - rady_;
 }
 
+void GaussianBokehBlurOperation::update_memory_buffer_started(MemoryBuffer *output,
+                                                              const rcti &area,
+                                                              Span<MemoryBuffer *> inputs)
+{
+  const int2 kernel_size = int2(radx_ * 2 + 1, rady_ * 2 + 1);
+  is_filtered_in_frequency_domain_ = gausstab_ != nullptr &&
+                                     FFTConvolution::is_faster(kernel_size);
+  if (!is_filtered_in_frequency_domain_) {
+    return;
+  }
+
+  /* Pixels outside the input don't contribute and the weights are normalized by the ones of
+   * pixels inside, as done by the direct convolution. */
+  const FFTConvolution convolution(Span<float>(gausstab_, int64_t(kernel_size.x) * kernel_size.y),
+                                   kernel_size,
+                                   1,
+                                   int2(get_width(), get_height()));
+  convolution.filter(
+      *inputs[IMAGE_INPUT_INDEX], *output, area, 4, FFTConvolution::Boundary::Normalize);
+}
+
 void GaussianBokehBlurOperation::update_memory_buffer_partial(MemoryBuffer *output,
                                                               const rcti &area,
                                                               Span<MemoryBuffer *> inputs)
 {
+  if (is_filtered_in_frequency_domain_) {
+    return;
+  }
+
   const MemoryBuffer *input = inputs[IMAGE_INPUT_INDEX];
   BuffersIterator<float> it = output->iterate_with({}, area);
   const rcti &input_rect = input->get_rect();
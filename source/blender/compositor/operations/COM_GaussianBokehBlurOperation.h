@@ -17,6 +17,8 @@ class GaussianBokehBlurOperation : public BlurBaseOperation {
   int radx_, rady_;
   float radxf_;
   float radyf_;
+  /** Whether the image was filtered in the frequency domain for the whole area. */
+  bool is_filtered_in_frequency_domain_;
   void update_gauss();
 
  public:
@@ -26,6 +28,9 @@ class GaussianBokehBlurOperation : public BlurBaseOperation {
   void deinit_execution() override;
 
   void get_area_of_interest(int input_idx, const rcti &output_area, rcti &r_input_area) override;
+  void update_memory_buffer_started(MemoryBuffer *output,
+                                    const rcti &area,
+                                    Span<MemoryBuffer *> inputs) override;
   void update_memory_buffer_partial(MemoryBuffer *output,
                                     const rcti &area,
                                     Span<MemoryBuffer *> inputs) override;
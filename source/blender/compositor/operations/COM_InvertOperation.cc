@@ -15,6 +15,12 @@ InvertOperation::InvertOperation()
   alpha_ = false;
   set_canvas_input_index(1);
   flags_.can_be_constant = true;
+  flags_.is_pixel_operation = true;
+}
+
+void InvertOperation::hash_output_params()
+{
+  hash_params(color_, alpha_);
 }
 
 void InvertOperation::update_memory_buffer_partial(MemoryBuffer *output,
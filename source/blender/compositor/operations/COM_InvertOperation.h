@@ -25,6 +25,7 @@ class InvertOperation : public MultiThreadedOperation {
     alpha_ = alpha;
   }
 
+  void hash_output_params() override;
   void update_memory_buffer_partial(MemoryBuffer *output,
                                     const rcti &area,
                                     Span<MemoryBuffer *> inputs) override;
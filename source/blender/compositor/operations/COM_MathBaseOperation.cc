@@ -18,6 +18,7 @@ MathBaseOperation::MathBaseOperation()
   this->add_output_socket(DataType::Value);
   use_clamp_ = false;
   flags_.can_be_constant = true;
+  flags_.is_pixel_operation = true;
 }
 
 void MathBaseOperation::determine_canvas(const rcti &preferred_area, rcti &r_area)
@@ -35,6 +36,11 @@ void MathBaseOperation::determine_canvas(const rcti &preferred_area, rcti &r_are
   NodeOperation::determine_canvas(preferred_area, r_area);
 }
 
+void MathBaseOperation::hash_output_params()
+{
+  hash_param(use_clamp_);
+}
+
 void MathBaseOperation::update_memory_buffer_partial(MemoryBuffer *output,
                                                      const rcti &area,
                                                      Span<MemoryBuffer *> inputs)
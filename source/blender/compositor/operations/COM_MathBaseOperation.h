@@ -50,6 +50,7 @@ class MathBaseOperation : public MultiThreadedOperation {
                                     Span<MemoryBuffer *> inputs) final;
 
  protected:
+  void hash_output_params() override;
   virtual void update_memory_buffer_partial(BuffersIterator<float> &it) = 0;
 };
 
@@ -19,6 +19,7 @@ MixBaseOperation::MixBaseOperation()
   this->set_use_value_alpha_multiply(false);
   this->set_use_clamp(false);
   flags_.can_be_constant = true;
+  flags_.is_pixel_operation = true;
 }
 
 void MixBaseOperation::determine_canvas(const rcti &preferred_area, rcti &r_area)
@@ -44,6 +45,11 @@ void MixBaseOperation::determine_canvas(const rcti &preferred_area, rcti &r_area
   NodeOperation::determine_canvas(preferred_area, r_area);
 }
 
+void MixBaseOperation::hash_output_params()
+{
+  hash_params(value_alpha_multiply_, use_clamp_);
+}
+
 void MixBaseOperation::update_memory_buffer_partial(MemoryBuffer *output,
                                                     const rcti &area,
                                                     Span<MemoryBuffer *> inputs)
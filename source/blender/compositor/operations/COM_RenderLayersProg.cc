@@ -63,6 +63,32 @@ void RenderLayersProg::deinit_execution()
   }
 }
 
+void RenderLayersProg::hash_output_params()
+{
+  Scene *scene = this->get_scene();
+  Render *re = (scene) ? RE_GetSceneRender(scene) : nullptr;
+  const float *pass_buffer = nullptr;
+  double render_start_time = 0.0;
+
+  if (re) {
+    RenderResult *rr = RE_AcquireResultRead(re);
+    if (rr) {
+      ViewLayer *view_layer = (ViewLayer *)BLI_findlink(&scene->view_layers, get_layer_id());
+      RenderLayer *rl = view_layer ? RE_GetRenderLayer(rr, view_layer->name) : nullptr;
+      if (rl) {
+        pass_buffer = RE_RenderLayerGetPass(rl, pass_name_.c_str(), view_name_);
+      }
+    }
+    render_start_time = RE_GetStats(re)->starttime;
+    RE_ReleaseResult(re);
+  }
+
+  /* The pixels read from the render result don't change until the next render, identify them by
+   * the time that render started and the buffer of the pass. */
+  hash_params(scene ? scene->id.session_uid : 0, layer_id_, pass_name_);
+  hash_params(StringRef(view_name_ ? view_name_ : ""), render_start_time, pass_buffer);
+}
+
 void RenderLayersProg::determine_canvas(const rcti & /*preferred_area*/, rcti &r_area)
 {
   Scene *sce = this->get_scene();
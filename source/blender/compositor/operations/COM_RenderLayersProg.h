@@ -112,6 +112,7 @@ class RenderLayersProg : public MultiThreadedOperation {
 
   std::unique_ptr<MetaData> get_meta_data() override;
 
+  void hash_output_params() override;
   virtual void update_memory_buffer_partial(MemoryBuffer *output,
                                             const rcti &area,
                                             Span<MemoryBuffer *> inputs) override;
@@ -0,0 +1,118 @@
+/* SPDX-FileCopyrightText: 2024 Blender Authors
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later */
+
+#include "testing/testing.h"
+
+#include "BLI_array.hh"
+#include "BLI_rand.hh"
+
+#include "COM_FFTConvolution.h"
+#include "COM_MemoryBuffer.h"
+
+namespace blender::compositor::tests {
+
+#if defined(WITH_FFTW3)
+
+using Boundary = FFTConvolution::Boundary;
+
+/* Filter the image directly, weighting pixels by the kernel value at the same offset. */
+static float4 filter_directly(const MemoryBuffer &image,
+                              Span<float> kernel,
+                              const int2 kernel_size,
+                              const int kernel_channels_num,
+                              const Boundary boundary,
+                              const int x,
+                              const int y)
+{
+  const rcti &rect = image.get_rect();
+  const int2 radius = kernel_size / 2;
+  float4 result = float4(0.0f);
+  float weights_sum = 0.0f;
+  for (int ky = 0; ky < kernel_size.y; ky++) {
+    for (int kx = 0; kx < kernel_size.x; kx++) {
+      int image_x = x + kx - radius.x;
+      int image_y = y + ky - radius.y;
+      if (boundary == Boundary::Extend) {
+        image_x = math::clamp(image_x, rect.xmin, rect.xmax - 1);
+        image_y = math::clamp(image_y, rect.ymin, rect.ymax - 1);
+      }
+      else if (image_x < rect.xmin || image_x >= rect.xmax || image_y < rect.ymin ||
+               image_y >= rect.ymax)
+      {
+        continue;
+      }
+      const float *elem = image.get_elem(image_x, image_y);
+      const int64_t kernel_index = (int64_t(ky) * kernel_size.x + kx) * kernel_channels_num;
+      for (int channel = 0; channel < 4; channel++) {
+        const int kernel_channel = kernel_channels_num == 1 ? 0 : channel;
+        result[channel] += elem[channel] * kernel[kernel_index + kernel_channel];
+      }
+      weights_sum += kernel[kernel_index];
+    }
+  }
+  return boundary == Boundary::Normalize ? result / weights_sum : result;
+}
+
+static void test_fft_convolution(const int2 kernel_size,
+                                 const int kernel_channels_num,
+                                 const Boundary boundary)
+{
+  RandomNumberGenerator rng(42);
+
+  rcti rect;
+  BLI_rcti_init(&rect, 0, 600, 0, 400);
+  MemoryBuffer image(DataType::Color, rect);
+  for (int y = rect.ymin; y < rect.ymax; y++) {
+    for (int x = rect.xmin; x < rect.xmax; x++) {
+      for (int channel = 0; channel < 4; channel++) {
+        image.get_elem(x, y)[channel] = rng.get_float();
+      }
+    }
+  }
+
+  Array<float> kernel(int64_t(kernel_size.x) * kernel_size.y * kernel_channels_num);
+  for (float &value : kernel) {
+    value = rng.get_float() / float(kernel_size.x * kernel_size.y);
+  }
+
+  const int2 image_size = int2(BLI_rcti_size_x(&rect), BLI_rcti_size_y(&rect));
+  const FFTConvolution convolution(kernel, kernel_size, kernel_channels_num, image_size);
+  /* Filter only part of the image, which still needs pixels of the rest. The area is larger than
+   * the tiles, so it is filtered in several. */
+  rcti area;
+  BLI_rcti_init(&area, 10, 590, 5, 395);
+  MemoryBuffer output(DataType::Color, rect);
+  convolution.filter(image, output, area, 4, boundary);
+
+  /* Compare a subset of the pixels, filtering directly is slow. */
+  for (int y = area.ymin; y < area.ymax; y += 11) {
+    for (int x = area.xmin; x < area.xmax; x += 13) {
+      const float4 expected = filter_directly(
+          image, kernel, kernel_size, kernel_channels_num, boundary, x, y);
+      const float *result = output.get_elem(x, y);
+      for (int channel = 0; channel < 4; channel++) {
+        EXPECT_NEAR(result[channel], expected[channel], 1e-4f);
+      }
+    }
+  }
+}
+
+TEST(FFTConvolution, ExtendBoundary)
+{
+  test_fft_convolution(int2(41, 35), 4, Boundary::Extend);
+}
+
+TEST(FFTConvolution, NormalizeBoundary)
+{
+  test_fft_convolution(int2(35, 51), 1, Boundary::Normalize);
+}
+
+TEST(FFTConvolution, LargeKernel)
+{
+  test_fft_convolution(int2(151, 121), 1, Boundary::Extend);
+}
+
+#endif
+
+}  // namespace blender::compositor::tests
@@ -0,0 +1,68 @@
+/* SPDX-FileCopyrightText: 2024 Blender Authors
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later */
+
+#include "testing/testing.h"
+
+#include "COM_ConvertOperation.h"
+#include "COM_FusedPixelOperation.h"
+#include "COM_MathBaseOperation.h"
+
+namespace blender::compositor::tests {
+
+using MemberInput = FusedPixelOperation::MemberInput;
+
+/* Use an area of more rows than fit in a single block, so that it is evaluated in several
+ * blocks. */
+static const rcti fused_test_area = {0, 256, 0, 300};
+
+static float fused_test_value(const int x, const int y)
+{
+  return float(x) * 0.5f + float(y);
+}
+
+TEST(FusedPixelOperation, MathChain)
+{
+  MemoryBuffer input_a(DataType::Value, fused_test_area);
+  MemoryBuffer input_b(DataType::Value, fused_test_area);
+  for (int y = fused_test_area.ymin; y < fused_test_area.ymax; y++) {
+    for (int x = fused_test_area.xmin; x < fused_test_area.xmax; x++) {
+      *input_a.get_elem(x, y) = fused_test_value(x, y);
+      *input_b.get_elem(x, y) = 2.0f;
+    }
+  }
+
+  /* Evaluate `(a + b) * b` converted to a color. */
+  FusedPixelOperation fused_op(DataType::Color);
+  const int a = fused_op.add_fused_input(DataType::Value);
+  const int b = fused_op.add_fused_input(DataType::Value);
+  fused_op.add_member(new MathAddOperation(),
+                      {{MemberInput::Type::FusedInput, a},
+                       {MemberInput::Type::FusedInput, b},
+                       {MemberInput::Type::FusedInput, b}});
+  fused_op.add_member(new MathMultiplyOperation(),
+                      {{MemberInput::Type::Member, 0},
+                       {MemberInput::Type::FusedInput, b},
+                       {MemberInput::Type::FusedInput, b}});
+  fused_op.add_member(new ConvertValueToColorOperation(), {{MemberInput::Type::Member, 1}});
+  EXPECT_EQ(fused_op.get_number_of_members(), 3);
+  EXPECT_EQ(fused_op.get_number_of_input_sockets(), 2);
+
+  MemoryBuffer output(DataType::Color, fused_test_area);
+  fused_op.init_execution();
+  fused_op.update_memory_buffer_partial(&output, fused_test_area, {&input_a, &input_b});
+  fused_op.deinit_execution();
+
+  for (int y = fused_test_area.ymin; y < fused_test_area.ymax; y++) {
+    for (int x = fused_test_area.xmin; x < fused_test_area.xmax; x++) {
+      const float expected = (fused_test_value(x, y) + 2.0f) * 2.0f;
+      const float *color = output.get_elem(x, y);
+      EXPECT_FLOAT_EQ(color[0], expected);
+      EXPECT_FLOAT_EQ(color[1], expected);
+      EXPECT_FLOAT_EQ(color[2], expected);
+      EXPECT_FLOAT_EQ(color[3], 1.0f);
+    }
+  }
+}
+
+}  // namespace blender::compositor::tests
@@ -0,0 +1,108 @@
+/* SPDX-FileCopyrightText: 2024 Blender Authors
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later */
+
+#include "testing/testing.h"
+
+#include <iostream>
+#include <memory>
+
+#include "BLI_timeit.hh"
+
+#include "COM_MemoryBuffer.h"
+
+// #define DO_PERF_TESTS 1
+
+namespace blender::compositor::tests {
+
+static float compact_test_value(const int x, const int y, const int channel)
+{
+  /* Values exactly representable with half precision. */
+  return float((x + y * 3 + channel) % 1024) * 0.25f;
+}
+
+static void fill_compact_test_buffer(MemoryBuffer &buffer)
+{
+  const rcti &rect = buffer.get_rect();
+  for (int y = rect.ymin; y < rect.ymax; y++) {
+    for (int x = rect.xmin; x < rect.xmax; x++) {
+      float *elem = buffer.get_elem(x, y);
+      for (int channel = 0; channel < buffer.get_num_channels(); channel++) {
+        elem[channel] = compact_test_value(x, y, channel);
+      }
+    }
+  }
+}
+
+TEST(MemoryBuffer, CompactExpand)
+{
+  rcti rect;
+  BLI_rcti_init(&rect, -5, 123, 10, 71);
+  MemoryBuffer buffer(DataType::Color, rect);
+  fill_compact_test_buffer(buffer);
+  const int64_t full_bytes_len = buffer.get_data_bytes_len();
+
+  buffer.compact();
+  EXPECT_TRUE(buffer.is_compact());
+  EXPECT_EQ(buffer.get_data_bytes_len() * 2, full_bytes_len);
+
+  rcti expanded_rect = rect;
+  BLI_rcti_translate(&expanded_rect, 7, -10);
+  std::unique_ptr<MemoryBuffer> expanded(buffer.expand(expanded_rect));
+  EXPECT_FALSE(expanded->is_compact());
+  EXPECT_EQ(expanded->get_rect().xmin, expanded_rect.xmin);
+  EXPECT_EQ(expanded->get_rect().ymin, expanded_rect.ymin);
+  for (int y = rect.ymin; y < rect.ymax; y++) {
+    for (int x = rect.xmin; x < rect.xmax; x++) {
+      const float *elem = expanded->get_elem(x + 7, y - 10);
+      for (int channel = 0; channel < 4; channel++) {
+        EXPECT_EQ(elem[channel], compact_test_value(x, y, channel));
+      }
+    }
+  }
+}
+
+TEST(MemoryBuffer, CompactSingleElem)
+{
+  rcti rect;
+  BLI_rcti_init(&rect, 0, 64, 0, 64);
+  MemoryBuffer buffer(DataType::Value, rect, true);
+  *buffer.get_elem(0, 0) = 0.1f;
+
+  buffer.compact();
+  EXPECT_FALSE(buffer.is_compact());
+  EXPECT_EQ(*buffer.get_elem(10, 10), 0.1f);
+}
+
+#ifdef DO_PERF_TESTS
+
+/* Compares memory usage and conversion throughput of a 4K color buffer with half precision
+ * against copying it with full precision, as done when passing buffers between operations. */
+TEST(MemoryBuffer, CompactBenchmark)
+{
+  rcti rect;
+  BLI_rcti_init(&rect, 0, 3840, 0, 2160);
+  MemoryBuffer buffer(DataType::Color, rect);
+  fill_compact_test_buffer(buffer);
+  const int64_t full_bytes_len = buffer.get_data_bytes_len();
+
+  {
+    SCOPED_TIMER("full precision copy");
+    MemoryBuffer copy(buffer);
+  }
+  {
+    SCOPED_TIMER("compact");
+    buffer.compact();
+  }
+  {
+    SCOPED_TIMER("expand");
+    std::unique_ptr<MemoryBuffer> expanded(buffer.expand(rect));
+  }
+  std::cout << "Full precision: " << full_bytes_len / (1024 * 1024)
+            << " MiB, half precision: " << buffer.get_data_bytes_len() / (1024 * 1024)
+            << " MiB\n";
+}
+
+#endif  // #ifdef DO_PERF_TESTS
+
+}  // namespace blender::compositor::tests
@@ -0,0 +1,174 @@
+/* SPDX-FileCopyrightText: 2024 Blender Authors
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later */
+
+#include "testing/testing.h"
+
+#include "DNA_userdef_types.h"
+
+#include "COM_MemoryBuffer.h"
+#include "COM_NodeOperation.h"
+#include "COM_OperationOutputCache.h"
+
+namespace blender::compositor::tests {
+
+class SourceOperation : public NodeOperation {
+ private:
+  int value_;
+
+ public:
+  SourceOperation(int value, int width, int height) : value_(value)
+  {
+    add_output_socket(DataType::Color);
+    set_canvas({0, width, 0, height});
+  }
+
+  void hash_output_params() override
+  {
+    hash_param(value_);
+  }
+};
+
+class NonHashedSourceOperation : public NodeOperation {
+ public:
+  NonHashedSourceOperation(int width, int height)
+  {
+    add_output_socket(DataType::Color);
+    set_canvas({0, width, 0, height});
+  }
+};
+
+class LinkedOperation : public NodeOperation {
+ public:
+  LinkedOperation(NodeOperation &input)
+  {
+    add_input_socket(DataType::Color);
+    add_output_socket(DataType::Color);
+    set_canvas(input.get_canvas());
+    get_input_socket(0)->set_link(input.get_output_socket());
+  }
+
+  void hash_output_params() override {}
+};
+
+/** Limits the memory budget of the cache to 1 MiB during the tests. */
+class OperationOutputCacheTest : public testing::Test {
+ private:
+  int memcachelimit_;
+
+ protected:
+  void SetUp() override
+  {
+    memcachelimit_ = U.memcachelimit;
+    U.memcachelimit = 1;
+  }
+
+  void TearDown() override
+  {
+    U.memcachelimit = memcachelimit_;
+  }
+};
+
+static std::shared_ptr<MemoryBuffer> create_buffer(const NodeOperation &op)
+{
+  return std::make_shared<MemoryBuffer>(DataType::Color, op.get_canvas());
+}
+
+TEST_F(OperationOutputCacheTest, Hit)
+{
+  OperationOutputCache cache;
+  const rcti area = {0, 16, 0, 16};
+  std::shared_ptr<MemoryBuffer> buffer;
+  {
+    SourceOperation source(1, 16, 16);
+    LinkedOperation linked(source);
+    cache.begin_execution({&source, &linked}, false);
+    EXPECT_EQ(cache.lookup(&linked, {area}), nullptr);
+    buffer = create_buffer(linked);
+    cache.add(&linked, buffer, {area});
+    cache.end_execution();
+  }
+
+  /* Operations of a later execution with the same parameters and inputs use the buffer. */
+  SourceOperation source(1, 16, 16);
+  LinkedOperation linked(source);
+  cache.begin_execution({&source, &linked}, false);
+  EXPECT_EQ(cache.lookup(&linked, {area}), buffer);
+  /* Areas that were not rendered into the buffer. */
+  const rcti larger_area = {0, 16, 0, 32};
+  EXPECT_EQ(cache.lookup(&linked, {larger_area}), nullptr);
+  cache.end_execution();
+}
+
+TEST_F(OperationOutputCacheTest, Miss)
+{
+  OperationOutputCache cache;
+  const rcti area = {0, 16, 0, 16};
+  {
+    SourceOperation source(1, 16, 16);
+    LinkedOperation linked(source);
+    cache.begin_execution({&source, &linked}, false);
+    cache.add(&linked, create_buffer(linked), {area});
+    cache.end_execution();
+  }
+  {
+    /* Changed parameters of an input. */
+    SourceOperation source(2, 16, 16);
+    LinkedOperation linked(source);
+    cache.begin_execution({&source, &linked}, false);
+    EXPECT_EQ(cache.lookup(&linked, {area}), nullptr);
+    cache.end_execution();
+  }
+  {
+    /* Buffers compacted to half precision are not used with full precision. */
+    SourceOperation source(1, 16, 16);
+    LinkedOperation linked(source);
+    cache.begin_execution({&source, &linked}, true);
+    EXPECT_EQ(cache.lookup(&linked, {area}), nullptr);
+    cache.end_execution();
+  }
+  {
+    /* Operations depending on operations without hash are not cached. */
+    NonHashedSourceOperation source(16, 16);
+    LinkedOperation linked(source);
+    cache.begin_execution({&source, &linked}, false);
+    cache.add(&linked, create_buffer(linked), {area});
+    EXPECT_EQ(cache.lookup(&linked, {area}), nullptr);
+    cache.end_execution();
+  }
+}
+
+TEST_F(OperationOutputCacheTest, EvictLeastRecentlyUsed)
+{
+  OperationOutputCache cache;
+  /* Half of the 1 MiB budget for every buffer. */
+  const int width = 128;
+  const int height = 256;
+  const rcti area = {0, width, 0, height};
+  SourceOperation source_a(1, width, height);
+  SourceOperation source_b(2, width, height);
+  SourceOperation source_c(3, width, height);
+
+  cache.begin_execution({&source_a, &source_b}, false);
+  cache.add(&source_a, create_buffer(source_a), {area});
+  cache.add(&source_b, create_buffer(source_b), {area});
+  cache.end_execution();
+  EXPECT_EQ(cache.size_in_bytes(), 1024 * 1024);
+
+  cache.begin_execution({&source_a, &source_c}, false);
+  EXPECT_NE(cache.lookup(&source_a, {area}), nullptr);
+  cache.add(&source_c, create_buffer(source_c), {area});
+  cache.end_execution();
+  EXPECT_EQ(cache.size_in_bytes(), 1024 * 1024);
+
+  cache.begin_execution({&source_a, &source_b, &source_c}, false);
+  EXPECT_NE(cache.lookup(&source_a, {area}), nullptr);
+  EXPECT_EQ(cache.lookup(&source_b, {area}), nullptr);
+  EXPECT_NE(cache.lookup(&source_c, {area}), nullptr);
+  cache.end_execution();
+
+  cache.clear();
+  EXPECT_EQ(cache.size_in_bytes(), 0);
+}
+
+}  // namespace blender::compositor::tests
@@ -196,6 +196,7 @@ class Context : public realtime_compositor::Context {
   {
     switch (get_scene().r.compositor_precision) {
       case SCE_COMPOSITOR_PRECISION_AUTO:
+      case SCE_COMPOSITOR_PRECISION_HALF:
         return realtime_compositor::ResultPrecision::Half;
       case SCE_COMPOSITOR_PRECISION_FULL:
         return realtime_compositor::ResultPrecision::Full;
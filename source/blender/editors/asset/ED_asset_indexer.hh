@@ -18,16 +18,16 @@ namespace blender::ed::asset::index {
  * Opening and parsing a large collection of asset files inside a library can take a lot of time.
  * To reduce the time it takes the files are indexed.
  *
- * - Index files are created for each blend file in the asset library, even when the blend file
- *   doesn't contain any assets.
+ * - A single index file is created for each asset library, it contains the entries of every blend
+ *   file in the library, even when the blend file doesn't contain any assets.
  * - Indexes are stored in an persistent cache folder (`BKE_appdir_folder_caches` +
- *   `asset_library_indexes/{asset_library_dir}/{asset_index_file.json}`).
- * - The content of the indexes are used when:
- *   - Index exists and can be opened
- *   - Last modification date is earlier than the file it represents.
- *   - The index file version is the latest.
- * - Blend files without any assets can be determined by the size of the index file for some
- *   additional performance.
+ *   `asset-library-indices/{asset_library_dir_hash}/library.index`).
+ * - The index file is memory mapped, so only the entries of listed blend files are decoded.
+ * - The content of the index is used for a blend file when:
+ *   - Index exists and has the latest version.
+ *   - The modification time and size of the blend file are the same as when it was indexed.
+ * - Blend files that changed are read again and the index is written with their new entries once
+ *   listing finished. Blend files that don't exist anymore are removed from the index.
  */
 extern const FileIndexerType file_indexer_asset;
 
@@ -6,10 +6,18 @@
  * \ingroup edasset
  */
 
-#include <ctime>
-#include <fstream>
+#include <fcntl.h> /* For open flags (O_BINARY, O_RDONLY). */
 #include <iomanip>
+#include <limits>
+#include <mutex>
 #include <optional>
+#include <sstream>
+
+#ifndef WIN32
+#  include <unistd.h> /* For close. */
+#else
+#  include <io.h> /* For close. */
+#endif
 
 #include "ED_asset_indexer.hh"
 
@@ -19,13 +27,15 @@
 #include "BLI_fileops.h"
 #include "BLI_hash.hh"
 #include "BLI_linklist.h"
+#include "BLI_map.hh"
+#include "BLI_mmap.h"
 #include "BLI_path_utils.hh"
 #include "BLI_serialize.hh"
-#include "BLI_set.hh"
 #include "BLI_string.h"
 #include "BLI_string_ref.hh"
 #include "BLI_string_utf8.h"
 #include "BLI_uuid.h"
+#include "BLI_vector.hh"
 
 #include "AS_asset_catalog.hh"
 #include "BKE_appdir.hh"
@@ -34,8 +44,6 @@
 
 #include "CLG_log.h"
 
-#include <sstream>
-
 static CLG_LogRef LOG = {"ed.asset"};
 
 namespace blender::ed::asset::index {
@@ -47,152 +55,250 @@ using namespace blender::bke::idprop;
 /**
  * \brief Indexer for asset libraries.
  *
- * Indexes are stored per input file. Each index can contain zero to multiple asset entries.
- * The indexes are grouped together per asset library. They are stored in
- * #BKE_appdir_folder_caches +
- * /asset-library-indices/<asset-library-hash>/<asset-index-hash>_<asset_file>.index.json.
+ * The entries of all blend files of an asset library are stored together in a single binary index
+ * file, stored in #BKE_appdir_folder_caches +
+ * /asset-library-indices/<asset-library-hash>/library.index. Each blend file can have zero to
+ * multiple asset entries.
+ *
+ * The index file is memory mapped when listing the library starts, reading the entries of a blend
+ * file only decodes its own entries. Blend files are stored with the modification time and size
+ * they had when they were indexed. Blend files that changed since are read again, and the index is
+ * written again with their new entries when listing finishes.
  *
  * The structure of an index file is
  * \code
- * {
- *   "version": <file version number>,
- *   "entries": [{
- *     "name": "<asset name>",
- *     "catalog_id": "<catalog_id>",
- *     "catalog_name": "<catalog_name>",
- *     "description": "<description>",
- *     "author": "<author>",
- *     "copyright": "<copyright>",
- *     "license": "<license>",
- *     "tags": ["<tag>"],
- *     "properties": [..]
- *   }]
- * }
+ * IndexFileHeader                  "BLASSIDX", <file version number>, <number of files>
+ * IndexFileRecord[number of files] <blend file path>, <mtime>, <size>, <entries location>
+ * <data>                           Paths and entries of the blend files.
  * \endcode
  *
- * NOTE: entries, author, description, copyright, license, tags and properties are optional
- * attributes.
+ * The entries of a blend file are stored one after the other as
+ * \code
+ * int16  idcode
+ * string name
+ * uint8  no_preview_found
+ * bUUID  catalog_id
+ * string catalog_name
+ * string description, author, copyright, license (optional)
+ * uint32 number of tags, followed by the tag strings
+ * string properties (optional, serialized as JSON)
+ * \endcode
  *
- * NOTE: File browser uses name and idcode separate. Inside the index they are joined together like
- * #ID.name.
+ * Strings are stored as their uint32 length followed by their characters, optional strings that
+ * are not set have the length #NULL_STRING_LEN.
+ *
+ * NOTE: File browser uses name and idcode separate. Inside the index they are stored separately
+ * too, the name is stored without the #ID.name prefix.
  * NOTE: File browser group name isn't stored in the index as it is a translatable name.
  */
-constexpr StringRef ATTRIBUTE_VERSION("version");
-constexpr StringRef ATTRIBUTE_ENTRIES("entries");
-constexpr StringRef ATTRIBUTE_ENTRIES_NAME("name");
-constexpr StringRef ATTRIBUTE_ENTRIES_CATALOG_ID("catalog_id");
-constexpr StringRef ATTRIBUTE_ENTRIES_CATALOG_NAME("catalog_name");
-constexpr StringRef ATTRIBUTE_ENTRIES_DESCRIPTION("description");
-constexpr StringRef ATTRIBUTE_ENTRIES_AUTHOR("author");
-constexpr StringRef ATTRIBUTE_ENTRIES_COPYRIGHT("copyright");
-constexpr StringRef ATTRIBUTE_ENTRIES_LICENSE("license");
-constexpr StringRef ATTRIBUTE_ENTRIES_TAGS("tags");
-constexpr StringRef ATTRIBUTE_ENTRIES_PROPERTIES("properties");
-
-/** Abstract class for #BlendFile and #AssetIndexFile. */
-class AbstractFile {
- public:
-  virtual ~AbstractFile() = default;
+constexpr StringRef INDEX_FILE_NAME("library.index");
+constexpr char INDEX_FILE_MAGIC[8] = {'B', 'L', 'A', 'S', 'S', 'I', 'D', 'X'};
+constexpr uint32_t NULL_STRING_LEN = std::numeric_limits<uint32_t>::max();
 
-  virtual const char *get_file_path() const = 0;
+/**
+ * \brief Version to store in new index files.
+ *
+ * When reading the version is checked against `INDEX_FILE_VERSION` to make sure we can use the
+ * index. Developer should increase `INDEX_FILE_VERSION` when changes are made to the structure of
+ * the stored index.
+ */
+constexpr uint32_t INDEX_FILE_VERSION = 2;
 
-  bool exists() const
-  {
-    return BLI_exists(this->get_file_path());
-  }
+struct IndexFileHeader {
+  char magic[8];
+  uint32_t version;
+  uint32_t files_num;
+};
 
-  size_t get_file_size() const
-  {
-    return BLI_file_size(this->get_file_path());
-  }
+struct IndexFileRecord {
+  /** Location of the absolute blend file path in the index file. */
+  uint64_t path_offset;
+  uint64_t path_len;
+  /** Location of the entries of the blend file in the index file. */
+  uint64_t entries_offset;
+  uint64_t entries_size;
+  uint64_t entries_num;
+  /** Modification time and size of the blend file when it was indexed. */
+  int64_t file_mtime;
+  int64_t file_size;
 };
 
 /**
  * \brief Reference to a blend file that can be indexed.
  */
-class BlendFile : public AbstractFile {
+class BlendFile {
   StringRefNull file_path_;
 
  public:
   BlendFile(StringRefNull file_path) : file_path_(file_path) {}
 
-  uint64_t hash() const
+  const char *get_file_path() const
   {
-    DefaultHash<StringRefNull> hasher;
-    return hasher(file_path_);
+    return file_path_.c_str();
   }
+};
+
+/** Modification time and size of a blend file, to detect if its index is outdated. */
+struct BlendFileStat {
+  int64_t mtime = 0;
+  int64_t size = 0;
 
-  std::string get_filename() const
+  static std::optional<BlendFileStat> from_file(const BlendFile &file)
   {
-    char filename[FILE_MAX];
-    BLI_path_split_file_part(this->get_file_path(), filename, sizeof(filename));
-    return std::string(filename);
+    BLI_stat_t stat = {};
+    if (BLI_stat(file.get_file_path(), &stat) == -1) {
+      return std::nullopt;
+    }
+    BlendFileStat result;
+    result.mtime = int64_t(stat.st_mtime);
+    result.size = int64_t(stat.st_size);
+    return result;
   }
 
-  const char *get_file_path() const override
+  friend bool operator==(const BlendFileStat &a, const BlendFileStat &b)
   {
-    return file_path_.c_str();
+    return a.mtime == b.mtime && a.size == b.size;
   }
 };
 
-/**
- * \brief add id + name to the attributes.
- *
- * NOTE: id and name are encoded like #ID.name
- */
-static void add_id_name(DictionaryValue &result, const short idcode, const StringRefNull name)
-{
-  char idcode_prefix[2];
-  /* Similar to `BKE_libblock_alloc`. */
-  *((short *)idcode_prefix) = idcode;
-  std::string name_with_idcode = std::string(idcode_prefix, sizeof(idcode_prefix)) + name;
+/** Appends values to the binary contents of an index file. */
+class BinaryWriter {
+  Vector<char> data_;
 
-  result.append_str(ATTRIBUTE_ENTRIES_NAME, name_with_idcode);
-}
+ public:
+  template<typename T> void write(const T &value)
+  {
+    static_assert(std::is_trivially_copyable_v<T>);
+    data_.extend(Span<char>(reinterpret_cast<const char *>(&value), sizeof(T)));
+  }
 
-static void init_value_from_file_indexer_entry(DictionaryValue &result,
-                                               const FileIndexerEntry *indexer_entry)
-{
-  const BLODataBlockInfo &datablock_info = indexer_entry->datablock_info;
+  void write_str(const StringRef str)
+  {
+    this->write(uint32_t(str.size()));
+    data_.extend(Span<char>(str.data(), str.size()));
+  }
 
-  add_id_name(result, indexer_entry->idcode, datablock_info.name);
+  void write_optional_str(const char *str)
+  {
+    if (str == nullptr) {
+      this->write(NULL_STRING_LEN);
+      return;
+    }
+    this->write_str(str);
+  }
 
-  const AssetMetaData &asset_data = *datablock_info.asset_data;
-  result.append_str(ATTRIBUTE_ENTRIES_CATALOG_ID, CatalogID(asset_data.catalog_id).str());
-  result.append_str(ATTRIBUTE_ENTRIES_CATALOG_NAME, asset_data.catalog_simple_name);
+  void write_bytes(const Span<char> bytes)
+  {
+    data_.extend(bytes);
+  }
 
-  if (const char *description = asset_data.description) {
-    result.append_str(ATTRIBUTE_ENTRIES_DESCRIPTION, description);
+  Span<char> data() const
+  {
+    return data_;
   }
-  if (const char *author = asset_data.author) {
-    result.append_str(ATTRIBUTE_ENTRIES_AUTHOR, author);
+};
+
+/**
+ * Reads values from the binary contents of an index file. Reading past the end of the contents
+ * makes the reader invalid, so corrupted index files are detected instead of read.
+ */
+class BinaryReader {
+  Span<char> data_;
+  int64_t offset_ = 0;
+  bool is_valid_ = true;
+
+ public:
+  BinaryReader(const Span<char> data) : data_(data) {}
+
+  bool is_valid() const
+  {
+    return is_valid_;
   }
-  if (const char *copyright = asset_data.copyright) {
-    result.append_str(ATTRIBUTE_ENTRIES_COPYRIGHT, copyright);
+
+  template<typename T> T read()
+  {
+    static_assert(std::is_trivially_copyable_v<T>);
+    T value{};
+    if (!is_valid_ || offset_ + int64_t(sizeof(T)) > data_.size()) {
+      is_valid_ = false;
+      return value;
+    }
+    memcpy(&value, data_.data() + offset_, sizeof(T));
+    offset_ += sizeof(T);
+    return value;
   }
-  if (const char *license = asset_data.license) {
-    result.append_str(ATTRIBUTE_ENTRIES_LICENSE, license);
+
+  std::optional<std::string> read_optional_str()
+  {
+    const uint32_t len = this->read<uint32_t>();
+    if (!is_valid_ || len == NULL_STRING_LEN) {
+      return std::nullopt;
+    }
+    if (int64_t(len) > data_.size() - offset_) {
+      is_valid_ = false;
+      return std::nullopt;
+    }
+    std::string str(data_.data() + offset_, len);
+    offset_ += len;
+    return str;
   }
 
-  if (!BLI_listbase_is_empty(&asset_data.tags)) {
-    ArrayValue &tags = *result.append_array(ATTRIBUTE_ENTRIES_TAGS);
-    LISTBASE_FOREACH (AssetTag *, tag, &asset_data.tags) {
-      tags.append_str(tag->name);
+  std::string read_str()
+  {
+    std::optional<std::string> str = this->read_optional_str();
+    if (!str) {
+      is_valid_ = false;
+      return {};
     }
+    return *str;
+  }
+};
+
+static void write_file_indexer_entry(BinaryWriter &writer, const FileIndexerEntry *indexer_entry)
+{
+  const BLODataBlockInfo &datablock_info = indexer_entry->datablock_info;
+
+  writer.write(int16_t(indexer_entry->idcode));
+  writer.write_str(datablock_info.name);
+  writer.write(uint8_t(datablock_info.no_preview_found));
+
+  const AssetMetaData &asset_data = *datablock_info.asset_data;
+  writer.write(asset_data.catalog_id);
+  writer.write_str(asset_data.catalog_simple_name);
+
+  writer.write_optional_str(asset_data.description);
+  writer.write_optional_str(asset_data.author);
+  writer.write_optional_str(asset_data.copyright);
+  writer.write_optional_str(asset_data.license);
+
+  writer.write(uint32_t(BLI_listbase_count(&asset_data.tags)));
+  LISTBASE_FOREACH (AssetTag *, tag, &asset_data.tags) {
+    writer.write_str(tag->name);
   }
 
+  std::unique_ptr<Value> properties_value;
   if (const IDProperty *properties = asset_data.properties) {
-    if (std::unique_ptr<Value> value = convert_to_serialize_values(properties)) {
-      result.append(ATTRIBUTE_ENTRIES_PROPERTIES, std::move(value));
-    }
+    properties_value = convert_to_serialize_values(properties);
+  }
+  if (properties_value) {
+    JsonFormatter formatter;
+    std::stringstream ss;
+    formatter.serialize(ss, *properties_value);
+    writer.write_str(ss.str());
+  }
+  else {
+    writer.write(NULL_STRING_LEN);
   }
 }
 
-static void init_value_from_file_indexer_entries(DictionaryValue &result,
-                                                 const FileIndexerEntries &indexer_entries)
+/**
+ * Write the entries of a blend file that are assets.
+ * \return The number of written entries.
+ */
+static int write_file_indexer_entries(BinaryWriter &writer,
+                                      const FileIndexerEntries &indexer_entries)
 {
-  auto entries = std::make_shared<ArrayValue>();
-
+  int entries_num = 0;
   for (LinkNode *ln = indexer_entries.entries; ln; ln = ln->next) {
     const FileIndexerEntry *indexer_entry = static_cast<const FileIndexerEntry *>(ln->link);
     /* We also get non asset types (brushes, work-spaces), when browsing using the asset browser.
@@ -200,107 +306,105 @@ static void init_value_from_file_indexer_entries(DictionaryValue &result,
     if (indexer_entry->datablock_info.asset_data == nullptr) {
       continue;
     }
-    init_value_from_file_indexer_entry(*entries->append_dict(), indexer_entry);
+    write_file_indexer_entry(writer, indexer_entry);
+    entries_num++;
   }
-
-  /* When no entries to index, we should not store the entries attribute as this would make the
-   * size bigger than the #MIN_FILE_SIZE_WITH_ENTRIES. */
-  if (entries->elements().is_empty()) {
-    return;
-  }
-
-  result.append(ATTRIBUTE_ENTRIES, entries);
+  return entries_num;
 }
 
-static void init_indexer_entry_from_value(FileIndexerEntry &indexer_entry,
-                                          const DictionaryValue &entry)
+static void read_indexer_entry(BinaryReader &reader, FileIndexerEntry &indexer_entry)
 {
-  const StringRef idcode_name = *entry.lookup_str(ATTRIBUTE_ENTRIES_NAME);
-
-  indexer_entry.idcode = GS(idcode_name.data());
-
-  idcode_name.substr(2).copy(indexer_entry.datablock_info.name);
+  indexer_entry.idcode = reader.read<int16_t>();
+  STRNCPY(indexer_entry.datablock_info.name, reader.read_str().c_str());
+  indexer_entry.datablock_info.no_preview_found = reader.read<uint8_t>() != 0;
 
   AssetMetaData *asset_data = BKE_asset_metadata_create();
   indexer_entry.datablock_info.asset_data = asset_data;
   indexer_entry.datablock_info.free_asset_data = true;
 
-  if (const std::optional<StringRef> value = entry.lookup_str(ATTRIBUTE_ENTRIES_DESCRIPTION)) {
+  asset_data->catalog_id = reader.read<bUUID>();
+  STRNCPY_UTF8(asset_data->catalog_simple_name, reader.read_str().c_str());
+
+  if (const std::optional<std::string> value = reader.read_optional_str()) {
     asset_data->description = BLI_strdupn(value->data(), value->size());
   }
-  if (const std::optional<StringRef> value = entry.lookup_str(ATTRIBUTE_ENTRIES_AUTHOR)) {
+  if (const std::optional<std::string> value = reader.read_optional_str()) {
     asset_data->author = BLI_strdupn(value->data(), value->size());
   }
-  if (const std::optional<StringRef> value = entry.lookup_str(ATTRIBUTE_ENTRIES_COPYRIGHT)) {
+  if (const std::optional<std::string> value = reader.read_optional_str()) {
     asset_data->copyright = BLI_strdupn(value->data(), value->size());
   }
-  if (const std::optional<StringRef> value = entry.lookup_str(ATTRIBUTE_ENTRIES_LICENSE)) {
+  if (const std::optional<std::string> value = reader.read_optional_str()) {
     asset_data->license = BLI_strdupn(value->data(), value->size());
   }
 
-  const StringRefNull catalog_name = *entry.lookup_str(ATTRIBUTE_ENTRIES_CATALOG_NAME);
-  STRNCPY_UTF8(asset_data->catalog_simple_name, catalog_name.c_str());
-
-  const StringRefNull catalog_id = *entry.lookup_str(ATTRIBUTE_ENTRIES_CATALOG_ID);
-  asset_data->catalog_id = CatalogID(catalog_id);
-
-  if (const ArrayValue *array_value = entry.lookup_array(ATTRIBUTE_ENTRIES_TAGS)) {
-    for (const std::shared_ptr<Value> &item : array_value->elements()) {
-      BKE_asset_metadata_tag_add(asset_data, item->as_string_value()->value().c_str());
-    }
+  const uint32_t tags_num = reader.read<uint32_t>();
+  for (uint32_t i = 0; i < tags_num && reader.is_valid(); i++) {
+    BKE_asset_metadata_tag_add(asset_data, reader.read_str().c_str());
   }
 
-  if (const std::shared_ptr<Value> *value = entry.lookup(ATTRIBUTE_ENTRIES_PROPERTIES)) {
-    asset_data->properties = convert_from_serialize_value(*value->get());
+  if (const std::optional<std::string> value = reader.read_optional_str()) {
+    JsonFormatter formatter;
+    std::stringstream ss(*value);
+    if (std::unique_ptr<Value> properties_value = formatter.deserialize(ss)) {
+      asset_data->properties = convert_from_serialize_value(*properties_value);
+    }
   }
 }
 
-static int init_indexer_entries_from_value(FileIndexerEntries &indexer_entries,
-                                           const DictionaryValue &value)
+/**
+ * Read the entries of a blend file into the given \p indexer_entries.
+ *
+ * \return False when the data is corrupted, no entries are added in that case.
+ */
+static bool read_indexer_entries(const Span<char> data,
+                                 const int64_t entries_num,
+                                 FileIndexerEntries &indexer_entries)
 {
-  const ArrayValue *entries = value.lookup_array(ATTRIBUTE_ENTRIES);
-  BLI_assert(entries != nullptr);
-  if (entries == nullptr) {
-    return 0;
-  }
-
-  int num_entries_read = 0;
-  for (const std::shared_ptr<Value> &element : entries->elements()) {
+  BinaryReader reader(data);
+  FileIndexerEntries read_entries = {nullptr};
+  for (int64_t i = 0; i < entries_num && reader.is_valid(); i++) {
     FileIndexerEntry *entry = static_cast<FileIndexerEntry *>(
         MEM_callocN(sizeof(FileIndexerEntry), __func__));
-    init_indexer_entry_from_value(*entry, *element->as_dictionary_value());
+    read_indexer_entry(reader, *entry);
+    BLI_linklist_prepend(&read_entries.entries, entry);
+  }
 
-    BLI_linklist_prepend(&indexer_entries.entries, entry);
-    num_entries_read += 1;
+  if (!reader.is_valid()) {
+    ED_file_indexer_entries_clear(&read_entries);
+    return false;
   }
 
-  return num_entries_read;
+  while (read_entries.entries) {
+    BLI_linklist_prepend(&indexer_entries.entries, BLI_linklist_pop(&read_entries.entries));
+  }
+  return true;
 }
 
 /**
- * \brief References the asset library directory.
+ * \brief References the asset library directory and its index.
  *
- * The #AssetLibraryIndex instance collects file indices that are existing before the actual
- * reading/updating starts. This way, the reading/updating can tag pre-existing files as used when
- * they are still needed. Remaining ones (indices that are not tagged as used) can be removed once
- * reading finishes.
+ * The #AssetLibraryIndex instance maps the index file that exists before the actual
+ * reading/updating starts. Blend files that are listed are tracked, so the index written after
+ * listing finished only contains the blend files that still exist. Since blend files are listed
+ * in parallel, tracking and updating is protected by a mutex.
  */
 struct AssetLibraryIndex {
-  struct PreexistingFileIndexInfo {
-    bool is_used = false;
+  struct IndexedFile {
+    BlendFileStat stat;
+    /** Entries in the mapped index file. */
+    Span<char> entries_data;
+    int64_t entries_num;
   };
 
-  /**
-   * File indices that are existing already before reading/updating performs changes. The key is
-   * the absolute path. The value can store information like if the index is known to be used.
-   *
-   * Note that when deleting a file index (#delete_index_file()), it's also removed from here,
-   * since it doesn't exist and isn't relevant to keep track of anymore.
-   */
-  Map<std::string /*path*/, PreexistingFileIndexInfo> preexisting_file_indices;
+  struct UpdatedFile {
+    BlendFileStat stat;
+    Vector<char> entries_data;
+    int64_t entries_num;
+  };
 
   /**
-   * \brief Absolute path where the indices of `library` are stored.
+   * \brief Absolute path where the index of `library` is stored.
    *
    * \note includes trailing directory separator.
    */
@@ -308,11 +412,33 @@ struct AssetLibraryIndex {
 
   std::string library_path;
 
+  int index_file_handle = -1;
+  BLI_mmap_file *index_mmap = nullptr;
+
+  /**
+   * Blend files in the index file that existed before reading/updating started. The key is the
+   * absolute path of the blend file. Not changed while listing, so it can be read without lock.
+   */
+  Map<std::string, IndexedFile> indexed_files;
+
+  std::mutex mutex;
+  /** Blend files that were listed and their status when their index was read. */
+  Map<std::string, BlendFileStat> listed_files;
+  /** Blend files that were read because their index didn't exist or was outdated. */
+  Map<std::string, UpdatedFile> updated_files;
+  /** Set when the whole library was listed, unlisted blend files can be removed from the index. */
+  bool listing_finished = false;
+
   AssetLibraryIndex(const StringRef library_path) : library_path(library_path)
   {
     this->init_indices_base_path();
   }
 
+  ~AssetLibraryIndex()
+  {
+    this->close_index_file();
+  }
+
   uint64_t hash() const
   {
     return get_default_hash(this->library_path);
@@ -343,303 +469,215 @@ struct AssetLibraryIndex {
   }
 
   /**
-   * \return absolute path to the index file of the given `asset_file`.
+   * \return absolute path to the index file of the library.
    *
-   * `{indices_base_path}/{asset-file_hash}_{asset-file-filename}.index.json`.
+   * `{indices_base_path}/library.index`.
    */
-  std::string index_file_path(const BlendFile &asset_file) const
+  std::string index_file_path() const
   {
-    std::stringstream ss;
-    ss << this->indices_base_path;
-    ss << std::setfill('0') << std::setw(16) << std::hex << asset_file.hash() << "_"
-       << asset_file.get_filename() << ".index.json";
-    return ss.str();
+    return this->indices_base_path + INDEX_FILE_NAME;
   }
 
   /**
-   * Check for pre-existing index files to be able to track what is still used and what can be
-   * removed. See #AssetLibraryIndex::preexisting_file_indices.
+   * Map the index file and collect the blend files it contains. Index files that are corrupted or
+   * have a different version are ignored, they are replaced when the index is written.
    */
-  void collect_preexisting_file_indices()
+  void open_index_file()
   {
-    const char *index_path = this->indices_base_path.c_str();
-    if (!BLI_is_dir(index_path)) {
+    const std::string index_path = this->index_file_path();
+    if (!BLI_exists(index_path.c_str())) {
       return;
     }
-    direntry *dir_entries = nullptr;
-    const int dir_entries_num = BLI_filelist_dir_contents(index_path, &dir_entries);
-    for (int i = 0; i < dir_entries_num; i++) {
-      direntry *entry = &dir_entries[i];
-      if (BLI_str_endswith(entry->relname, ".index.json")) {
-        this->preexisting_file_indices.add_as(std::string(entry->path));
-      }
+    this->index_file_handle = BLI_open(index_path.c_str(), O_BINARY | O_RDONLY, 0);
+    if (this->index_file_handle == -1) {
+      return;
+    }
+    this->index_mmap = BLI_mmap_open(this->index_file_handle);
+    if (this->index_mmap == nullptr) {
+      this->close_index_file();
+      return;
     }
 
-    BLI_filelist_free(dir_entries, dir_entries_num);
-  }
+    const Span<char> data(static_cast<const char *>(BLI_mmap_get_pointer(this->index_mmap)),
+                          int64_t(BLI_mmap_get_length(this->index_mmap)));
+    BinaryReader reader(data);
+    const IndexFileHeader header = reader.read<IndexFileHeader>();
+    if (!reader.is_valid() || memcmp(header.magic, INDEX_FILE_MAGIC, sizeof(header.magic)) != 0) {
+      CLOG_INFO(&LOG,
+                3,
+                "Asset library index is ignored; not an index file [%s].",
+                index_path.c_str());
+      this->close_index_file();
+      return;
+    }
+    if (header.version != INDEX_FILE_VERSION) {
+      CLOG_INFO(&LOG,
+                3,
+                "Asset library index is ignored; expected version %u but file is version %u [%s].",
+                INDEX_FILE_VERSION,
+                header.version,
+                index_path.c_str());
+      this->close_index_file();
+      return;
+    }
 
-  void mark_as_used(const std::string &filename)
-  {
-    PreexistingFileIndexInfo *preexisting = this->preexisting_file_indices.lookup_ptr(filename);
-    if (preexisting) {
-      preexisting->is_used = true;
+    for (uint32_t i = 0; i < header.files_num; i++) {
+      const IndexFileRecord record = reader.read<IndexFileRecord>();
+      if (!reader.is_valid() || record.path_offset + record.path_len > uint64_t(data.size()) ||
+          record.entries_offset + record.entries_size > uint64_t(data.size()))
+      {
+        CLOG_INFO(&LOG,
+                  3,
+                  "Asset library index is ignored; file is corrupted [%s].",
+                  index_path.c_str());
+        this->indexed_files.clear();
+        this->close_index_file();
+        return;
+      }
+      IndexedFile indexed_file;
+      indexed_file.stat.mtime = record.file_mtime;
+      indexed_file.stat.size = record.file_size;
+      indexed_file.entries_data = data.slice(record.entries_offset, record.entries_size);
+      indexed_file.entries_num = int64_t(record.entries_num);
+      this->indexed_files.add_overwrite(
+          std::string(data.data() + record.path_offset, record.path_len), indexed_file);
     }
   }
 
-  /**
-   * Removes the file index from disk and #preexisting_file_indices (invalidating its iterators, so
-   * don't call while iterating).
-   * \return true if deletion was successful.
-   */
-  bool delete_file_index(const std::string &filename)
+  void close_index_file()
   {
-    if (BLI_delete(filename.c_str(), false, false) == 0) {
-      this->preexisting_file_indices.remove(filename);
-      return true;
+    if (this->index_mmap) {
+      BLI_mmap_free(this->index_mmap);
+      this->index_mmap = nullptr;
+    }
+    if (this->index_file_handle != -1) {
+      close(this->index_file_handle);
+      this->index_file_handle = -1;
     }
-    return false;
   }
 
   /**
-   * A bug was creating empty index files for a while (see D16665). Remove empty index files from
-   * this period, so they are regenerated.
+   * Per blend file JSON indices were written by older versions, they are replaced by the library
+   * index.
+   * \return the number of removed files.
    */
-  /* Implemented further below. */
-  int remove_broken_index_files();
-
-  int remove_unused_index_files()
+  int remove_legacy_index_files()
   {
-    int num_files_deleted = 0;
-
-    Set<StringRef> files_to_remove;
-
-    for (auto preexisting_index : this->preexisting_file_indices.items()) {
-      if (preexisting_index.value.is_used) {
-        continue;
-      }
-
-      const std::string &file_path = preexisting_index.key;
-      CLOG_INFO(&LOG, 2, "Remove unused index file [%s].", file_path.c_str());
-      files_to_remove.add(preexisting_index.key);
+    const char *index_path = this->indices_base_path.c_str();
+    if (!BLI_is_dir(index_path)) {
+      return 0;
     }
-
-    for (StringRef file_to_remove : files_to_remove) {
-      if (delete_file_index(file_to_remove)) {
-        num_files_deleted++;
+    int num_files_deleted = 0;
+    direntry *dir_entries = nullptr;
+    const int dir_entries_num = BLI_filelist_dir_contents(index_path, &dir_entries);
+    for (int i = 0; i < dir_entries_num; i++) {
+      direntry *entry = &dir_entries[i];
+      if (BLI_str_endswith(entry->relname, ".index.json")) {
+        if (BLI_delete(entry->path, false, false) == 0) {
+          num_files_deleted++;
+        }
       }
     }
-
+    BLI_filelist_free(dir_entries, dir_entries_num);
     return num_files_deleted;
   }
-};
-
-/**
- * Instance of this class represents the contents of an asset index file.
- *
- * \code
- * {
- *    "version": {version},
- *    "entries": ...
- * }
- * \endcode
- */
-struct AssetIndex {
-  /**
-   * \brief Version to store in new index files.
-   *
-   * Versions are written to each index file. When reading the version is checked against
-   * `CURRENT_VERSION` to make sure we can use the index. Developer should increase
-   * `CURRENT_VERSION` when changes are made to the structure of the stored index.
-   */
-  static const int CURRENT_VERSION = 1;
 
   /**
-   * Version number to use when version couldn't be read from an index file.
+   * Write the index file when blend files were updated or removed while listing.
    */
-  const int UNKNOWN_VERSION = -1;
-
-  /**
-   * `io::serialize::Value` representing the contents of an index file.
-   *
-   * Value is used over #DictionaryValue as the contents of the index could be corrupted and
-   * doesn't represent an object. In case corrupted files are detected the `get_version` would
-   * return `UNKNOWN_VERSION`.
-   */
-  std::unique_ptr<Value> contents;
-
-  /**
-   * Constructor for when creating/updating an asset index file.
-   * #AssetIndex.contents are filled from the given \p indexer_entries.
-   */
-  AssetIndex(const FileIndexerEntries &indexer_entries)
-  {
-    std::unique_ptr<DictionaryValue> root = std::make_unique<DictionaryValue>();
-    root->append_int(ATTRIBUTE_VERSION, CURRENT_VERSION);
-    init_value_from_file_indexer_entries(*root, indexer_entries);
-
-    this->contents = std::move(root);
-  }
-
-  /**
-   * Constructor when reading an asset index file.
-   * #AssetIndex.contents are read from the given \p value.
-   */
-  AssetIndex(std::unique_ptr<Value> &value) : contents(std::move(value)) {}
-
-  int get_version() const
+  void write_index_file()
   {
-    const DictionaryValue *root = this->contents->as_dictionary_value();
-    if (root == nullptr) {
-      return UNKNOWN_VERSION;
+    Vector<std::pair<StringRef, IndexFileRecord>> records;
+    Vector<Span<char>> records_entries;
+    int removed_files_num = 0;
+    for (const auto item : this->indexed_files.items()) {
+      if (this->updated_files.contains(item.key)) {
+        continue;
+      }
+      if (this->listing_finished && !this->listed_files.contains(item.key)) {
+        CLOG_INFO(&LOG, 2, "Remove unused index of [%s].", item.key.c_str());
+        removed_files_num++;
+        continue;
+      }
+      IndexFileRecord record{};
+      record.entries_num = uint64_t(item.value.entries_num);
+      record.file_mtime = item.value.stat.mtime;
+      record.file_size = item.value.stat.size;
+      records.append({item.key, record});
+      records_entries.append(item.value.entries_data);
     }
-    const std::optional<int64_t> version_value = root->lookup_int(ATTRIBUTE_VERSION);
-    return version_value.value_or(UNKNOWN_VERSION);
-  }
-
-  bool is_latest_version() const
-  {
-    return get_version() == CURRENT_VERSION;
-  }
-
-  /**
-   * Extract the contents of this index into the given \p indexer_entries.
-   *
-   * \return The number of entries read from the given entries.
-   */
-  int extract_into(FileIndexerEntries &indexer_entries) const
-  {
-    const DictionaryValue *root = this->contents->as_dictionary_value();
-    const int num_entries_read = init_indexer_entries_from_value(indexer_entries, *root);
-    return num_entries_read;
-  }
-};
-
-class AssetIndexFile : public AbstractFile {
- public:
-  AssetLibraryIndex &library_index;
-  /**
-   * Asset index files with a size smaller than this attribute would be considered to not contain
-   * any entries.
-   */
-  const size_t MIN_FILE_SIZE_WITH_ENTRIES = 32;
-  std::string filename;
-
-  AssetIndexFile(AssetLibraryIndex &library_index, StringRef index_file_path)
-      : library_index(library_index), filename(index_file_path)
-  {
-  }
-
-  AssetIndexFile(AssetLibraryIndex &library_index, BlendFile &asset_filename)
-      : AssetIndexFile(library_index, library_index.index_file_path(asset_filename))
-  {
-  }
-
-  void mark_as_used()
-  {
-    this->library_index.mark_as_used(this->filename);
-  }
-
-  const char *get_file_path() const override
-  {
-    return filename.c_str();
-  }
-
-  /**
-   * Returns whether the index file is older than the given asset file.
-   */
-  bool is_older_than(const BlendFile &asset_file) const
-  {
-    return BLI_file_older(this->get_file_path(), asset_file.get_file_path());
-  }
-
-  /**
-   * Check whether the index file contains entries without opening the file.
-   */
-  bool constains_entries() const
-  {
-    const size_t file_size = get_file_size();
-    return file_size >= MIN_FILE_SIZE_WITH_ENTRIES;
-  }
-
-  std::unique_ptr<AssetIndex> read_contents() const
-  {
-    JsonFormatter formatter;
-    std::ifstream is;
-    is.open(this->filename);
-    std::unique_ptr<Value> read_data = formatter.deserialize(is);
-    is.close();
-
-    return std::make_unique<AssetIndex>(read_data);
-  }
-
-  bool ensure_parent_path_exists() const
-  {
-    return BLI_file_ensure_parent_dir_exists(this->get_file_path());
-  }
-
-  void write_contents(AssetIndex &content)
-  {
-    JsonFormatter formatter;
-    if (!ensure_parent_path_exists()) {
-      CLOG_ERROR(&LOG, "Index not created: couldn't create folder [%s].", this->get_file_path());
+    if (this->updated_files.is_empty() && removed_files_num == 0) {
       return;
     }
+    for (const auto item : this->updated_files.items()) {
+      IndexFileRecord record{};
+      record.entries_num = uint64_t(item.value.entries_num);
+      record.file_mtime = item.value.stat.mtime;
+      record.file_size = item.value.stat.size;
+      records.append({item.key, record});
+      records_entries.append(item.value.entries_data);
+    }
 
-    std::ofstream os;
-    os.open(this->filename, std::ios::out | std::ios::trunc);
-    formatter.serialize(os, *content.contents);
-    os.close();
-  }
-};
-
-/* TODO(Julian): remove this after a short while. Just necessary for people who've been using alpha
- * builds from a certain period. */
-int AssetLibraryIndex::remove_broken_index_files()
-{
-  Set<StringRef> files_to_remove;
-
-  for (const std::string &index_path : this->preexisting_file_indices.keys()) {
-    AssetIndexFile index_file(*this, index_path);
-
-    /* Bug was causing empty index files, so non-empty ones can be skipped. */
-    if (index_file.constains_entries()) {
-      continue;
+    BinaryWriter data;
+    const uint64_t data_offset = sizeof(IndexFileHeader) +
+                                 sizeof(IndexFileRecord) * uint64_t(records.size());
+    for (const int i : records.index_range()) {
+      IndexFileRecord &record = records[i].second;
+      record.path_offset = data_offset + uint64_t(data.data().size());
+      record.path_len = uint64_t(records[i].first.size());
+      data.write_bytes(Span<char>(records[i].first.data(), records[i].first.size()));
+      record.entries_offset = data_offset + uint64_t(data.data().size());
+      record.entries_size = uint64_t(records_entries[i].size());
+      data.write_bytes(records_entries[i]);
     }
 
-    /* Use the file modification time stamp to attempt to remove empty index files from a
-     * certain period (when the bug was in there). Starting from a day before the bug was
-     * introduced until a day after the fix should be enough to mitigate possible local time
-     * zone issues. */
-
-    std::tm tm_from{};
-    tm_from.tm_year = 2022 - 1900; /* 2022 */
-    tm_from.tm_mon = 11 - 1;       /* November */
-    tm_from.tm_mday = 8;           /* Day before bug was introduced. */
-    std::tm tm_to{};
-    tm_from.tm_year = 2022 - 1900; /* 2022 */
-    tm_from.tm_mon = 12 - 1;       /* December */
-    tm_from.tm_mday = 3;           /* Day after fix. */
-    std::time_t timestamp_from = std::mktime(&tm_from);
-    std::time_t timestamp_to = std::mktime(&tm_to);
-    BLI_stat_t stat = {};
-    if (BLI_stat(index_file.get_file_path(), &stat) == -1) {
-      continue;
+    BinaryWriter writer;
+    IndexFileHeader header{};
+    memcpy(header.magic, INDEX_FILE_MAGIC, sizeof(header.magic));
+    header.version = INDEX_FILE_VERSION;
+    header.files_num = uint32_t(records.size());
+    writer.write(header);
+    for (const std::pair<StringRef, IndexFileRecord> &record : records) {
+      writer.write(record.second);
     }
-    if (IN_RANGE(stat.st_mtime, timestamp_from, timestamp_to)) {
-      CLOG_INFO(&LOG, 2, "Remove potentially broken index file [%s].", index_path.c_str());
-      files_to_remove.add(index_path);
+    writer.write_bytes(data.data());
+
+    /* The entries of blend files that didn't change point into the mapped file, it can only be
+     * closed after they are copied. Write to a temporary file first, so an index that is being
+     * read by another instance is replaced at once. */
+    this->close_index_file();
+    this->indexed_files.clear();
+
+    const std::string index_path = this->index_file_path();
+    const std::string index_path_temp = index_path + "@";
+    if (!BLI_file_ensure_parent_dir_exists(index_path.c_str())) {
+      CLOG_ERROR(&LOG, "Index not created: couldn't create folder [%s].", index_path.c_str());
+      return;
     }
-  }
-
-  int num_files_deleted = 0;
-  for (StringRef filepath : files_to_remove) {
-    if (delete_file_index(filepath)) {
-      num_files_deleted++;
+    FILE *file = BLI_fopen(index_path_temp.c_str(), "wb");
+    if (file == nullptr) {
+      CLOG_ERROR(&LOG, "Index not created: couldn't open [%s].", index_path_temp.c_str());
+      return;
+    }
+    const Span<char> contents = writer.data();
+    const bool written = fwrite(contents.data(), 1, size_t(contents.size()), file) ==
+                         size_t(contents.size());
+    fclose(file);
+    if (!written || BLI_rename_overwrite(index_path_temp.c_str(), index_path.c_str()) != 0) {
+      CLOG_ERROR(&LOG, "Index not created: couldn't write [%s].", index_path.c_str());
+      BLI_delete(index_path_temp.c_str(), false, false);
+      return;
     }
-  }
 
-  return num_files_deleted;
-}
+    CLOG_INFO(&LOG,
+              1,
+              "Wrote asset library index with %d files, %d updated and %d removed [%s].",
+              int(records.size()),
+              int(this->updated_files.size()),
+              removed_files_num,
+              index_path.c_str());
+  }
+};
 
 static eFileIndexerResult read_index(const char *filename,
                                      FileIndexerEntries *entries,
@@ -648,49 +686,41 @@ static eFileIndexerResult read_index(const char *filename,
 {
   AssetLibraryIndex &library_index = *static_cast<AssetLibraryIndex *>(user_data);
   BlendFile asset_file(filename);
-  AssetIndexFile asset_index_file(library_index, asset_file);
 
-  if (!asset_index_file.exists()) {
+  const std::optional<BlendFileStat> stat = BlendFileStat::from_file(asset_file);
+  if (!stat) {
     return FILE_INDEXER_NEEDS_UPDATE;
   }
 
-  /* Mark index as used, even when it will be recreated. When not done it would remove the index
-   * when the indexing has finished (see `AssetLibraryIndex.remove_unused_index_files`), thereby
+  /* Track the listed file, even when it will be read again. When not done it would remove the
+   * index when the indexing has finished (see `AssetLibraryIndex.write_index_file`), thereby
    * removing the newly created index.
    */
-  asset_index_file.mark_as_used();
-
-  if (asset_index_file.is_older_than(asset_file)) {
-    CLOG_INFO(
-        &LOG,
-        3,
-        "Asset index file [%s] needs to be refreshed as it is older than the asset file [%s].",
-        asset_index_file.filename.c_str(),
-        filename);
+  {
+    std::scoped_lock lock(library_index.mutex);
+    library_index.listed_files.add_overwrite(filename, *stat);
+  }
+
+  const AssetLibraryIndex::IndexedFile *indexed_file = library_index.indexed_files.lookup_ptr_as(
+      StringRef(filename));
+  if (indexed_file == nullptr) {
     return FILE_INDEXER_NEEDS_UPDATE;
   }
 
-  if (!asset_index_file.constains_entries()) {
+  if (!(indexed_file->stat == *stat)) {
     CLOG_INFO(&LOG,
               3,
-              "Asset file index is to small to contain any entries. [%s]",
-              asset_index_file.filename.c_str());
-    *r_read_entries_len = 0;
-    return FILE_INDEXER_ENTRIES_LOADED;
+              "Asset index of [%s] needs to be refreshed as the asset file changed.",
+              filename);
+    return FILE_INDEXER_NEEDS_UPDATE;
   }
 
-  std::unique_ptr<AssetIndex> contents = asset_index_file.read_contents();
-  if (!contents->is_latest_version()) {
-    CLOG_INFO(&LOG,
-              3,
-              "Asset file index is ignored; expected version %d but file is version %d [%s].",
-              AssetIndex::CURRENT_VERSION,
-              contents->get_version(),
-              asset_index_file.filename.c_str());
+  if (!read_indexer_entries(indexed_file->entries_data, indexed_file->entries_num, *entries)) {
+    CLOG_INFO(&LOG, 3, "Asset index of [%s] is ignored; entries are corrupted.", filename);
     return FILE_INDEXER_NEEDS_UPDATE;
   }
 
-  const int read_entries_len = contents->extract_into(*entries);
+  const int read_entries_len = int(indexed_file->entries_num);
   CLOG_INFO(&LOG, 1, "Read %d entries from asset index for [%s].", read_entries_len, filename);
   *r_read_entries_len = read_entries_len;
 
@@ -700,39 +730,47 @@ static eFileIndexerResult read_index(const char *filename,
 static void update_index(const char *filename, FileIndexerEntries *entries, void *user_data)
 {
   AssetLibraryIndex &library_index = *static_cast<AssetLibraryIndex *>(user_data);
-  BlendFile asset_file(filename);
-  AssetIndexFile asset_index_file(library_index, asset_file);
-  CLOG_INFO(&LOG,
-            1,
-            "Update asset index for [%s] store index in [%s].",
-            asset_file.get_file_path(),
-            asset_index_file.get_file_path());
-
-  AssetIndex content(*entries);
-  asset_index_file.write_contents(content);
+  CLOG_INFO(&LOG, 1, "Update asset index for [%s].", filename);
+
+  BinaryWriter writer;
+  AssetLibraryIndex::UpdatedFile updated_file;
+  updated_file.entries_num = write_file_indexer_entries(writer, *entries);
+  updated_file.entries_data = writer.data();
+
+  std::scoped_lock lock(library_index.mutex);
+  /* Use the status of the file from before it was read, so changes while reading it are detected
+   * the next time. */
+  const BlendFileStat *stat = library_index.listed_files.lookup_ptr_as(StringRef(filename));
+  if (stat == nullptr) {
+    return;
+  }
+  updated_file.stat = *stat;
+  library_index.updated_files.add_overwrite(filename, std::move(updated_file));
 }
 
 static void *init_user_data(const char *root_directory, size_t root_directory_maxncpy)
 {
   AssetLibraryIndex *library_index = MEM_new<AssetLibraryIndex>(
       __func__, StringRef(root_directory, BLI_strnlen(root_directory, root_directory_maxncpy)));
-  library_index->collect_preexisting_file_indices();
-  library_index->remove_broken_index_files();
+  const int num_legacy_removed = library_index->remove_legacy_index_files();
+  if (num_legacy_removed > 0) {
+    CLOG_INFO(&LOG, 1, "Removed %d legacy index files.", num_legacy_removed);
+  }
+  library_index->open_index_file();
   return library_index;
 }
 
 static void free_user_data(void *user_data)
 {
-  MEM_delete((AssetLibraryIndex *)user_data);
+  AssetLibraryIndex *library_index = static_cast<AssetLibraryIndex *>(user_data);
+  library_index->write_index_file();
+  MEM_delete(library_index);
 }
 
 static void filelist_finished(void *user_data)
 {
   AssetLibraryIndex &library_index = *static_cast<AssetLibraryIndex *>(user_data);
-  const int num_indices_removed = library_index.remove_unused_index_files();
-  if (num_indices_removed > 0) {
-    CLOG_INFO(&LOG, 1, "Removed %d unused indices.", num_indices_removed);
-  }
+  library_index.listing_finished = true;
 }
 
 constexpr FileIndexerType asset_indexer()
@@ -104,6 +104,8 @@ struct FileIndexerType {
    * entries field, `r_read_entries_len` must be set to `0` and the function must return
    * `eFileIndexerResult::FILE_INDEXER_NEEDS_UPDATE`. In this case the blend file will read from
    * the blend file and the `update_index` function will be called.
+   *
+   * Blend files are listed in parallel, so this can be called concurrently for different files.
    */
   FileIndexerReadIndexFunc read_index;
 
@@ -113,6 +115,8 @@ struct FileIndexerType {
    * Is called after reading entries from the file when the result of `read_index` was
    * `eFileIndexerResult::FILE_INDEXER_NEED_UPDATE`. The callback should update the index so the
    * next time that read_index is called it will read the entries from the index.
+   *
+   * Like `read_index`, this can be called concurrently for different files.
    */
   FileIndexerUpdateIndexFunc update_index;
 };
@@ -11,10 +11,12 @@
 
 #include "MEM_guardedalloc.h"
 
+#include "BLI_index_mask.hh"
 #include "BLI_linklist_stack.h"
 #include "BLI_math_geom.h"
 #include "BLI_math_vector.h"
 #include "BLI_task.h"
+#include "BLI_task.hh"
 
 #include "DNA_brush_types.h"
 #include "DNA_mesh_types.h"
@@ -100,18 +102,15 @@ Array<float> distances_create(const Span<float3> vert_positions,
   BLI_LINKSTACK_INIT(queue);
   BLI_LINKSTACK_INIT(queue_next);
 
-  for (const int i : vert_positions.index_range()) {
-    if (initial_verts.contains(i)) {
-      dists[i] = 0.0f;
+  threading::parallel_for(vert_positions.index_range(), 4096, [&](const IndexRange range) {
+    for (const int i : range) {
+      dists[i] = initial_verts.contains(i) ? 0.0f : FLT_MAX;
     }
-    else {
-      dists[i] = FLT_MAX;
-    }
-  }
+  });
 
   /* Masks vertices that are further than limit radius from an initial vertex. As there is no need
    * to define a distance to them the algorithm can stop earlier by skipping them. */
-  BitVector<> affected_vert(vert_positions.size());
+  Array<bool> affected_vert(vert_positions.size());
 
   if (limit_radius == FLT_MAX) {
     /* In this case, no need to loop through all initial vertices to check distances as they are
@@ -122,27 +121,32 @@ Array<float> distances_create(const Span<float3> vert_positions,
     /* This is an O(n^2) loop used to limit the geodesic distance calculation to a radius. When
      * this optimization is needed, it is expected for the tool to request the distance to a low
      * number of vertices (usually just 1 or 2). */
-    for (const int v : initial_verts) {
-      const float *v_co = vert_positions[v];
-      for (const int i : vert_positions.index_range()) {
-        if (len_squared_v3v3(v_co, vert_positions[i]) <= limit_radius_sq) {
-          affected_vert[i].set();
+    threading::parallel_for(vert_positions.index_range(), 1024, [&](const IndexRange range) {
+      for (const int i : range) {
+        affected_vert[i] = false;
+        for (const int v : initial_verts) {
+          if (len_squared_v3v3(vert_positions[v], vert_positions[i]) <= limit_radius_sq) {
+            affected_vert[i] = true;
+            break;
+          }
         }
       }
-    }
+    });
   }
 
   /* Add edges adjacent to an initial vertex to the queue. */
-  for (const int i : edges.index_range()) {
-    const int v1 = edges[i][0];
-    const int v2 = edges[i][1];
-    if (!affected_vert[v1] && !affected_vert[v2]) {
-      continue;
-    }
-    if (dists[v1] != FLT_MAX || dists[v2] != FLT_MAX) {
-      BLI_LINKSTACK_PUSH(queue, POINTER_FROM_INT(i));
-    }
-  }
+  IndexMaskMemory memory;
+  const IndexMask initial_edges = IndexMask::from_predicate(
+      edges.index_range(), GrainSize(4096), memory, [&](const int i) {
+        const int v1 = edges[i][0];
+        const int v2 = edges[i][1];
+        if (!affected_vert[v1] && !affected_vert[v2]) {
+          return false;
+        }
+        return dists[v1] != FLT_MAX || dists[v2] != FLT_MAX;
+      });
+  initial_edges.foreach_index(
+      [&](const int i) { BLI_LINKSTACK_PUSH(queue, POINTER_FROM_INT(i)); });
 
   do {
     while (BLI_LINKSTACK_SIZE(queue)) {
@@ -31,14 +31,19 @@
 
 #include <mutex>
 
+#include <zstd.h>
+
 #include "MEM_guardedalloc.h"
 
+#include "CLG_log.h"
+
 #include "BLI_array.hh"
 #include "BLI_bit_group_vector.hh"
 #include "BLI_enumerable_thread_specific.hh"
 #include "BLI_listbase.h"
 #include "BLI_map.hh"
 #include "BLI_string.h"
+#include "BLI_task.h"
 #include "BLI_utildefines.h"
 #include "BLI_vector.hh"
 
@@ -123,6 +128,16 @@ namespace blender::ed::sculpt_paint::undo {
 
 #define NO_ACTIVE_LAYER bke::AttrDomain::Auto
 
+static CLG_LogRef LOG = {"ed.sculpt_paint.undo"};
+
+/** Lossless compressed copy of an array of floats or float vectors, see #compress_array. */
+struct CompressedArray {
+  /** The zstd compressed byte planes, empty when the array is not compressed. */
+  Array<std::byte, 0> data;
+  /** The size of the uncompressed array in bytes. */
+  int64_t raw_size = 0;
+};
+
 struct Node {
   Array<float3, 0> position;
   Array<float3, 0> normal;
@@ -154,6 +169,17 @@ struct Node {
   Array<int, 0> face_sets;
 
   Vector<int> face_indices;
+
+  /**
+   * Storage for the arrays above while the undo step is not being restored. Only one of the
+   * compressed and uncompressed version of each array contains data at any time.
+   */
+  struct {
+    CompressedArray position;
+    CompressedArray col;
+    CompressedArray mask;
+    CompressedArray loop_col;
+  } compressed;
 };
 
 struct SculptAttrRef {
@@ -251,7 +277,17 @@ struct StepData {
   /** Storage of per-node undo data after creation of the undo step is finished. */
   Vector<std::unique_ptr<Node>> nodes;
 
+  /** Memory used by the step before its nodes were compressed. */
   size_t undo_size;
+
+  /**
+   * Memory used by the step once its nodes are compressed, or zero while the compression has not
+   * finished. Written by the compression task, see #compress_nodes_in_background.
+   */
+  std::atomic<size_t> undo_size_compressed = 0;
+
+  /** Runs the compression of the nodes once the step is finished, null when nothing is running. */
+  TaskPool *compress_task_pool = nullptr;
 };
 
 struct SculptUndoStep {
@@ -1056,8 +1092,206 @@ static void restore_list(bContext *C, Depsgraph *depsgraph, StepData &step_data)
   }
 }
 
+/* -------------------------------------------------------------------- */
+/** \name Compressed Node Storage
+ *
+ * Once an undo step is finished, the per-vertex arrays of its nodes are compressed by a
+ * background task. They are only decompressed while the step is undone or redone. Every float is
+ * replaced by the XOR of its bits with the same component of the previous element, which leaves
+ * mostly zero sign, exponent and high mantissa bits for the similar values of neighboring
+ * vertices. Grouping the bytes into planes puts those zeros next to each other before the lossless
+ * compression with zstd.
+ * \{ */
+
+template<typename T> static void compress_array(Array<T, 0> &array, CompressedArray &r_compressed)
+{
+  static_assert(sizeof(T) % sizeof(uint32_t) == 0);
+  constexpr int64_t components_num = sizeof(T) / sizeof(uint32_t);
+  if (array.is_empty()) {
+    return;
+  }
+  const Span<uint32_t> values(reinterpret_cast<const uint32_t *>(array.data()),
+                              array.size() * components_num);
+  const int64_t values_num = values.size();
+
+  Array<uint8_t> planes(values.size_in_bytes(), NoInitialization());
+  for (const int64_t i : values.index_range()) {
+    const uint32_t prev = i < components_num ? 0 : values[i - components_num];
+    const uint32_t delta = values[i] ^ prev;
+    for (const int byte : IndexRange(sizeof(uint32_t))) {
+      planes[byte * values_num + i] = uint8_t(delta >> (byte * 8));
+    }
+  }
+
+  Array<std::byte> buffer(ZSTD_compressBound(planes.size()), NoInitialization());
+  const size_t compressed_size = ZSTD_compress(
+      buffer.data(), buffer.size(), planes.data(), planes.size(), 1);
+  if (ZSTD_isError(compressed_size) || compressed_size >= size_t(planes.size())) {
+    /* Keep the uncompressed array when compression doesn't help. */
+    return;
+  }
+  r_compressed.data = Array<std::byte, 0>(buffer.as_span().take_front(compressed_size));
+  r_compressed.raw_size = values.size_in_bytes();
+  array = {};
+}
+
+template<typename T>
+static void decompress_array(CompressedArray &compressed, Array<T, 0> &r_array)
+{
+  constexpr int64_t components_num = sizeof(T) / sizeof(uint32_t);
+  if (compressed.data.is_empty()) {
+    return;
+  }
+  const int64_t values_num = compressed.raw_size / sizeof(uint32_t);
+
+  Array<uint8_t> planes(compressed.raw_size, NoInitialization());
+  const size_t decompressed_size = ZSTD_decompress(
+      planes.data(), planes.size(), compressed.data.data(), compressed.data.size());
+  BLI_assert(decompressed_size == size_t(planes.size()));
+  UNUSED_VARS_NDEBUG(decompressed_size);
+
+  r_array.reinitialize(compressed.raw_size / sizeof(T));
+  MutableSpan<uint32_t> values(reinterpret_cast<uint32_t *>(r_array.data()), values_num);
+  for (const int64_t i : values.index_range()) {
+    uint32_t delta = 0;
+    for (const int byte : IndexRange(sizeof(uint32_t))) {
+      delta |= uint32_t(planes[byte * values_num + i]) << (byte * 8);
+    }
+    const uint32_t prev = i < components_num ? 0 : values[i - components_num];
+    values[i] = delta ^ prev;
+  }
+  compressed = {};
+}
+
+static void compress_node(Node &node)
+{
+  compress_array(node.position, node.compressed.position);
+  compress_array(node.col, node.compressed.col);
+  compress_array(node.mask, node.compressed.mask);
+  compress_array(node.loop_col, node.compressed.loop_col);
+}
+
+static void decompress_node(Node &node)
+{
+  decompress_array(node.compressed.position, node.position);
+  decompress_array(node.compressed.col, node.col);
+  decompress_array(node.compressed.mask, node.mask);
+  decompress_array(node.compressed.loop_col, node.loop_col);
+}
+
+static size_t node_size_in_bytes(const Node &node)
+{
+  size_t size = sizeof(Node);
+  size += node.position.as_span().size_in_bytes();
+  size += node.normal.as_span().size_in_bytes();
+  size += node.col.as_span().size_in_bytes();
+  size += node.mask.as_span().size_in_bytes();
+  size += node.loop_col.as_span().size_in_bytes();
+  size += node.vert_indices.as_span().size_in_bytes();
+  size += node.corner_indices.as_span().size_in_bytes();
+  size += node.vert_hidden.size() / 8;
+  size += node.face_hidden.size() / 8;
+  size += node.grids.as_span().size_in_bytes();
+  size += node.grid_hidden.all_bits().size() / 8;
+  size += node.face_sets.as_span().size_in_bytes();
+  size += node.face_indices.as_span().size_in_bytes();
+  size += node.compressed.position.data.size();
+  size += node.compressed.col.data.size();
+  size += node.compressed.mask.data.size();
+  size += node.compressed.loop_col.data.size();
+  return size;
+}
+
+static size_t calc_undo_size(const StepData &step_data)
+{
+  return threading::parallel_reduce(
+      step_data.nodes.index_range(),
+      16,
+      size_t(0),
+      [&](const IndexRange range, size_t size) {
+        for (const int i : range) {
+          size += node_size_in_bytes(*step_data.nodes[i]);
+        }
+        return size;
+      },
+      std::plus<size_t>());
+}
+
+static void compress_nodes_task(TaskPool *__restrict /*pool*/, void *taskdata)
+{
+  StepData &step_data = *static_cast<StepData *>(taskdata);
+  threading::parallel_for(step_data.nodes.index_range(), 1, [&](const IndexRange range) {
+    for (const int i : range) {
+      compress_node(*step_data.nodes[i]);
+    }
+  });
+  const size_t undo_size_compressed = calc_undo_size(step_data);
+  step_data.undo_size_compressed = undo_size_compressed;
+  CLOG_INFO(&LOG,
+            2,
+            "Compressed undo step for \"%s\": %zu bytes raw, %zu bytes compressed",
+            step_data.object_name.c_str(),
+            step_data.undo_size,
+            undo_size_compressed);
+}
+
+/**
+ * Start compressing the nodes of a finished step. The nodes must not be accessed until
+ * #compress_nodes_wait or #decompress_nodes is called.
+ */
+static void compress_nodes_in_background(StepData &step_data)
+{
+  BLI_assert(step_data.compress_task_pool == nullptr);
+  if (step_data.nodes.is_empty()) {
+    return;
+  }
+  step_data.compress_task_pool = BLI_task_pool_create_background(nullptr, TASK_PRIORITY_LOW);
+  BLI_task_pool_push(
+      step_data.compress_task_pool, compress_nodes_task, &step_data, false, nullptr);
+}
+
+static void compress_nodes_wait(StepData &step_data)
+{
+  if (!step_data.compress_task_pool) {
+    return;
+  }
+  BLI_task_pool_work_and_wait(step_data.compress_task_pool);
+  BLI_task_pool_free(step_data.compress_task_pool);
+  step_data.compress_task_pool = nullptr;
+}
+
+static void decompress_nodes(StepData &step_data)
+{
+  compress_nodes_wait(step_data);
+  threading::parallel_for(step_data.nodes.index_range(), 1, [&](const IndexRange range) {
+    for (const int i : range) {
+      decompress_node(*step_data.nodes[i]);
+    }
+  });
+}
+
+/**
+ * The undo system reads the size of steps without synchronization, so the compressed sizes are
+ * only copied to the steps here, when the memory limit is about to be enforced.
+ */
+static void update_compressed_step_sizes(UndoStack &ustack)
+{
+  LISTBASE_FOREACH (UndoStep *, us, &ustack.steps) {
+    if (us->type != BKE_UNDOSYS_TYPE_SCULPT) {
+      continue;
+    }
+    const StepData &step_data = reinterpret_cast<SculptUndoStep *>(us)->data;
+    if (const size_t undo_size_compressed = step_data.undo_size_compressed) {
+      us->data_size = undo_size_compressed;
+    }
+  }
+}
+
+/** \} */
+
 static void free_step_data(StepData &step_data)
 {
+  compress_nodes_wait(step_data);
   geometry_free_data(&step_data.geometry_original);
   geometry_free_data(&step_data.geometry_modified);
   geometry_free_data(&step_data.bmesh.geometry_enter);
@@ -1662,25 +1896,6 @@ void push_begin(const Scene &scene, Object &ob, const wmOperator *op)
   push_begin_ex(scene, ob, op->type->name);
 }
 
-static size_t node_size_in_bytes(const Node &node)
-{
-  size_t size = sizeof(Node);
-  size += node.position.as_span().size_in_bytes();
-  size += node.normal.as_span().size_in_bytes();
-  size += node.col.as_span().size_in_bytes();
-  size += node.mask.as_span().size_in_bytes();
-  size += node.loop_col.as_span().size_in_bytes();
-  size += node.vert_indices.as_span().size_in_bytes();
-  size += node.corner_indices.as_span().size_in_bytes();
-  size += node.vert_hidden.size() / 8;
-  size += node.face_hidden.size() / 8;
-  size += node.grids.as_span().size_in_bytes();
-  size += node.grid_hidden.all_bits().size() / 8;
-  size += node.face_sets.as_span().size_in_bytes();
-  size += node.face_indices.as_span().size_in_bytes();
-  return size;
-}
-
 void push_end_ex(Object &ob, const bool use_nested_undo)
 {
   StepData *step_data = get_step_data();
@@ -1697,17 +1912,7 @@ void push_end_ex(Object &ob, const bool use_nested_undo)
     unode->normal = {};
   }
 
-  step_data->undo_size = threading::parallel_reduce(
-      step_data->nodes.index_range(),
-      16,
-      0,
-      [&](const IndexRange range, size_t size) {
-        for (const int i : range) {
-          size += node_size_in_bytes(*step_data->nodes[i]);
-        }
-        return size;
-      },
-      std::plus<size_t>());
+  step_data->undo_size = calc_undo_size(*step_data);
 
   /* We could remove this and enforce all callers run in an operator using 'OPTYPE_UNDO'. */
   wmWindowManager *wm = static_cast<wmWindowManager *>(G_MAIN->wm.first);
@@ -1715,6 +1920,7 @@ void push_end_ex(Object &ob, const bool use_nested_undo)
     UndoStack *ustack = ED_undo_stack_get();
     BKE_undosys_step_push(ustack, nullptr, nullptr);
     if (wm->op_undo_depth == 0) {
+      update_compressed_step_sizes(*ustack);
       BKE_undosys_stack_limit_steps_and_memory_defaults(ustack);
     }
     WM_file_tag_modified();
@@ -1796,6 +2002,7 @@ static bool step_encode(bContext * /*C*/, Main *bmain, UndoStep *us_p)
    * to the current 'SculptUndoStep' added by encode_init. */
   SculptUndoStep *us = reinterpret_cast<SculptUndoStep *>(us_p);
   us->step.data_size = us->data.undo_size;
+  us->step.data_size_uncompressed = us->data.undo_size;
 
   Node *unode = us->data.nodes.is_empty() ? nullptr : us->data.nodes.last().get();
   if (unode && us->data.type == Type::DyntopoEnd) {
@@ -1807,6 +2014,8 @@ static bool step_encode(bContext * /*C*/, Main *bmain, UndoStep *us_p)
     bmain->is_memfile_undo_flush_needed = true;
   }
 
+  compress_nodes_in_background(us->data);
+
   return true;
 }
 
@@ -1814,7 +2023,9 @@ static void step_decode_undo_impl(bContext *C, Depsgraph *depsgraph, SculptUndoS
 {
   BLI_assert(us->step.is_applied == true);
 
+  decompress_nodes(us->data);
   restore_list(C, depsgraph, us->data);
+  compress_nodes_in_background(us->data);
   us->step.is_applied = false;
 }
 
@@ -1822,7 +2033,9 @@ static void step_decode_redo_impl(bContext *C, Depsgraph *depsgraph, SculptUndoS
 {
   BLI_assert(us->step.is_applied == false);
 
+  decompress_nodes(us->data);
   restore_list(C, depsgraph, us->data);
+  compress_nodes_in_background(us->data);
   us->step.is_applied = true;
 }
 
@@ -37,7 +37,6 @@
 #include "BLI_ghash.h"
 #include "BLI_linklist.h"
 #include "BLI_math_vector.h"
-#include "BLI_stack.h"
 #include "BLI_string_utils.hh"
 #include "BLI_task.h"
 #include "BLI_threads.h"
@@ -3004,17 +3003,12 @@ struct TodoDir {
 };
 
 struct FileListReadJob {
+  /** Protects #tmp_filelist and the loaded asset library, directories are read in parallel. */
   ThreadMutex lock;
   char main_filepath[FILE_MAX];
   Main *current_main;
   FileList *filelist;
 
-  /** The path currently being read, relative to the filelist root directory. Needed for recursive
-   * reading. The full file path is then composed like: `<filelist root>/<cur_relbase>/<file name>.
-   * (whereby the file name may also be a library path within a .blend, e.g.
-   * `Materials/Material.001`). */
-  char cur_relbase[FILE_MAX_LIBEXTRA];
-
   /** The current asset library to load. Usually the same as #FileList.asset_library, however
    * sometimes the #FileList one is a combination of multiple other ones ("All" asset library),
    * which need to be loaded individually. Then this can be set to override the #FileList library.
@@ -3039,13 +3033,12 @@ struct FileListReadJob {
 
 /**
  * Append \a filename (or even a path inside of a .blend, like `Material/Material.001`), to the
- * current relative path being read within the filelist root. The returned string needs freeing
- * with #MEM_freeN().
+ * relative path \a relbase being read within the filelist root. The full file path is then
+ * composed like: `<filelist root>/<relbase>/<file name>`. The returned string needs freeing with
+ * #MEM_freeN().
  */
-static char *current_relpath_append(const FileListReadJob *job_params, const char *filename)
+static char *current_relpath_append(const char *relbase, const char *filename)
 {
-  const char *relbase = job_params->cur_relbase;
-
   /* Early exit, nothing to join. */
   if (!relbase[0]) {
     return BLI_strdup(filename);
@@ -3065,7 +3058,7 @@ static char *current_relpath_append(const FileListReadJob *job_params, const cha
   return BLI_strdup(relpath);
 }
 
-static int filelist_readjob_list_dir(FileListReadJob *job_params,
+static int filelist_readjob_list_dir(const char *relbase,
                                      const char *root,
                                      ListBase *entries,
                                      const char *filter_glob,
@@ -3089,7 +3082,7 @@ static int filelist_readjob_list_dir(FileListReadJob *job_params,
       }
 
       entry = MEM_new<FileListInternEntry>(__func__);
-      entry->relpath = current_relpath_append(job_params, files[i].relname);
+      entry->relpath = current_relpath_append(relbase, files[i].relname);
       entry->st = files[i].s;
 
       BLI_path_join(full_path, FILE_MAX, root, files[i].relname);
@@ -3177,11 +3170,12 @@ enum ListLibOptions {
 };
 ENUM_OPERATORS(ListLibOptions, LIST_LIB_ADD_PARENT);
 
-static FileListInternEntry *filelist_readjob_list_lib_group_create(
-    const FileListReadJob *job_params, const int idcode, const char *group_name)
+static FileListInternEntry *filelist_readjob_list_lib_group_create(const char *relbase,
+                                                                   const int idcode,
+                                                                   const char *group_name)
 {
   FileListInternEntry *entry = MEM_new<FileListInternEntry>(__func__);
-  entry->relpath = current_relpath_append(job_params, group_name);
+  entry->relpath = current_relpath_append(relbase, group_name);
   entry->typeflag |= FILE_TYPE_BLENDERLIB | FILE_TYPE_DIR;
   entry->blentype = idcode;
   return entry;
@@ -3192,6 +3186,7 @@ static FileListInternEntry *filelist_readjob_list_lib_group_create(
  *           this requires redesigning things on the caller side for proper ownership management.
  */
 static void filelist_readjob_list_lib_add_datablock(FileListReadJob *job_params,
+                                                    const char *relbase,
                                                     ListBase *entries,
                                                     BLODataBlockInfo *datablock_info,
                                                     const bool prefix_relpath_with_group_name,
@@ -3201,10 +3196,10 @@ static void filelist_readjob_list_lib_add_datablock(FileListReadJob *job_params,
   FileListInternEntry *entry = MEM_new<FileListInternEntry>(__func__);
   if (prefix_relpath_with_group_name) {
     std::string datablock_path = StringRef(group_name) + SEP_STR + datablock_info->name;
-    entry->relpath = current_relpath_append(job_params, datablock_path.c_str());
+    entry->relpath = current_relpath_append(relbase, datablock_path.c_str());
   }
   else {
-    entry->relpath = current_relpath_append(job_params, datablock_info->name);
+    entry->relpath = current_relpath_append(relbase, datablock_info->name);
   }
   entry->typeflag |= FILE_TYPE_BLENDERLIB;
   if (datablock_info) {
@@ -3224,8 +3219,10 @@ static void filelist_readjob_list_lib_add_datablock(FileListReadJob *job_params,
         datablock_info->asset_data = metadata.get();
         datablock_info->free_asset_data = false;
 
+        BLI_mutex_lock(&job_params->lock);
         entry->asset = job_params->load_asset_library->add_external_asset(
             entry->relpath, datablock_info->name, idcode, std::move(metadata));
+        BLI_mutex_unlock(&job_params->lock);
       }
     }
   }
@@ -3234,6 +3231,7 @@ static void filelist_readjob_list_lib_add_datablock(FileListReadJob *job_params,
 }
 
 static void filelist_readjob_list_lib_add_datablocks(FileListReadJob *job_params,
+                                                     const char *relbase,
                                                      ListBase *entries,
                                                      LinkNode *datablock_infos,
                                                      const bool prefix_relpath_with_group_name,
@@ -3242,13 +3240,19 @@ static void filelist_readjob_list_lib_add_datablocks(FileListReadJob *job_params
 {
   for (LinkNode *ln = datablock_infos; ln; ln = ln->next) {
     BLODataBlockInfo *datablock_info = static_cast<BLODataBlockInfo *>(ln->link);
-    filelist_readjob_list_lib_add_datablock(
-        job_params, entries, datablock_info, prefix_relpath_with_group_name, idcode, group_name);
+    filelist_readjob_list_lib_add_datablock(job_params,
+                                            relbase,
+                                            entries,
+                                            datablock_info,
+                                            prefix_relpath_with_group_name,
+                                            idcode,
+                                            group_name);
   }
 }
 
 static void filelist_readjob_list_lib_add_from_indexer_entries(
     FileListReadJob *job_params,
+    const char *relbase,
     ListBase *entries,
     const FileIndexerEntries *indexer_entries,
     const bool prefix_relpath_with_group_name)
@@ -3257,6 +3261,7 @@ static void filelist_readjob_list_lib_add_from_indexer_entries(
     FileIndexerEntry *indexer_entry = static_cast<FileIndexerEntry *>(ln->link);
     const char *group_name = BKE_idtype_idcode_to_name(indexer_entry->idcode);
     filelist_readjob_list_lib_add_datablock(job_params,
+                                            relbase,
                                             entries,
                                             &indexer_entry->datablock_info,
                                             prefix_relpath_with_group_name,
@@ -3266,10 +3271,10 @@ static void filelist_readjob_list_lib_add_from_indexer_entries(
 }
 
 static FileListInternEntry *filelist_readjob_list_lib_navigate_to_parent_entry_create(
-    const FileListReadJob *job_params)
+    const char *relbase)
 {
   FileListInternEntry *entry = MEM_new<FileListInternEntry>(__func__);
-  entry->relpath = current_relpath_append(job_params, FILENAME_PARENT);
+  entry->relpath = current_relpath_append(relbase, FILENAME_PARENT);
   entry->typeflag |= (FILE_TYPE_BLENDERLIB | FILE_TYPE_DIR);
   return entry;
 }
@@ -3287,6 +3292,7 @@ struct FileIndexer {
 };
 
 static int filelist_readjob_list_lib_populate_from_index(FileListReadJob *job_params,
+                                                         const char *relbase,
                                                          ListBase *entries,
                                                          const ListLibOptions options,
                                                          const int read_from_index,
@@ -3295,12 +3301,13 @@ static int filelist_readjob_list_lib_populate_from_index(FileListReadJob *job_pa
   int navigate_to_parent_len = 0;
   if (options & LIST_LIB_ADD_PARENT) {
     FileListInternEntry *entry = filelist_readjob_list_lib_navigate_to_parent_entry_create(
-        job_params);
+        relbase);
     BLI_addtail(entries, entry);
     navigate_to_parent_len = 1;
   }
 
-  filelist_readjob_list_lib_add_from_indexer_entries(job_params, entries, indexer_entries, true);
+  filelist_readjob_list_lib_add_from_indexer_entries(
+      job_params, relbase, entries, indexer_entries, true);
   return read_from_index + navigate_to_parent_len;
 }
 
@@ -3309,6 +3316,7 @@ static int filelist_readjob_list_lib_populate_from_index(FileListReadJob *job_pa
  *         Otherwise returns no value (#std::nullopt).
  */
 static std::optional<int> filelist_readjob_list_lib(FileListReadJob *job_params,
+                                                    const char *relbase,
                                                     const char *root,
                                                     ListBase *entries,
                                                     const ListLibOptions options,
@@ -3349,7 +3357,7 @@ static std::optional<int> filelist_readjob_list_lib(FileListReadJob *job_params,
         dir, &indexer_entries, &read_from_index, indexer_runtime->user_data);
     if (indexer_result == FILE_INDEXER_ENTRIES_LOADED) {
       int entries_read = filelist_readjob_list_lib_populate_from_index(
-          job_params, entries, options, read_from_index, &indexer_entries);
+          job_params, relbase, entries, options, read_from_index, &indexer_entries);
       ED_file_indexer_entries_clear(&indexer_entries);
       return entries_read;
     }
@@ -3369,7 +3377,7 @@ static std::optional<int> filelist_readjob_list_lib(FileListReadJob *job_params,
   int navigate_to_parent_len = 0;
   if (options & LIST_LIB_ADD_PARENT) {
     FileListInternEntry *entry = filelist_readjob_list_lib_navigate_to_parent_entry_create(
-        job_params);
+        relbase);
     BLI_addtail(entries, entry);
     navigate_to_parent_len = 1;
   }
@@ -3382,7 +3390,7 @@ static std::optional<int> filelist_readjob_list_lib(FileListReadJob *job_params,
     LinkNode *datablock_infos = BLO_blendhandle_get_datablock_info(
         libfiledata, idcode, options & LIST_LIB_ASSETS_ONLY, &datablock_len);
     filelist_readjob_list_lib_add_datablocks(
-        job_params, entries, datablock_infos, false, idcode, group);
+        job_params, relbase, entries, datablock_infos, false, idcode, group);
     BLO_datablock_info_linklist_free(datablock_infos);
   }
   /* Read all datablocks from all groups. */
@@ -3394,7 +3402,7 @@ static std::optional<int> filelist_readjob_list_lib(FileListReadJob *job_params,
       const char *group_name = static_cast<char *>(ln->link);
       const int idcode = groupname_to_code(group_name);
       FileListInternEntry *group_entry = filelist_readjob_list_lib_group_create(
-          job_params, idcode, group_name);
+          relbase, idcode, group_name);
       BLI_addtail(entries, group_entry);
 
       if (options & LIST_LIB_RECURSIVE) {
@@ -3402,7 +3410,7 @@ static std::optional<int> filelist_readjob_list_lib(FileListReadJob *job_params,
         LinkNode *group_datablock_infos = BLO_blendhandle_get_datablock_info(
             libfiledata, idcode, options & LIST_LIB_ASSETS_ONLY, &group_datablock_len);
         filelist_readjob_list_lib_add_datablocks(
-            job_params, entries, group_datablock_infos, true, idcode, group_name);
+            job_params, relbase, entries, group_datablock_infos, true, idcode, group_name);
         if (use_indexer) {
           ED_file_indexer_entries_extend_from_datablock_infos(
               &indexer_entries, group_datablock_infos, idcode);
@@ -3659,6 +3667,154 @@ static bool filelist_readjob_should_recurse_into_entry(const int max_recursion,
   return true;
 }
 
+/**
+ * State shared by the tasks reading the directories of a recursive listing. Every directory is
+ * read by its own task, which queues a new task for each sub-directory to read, so directories and
+ * libraries on slow storage are read concurrently by the workers of the task pool.
+ */
+struct FileListReadDirs {
+  FileListReadJob *job_params;
+  FileIndexer indexer_runtime;
+  bool do_lib;
+  char filter_glob[FILE_MAXFILE];
+  const bool *stop;
+  bool *do_update;
+  float *progress;
+
+  /** Protects the progress of the listing. */
+  ThreadMutex lock;
+  int dirs_done_count;
+  int dirs_todo_count;
+  /** Set when reading was stopped before all directories were read. */
+  bool interrupted;
+};
+
+static void filelist_readjob_recursive_dir_free_task(TaskPool *__restrict /*pool*/,
+                                                     void *taskdata)
+{
+  TodoDir *td_dir = static_cast<TodoDir *>(taskdata);
+  MEM_freeN(td_dir->dir);
+  MEM_freeN(td_dir);
+}
+
+static void filelist_readjob_recursive_dir_run(TaskPool *__restrict pool, void *taskdata);
+
+static void filelist_readjob_recursive_dir_push(TaskPool *pool, const int level, const char *dir)
+{
+  TodoDir *td_dir = MEM_cnew<TodoDir>(__func__);
+  td_dir->level = level;
+  td_dir->dir = BLI_strdup(dir);
+  BLI_task_pool_push(pool,
+                     filelist_readjob_recursive_dir_run,
+                     td_dir,
+                     true,
+                     filelist_readjob_recursive_dir_free_task);
+}
+
+static void filelist_readjob_recursive_dir_run(TaskPool *__restrict pool, void *taskdata)
+{
+  FileListReadDirs *read_dirs = static_cast<FileListReadDirs *>(BLI_task_pool_user_data(pool));
+  FileListReadJob *job_params = read_dirs->job_params;
+  const TodoDir *td_dir = static_cast<const TodoDir *>(taskdata);
+  if (*read_dirs->stop) {
+    BLI_mutex_lock(&read_dirs->lock);
+    read_dirs->interrupted = true;
+    BLI_mutex_unlock(&read_dirs->lock);
+    return;
+  }
+
+  FileList *filelist = job_params->tmp_filelist; /* Use the thread-safe filelist queue. */
+  ListBase entries = {nullptr};
+  int entries_num = 0;
+  char dir[FILE_MAX_LIBEXTRA];
+  char rel_subdir[FILE_MAX_LIBEXTRA];
+  const char *root = filelist->filelist.root;
+  const int max_recursion = filelist->max_recursion;
+  const char *subdir = td_dir->dir;
+  const int recursion_level = td_dir->level;
+  const bool skip_currpar = (recursion_level > 1);
+
+  /* ARRRG! We have to be very careful *not to use* common `BLI_path_utils.hh` helpers over
+   * entry->relpath itself (nor any path containing it), since it may actually be a datablock
+   * name inside .blend file, which can have slashes and backslashes! See #46827.
+   * Note that in the end, this means we 'cache' valid relative subdir once here,
+   * this is actually better. */
+  STRNCPY(rel_subdir, subdir);
+  BLI_path_abs(rel_subdir, root);
+  BLI_path_normalize_dir(rel_subdir, sizeof(rel_subdir));
+  BLI_path_rel(rel_subdir, root);
+
+  bool is_lib = false;
+  if (read_dirs->do_lib) {
+    ListLibOptions list_lib_options = LIST_LIB_OPTION_NONE;
+    if (!skip_currpar) {
+      list_lib_options |= LIST_LIB_ADD_PARENT;
+    }
+
+    /* Libraries are loaded recursively when max_recursion is set. It doesn't check if there is
+     * still a recursion level over. */
+    if (max_recursion > 0) {
+      list_lib_options |= LIST_LIB_RECURSIVE;
+    }
+    /* Only load assets when browsing an asset library. For normal file browsing we return all
+     * entries. `FLF_ASSETS_ONLY` filter can be enabled/disabled by the user. */
+    if (job_params->load_asset_library) {
+      list_lib_options |= LIST_LIB_ASSETS_ONLY;
+    }
+    std::optional<int> lib_entries_num = filelist_readjob_list_lib(job_params,
+                                                                   rel_subdir,
+                                                                   subdir,
+                                                                   &entries,
+                                                                   list_lib_options,
+                                                                   &read_dirs->indexer_runtime);
+    if (lib_entries_num) {
+      is_lib = true;
+      entries_num += *lib_entries_num;
+    }
+  }
+
+  if (!is_lib && BLI_is_dir(subdir)) {
+    entries_num = filelist_readjob_list_dir(rel_subdir,
+                                            subdir,
+                                            &entries,
+                                            read_dirs->filter_glob,
+                                            read_dirs->do_lib,
+                                            job_params->main_filepath,
+                                            skip_currpar);
+  }
+
+  int subdirs_num = 0;
+  LISTBASE_FOREACH (FileListInternEntry *, entry, &entries) {
+    entry->uid = filelist_uid_generate(filelist);
+    entry->name = fileentry_uiname(root, entry, dir);
+    entry->free_name = true;
+
+    if (filelist_readjob_should_recurse_into_entry(max_recursion, is_lib, recursion_level, entry))
+    {
+      /* We have a directory we want to list, add it to todo list!
+       * Using #BLI_path_join works but isn't needed as `root` has a trailing slash. */
+      BLI_string_join(dir, sizeof(dir), root, entry->relpath);
+      BLI_path_abs(dir, job_params->main_filepath);
+      BLI_path_normalize_dir(dir, sizeof(dir));
+      filelist_readjob_recursive_dir_push(pool, recursion_level + 1, dir);
+      subdirs_num++;
+    }
+  }
+
+  /* Entries are added as soon as a directory is read, sorting them is done when moving them to
+   * the file list in the main thread. */
+  const bool entries_added = filelist_readjob_append_entries(job_params, &entries, entries_num);
+
+  BLI_mutex_lock(&read_dirs->lock);
+  if (entries_added) {
+    *read_dirs->do_update = true;
+  }
+  read_dirs->dirs_todo_count += subdirs_num;
+  read_dirs->dirs_done_count++;
+  *read_dirs->progress = float(read_dirs->dirs_done_count) / float(read_dirs->dirs_todo_count);
+  BLI_mutex_unlock(&read_dirs->lock);
+}
+
 static void filelist_readjob_recursive_dir_add_items(const bool do_lib,
                                                      FileListReadJob *job_params,
                                                      const bool *stop,
@@ -3666,127 +3822,37 @@ static void filelist_readjob_recursive_dir_add_items(const bool do_lib,
                                                      float *progress)
 {
   FileList *filelist = job_params->tmp_filelist; /* Use the thread-safe filelist queue. */
-  ListBase entries = {nullptr};
-  BLI_Stack *todo_dirs;
-  TodoDir *td_dir;
   char dir[FILE_MAX_LIBEXTRA];
-  char filter_glob[FILE_MAXFILE];
-  const char *root = filelist->filelist.root;
-  const int max_recursion = filelist->max_recursion;
-  int dirs_done_count = 0, dirs_todo_count = 1;
 
-  todo_dirs = BLI_stack_new(sizeof(*td_dir), __func__);
-  td_dir = static_cast<TodoDir *>(BLI_stack_push_r(todo_dirs));
-  td_dir->level = 1;
+  FileListReadDirs read_dirs{};
+  read_dirs.job_params = job_params;
+  read_dirs.do_lib = do_lib;
+  read_dirs.stop = stop;
+  read_dirs.do_update = do_update;
+  read_dirs.progress = progress;
+  read_dirs.dirs_todo_count = 1;
+  BLI_mutex_init(&read_dirs.lock);
 
   STRNCPY(dir, filelist->filelist.root);
-  STRNCPY(filter_glob, filelist->filter_data.filter_glob);
+  STRNCPY(read_dirs.filter_glob, filelist->filter_data.filter_glob);
 
   BLI_path_abs(dir, job_params->main_filepath);
   BLI_path_normalize_dir(dir, sizeof(dir));
-  td_dir->dir = BLI_strdup(dir);
 
   /* Init the file indexer. */
-  FileIndexer indexer_runtime{};
+  FileIndexer &indexer_runtime = read_dirs.indexer_runtime;
   indexer_runtime.callbacks = filelist->indexer;
   if (indexer_runtime.callbacks->init_user_data) {
     indexer_runtime.user_data = indexer_runtime.callbacks->init_user_data(dir, sizeof(dir));
   }
 
-  while (!BLI_stack_is_empty(todo_dirs) && !(*stop)) {
-    int entries_num = 0;
-
-    char *subdir;
-    char rel_subdir[FILE_MAX_LIBEXTRA];
-    int recursion_level;
-    bool skip_currpar;
-
-    td_dir = static_cast<TodoDir *>(BLI_stack_peek(todo_dirs));
-    subdir = td_dir->dir;
-    recursion_level = td_dir->level;
-    skip_currpar = (recursion_level > 1);
-
-    BLI_stack_discard(todo_dirs);
-
-    /* ARRRG! We have to be very careful *not to use* common `BLI_path_utils.hh` helpers over
-     * entry->relpath itself (nor any path containing it), since it may actually be a datablock
-     * name inside .blend file, which can have slashes and backslashes! See #46827.
-     * Note that in the end, this means we 'cache' valid relative subdir once here,
-     * this is actually better. */
-    STRNCPY(rel_subdir, subdir);
-    BLI_path_abs(rel_subdir, root);
-    BLI_path_normalize_dir(rel_subdir, sizeof(rel_subdir));
-    BLI_path_rel(rel_subdir, root);
-
-    /* Update the current relative base path within the filelist root. */
-    STRNCPY(job_params->cur_relbase, rel_subdir);
-
-    bool is_lib = false;
-    if (do_lib) {
-      ListLibOptions list_lib_options = LIST_LIB_OPTION_NONE;
-      if (!skip_currpar) {
-        list_lib_options |= LIST_LIB_ADD_PARENT;
-      }
-
-      /* Libraries are loaded recursively when max_recursion is set. It doesn't check if there is
-       * still a recursion level over. */
-      if (max_recursion > 0) {
-        list_lib_options |= LIST_LIB_RECURSIVE;
-      }
-      /* Only load assets when browsing an asset library. For normal file browsing we return all
-       * entries. `FLF_ASSETS_ONLY` filter can be enabled/disabled by the user. */
-      if (job_params->load_asset_library) {
-        list_lib_options |= LIST_LIB_ASSETS_ONLY;
-      }
-      std::optional<int> lib_entries_num = filelist_readjob_list_lib(
-          job_params, subdir, &entries, list_lib_options, &indexer_runtime);
-      if (lib_entries_num) {
-        is_lib = true;
-        entries_num += *lib_entries_num;
-      }
-    }
-
-    if (!is_lib && BLI_is_dir(subdir)) {
-      entries_num = filelist_readjob_list_dir(job_params,
-                                              subdir,
-                                              &entries,
-                                              filter_glob,
-                                              do_lib,
-                                              job_params->main_filepath,
-                                              skip_currpar);
-    }
-
-    LISTBASE_FOREACH (FileListInternEntry *, entry, &entries) {
-      entry->uid = filelist_uid_generate(filelist);
-      entry->name = fileentry_uiname(root, entry, dir);
-      entry->free_name = true;
-
-      if (filelist_readjob_should_recurse_into_entry(
-              max_recursion, is_lib, recursion_level, entry))
-      {
-        /* We have a directory we want to list, add it to todo list!
-         * Using #BLI_path_join works but isn't needed as `root` has a trailing slash. */
-        BLI_string_join(dir, sizeof(dir), root, entry->relpath);
-        BLI_path_abs(dir, job_params->main_filepath);
-        BLI_path_normalize_dir(dir, sizeof(dir));
-        td_dir = static_cast<TodoDir *>(BLI_stack_push_r(todo_dirs));
-        td_dir->level = recursion_level + 1;
-        td_dir->dir = BLI_strdup(dir);
-        dirs_todo_count++;
-      }
-    }
-
-    if (filelist_readjob_append_entries(job_params, &entries, entries_num)) {
-      *do_update = true;
-    }
-
-    dirs_done_count++;
-    *progress = float(dirs_done_count) / float(dirs_todo_count);
-    MEM_freeN(subdir);
-  }
+  TaskPool *pool = BLI_task_pool_create(&read_dirs, TASK_PRIORITY_LOW);
+  filelist_readjob_recursive_dir_push(pool, 1, dir);
+  BLI_task_pool_work_and_wait(pool);
+  BLI_task_pool_free(pool);
 
   /* Finalize and free indexer. */
-  if (indexer_runtime.callbacks->filelist_finished && BLI_stack_is_empty(todo_dirs)) {
+  if (indexer_runtime.callbacks->filelist_finished && !read_dirs.interrupted) {
     indexer_runtime.callbacks->filelist_finished(indexer_runtime.user_data);
   }
   if (indexer_runtime.callbacks->free_user_data && indexer_runtime.user_data) {
@@ -3794,14 +3860,7 @@ static void filelist_readjob_recursive_dir_add_items(const bool do_lib,
     indexer_runtime.user_data = nullptr;
   }
 
-  /* If we were interrupted by stop, stack may not be empty and we need to free
-   * pending dir paths. */
-  while (!BLI_stack_is_empty(todo_dirs)) {
-    td_dir = static_cast<TodoDir *>(BLI_stack_peek(todo_dirs));
-    MEM_freeN(td_dir->dir);
-    BLI_stack_discard(todo_dirs);
-  }
-  BLI_stack_free(todo_dirs);
+  BLI_mutex_end(&read_dirs.lock);
 }
 
 static void filelist_readjob_do(const bool do_lib,
@@ -3890,7 +3949,7 @@ static void filelist_readjob_main_assets_add_items(FileListReadJob *job_params,
 
     entry = MEM_new<FileListInternEntry>(__func__);
     std::string datablock_path = StringRef(id_code_name) + SEP_STR + (id_iter->name + 2);
-    entry->relpath = current_relpath_append(job_params, datablock_path.c_str());
+    entry->relpath = current_relpath_append("", datablock_path.c_str());
     entry->name = id_iter->name + 2;
     entry->free_name = false;
     entry->typeflag |= FILE_TYPE_BLENDERLIB | FILE_TYPE_ASSET;
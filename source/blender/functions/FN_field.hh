@@ -492,6 +492,34 @@ Vector<GVArray> evaluate_fields(ResourceScope &scope,
                                 const FieldContext &context,
                                 Span<GVMutableArray> dst_varrays = {});
 
+/**
+ * The values of fields for a small part of the domain, see #evaluate_fields_chunked.
+ */
+struct FieldsChunk {
+  /** The first index in the domain that is part of the chunk. */
+  int64_t start;
+  /** Indices of the evaluated mask that are in the chunk, relative to #start. */
+  IndexMask mask;
+  /** Position of the first index of the chunk in the entire evaluated mask. */
+  int64_t mask_start;
+  /** The computed virtual array for each field, indexed relative to #start. */
+  Span<GVArray> values;
+};
+
+/**
+ * Same as #evaluate_fields, but the fields are evaluated in chunks that fit into the CPU cache.
+ * Instead of allocating arrays for the entire domain, only one chunk of values exists per thread
+ * at a time. This is more memory efficient when the computed values are consumed directly, e.g.
+ * to compute a reduction or to copy only selected values.
+ *
+ * \param fn: Called for every chunk, potentially from multiple threads at the same time. The
+ *   values of a chunk are only valid for the duration of the call.
+ */
+void evaluate_fields_chunked(Span<GFieldRef> fields_to_evaluate,
+                             const IndexMask &mask,
+                             const FieldContext &context,
+                             FunctionRef<void(const FieldsChunk &chunk)> fn);
+
 /* -------------------------------------------------------------------- */
 /** \name Utility functions for simple field creation and evaluation
  * \{ */
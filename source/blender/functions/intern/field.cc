@@ -3,6 +3,7 @@
  * SPDX-License-Identifier: GPL-2.0-or-later */
 
 #include "BLI_array_utils.hh"
+#include "BLI_index_ranges_builder.hh"
 #include "BLI_map.hh"
 #include "BLI_multi_value_map.hh"
 #include "BLI_set.hh"
@@ -278,6 +279,86 @@ static void build_multi_function_procedure_for_fields(mf::Procedure &procedure,
   BLI_assert(procedure.validate());
 }
 
+/**
+ * \return The virtual array for fields that don't have to be computed, i.e. inputs and
+ * constants, or an empty virtual array for operations.
+ */
+static GVArray get_unprocessed_field_varray(const GFieldRef &field,
+                                            const FieldTreeInfo &field_tree_info,
+                                            const Span<GVArray> field_context_inputs,
+                                            const int64_t array_size)
+{
+  const FieldNode &field_node = field.node();
+  switch (field_node.node_type()) {
+    case FieldNodeType::Input: {
+      const FieldInput &field_input = static_cast<const FieldInput &>(field.node());
+      const int field_input_index = field_tree_info.deduplicated_field_inputs.index_of(
+          field_input);
+      return field_context_inputs[field_input_index];
+    }
+    case FieldNodeType::Constant: {
+      const FieldConstant &field_constant = static_cast<const FieldConstant &>(field.node());
+      return GVArray::ForSingleRef(
+          field_constant.type(), array_size, field_constant.value().get());
+    }
+    case FieldNodeType::Operation: {
+      break;
+    }
+  }
+  return {};
+}
+
+/**
+ * Evaluate fields that don't depend on varying inputs only once and store them as single value
+ * virtual arrays in #r_varrays.
+ */
+static void evaluate_constant_fields(ResourceScope &scope,
+                                     const FieldTreeInfo &field_tree_info,
+                                     const Span<GVArray> field_context_inputs,
+                                     const Span<GFieldRef> constant_fields_to_evaluate,
+                                     const Span<int> constant_field_indices,
+                                     const int64_t array_size,
+                                     MutableSpan<GVArray> r_varrays)
+{
+  if (constant_fields_to_evaluate.is_empty()) {
+    return;
+  }
+  /* Build the procedure for those fields. */
+  mf::Procedure procedure;
+  build_multi_function_procedure_for_fields(
+      procedure, scope, field_tree_info, constant_fields_to_evaluate);
+  mf::ProcedureExecutor procedure_executor{procedure};
+  const IndexMask mask(1);
+  mf::ParamsBuilder mf_params{procedure_executor, &mask};
+  mf::ContextBuilder mf_context;
+
+  /* Provide inputs to the procedure executor. */
+  for (const GVArray &varray : field_context_inputs) {
+    mf_params.add_readonly_single_input(varray);
+  }
+
+  for (const int i : constant_fields_to_evaluate.index_range()) {
+    const GFieldRef &field = constant_fields_to_evaluate[i];
+    const CPPType &type = field.cpp_type();
+    /* Allocate memory where the computed value will be stored in. */
+    void *buffer = scope.linear_allocator().allocate(type.size(), type.alignment());
+
+    if (!type.is_trivially_destructible()) {
+      /* Destruct value in the end. */
+      scope.add_destruct_call([buffer, &type]() { type.destruct(buffer); });
+    }
+
+    /* Pass output buffer to the procedure executor. */
+    mf_params.add_uninitialized_single_output({type, buffer, 1});
+
+    /* Create virtual array that can be used after the procedure has been executed below. */
+    const int out_index = constant_field_indices[i];
+    r_varrays[out_index] = GVArray::ForSingleRef(type, array_size, buffer);
+  }
+
+  procedure_executor.call(mask, mf_params, mf_context);
+}
+
 Vector<GVArray> evaluate_fields(ResourceScope &scope,
                                 Span<GFieldRef> fields_to_evaluate,
                                 const IndexMask &mask,
@@ -318,27 +399,8 @@ Vector<GVArray> evaluate_fields(ResourceScope &scope,
 
   /* Finish fields that don't need any processing directly. */
   for (const int out_index : fields_to_evaluate.index_range()) {
-    const GFieldRef &field = fields_to_evaluate[out_index];
-    const FieldNode &field_node = field.node();
-    switch (field_node.node_type()) {
-      case FieldNodeType::Input: {
-        const FieldInput &field_input = static_cast<const FieldInput &>(field.node());
-        const int field_input_index = field_tree_info.deduplicated_field_inputs.index_of(
-            field_input);
-        const GVArray &varray = field_context_inputs[field_input_index];
-        r_varrays[out_index] = varray;
-        break;
-      }
-      case FieldNodeType::Constant: {
-        const FieldConstant &field_constant = static_cast<const FieldConstant &>(field.node());
-        r_varrays[out_index] = GVArray::ForSingleRef(
-            field_constant.type(), mask.min_array_size(), field_constant.value().get());
-        break;
-      }
-      case FieldNodeType::Operation: {
-        break;
-      }
-    }
+    r_varrays[out_index] = get_unprocessed_field_varray(
+        fields_to_evaluate[out_index], field_tree_info, field_context_inputs, array_size);
   }
 
   Set<GFieldRef> varying_fields = find_varying_fields(field_tree_info, field_context_inputs);
@@ -418,42 +480,13 @@ Vector<GVArray> evaluate_fields(ResourceScope &scope,
   }
 
   /* Evaluate constant fields if necessary. */
-  if (!constant_fields_to_evaluate.is_empty()) {
-    /* Build the procedure for those fields. */
-    mf::Procedure procedure;
-    build_multi_function_procedure_for_fields(
-        procedure, scope, field_tree_info, constant_fields_to_evaluate);
-    mf::ProcedureExecutor procedure_executor{procedure};
-    const IndexMask mask(1);
-    mf::ParamsBuilder mf_params{procedure_executor, &mask};
-    mf::ContextBuilder mf_context;
-
-    /* Provide inputs to the procedure executor. */
-    for (const GVArray &varray : field_context_inputs) {
-      mf_params.add_readonly_single_input(varray);
-    }
-
-    for (const int i : constant_fields_to_evaluate.index_range()) {
-      const GFieldRef &field = constant_fields_to_evaluate[i];
-      const CPPType &type = field.cpp_type();
-      /* Allocate memory where the computed value will be stored in. */
-      void *buffer = scope.linear_allocator().allocate(type.size(), type.alignment());
-
-      if (!type.is_trivially_destructible()) {
-        /* Destruct value in the end. */
-        scope.add_destruct_call([buffer, &type]() { type.destruct(buffer); });
-      }
-
-      /* Pass output buffer to the procedure executor. */
-      mf_params.add_uninitialized_single_output({type, buffer, 1});
-
-      /* Create virtual array that can be used after the procedure has been executed below. */
-      const int out_index = constant_field_indices[i];
-      r_varrays[out_index] = GVArray::ForSingleRef(type, array_size, buffer);
-    }
-
-    procedure_executor.call(mask, mf_params, mf_context);
-  }
+  evaluate_constant_fields(scope,
+                           field_tree_info,
+                           field_context_inputs,
+                           constant_fields_to_evaluate,
+                           constant_field_indices,
+                           array_size,
+                           r_varrays);
 
   /* Copy data to supplied destination arrays if necessary. In some cases the evaluation above
    * has written the computed data in the right place already. */
@@ -495,6 +528,143 @@ Vector<GVArray> evaluate_fields(ResourceScope &scope,
   return r_varrays;
 }
 
+/**
+ * Evaluates fields for one chunk of the domain at a time. Everything that is the same for all
+ * chunks, like retrieving the inputs from the context and building the procedure, is only done
+ * once.
+ */
+class FieldsChunkEvaluator : NonCopyable, NonMovable {
+ private:
+  ResourceScope scope_;
+  FieldTreeInfo field_tree_info_;
+  Vector<GVArray> field_context_inputs_;
+  /** Virtual arrays for the entire domain for the fields that are not computed per chunk. */
+  Array<GVArray> varrays_;
+  Vector<GFieldRef> varying_fields_to_evaluate_;
+  Vector<int> varying_field_indices_;
+  mf::Procedure procedure_;
+  std::optional<mf::ProcedureExecutor> procedure_executor_;
+
+ public:
+  FieldsChunkEvaluator(const Span<GFieldRef> fields_to_evaluate,
+                       const IndexMask &mask,
+                       const FieldContext &context)
+      : varrays_(fields_to_evaluate.size())
+  {
+    const int64_t array_size = mask.min_array_size();
+    field_tree_info_ = preprocess_field_tree(fields_to_evaluate);
+    field_context_inputs_ = get_field_context_inputs(
+        scope_, mask, context, field_tree_info_.deduplicated_field_inputs);
+
+    for (const int out_index : fields_to_evaluate.index_range()) {
+      varrays_[out_index] = get_unprocessed_field_varray(
+          fields_to_evaluate[out_index], field_tree_info_, field_context_inputs_, array_size);
+    }
+
+    const Set<GFieldRef> varying_fields = find_varying_fields(field_tree_info_,
+                                                              field_context_inputs_);
+    Vector<GFieldRef> constant_fields_to_evaluate;
+    Vector<int> constant_field_indices;
+    for (const int i : fields_to_evaluate.index_range()) {
+      if (varrays_[i]) {
+        continue;
+      }
+      const GFieldRef field = fields_to_evaluate[i];
+      if (varying_fields.contains(field)) {
+        varying_fields_to_evaluate_.append(field);
+        varying_field_indices_.append(i);
+      }
+      else {
+        constant_fields_to_evaluate.append(field);
+        constant_field_indices.append(i);
+      }
+    }
+
+    evaluate_constant_fields(scope_,
+                             field_tree_info_,
+                             field_context_inputs_,
+                             constant_fields_to_evaluate,
+                             constant_field_indices,
+                             array_size,
+                             varrays_);
+
+    if (!varying_fields_to_evaluate_.is_empty()) {
+      build_multi_function_procedure_for_fields(
+          procedure_, scope_, field_tree_info_, varying_fields_to_evaluate_);
+      procedure_executor_.emplace(procedure_);
+    }
+  }
+
+  /**
+   * Compute the values for the indices in the segment, which has to be part of the evaluated mask.
+   */
+  void evaluate(const IndexMaskSegment segment,
+                const int64_t mask_start,
+                const FunctionRef<void(const FieldsChunk &chunk)> fn) const
+  {
+    const IndexRange chunk_range = IndexRange::from_begin_end_inclusive(segment[0],
+                                                                        segment.last());
+    IndexMaskMemory memory;
+    const IndexMaskSegment chunk_segment = segment.shift(-chunk_range.start());
+    const IndexMask chunk_mask = IndexMask::from_segments({chunk_segment}, memory);
+
+    Array<GVArray, 16> chunk_varrays(varrays_.size());
+    for (const int i : varrays_.index_range()) {
+      if (varrays_[i]) {
+        chunk_varrays[i] = varrays_[i].slice(chunk_range);
+      }
+    }
+
+    /* Only the output buffers for a single chunk are allocated. */
+    LinearAllocator<> allocator;
+    Vector<GMutableSpan, 16> buffers;
+    if (procedure_executor_) {
+      mf::ParamsBuilder mf_params{*procedure_executor_, &chunk_mask};
+      mf::ContextBuilder mf_context;
+
+      for (const GVArray &varray : field_context_inputs_) {
+        mf_params.add_readonly_single_input(varray.slice(chunk_range));
+      }
+
+      for (const int i : varying_fields_to_evaluate_.index_range()) {
+        const CPPType &type = varying_fields_to_evaluate_[i].cpp_type();
+        void *buffer = allocator.allocate(type.size() * chunk_range.size(), type.alignment());
+        const GMutableSpan span{type, buffer, chunk_range.size()};
+        mf_params.add_uninitialized_single_output(span);
+        buffers.append(span);
+        chunk_varrays[varying_field_indices_[i]] = GVArray::ForSpan(span);
+      }
+
+      procedure_executor_->call_auto(chunk_mask, mf_params, mf_context);
+    }
+
+    fn(FieldsChunk{chunk_range.start(), chunk_mask, mask_start, chunk_varrays});
+
+    for (const GMutableSpan buffer : buffers) {
+      if (!buffer.type().is_trivially_destructible()) {
+        buffer.type().destruct_indices(buffer.data(), chunk_mask);
+      }
+    }
+  }
+};
+
+void evaluate_fields_chunked(const Span<GFieldRef> fields_to_evaluate,
+                             const IndexMask &mask,
+                             const FieldContext &context,
+                             const FunctionRef<void(const FieldsChunk &chunk)> fn)
+{
+  if (mask.is_empty()) {
+    return;
+  }
+  const FieldsChunkEvaluator evaluator(fields_to_evaluate, mask, context);
+  /* Every segment of the mask is a separate chunk. Its indices are in a small range, so that the
+   * values of all fields for a chunk fit into the CPU cache. */
+  mask.foreach_segment(GrainSize(4096),
+                       [&](const IndexMaskSegment segment, const int64_t segment_pos) {
+                         evaluator.evaluate(segment, segment_pos, fn);
+                       });
+}
+
 void evaluate_constant_field(const GField &field, void *r_value)
 {
   if (field.node().depends_on_input()) {
@@ -777,12 +947,34 @@ static IndexMask evaluate_selection(const Field<bool> &selection_field,
                                     IndexMask full_mask,
                                     ResourceScope &scope)
 {
-  if (selection_field) {
-    VArray<bool> selection =
-        evaluate_fields(scope, {selection_field}, full_mask, context)[0].typed<bool>();
-    return index_mask_from_selection(full_mask, selection, scope);
+  if (!selection_field) {
+    return full_mask;
+  }
+  if (selection_field.node().node_type() == FieldNodeType::Operation && !full_mask.is_empty()) {
+    /* Build the mask chunk by chunk to avoid allocating a boolean array for the entire domain. */
+    const FieldsChunkEvaluator evaluator({selection_field}, full_mask, context);
+    return IndexMask::from_batch_predicate(
+        full_mask,
+        GrainSize(4096),
+        scope.construct<IndexMaskMemory>(),
+        [&](const IndexMaskSegment universe_segment,
+            IndexRangesBuilder<int16_t> &builder) -> int64_t {
+          const int64_t chunk_start = universe_segment[0];
+          /* The position in the mask is not used here. */
+          evaluator.evaluate(universe_segment, 0, [&](const FieldsChunk &chunk) {
+            const VArraySpan<bool> selection = chunk.values[0].typed<bool>();
+            chunk.mask.foreach_index([&](const int64_t i) {
+              if (selection[i]) {
+                builder.add(int16_t(i));
+              }
+            });
+          });
+          return chunk_start;
+        });
   }
-  return full_mask;
+  VArray<bool> selection =
+      evaluate_fields(scope, {selection_field}, full_mask, context)[0].typed<bool>();
+  return index_mask_from_selection(full_mask, selection, scope);
 }
 
 void FieldEvaluator::evaluate()
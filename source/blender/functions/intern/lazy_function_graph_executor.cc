@@ -25,6 +25,14 @@
  * exceptions). The assumption here is that most nodes are only ever touched by a single thread and
  * therefore the lock contention is reduced the more nodes there are.
  *
+ * The most common state transitions don't need the lock though. Once the usage of an input is
+ * #ValueUsage::Used or #ValueUsage::Unused, it never changes again. Forwarding a value to such an
+ * input only publishes the value, decrements the atomic number of missing inputs and possibly
+ * schedules the node, which is an atomic state transition as well. This avoids contention on nodes
+ * with many inputs (fan-in) and locking many nodes when an output has many targets (fan-out). The
+ * lock is still used when the usage of an input may change concurrently, e.g. when a node requests
+ * a lazy input or when inputs and outputs become unused.
+ *
  * Similar to how a #LazyFunction can be thought of as a state machine (see `FN_lazy_function.hh`),
  * each node can also be thought of as a state machine. The state of a node contains the evaluation
  * state of its inputs and outputs. Every time a node is executed, it has to advance its state in
@@ -84,15 +92,19 @@ struct InputState {
    * computing their outputs, the computed values will be forwarded to linked input sockets. The
    * value will then live here until it is found that it is not needed anymore.
    *
-   * If #was_ready_for_execution is true, access does not require holding the node lock.
+   * If #was_ready_for_execution is true, access does not require holding the node lock. When
+   * #usage is #ValueUsage::Used, the value is set without holding the lock.
    */
-  void *value = nullptr;
+  std::atomic<void *> value = nullptr;
   /**
    * How the node intends to use this input. By default, all inputs may be used. Based on which
    * outputs are used, a node can decide that an input will definitely be used or is never used.
    * This allows freeing values early and avoids unnecessary computations.
+   *
+   * Changing it requires holding the node lock. Reading it does not, because the #ValueUsage::Used
+   * and #ValueUsage::Unused states are final.
    */
-  ValueUsage usage = ValueUsage::Maybe;
+  std::atomic<ValueUsage> usage = ValueUsage::Maybe;
   /**
    * Set to true once #value is set and will stay true afterwards. Access during execution of a
    * node, does not require holding the node lock.
@@ -147,9 +159,10 @@ struct NodeState {
   /**
    * Counts the number of inputs that still have to be provided to this node, until it should run
    * again. This is used as an optimization so that nodes are not scheduled unnecessarily in many
-   * cases.
+   * cases. It is incremented while the node is locked, before the input usage becomes used, and
+   * decremented without the lock when a value is forwarded to a used input.
    */
-  int missing_required_inputs = 0;
+  std::atomic<int> missing_required_inputs = 0;
   /**
    * Is set to true once the node is done with its work, i.e. when all outputs that may be used
    * have been computed.
@@ -177,9 +190,10 @@ struct NodeState {
   bool enabled_multi_threading = false;
   /**
    * A node is always in one specific schedule state. This helps to ensure that the same node does
-   * not run twice at the same time accidentally.
+   * not run twice at the same time accidentally. Nodes can be scheduled without holding the lock,
+   * so it is changed atomically.
    */
-  NodeScheduleState schedule_state = NodeScheduleState::NotScheduled;
+  std::atomic<NodeScheduleState> schedule_state = NodeScheduleState::NotScheduled;
   /**
    * Custom storage of the node.
    */
@@ -628,7 +642,7 @@ class Executor {
       NodeState &node_state = *node_states_[node->index_in_graph()];
       this->with_locked_node(
           *node, node_state, current_task, local_data, [&](LockedNode &locked_node) {
-            this->schedule_node(locked_node, current_task, false);
+            this->schedule_node(locked_node.node, locked_node.node_state, current_task, false);
           });
     }
   }
@@ -700,7 +714,7 @@ class Executor {
             return;
           }
           output_state.usage = ValueUsage::Used;
-          this->schedule_node(locked_node, current_task, false);
+          this->schedule_node(node, node_state, current_task, false);
         });
   }
 
@@ -728,39 +742,56 @@ class Executor {
               else {
                 /* Schedule as priority node. This allows freeing up memory earlier which results
                  * in better memory reuse and fewer implicit sharing copies. */
-                this->schedule_node(locked_node, current_task, true);
+                this->schedule_node(node, node_state, current_task, true);
               }
             }
           }
         });
   }
 
-  void schedule_node(LockedNode &locked_node, CurrentTask &current_task, const bool is_priority)
+  /**
+   * Does not require the node to be locked, because the schedule state is changed atomically.
+   */
+  void schedule_node(const Node &node,
+                     NodeState &node_state,
+                     CurrentTask &current_task,
+                     const bool is_priority)
   {
-    BLI_assert(locked_node.node.is_function());
-    switch (locked_node.node_state.schedule_state) {
-      case NodeScheduleState::NotScheduled: {
-        locked_node.node_state.schedule_state = NodeScheduleState::Scheduled;
-        const FunctionNode &node = static_cast<const FunctionNode &>(locked_node.node);
-        if (this->use_multi_threading()) {
-          std::lock_guard lock{current_task.mutex};
-          current_task.scheduled_nodes.schedule(node, is_priority);
+    BLI_assert(node.is_function());
+    NodeScheduleState old_state = node_state.schedule_state.load();
+    while (true) {
+      switch (old_state) {
+        case NodeScheduleState::NotScheduled: {
+          if (!node_state.schedule_state.compare_exchange_weak(old_state,
+                                                               NodeScheduleState::Scheduled))
+          {
+            continue;
+          }
+          const FunctionNode &fn_node = static_cast<const FunctionNode &>(node);
+          if (this->use_multi_threading()) {
+            std::lock_guard lock{current_task.mutex};
+            current_task.scheduled_nodes.schedule(fn_node, is_priority);
+          }
+          else {
+            current_task.scheduled_nodes.schedule(fn_node, is_priority);
+          }
+          current_task.has_scheduled_nodes.store(true, std::memory_order_relaxed);
+          return;
         }
-        else {
-          current_task.scheduled_nodes.schedule(node, is_priority);
+        case NodeScheduleState::Scheduled: {
+          return;
+        }
+        case NodeScheduleState::Running: {
+          if (!node_state.schedule_state.compare_exchange_weak(
+                  old_state, NodeScheduleState::RunningAndRescheduled))
+          {
+            continue;
+          }
+          return;
+        }
+        case NodeScheduleState::RunningAndRescheduled: {
+          return;
         }
-        current_task.has_scheduled_nodes.store(true, std::memory_order_relaxed);
-        break;
-      }
-      case NodeScheduleState::Scheduled: {
-        break;
-      }
-      case NodeScheduleState::Running: {
-        locked_node.node_state.schedule_state = NodeScheduleState::RunningAndRescheduled;
-        break;
-      }
-      case NodeScheduleState::RunningAndRescheduled: {
-        break;
       }
     }
   }
@@ -838,8 +869,8 @@ class Executor {
     bool node_needs_execution = false;
     this->with_locked_node(
         node, node_state, current_task, local_data, [&](LockedNode &locked_node) {
-          BLI_assert(node_state.schedule_state == NodeScheduleState::Scheduled);
-          node_state.schedule_state = NodeScheduleState::Running;
+          BLI_assert(node_state.schedule_state.load() == NodeScheduleState::Scheduled);
+          node_state.schedule_state.store(NodeScheduleState::Running);
 
           if (node_state.node_has_finished) {
             return;
@@ -878,7 +909,7 @@ class Executor {
             if (input_state.was_ready_for_execution) {
               continue;
             }
-            if (input_state.value != nullptr) {
+            if (input_state.value.load() != nullptr) {
               input_state.was_ready_for_execution = true;
               continue;
             }
@@ -910,9 +941,10 @@ class Executor {
           if (self_.logger_ != nullptr) {
             self_.logger_->log_socket_value(input_socket, {type, default_value}, local_context);
           }
-          BLI_assert(input_state.value == nullptr);
-          input_state.value = allocator.allocate(type.size(), type.alignment());
-          type.copy_construct(default_value, input_state.value);
+          BLI_assert(input_state.value.load() == nullptr);
+          void *value = allocator.allocate(type.size(), type.alignment());
+          type.copy_construct(default_value, value);
+          input_state.value.store(value);
           input_state.was_ready_for_execution = true;
         }
 
@@ -933,11 +965,11 @@ class Executor {
           }
 #endif
           this->finish_node_if_possible(locked_node);
-          const bool reschedule_requested = node_state.schedule_state ==
+          const bool reschedule_requested = node_state.schedule_state.exchange(
+                                                NodeScheduleState::NotScheduled) ==
                                             NodeScheduleState::RunningAndRescheduled;
-          node_state.schedule_state = NodeScheduleState::NotScheduled;
           if (reschedule_requested && !node_state.node_has_finished) {
-            this->schedule_node(locked_node, current_task, false);
+            this->schedule_node(node, node_state, current_task, false);
           }
         });
   }
@@ -948,10 +980,15 @@ class Executor {
     const FunctionNode &node = static_cast<const FunctionNode &>(locked_node.node);
     const NodeState &node_state = locked_node.node_state;
 
-    if (node_state.missing_required_inputs > 0) {
-      return;
+    /* Values of used inputs may be forwarded without locking the node, so #missing_required_inputs
+     * might have changed already. Whether the node got all its used inputs is checked instead. */
+    for (const int i : node.inputs().index_range()) {
+      const InputState &input_state = node_state.inputs[i];
+      if (input_state.usage == ValueUsage::Used && !input_state.was_ready_for_execution) {
+        return;
+      }
     }
-    if (node_state.schedule_state == NodeScheduleState::RunningAndRescheduled) {
+    if (node_state.schedule_state.load() == NodeScheduleState::RunningAndRescheduled) {
       return;
     }
     Vector<const OutputSocket *> missing_outputs;
@@ -1020,9 +1057,9 @@ class Executor {
 
   void destruct_input_value_if_exists(InputState &input_state, const CPPType &type)
   {
-    if (input_state.value != nullptr) {
-      type.destruct(input_state.value);
-      input_state.value = nullptr;
+    if (void *value = input_state.value.load()) {
+      type.destruct(value);
+      input_state.value.store(nullptr);
     }
   }
 
@@ -1090,15 +1127,17 @@ class Executor {
 
     BLI_assert(input_state.usage != ValueUsage::Unused);
 
-    if (input_state.value != nullptr) {
+    if (void *value = input_state.value.load()) {
       input_state.was_ready_for_execution = true;
-      return input_state.value;
+      return value;
     }
     if (input_state.usage == ValueUsage::Used) {
       return nullptr;
     }
-    input_state.usage = ValueUsage::Used;
-    node_state.missing_required_inputs += 1;
+    /* The counter has to be incremented first, because the value may be forwarded without locking
+     * the node as soon as the input is used. */
+    node_state.missing_required_inputs.fetch_add(1);
+    input_state.usage.store(ValueUsage::Used);
 
     const OutputSocket *origin_socket = input_socket.origin();
     /* Unlinked inputs are always loaded in advance. */
@@ -1161,22 +1200,35 @@ class Executor {
         }
         continue;
       }
+      const auto forward_to_input = [&]() {
+        if (is_last_target) {
+          /* No need to make a copy if this is the last target. */
+          this->forward_value_to_input(
+              target_node, node_state, input_state, value_to_forward, current_task);
+          value_to_forward = {};
+        }
+        else {
+          void *buffer = local_data.allocator->allocate(type.size(), type.alignment());
+          type.copy_construct(value_to_forward.get(), buffer);
+          this->forward_value_to_input(
+              target_node, node_state, input_state, {type, buffer}, current_task);
+        }
+      };
+      /* The used and unused states are final, so the node does not have to be locked for them. */
+      const ValueUsage usage = input_state.usage.load();
+      if (usage == ValueUsage::Unused) {
+        continue;
+      }
+      if (usage == ValueUsage::Used) {
+        forward_to_input();
+        continue;
+      }
       this->with_locked_node(
-          target_node, node_state, current_task, local_data, [&](LockedNode &locked_node) {
+          target_node, node_state, current_task, local_data, [&](LockedNode & /*locked_node*/) {
             if (input_state.usage == ValueUsage::Unused) {
               return;
             }
-            if (is_last_target) {
-              /* No need to make a copy if this is the last target. */
-              this->forward_value_to_input(
-                  locked_node, input_state, value_to_forward, current_task);
-              value_to_forward = {};
-            }
-            else {
-              void *buffer = local_data.allocator->allocate(type.size(), type.alignment());
-              type.copy_construct(value_to_forward.get(), buffer);
-              this->forward_value_to_input(locked_node, input_state, {type, buffer}, current_task);
-            }
+            forward_to_input();
           });
     }
     if (value_to_forward.get() != nullptr) {
@@ -1184,25 +1236,26 @@ class Executor {
     }
   }
 
-  void forward_value_to_input(LockedNode &locked_node,
+  /**
+   * The node only has to be locked when the input usage is not known to be used already.
+   */
+  void forward_value_to_input(const Node &node,
+                              NodeState &node_state,
                               InputState &input_state,
                               GMutablePointer value,
                               CurrentTask &current_task)
   {
-    NodeState &node_state = locked_node.node_state;
-
-    BLI_assert(input_state.value == nullptr);
+    BLI_assert(input_state.value.load() == nullptr);
     BLI_assert(!input_state.was_ready_for_execution);
-    input_state.value = value.get();
+    input_state.value.store(value.get());
 
     if (input_state.usage == ValueUsage::Used) {
-      node_state.missing_required_inputs -= 1;
-      if (node_state.missing_required_inputs == 0 ||
-          (locked_node.node.is_function() && static_cast<const FunctionNode &>(locked_node.node)
-                                                 .function()
-                                                 .allow_missing_requested_inputs()))
+      const int missing_inputs = node_state.missing_required_inputs.fetch_sub(1) - 1;
+      if (missing_inputs == 0 ||
+          (node.is_function() &&
+           static_cast<const FunctionNode &>(node).function().allow_missing_requested_inputs()))
       {
-        this->schedule_node(locked_node, current_task, false);
+        this->schedule_node(node, node_state, current_task, false);
       }
     }
   }
@@ -281,4 +281,68 @@ TEST(field, IgnoredOutput)
   EXPECT_EQ(results.get(3), 5);
 }
 
+TEST(field, ChunkedEvaluation)
+{
+  GField index_field{std::make_shared<IndexFieldInput>()};
+  auto add_fn = mf::build::SI2_SO<int, int, int>("add", [](int a, int b) { return a + b; });
+  GField add_field{FieldOperation::Create(add_fn, {index_field, index_field}), 0};
+  GField constant_field{
+      FieldOperation::Create(std::make_unique<mf::CustomMF_Constant<int>>(10), {}), 0};
+
+  IndexMaskMemory memory;
+  const IndexMask mask = IndexMask::from_predicate(
+      IndexRange(100000), GrainSize(1024), memory, [](const int64_t i) { return i % 3 != 0; });
+
+  Array<int> add_result(100000, -1);
+  Array<int> index_result(100000, -1);
+  Array<int> constant_result(100000, -1);
+  Array<int> mask_positions(100000, -1);
+  FieldContext context;
+  evaluate_fields_chunked(
+      {add_field, index_field, constant_field}, mask, context, [&](const FieldsChunk &chunk) {
+        const VArray<int> add_values = chunk.values[0].typed<int>();
+        const VArray<int> index_values = chunk.values[1].typed<int>();
+        const VArray<int> constant_values = chunk.values[2].typed<int>();
+        chunk.mask.foreach_index([&](const int64_t i, const int64_t pos) {
+          add_result[chunk.start + i] = add_values[i];
+          index_result[chunk.start + i] = index_values[i];
+          constant_result[chunk.start + i] = constant_values[i];
+          mask_positions[chunk.start + i] = chunk.mask_start + pos;
+        });
+      });
+
+  for (const int i : IndexRange(100000)) {
+    if (i % 3 == 0) {
+      EXPECT_EQ(add_result[i], -1);
+      continue;
+    }
+    EXPECT_EQ(add_result[i], i * 2);
+    EXPECT_EQ(index_result[i], i);
+    EXPECT_EQ(constant_result[i], 10);
+    EXPECT_EQ(mask_positions[i], i - (i / 3) - 1);
+  }
+}
+
+TEST(field, ComputedSelection)
+{
+  GField index_field{std::make_shared<IndexFieldInput>()};
+  auto is_selected_fn = mf::build::SI1_SO<int, bool>(
+      "is_selected", [](const int a) { return a % 7 == 0 || a > 60000; });
+  Field<bool> selection_field{FieldOperation::Create(is_selected_fn, {index_field}), 0};
+
+  IndexMaskMemory memory;
+  const IndexMask mask = IndexMask::from_predicate(
+      IndexRange(100000), GrainSize(1024), memory, [](const int64_t i) { return i % 2 == 0; });
+
+  FieldContext context;
+  FieldEvaluator evaluator{context, &mask};
+  evaluator.set_selection(selection_field);
+  evaluator.evaluate();
+  const IndexMask selection = evaluator.get_evaluated_selection_as_mask();
+
+  const IndexMask expected_selection = IndexMask::from_predicate(
+      mask, GrainSize(1024), memory, [](const int64_t i) { return i % 7 == 0 || i > 60000; });
+  EXPECT_EQ(selection, expected_selection);
+}
+
 }  // namespace blender::fn::tests
@@ -179,4 +179,111 @@ TEST(lazy_function, GraphWithCycle)
   EXPECT_EQ(result, 10 * 2 * 5);
 }
 
+class SumLazyFunction : public LazyFunction {
+ private:
+  bool lazy_inputs_;
+
+ public:
+  SumLazyFunction(const int inputs_num, const bool lazy_inputs) : lazy_inputs_(lazy_inputs)
+  {
+    debug_name_ = "Sum";
+    for ([[maybe_unused]] const int i : IndexRange(inputs_num)) {
+      inputs_.append_as("Value",
+                        CPPType::get<int>(),
+                        lazy_inputs ? ValueUsage::Maybe : ValueUsage::Used);
+    }
+    outputs_.append_as("Sum", CPPType::get<int>());
+  }
+
+  void execute_impl(Params &params, const Context & /*context*/) const override
+  {
+    int sum = 0;
+    bool inputs_missing = false;
+    for (const int i : inputs_.index_range()) {
+      if (lazy_inputs_) {
+        if (const int *value = params.try_get_input_data_ptr_or_request<int>(i)) {
+          sum += *value;
+        }
+        else {
+          inputs_missing = true;
+        }
+      }
+      else {
+        sum += params.get_input<int>(i);
+      }
+    }
+    if (!inputs_missing) {
+      params.set_output(0, sum);
+    }
+  }
+};
+
+/**
+ * Build a graph where the graph input is added to many values in separate nodes, whose results
+ * are summed up by a single node. Values are forwarded to many nodes at once (fan-out) and a
+ * single node gets values from many nodes (fan-in), possibly from different threads.
+ */
+static int execute_fan_out_fan_in_graph(const int width, const bool lazy_inputs, const int input)
+{
+  const AddLazyFunction add_fn;
+  const SumLazyFunction sum_fn{width, lazy_inputs};
+  Array<int> values(width);
+
+  Graph graph;
+  GraphInputSocket &graph_input = graph.add_input(CPPType::get<int>());
+  GraphOutputSocket &graph_output = graph.add_output(CPPType::get<int>());
+  FunctionNode &sum_node = graph.add_function(sum_fn);
+  for (const int i : IndexRange(width)) {
+    FunctionNode &add_node = graph.add_function(add_fn);
+    values[i] = i;
+    graph.add_link(graph_input, add_node.input(0));
+    add_node.input(1).set_default_value(&values[i]);
+    graph.add_link(add_node.output(0), sum_node.input(i));
+  }
+  graph.add_link(sum_node.output(0), graph_output);
+  graph.update_node_indices();
+
+  GraphExecutor executor_fn{graph, {&graph_input}, {&graph_output}, nullptr, nullptr, nullptr};
+  /* Thread-local user data is retrieved once the executor uses multiple threads. */
+  UserData user_data;
+  int result = 0;
+  execute_lazy_function_eagerly(
+      executor_fn, &user_data, nullptr, std::make_tuple(input), std::make_tuple(&result));
+  return result;
+}
+
+TEST(lazy_function, FanOutFanIn)
+{
+  BLI_task_scheduler_init();
+  for (const int width : {1, 10, 1000, 10000}) {
+    for (const bool lazy_inputs : {false, true}) {
+      const int expected = width * 7 + width * (width - 1) / 2;
+      EXPECT_EQ(execute_fan_out_fan_in_graph(width, lazy_inputs, 7), expected);
+    }
+  }
+}
+
+/**
+ * Set this to 1 to activate the benchmark. It is disabled by default, because it prints a lot.
+ */
+#if 0
+TEST(lazy_function, FanOutFanInBenchmark)
+{
+  BLI_task_scheduler_init();
+  for (const int width : {100, 1000, 10000}) {
+    for (const bool lazy_inputs : {false, true}) {
+      const int iterations = 100000 / width;
+      SCOPED_TIMER("width " + std::to_string(width) + (lazy_inputs ? " lazy" : "") + " x" +
+                   std::to_string(iterations));
+      int result = 0;
+      for (const int i : IndexRange(iterations)) {
+        result += execute_fan_out_fan_in_graph(width, lazy_inputs, i);
+      }
+      /* Print the value to avoid some compiler optimizations. */
+      std::cout << "Result: " << result << "\n";
+    }
+  }
+}
+#endif
+
 }  // namespace blender::fn::lazy_function::tests
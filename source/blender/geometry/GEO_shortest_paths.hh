@@ -0,0 +1,44 @@
+/* SPDX-FileCopyrightText: 2025 Blender Authors
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later */
+
+#pragma once
+
+#include "BLI_index_mask_fwd.hh"
+#include "BLI_math_vector_types.hh"
+#include "BLI_offset_indices.hh"
+#include "BLI_span.hh"
+
+/** \file
+ * \ingroup geo
+ *
+ * Shortest paths along the edges of a graph from a set of start vertices, computed in parallel
+ * with the delta-stepping algorithm. Instead of settling one vertex at a time like Dijkstra's
+ * algorithm, all vertices whose cost is in the same range ("bucket") are processed in parallel.
+ * The resulting costs are the same as with Dijkstra's algorithm.
+ */
+
+namespace blender::geometry {
+
+/**
+ * Find the lowest total cost of reaching every vertex from any of the start vertices.
+ *
+ * \param vert_to_edge_map: The edges connected to every vertex, see
+ * #bke::mesh::build_vert_to_edge_map.
+ * \param edge_costs: The cost of moving along every edge. Negative costs are used as zero.
+ * \param r_costs: The total cost of the path to every vertex. #FLT_MAX for vertices that can't be
+ * reached from a start vertex.
+ * \param r_next_verts: Optional, the vertex that comes before every vertex on its path, i.e. the
+ * next vertex when following the path back to its start vertex. -1 for start vertices and
+ * vertices that can't be reached. When there are multiple shortest paths, the previous vertex
+ * with the lowest cost and then the lowest index is used, so the result doesn't depend on
+ * multi-threading.
+ */
+void shortest_paths(Span<int2> edges,
+                    GroupedSpan<int> vert_to_edge_map,
+                    Span<float> edge_costs,
+                    const IndexMask &start_verts,
+                    MutableSpan<float> r_costs,
+                    MutableSpan<int> r_next_verts);
+
+}  // namespace blender::geometry
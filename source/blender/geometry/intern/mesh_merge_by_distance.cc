@@ -6,11 +6,13 @@
 // #define USE_WELD_DEBUG_TIME
 
 #include "BLI_array.hh"
+#include "BLI_array_utils.hh"
 #include "BLI_bit_vector.hh"
 #include "BLI_index_mask.hh"
 #include "BLI_kdtree.h"
 #include "BLI_math_vector.h"
 #include "BLI_offset_indices.hh"
+#include "BLI_task.hh"
 #include "BLI_vector.hh"
 
 #include "BKE_customdata.hh"
@@ -332,36 +334,46 @@ static Vector<WeldEdge> weld_edge_ctx_alloc_and_find_collapsed(Span<int2> edges,
                                                                MutableSpan<int> r_edge_dest_map,
                                                                int *r_edge_collapsed_len)
 {
-  /* Edge Context. */
-  int edge_collapsed_len = 0;
-
-  Vector<WeldEdge> wedge;
-  wedge.reserve(edges.size());
-
-  for (const int i : edges.index_range()) {
-    int v1 = edges[i][0];
-    int v2 = edges[i][1];
-    int v_dest_1 = vert_dest_map[v1];
-    int v_dest_2 = vert_dest_map[v2];
-    if (v_dest_1 == OUT_OF_CONTEXT && v_dest_2 == OUT_OF_CONTEXT) {
-      r_edge_dest_map[i] = OUT_OF_CONTEXT;
-      continue;
-    }
-
-    const int vert_a = (v_dest_1 == OUT_OF_CONTEXT) ? v1 : v_dest_1;
-    const int vert_b = (v_dest_2 == OUT_OF_CONTEXT) ? v2 : v_dest_2;
-
-    if (vert_a == vert_b) {
-      r_edge_dest_map[i] = ELEM_COLLAPSED;
-      edge_collapsed_len++;
-    }
-    else {
-      wedge.append({i, vert_a, vert_b});
-      r_edge_dest_map[i] = i;
-    }
-  }
+  const auto dest_vert = [&](const int vert) {
+    const int vert_dest = vert_dest_map[vert];
+    return (vert_dest == OUT_OF_CONTEXT) ? vert : vert_dest;
+  };
 
-  *r_edge_collapsed_len = edge_collapsed_len;
+  /* Edge Context. */
+  *r_edge_collapsed_len = threading::parallel_reduce(
+      edges.index_range(),
+      4096,
+      0,
+      [&](const IndexRange range, int edge_collapsed_len) {
+        for (const int i : range) {
+          const int v1 = edges[i][0];
+          const int v2 = edges[i][1];
+          if (vert_dest_map[v1] == OUT_OF_CONTEXT && vert_dest_map[v2] == OUT_OF_CONTEXT) {
+            r_edge_dest_map[i] = OUT_OF_CONTEXT;
+          }
+          else if (dest_vert(v1) == dest_vert(v2)) {
+            r_edge_dest_map[i] = ELEM_COLLAPSED;
+            edge_collapsed_len++;
+          }
+          else {
+            r_edge_dest_map[i] = i;
+          }
+        }
+        return edge_collapsed_len;
+      },
+      std::plus<>());
+
+  /* Compact the remaining edges, keeping them in ascending order. */
+  IndexMaskMemory memory;
+  const IndexMask wedge_mask = IndexMask::from_predicate(
+      edges.index_range(), GrainSize(4096), memory, [&](const int i) {
+        return r_edge_dest_map[i] == i;
+      });
+
+  Vector<WeldEdge> wedge(wedge_mask.size());
+  wedge_mask.foreach_index(GrainSize(4096), [&](const int i, const int pos) {
+    wedge[pos] = {i, dest_vert(edges[i][0]), dest_vert(edges[i][1])};
+  });
   return wedge;
 }
 
@@ -380,10 +392,8 @@ static void weld_edge_find_doubles(Span<WeldEdge> weld_edges,
                                    int *r_edge_double_kill_len)
 {
   /* Setup Edge Overlap. */
-  int edge_double_kill_len = 0;
-
   if (weld_edges.is_empty()) {
-    *r_edge_double_kill_len = edge_double_kill_len;
+    *r_edge_double_kill_len = 0;
     return;
   }
 
@@ -418,66 +428,58 @@ static void weld_edge_find_doubles(Span<WeldEdge> weld_edges,
     link_edge_buffer[--v_links[dst_vert_b]] = i;
   }
 
-  for (const int i : weld_edges.index_range()) {
-    const WeldEdge &we = weld_edges[i];
-    BLI_assert(r_edge_dest_map[we.edge_orig] != OUT_OF_CONTEXT);
-    if (r_edge_dest_map[we.edge_orig] != we.edge_orig) {
-      /* Already a duplicate. */
-      continue;
-    }
-
-    int dst_vert_a = we.vert_a;
-    int dst_vert_b = we.vert_b;
-
-    const int link_a = v_links[dst_vert_a];
-    const int link_b = v_links[dst_vert_b];
-
-    int edges_len_a = v_links[dst_vert_a + 1] - link_a;
-    int edges_len_b = v_links[dst_vert_b + 1] - link_b;
-
-    int edge_orig = we.edge_orig;
-    if (edges_len_a <= 1 || edges_len_b <= 1) {
-      /* This edge would form a group with only one element.
-       * For better performance, mark these edges and avoid forming these groups. */
-      r_edge_dest_map[edge_orig] = OUT_OF_CONTEXT;
-      continue;
-    }
-
-    int *edges_ctx_a = &link_edge_buffer[link_a];
-    int *edges_ctx_b = &link_edge_buffer[link_b];
-
-    const int edge_double_len_prev = edge_double_kill_len;
-    for (; edges_len_a--; edges_ctx_a++) {
-      int e_ctx_a = *edges_ctx_a;
-      if (e_ctx_a == i) {
-        continue;
-      }
-      while (edges_len_b && *edges_ctx_b < e_ctx_a) {
-        edges_ctx_b++;
-        edges_len_b--;
-      }
-      if (edges_len_b == 0) {
-        break;
-      }
-      int e_ctx_b = *edges_ctx_b;
-      if (e_ctx_a == e_ctx_b) {
-        const WeldEdge &we_b = weld_edges[e_ctx_b];
-        BLI_assert(ELEM(we_b.vert_a, dst_vert_a, dst_vert_b));
-        BLI_assert(ELEM(we_b.vert_b, dst_vert_a, dst_vert_b));
-        BLI_assert(we_b.edge_orig != edge_orig);
-        BLI_assert(r_edge_dest_map[we_b.edge_orig] == we_b.edge_orig);
-        r_edge_dest_map[we_b.edge_orig] = edge_orig;
-        edge_double_kill_len++;
-      }
-    }
-    if (edge_double_len_prev == edge_double_kill_len) {
-      /* This edge would form a group with only one element.
-       * For better performance, mark these edges and avoid forming these groups. */
-      r_edge_dest_map[edge_orig] = OUT_OF_CONTEXT;
-    }
-  }
-
-  *r_edge_double_kill_len = edge_double_kill_len;
+  /* The edges linked to both vertices of an edge are the edges with the same vertices. The first
+   * of them is the target of the others, so each edge can be handled independently. */
+  const OffsetIndices<int> vert_links(v_links);
+  *r_edge_double_kill_len = threading::parallel_reduce(
+      weld_edges.index_range(),
+      1024,
+      0,
+      [&](const IndexRange range, int edge_double_kill_len) {
+        for (const int i : range) {
+          const WeldEdge &we = weld_edges[i];
+          BLI_assert(r_edge_dest_map[we.edge_orig] == we.edge_orig);
+          const Span<int> edges_ctx_a = link_edge_buffer.as_span().slice(vert_links[we.vert_a]);
+          const Span<int> edges_ctx_b = link_edge_buffer.as_span().slice(vert_links[we.vert_b]);
+
+          /* Find the first two edges of the intersection. */
+          int doubles[2];
+          int doubles_num = 0;
+          int index_a = 0, index_b = 0;
+          while (index_a < edges_ctx_a.size() && index_b < edges_ctx_b.size() && doubles_num < 2)
+          {
+            const int e_ctx_a = edges_ctx_a[index_a];
+            const int e_ctx_b = edges_ctx_b[index_b];
+            if (e_ctx_a < e_ctx_b) {
+              index_a++;
+            }
+            else if (e_ctx_b < e_ctx_a) {
+              index_b++;
+            }
+            else {
+              doubles[doubles_num++] = e_ctx_a;
+              index_a++;
+              index_b++;
+            }
+          }
+          BLI_assert(doubles_num > 0 && doubles[0] <= i);
+
+          if (doubles[0] != i) {
+            const WeldEdge &we_dst = weld_edges[doubles[0]];
+            BLI_assert(ELEM(we_dst.vert_a, we.vert_a, we.vert_b));
+            BLI_assert(ELEM(we_dst.vert_b, we.vert_a, we.vert_b));
+            r_edge_dest_map[we.edge_orig] = we_dst.edge_orig;
+            edge_double_kill_len++;
+          }
+          else if (doubles_num == 1) {
+            /* This edge would form a group with only one element.
+             * For better performance, mark these edges and avoid forming these groups. */
+            r_edge_dest_map[we.edge_orig] = OUT_OF_CONTEXT;
+          }
+        }
+        return edge_double_kill_len;
+      },
+      std::plus<>());
 }
 
 /** \} */
@@ -583,109 +585,101 @@ static void weld_poly_loop_ctx_alloc(const OffsetIndices<int> faces,
   /* Loop/Poly Context. */
   Array<int> loop_map(corner_verts.size());
   Array<int> face_map(faces.size());
-  int wloop_len = 0;
-  int wpoly_len = 0;
-  int max_ctx_poly_len = 4;
-
-  Vector<WeldLoop> wloop;
-  wloop.reserve(corner_verts.size());
-
-  Vector<WeldPoly> wpoly;
-  wpoly.reserve(faces.size());
+  Array<int> loop_ctx_offsets(faces.size() + 1);
+
+  /* Count the context loops of every face. A loop is in the context when its vertex or the next
+   * one is. Meanwhile store the index of the loop among the context loops of its face. */
+  const int2 new_poly_info = threading::parallel_reduce(
+      faces.index_range(),
+      1024,
+      int2(0, 4),
+      [&](const IndexRange range, int2 info) {
+        for (const int i : range) {
+          const IndexRange face = faces[i];
+          const bool is_vert_first_ctx = vert_dest_map[corner_verts[face.first()]] !=
+                                         OUT_OF_CONTEXT;
+          bool is_vert_next_ctx = is_vert_first_ctx;
+          int loop_ctx_len = 0;
+          for (const int loop_orig : face) {
+            const bool is_vert_ctx = is_vert_next_ctx;
+            is_vert_next_ctx = (loop_orig != face.last()) ?
+                                   vert_dest_map[corner_verts[loop_orig + 1]] != OUT_OF_CONTEXT :
+                                   is_vert_first_ctx;
+            loop_map[loop_orig] = (is_vert_ctx || is_vert_next_ctx) ? loop_ctx_len++ :
+                                                                      OUT_OF_CONTEXT;
+          }
+          loop_ctx_offsets[i] = loop_ctx_len;
+          face_map[i] = OUT_OF_CONTEXT;
+
+          if (face.size() > 5 && loop_ctx_len > 1) {
+            /* We could be smarter here and actually count how many new polygons will be created.
+             * But counting this can be inefficient as it depends on the number of non-consecutive
+             * self face merges. For now just estimate a maximum value. */
+            int max_new = std::min(int(face.size() / 3), loop_ctx_len) - 1;
+            info[0] += max_new;
+            info[1] = std::max(info[1], int(face.size()));
+          }
+        }
+        return info;
+      },
+      [](const int2 a, const int2 b) { return int2(a[0] + b[0], std::max(a[1], b[1])); });
 
-  int maybe_new_poly = 0;
+  IndexMaskMemory memory;
+  const IndexMask ctx_faces = IndexMask::from_predicate(
+      faces.index_range(), GrainSize(4096), memory, [&](const int i) {
+        return loop_ctx_offsets[i] != 0;
+      });
+  const OffsetIndices<int> loop_ctx_offset_indices = offset_indices::accumulate_counts_to_offsets(
+      loop_ctx_offsets);
 
-  for (const int i : faces.index_range()) {
-    const int loopstart = faces[i].start();
-    const int totloop = faces[i].size();
-    const int loop_end = loopstart + totloop - 1;
-    int v_first = corner_verts[loopstart];
-    int v_dest_first = vert_dest_map[v_first];
-    bool is_vert_first_ctx = v_dest_first != OUT_OF_CONTEXT;
-
-    int v_next = v_first;
-    int v_dest_next = v_dest_first;
-    bool is_vert_next_ctx = is_vert_first_ctx;
-
-    int prev_wloop_len = wloop_len;
-    for (const int loop_orig : faces[i]) {
-      int v = v_next;
-      int v_dest = v_dest_next;
-      bool is_vert_ctx = is_vert_next_ctx;
+  Vector<WeldLoop> wloop(loop_ctx_offset_indices.total_size());
 
-      int loop_next;
-      if (loop_orig != loop_end) {
-        loop_next = loop_orig + 1;
-        v_next = corner_verts[loop_next];
-        v_dest_next = vert_dest_map[v_next];
-        is_vert_next_ctx = v_dest_next != OUT_OF_CONTEXT;
-      }
-      else {
-        loop_next = loopstart;
-        v_next = v_first;
-        v_dest_next = v_dest_first;
-        is_vert_next_ctx = is_vert_first_ctx;
+  Vector<WeldPoly> wpoly;
+  wpoly.reserve(ctx_faces.size() + new_poly_info[0]);
+  wpoly.resize(ctx_faces.size());
+
+  ctx_faces.foreach_index(GrainSize(1024), [&](const int i, const int pos) {
+    const IndexRange face = faces[i];
+    const IndexRange loops_ctx = loop_ctx_offset_indices[i];
+    for (const int loop_orig : face) {
+      if (loop_map[loop_orig] == OUT_OF_CONTEXT) {
+        continue;
       }
+      const int v = corner_verts[loop_orig];
+      const int v_dest = vert_dest_map[v];
+      const int e = corner_edges[loop_orig];
+      const int e_dest = edge_dest_map[e];
 
-      if (is_vert_ctx || is_vert_next_ctx) {
-        int e = corner_edges[loop_orig];
-        int e_dest = edge_dest_map[e];
-        bool is_edge_ctx = e_dest != OUT_OF_CONTEXT;
-
-        wloop.increase_size_by_unchecked(1);
-        WeldLoop &wl = wloop.last();
-        wl.vert = is_vert_ctx ? v_dest : v;
-        wl.edge = is_edge_ctx ? e_dest : e;
-        wl.loop_orig = loop_orig;
-        wl.loop_next = loop_next;
-
-        loop_map[loop_orig] = wloop_len++;
-      }
-      else {
-        loop_map[loop_orig] = OUT_OF_CONTEXT;
-      }
+      loop_map[loop_orig] += loops_ctx.start();
+      WeldLoop &wl = wloop[loop_map[loop_orig]];
+      wl.vert = (v_dest != OUT_OF_CONTEXT) ? v_dest : v;
+      wl.edge = (e_dest != OUT_OF_CONTEXT) ? e_dest : e;
+      wl.loop_orig = loop_orig;
+      wl.loop_next = (loop_orig != face.last()) ? loop_orig + 1 : face.start();
     }
 
-    if (wloop_len != prev_wloop_len) {
-      int loop_ctx_len = wloop_len - prev_wloop_len;
-      wpoly.increase_size_by_unchecked(1);
-
-      WeldPoly &wp = wpoly.last();
-      wp.poly_dst = OUT_OF_CONTEXT;
-      wp.poly_orig = i;
-      wp.loop_start = loopstart;
-      wp.loop_end = loop_end;
+    WeldPoly &wp = wpoly[pos];
+    wp.poly_dst = OUT_OF_CONTEXT;
+    wp.poly_orig = i;
+    wp.loop_start = face.start();
+    wp.loop_end = face.last();
 
-      wp.loop_ctx_start = prev_wloop_len;
-      wp.loop_ctx_len = loop_ctx_len;
+    wp.loop_ctx_start = loops_ctx.start();
+    wp.loop_ctx_len = loops_ctx.size();
 
 #ifdef USE_WELD_DEBUG
-      wp.loop_len = totloop;
+    wp.loop_len = face.size();
 #endif
 
-      face_map[i] = wpoly_len++;
-      if (totloop > 5 && loop_ctx_len > 1) {
-        /* We could be smarter here and actually count how many new polygons will be created.
-         * But counting this can be inefficient as it depends on the number of non-consecutive
-         * self face merges. For now just estimate a maximum value. */
-        int max_new = std::min((totloop / 3), loop_ctx_len) - 1;
-        maybe_new_poly += max_new;
-        CLAMP_MIN(max_ctx_poly_len, totloop);
-      }
-    }
-    else {
-      face_map[i] = OUT_OF_CONTEXT;
-    }
-  }
-
-  wpoly.reserve(wpoly.size() + maybe_new_poly);
+    face_map[i] = pos;
+  });
 
   r_weld_mesh->wloop = std::move(wloop);
   r_weld_mesh->wpoly = std::move(wpoly);
   r_weld_mesh->wpoly_new_len = 0;
   r_weld_mesh->loop_map = std::move(loop_map);
   r_weld_mesh->face_map = std::move(face_map);
-  r_weld_mesh->max_face_len = max_ctx_poly_len;
+  r_weld_mesh->max_face_len = new_poly_info[1];
 }
 
 static void weld_poly_split_recursive(int poly_loop_len,
@@ -852,6 +846,29 @@ static void weld_poly_split_recursive(int poly_loop_len,
 #endif
 }
 
+/**
+ * Check whether a face uses a merged vertex in more than one of its remaining loops, which is
+ * when #weld_poly_split_recursive splits or collapses it.
+ */
+static bool weld_poly_has_vert_repetition(const WeldPoly &wp,
+                                          const Span<WeldLoop> wloop,
+                                          const Span<int> vert_dest_map)
+{
+  const Span<WeldLoop> loops_ctx = wloop.slice(wp.loop_ctx_start, wp.loop_ctx_len);
+  for (const int i : loops_ctx.index_range()) {
+    const WeldLoop &wla = loops_ctx[i];
+    if (wla.flag == ELEM_COLLAPSED || vert_dest_map[wla.vert] == OUT_OF_CONTEXT) {
+      continue;
+    }
+    for (const WeldLoop &wlb : loops_ctx.drop_front(i + 1)) {
+      if (wlb.flag != ELEM_COLLAPSED && wlb.vert == wla.vert) {
+        return true;
+      }
+    }
+  }
+  return false;
+}
+
 /**
  * Alloc Weld Polygons and Weld Loops.
  *
@@ -880,92 +897,115 @@ static void weld_poly_loop_ctx_setup_collapsed_and_split(const int remain_edge_c
   Span<int> loop_map = r_weld_mesh->loop_map;
   Span<int> vert_dest_map = r_weld_mesh->vert_dest_map;
 
-  int face_kill_len = 0;
-  int loop_kill_len = 0;
-
   /* Setup Poly/Loop. */
-  /* `wpoly.size()` may change during the loop,
+  /* `wpoly.size()` may change when splitting,
    * so make it clear that we are only working with the original `wpoly` items. */
   IndexRange wpoly_original_range = r_weld_mesh->wpoly.index_range();
-  for (const int i : wpoly_original_range) {
-    WeldPoly &wp = wpoly[i];
-    int poly_loop_len = (wp.loop_end - wp.loop_start) + 1;
-    WeldLoop *wl_prev = nullptr;
-    bool chang_loop_start = false;
-    int l = wp.loop_start;
-    do {
-      int loop_ctx = loop_map[l];
-      if (loop_ctx == OUT_OF_CONTEXT) {
-        wl_prev = nullptr;
-        continue;
-      }
-
-      WeldLoop *wl = &wloop[loop_ctx];
-      const int edge_dest = wl->edge;
-      if (edge_dest == ELEM_COLLAPSED) {
-        wl->flag = ELEM_COLLAPSED;
-        if (poly_loop_len == 3) {
-          wp.flag = ELEM_COLLAPSED;
-          face_kill_len++;
-          loop_kill_len += 3;
-          poly_loop_len = 0;
-          break;
-        }
-
-        if (l == wp.loop_start) {
-          chang_loop_start = true;
-        }
+  Array<int> poly_loop_lens(wpoly_original_range.size());
+
+  /* Removing the collapsed loops only changes the face and its own loops, so faces are processed
+   * in parallel. */
+  const int2 kill_lens = threading::parallel_reduce(
+      wpoly_original_range,
+      1024,
+      int2(0),
+      [&](const IndexRange range, int2 kill_lens) {
+        for (const int i : range) {
+          WeldPoly &wp = wpoly[i];
+          int poly_loop_len = (wp.loop_end - wp.loop_start) + 1;
+          WeldLoop *wl_prev = nullptr;
+          bool chang_loop_start = false;
+          int l = wp.loop_start;
+          do {
+            int loop_ctx = loop_map[l];
+            if (loop_ctx == OUT_OF_CONTEXT) {
+              wl_prev = nullptr;
+              continue;
+            }
 
-        loop_kill_len++;
-        poly_loop_len--;
-      }
-      else {
-        if (chang_loop_start) {
-          wp.loop_start = l;
-          chang_loop_start = false;
-        }
-        if (wl_prev) {
-          wl_prev->loop_next = l;
-        }
-        wl_prev = wl;
-        BLI_assert(wl->loop_next == l + 1 || l == wp.loop_end);
-      }
-    } while (l++ != wp.loop_end);
+            WeldLoop *wl = &wloop[loop_ctx];
+            const int edge_dest = wl->edge;
+            if (edge_dest == ELEM_COLLAPSED) {
+              wl->flag = ELEM_COLLAPSED;
+              if (poly_loop_len == 3) {
+                wp.flag = ELEM_COLLAPSED;
+                kill_lens[0]++;
+                kill_lens[1] += 3;
+                poly_loop_len = 0;
+                break;
+              }
+
+              if (l == wp.loop_start) {
+                chang_loop_start = true;
+              }
+
+              kill_lens[1]++;
+              poly_loop_len--;
+            }
+            else {
+              if (chang_loop_start) {
+                wp.loop_start = l;
+                chang_loop_start = false;
+              }
+              if (wl_prev) {
+                wl_prev->loop_next = l;
+              }
+              wl_prev = wl;
+              BLI_assert(wl->loop_next == l + 1 || l == wp.loop_end);
+            }
+          } while (l++ != wp.loop_end);
 
-    if (poly_loop_len) {
-      if (wl_prev) {
-        wl_prev->loop_next = wp.loop_start;
-        wp.loop_end = wl_prev->loop_orig;
-      }
+          if (poly_loop_len) {
+            if (wl_prev) {
+              wl_prev->loop_next = wp.loop_start;
+              wp.loop_end = wl_prev->loop_orig;
+            }
 
 #ifdef USE_WELD_DEBUG
-      wp.loop_len = poly_loop_len;
-
-      for (int loop_orig : IndexRange(wp.loop_start, poly_loop_len)) {
-        int loop_ctx = loop_map[loop_orig];
-        if (loop_ctx == OUT_OF_CONTEXT) {
-          continue;
-        }
-
-        WeldLoop *wl = &wloop[loop_ctx];
-        if (wl->flag == ELEM_COLLAPSED) {
-          continue;
-        }
-
-        loop_ctx = loop_map[wl->loop_next];
-        if (loop_ctx == OUT_OF_CONTEXT) {
-          continue;
-        }
-
-        wl = &wloop[loop_ctx];
-        BLI_assert(wl->flag != ELEM_COLLAPSED);
-      }
+            wp.loop_len = poly_loop_len;
+
+            for (int loop_orig : IndexRange(wp.loop_start, poly_loop_len)) {
+              int loop_ctx = loop_map[loop_orig];
+              if (loop_ctx == OUT_OF_CONTEXT) {
+                continue;
+              }
+
+              WeldLoop *wl = &wloop[loop_ctx];
+              if (wl->flag == ELEM_COLLAPSED) {
+                continue;
+              }
+
+              loop_ctx = loop_map[wl->loop_next];
+              if (loop_ctx == OUT_OF_CONTEXT) {
+                continue;
+              }
+
+              wl = &wloop[loop_ctx];
+              BLI_assert(wl->flag != ELEM_COLLAPSED);
+            }
 #endif
-
-      weld_poly_split_recursive(
-          poly_loop_len, vert_dest_map, &wp, r_weld_mesh, &face_kill_len, &loop_kill_len);
-    }
-  }
+          }
+          poly_loop_lens[i] = poly_loop_len;
+        }
+        return kill_lens;
+      },
+      std::plus<>());
+
+  int face_kill_len = kill_lens[0];
+  int loop_kill_len = kill_lens[1];
+
+  /* Splitting adds new faces, so it is done serially. Only faces that use a merged vertex more
+   * than once are split, finding them is done in parallel. */
+  IndexMaskMemory memory;
+  const IndexMask faces_to_split = IndexMask::from_predicate(
+      wpoly_original_range, GrainSize(512), memory, [&](const int i) {
+        return poly_loop_lens[i] >= 3 &&
+               weld_poly_has_vert_repetition(wpoly[i], wloop, vert_dest_map);
+      });
+  faces_to_split.foreach_index([&](const int i) {
+    weld_poly_split_recursive(
+        poly_loop_lens[i], vert_dest_map, &wpoly[i], r_weld_mesh, &face_kill_len, &loop_kill_len);
+  });
 
   r_weld_mesh->face_kill_len = face_kill_len;
   r_weld_mesh->loop_kill_len = loop_kill_len;
@@ -1155,36 +1195,47 @@ static void weld_poly_find_doubles(const Span<int> corner_verts,
   }
 
   WeldPoly *wpoly = r_weld_mesh->wpoly.data();
-  MutableSpan<WeldLoop> wloop = r_weld_mesh->wloop;
+  Span<WeldLoop> wloop = r_weld_mesh->wloop;
   Span<int> loop_map = r_weld_mesh->loop_map;
-  int face_index = 0;
 
   const int face_len = r_weld_mesh->wpoly.size();
-  Array<int> poly_offs_(face_len + 1);
-  Vector<int> new_corner_edges;
-  new_corner_edges.reserve(corner_verts.size() - r_weld_mesh->loop_kill_len);
-
-  for (const WeldPoly &wp : r_weld_mesh->wpoly) {
-    poly_offs_[face_index++] = new_corner_edges.size();
 
+  /* Call the function for the edges of the remaining loops of a face. */
+  const auto foreach_poly_edge = [&](const WeldPoly &wp, const auto &fn) {
     WeldLoopOfPolyIter iter;
     if (!weld_iter_loop_of_poly_begin(
             iter, wp, wloop, corner_verts, corner_edges, loop_map, nullptr))
     {
-      continue;
+      return;
     }
 
     if (wp.poly_dst != OUT_OF_CONTEXT) {
-      continue;
+      return;
     }
 
     do {
-      new_corner_edges.append(iter.e);
+      fn(iter.e);
     } while (weld_iter_loop_of_poly_next(iter));
-  }
+  };
 
-  poly_offs_[face_len] = new_corner_edges.size();
-  OffsetIndices<int> poly_offs(poly_offs_);
+  Array<int> poly_offs_(face_len + 1);
+  threading::parallel_for(IndexRange(face_len), 1024, [&](const IndexRange range) {
+    for (const int face_index : range) {
+      int count = 0;
+      foreach_poly_edge(wpoly[face_index], [&](const int /*edge*/) { count++; });
+      poly_offs_[face_index] = count;
+    }
+  });
+  OffsetIndices<int> poly_offs = offset_indices::accumulate_counts_to_offsets(poly_offs_);
+
+  Array<int> new_corner_edges(poly_offs.total_size());
+  threading::parallel_for(IndexRange(face_len), 1024, [&](const IndexRange range) {
+    for (const int face_index : range) {
+      int corner = poly_offs[face_index].start();
+      foreach_poly_edge(wpoly[face_index],
+                        [&](const int edge) { new_corner_edges[corner++] = edge; });
+    }
+  });
 
   Vector<int> doubles_offsets;
   Array<int> doubles_buffer;
@@ -1451,83 +1502,80 @@ static void merge_customdata_all(const CustomData *source,
 
   const int source_size = dest_map.size();
 
-  MutableSpan<int> groups_offs_;
+  Array<int> groups_offs_;
   Array<int> groups_buffer;
   if (do_mix_data) {
-    r_final_map.reinitialize(source_size + 1);
-
-    /* Be careful when setting values to this array as it uses the same buffer as `r_final_map`. */
-    groups_offs_ = r_final_map;
+    groups_offs_.reinitialize(source_size + 1);
     merge_groups_create(dest_map, double_elems, groups_offs_, groups_buffer);
   }
-  else {
-    r_final_map.reinitialize(source_size);
-  }
   OffsetIndices<int> groups_offs(groups_offs_);
 
-  bool finalize_map = false;
-  int dest_index = 0;
-  for (int i = 0; i < source_size; i++) {
-    const int source_index = i;
-    int count = 0;
-    while (i < source_size && dest_map[i] == OUT_OF_CONTEXT) {
-      r_final_map[i] = dest_index + count;
-      count++;
-      i++;
-    }
-    if (count) {
-      CustomData_copy_data(source, dest, source_index, dest_index, count);
-      dest_index += count;
-    }
-    if (i == source_size) {
-      break;
-    }
-    if (dest_map[i] == i) {
-      if (do_mix_data) {
-        const IndexRange grp_buffer_range = groups_offs[i];
-        customdata_weld(source,
-                        dest,
-                        &groups_buffer[grp_buffer_range.start()],
-                        grp_buffer_range.size(),
-                        dest_index);
-      }
-      else {
-        CustomData_copy_data(source, dest, i, dest_index, 1);
-      }
-      r_final_map[i] = dest_index;
-      dest_index++;
-    }
-    else if (dest_map[i] == ELEM_COLLAPSED) {
-      /* Any value will do. This field must not be accessed anymore. */
-      r_final_map[i] = 0;
-    }
-    else {
+  r_final_map.reinitialize(source_size);
+
+  /* The elements that remain are compacted in their original order, the new index of each is its
+   * position in the mask. Every destination element is written once, so they are processed in
+   * parallel. */
+  IndexMaskMemory memory;
+  const IndexMask kept_elems = IndexMask::from_predicate(
+      dest_map.index_range(), GrainSize(4096), memory, [&](const int i) {
+        return ELEM(dest_map[i], OUT_OF_CONTEXT, i);
+      });
+  BLI_assert(kept_elems.size() == dest_size);
+
+  kept_elems.foreach_segment(
+      GrainSize(4096), [&](const IndexMaskSegment segment, const int64_t segment_pos) {
+        int64_t segment_i = 0;
+        while (segment_i < segment.size()) {
+          const int i = segment[segment_i];
+          const int dest_index = segment_pos + segment_i;
+          if (dest_map[i] == OUT_OF_CONTEXT) {
+            /* Copy consecutive elements at once. */
+            int count = 1;
+            while (segment_i + count < segment.size() && segment[segment_i + count] == i + count &&
+                   dest_map[i + count] == OUT_OF_CONTEXT)
+            {
+              count++;
+            }
+            CustomData_copy_data(source, dest, i, dest_index, count);
+            array_utils::fill_index_range(r_final_map.as_mutable_span().slice(i, count),
+                                          dest_index);
+            segment_i += count;
+            continue;
+          }
+
+          if (do_mix_data) {
+            const IndexRange grp_buffer_range = groups_offs[i];
+            customdata_weld(source,
+                            dest,
+                            &groups_buffer[grp_buffer_range.start()],
+                            grp_buffer_range.size(),
+                            dest_index);
+          }
+          else {
+            CustomData_copy_data(source, dest, i, dest_index, 1);
+          }
+          r_final_map[i] = dest_index;
+          segment_i++;
+        }
+      });
+
+  threading::parallel_for(dest_map.index_range(), 4096, [&](const IndexRange range) {
+    for (const int i : range) {
       const int elem_dest = dest_map[i];
-      BLI_assert(elem_dest != OUT_OF_CONTEXT);
-      BLI_assert(dest_map[elem_dest] == elem_dest);
-      if (elem_dest < i) {
-        r_final_map[i] = r_final_map[elem_dest];
-        BLI_assert(r_final_map[i] < dest_size);
+      if (ELEM(elem_dest, OUT_OF_CONTEXT, i)) {
+        continue;
       }
-      else {
-        /* Mark as negative to set at the end. */
-        r_final_map[i] = -elem_dest;
-        finalize_map = true;
+      if (elem_dest == ELEM_COLLAPSED) {
+        /* Any value will do. This field must not be accessed anymore. */
+        r_final_map[i] = 0;
       }
-    }
-  }
-
-  if (finalize_map) {
-    for (const int i : r_final_map.index_range()) {
-      if (r_final_map[i] < 0) {
-        r_final_map[i] = r_final_map[-r_final_map[i]];
+      else {
+        BLI_assert(dest_map[elem_dest] == elem_dest);
+        r_final_map[i] = r_final_map[elem_dest];
         BLI_assert(r_final_map[i] < dest_size);
       }
-      BLI_assert(r_final_map[i] >= 0);
     }
-  }
-
-  BLI_assert(dest_index == dest_size);
+  });
 }
 
 /** \} */
@@ -1590,98 +1638,116 @@ static Mesh *create_merged_mesh(const Mesh &mesh,
                        do_mix_data,
                        edge_final_map);
 
-  for (int2 &edge : dst_edges) {
-    edge[0] = vert_final_map[edge[0]];
-    edge[1] = vert_final_map[edge[1]];
-    BLI_assert(edge[0] != edge[1]);
-    BLI_assert(IN_RANGE_INCL(edge[0], 0, result_nverts - 1));
-    BLI_assert(IN_RANGE_INCL(edge[1], 0, result_nverts - 1));
-  }
+  threading::parallel_for(dst_edges.index_range(), 4096, [&](const IndexRange range) {
+    for (int2 &edge : dst_edges.slice(range)) {
+      edge[0] = vert_final_map[edge[0]];
+      edge[1] = vert_final_map[edge[1]];
+      BLI_assert(edge[0] != edge[1]);
+      BLI_assert(IN_RANGE_INCL(edge[0], 0, result_nverts - 1));
+      BLI_assert(IN_RANGE_INCL(edge[1], 0, result_nverts - 1));
+    }
+  });
 
   /* Faces/Loops. */
 
-  int r_i = 0;
-  int loop_cur = 0;
-  Array<int, 64> group_buffer(weld_mesh.max_face_len);
-  for (const int i : src_faces.index_range()) {
-    const int loop_start = loop_cur;
-    const int poly_ctx = weld_mesh.face_map[i];
-    if (poly_ctx == OUT_OF_CONTEXT) {
-      int mp_loop_len = src_faces[i].size();
-      CustomData_copy_data(
-          &mesh.corner_data, &result->corner_data, src_faces[i].start(), loop_cur, mp_loop_len);
-      for (; mp_loop_len--; loop_cur++) {
-        dst_corner_verts[loop_cur] = vert_final_map[dst_corner_verts[loop_cur]];
-        dst_corner_edges[loop_cur] = edge_final_map[dst_corner_edges[loop_cur]];
+  /* The source faces are followed by the new faces created by splitting. */
+  const IndexRange new_wpoly_range = weld_mesh.wpoly.index_range().take_back(
+      weld_mesh.wpoly_new_len);
+  const IndexRange all_faces_range(src_faces.size() + weld_mesh.wpoly_new_len);
+  const auto face_to_wpoly = [&](const int i) {
+    return (i < src_faces.size()) ? weld_mesh.face_map[i] :
+                                    new_wpoly_range[i - src_faces.size()];
+  };
+
+  /* Count the loops of every resulting face first, so that faces can be filled in parallel. Faces
+   * that are removed have no loops. */
+  Array<int> loop_offsets_data(all_faces_range.size() + 1);
+  threading::parallel_for(all_faces_range, 1024, [&](const IndexRange range) {
+    for (const int i : range) {
+      const int poly_ctx = face_to_wpoly(i);
+      if (poly_ctx == OUT_OF_CONTEXT) {
+        loop_offsets_data[i] = src_faces[i].size();
+        continue;
       }
-    }
-    else {
       const WeldPoly &wp = weld_mesh.wpoly[poly_ctx];
+      int loops_num = 0;
       WeldLoopOfPolyIter iter;
-      if (!weld_iter_loop_of_poly_begin(iter,
-                                        wp,
-                                        weld_mesh.wloop,
-                                        src_corner_verts,
-                                        src_corner_edges,
-                                        weld_mesh.loop_map,
-                                        group_buffer.data()))
+      if (weld_iter_loop_of_poly_begin(iter,
+                                       wp,
+                                       weld_mesh.wloop,
+                                       src_corner_verts,
+                                       src_corner_edges,
+                                       weld_mesh.loop_map,
+                                       nullptr) &&
+          wp.poly_dst == OUT_OF_CONTEXT)
       {
-        continue;
+        do {
+          loops_num++;
+        } while (weld_iter_loop_of_poly_next(iter));
       }
-
-      if (wp.poly_dst != OUT_OF_CONTEXT) {
-        continue;
+      loop_offsets_data[i] = loops_num;
+    }
+  });
+
+  IndexMaskMemory memory;
+  const IndexMask kept_faces = IndexMask::from_predicate(
+      all_faces_range, GrainSize(4096), memory, [&](const int i) {
+        return loop_offsets_data[i] != 0;
+      });
+  const OffsetIndices<int> loop_offsets = offset_indices::accumulate_counts_to_offsets(
+      loop_offsets_data);
+  BLI_assert(kept_faces.size() == result_nfaces);
+  BLI_assert(loop_offsets.total_size() == result_nloops);
+
+  kept_faces.foreach_segment(GrainSize(512), [&](const IndexMaskSegment segment,
+                                                 const int64_t segment_pos) {
+    Array<int, 64> group_buffer(weld_mesh.max_face_len);
+    for (const int64_t segment_i : segment.index_range()) {
+      const int i = segment[segment_i];
+      const int r_i = segment_pos + segment_i;
+      const IndexRange dst_face = loop_offsets[i];
+      const int poly_ctx = face_to_wpoly(i);
+      if (poly_ctx == OUT_OF_CONTEXT) {
+        CustomData_copy_data(&mesh.corner_data,
+                             &result->corner_data,
+                             src_faces[i].start(),
+                             dst_face.start(),
+                             dst_face.size());
+        for (const int loop_cur : dst_face) {
+          dst_corner_verts[loop_cur] = vert_final_map[dst_corner_verts[loop_cur]];
+          dst_corner_edges[loop_cur] = edge_final_map[dst_corner_edges[loop_cur]];
+        }
+      }
+      else {
+        const WeldPoly &wp = weld_mesh.wpoly[poly_ctx];
+        WeldLoopOfPolyIter iter;
+        weld_iter_loop_of_poly_begin(iter,
+                                     wp,
+                                     weld_mesh.wloop,
+                                     src_corner_verts,
+                                     src_corner_edges,
+                                     weld_mesh.loop_map,
+                                     group_buffer.data());
+        int loop_cur = dst_face.start();
+        do {
+          customdata_weld(&mesh.corner_data,
+                          &result->corner_data,
+                          group_buffer.data(),
+                          iter.group_len,
+                          loop_cur);
+          dst_corner_verts[loop_cur] = vert_final_map[iter.v];
+          dst_corner_edges[loop_cur] = edge_final_map[iter.e];
+          loop_cur++;
+        } while (weld_iter_loop_of_poly_next(iter));
+        BLI_assert(loop_cur == dst_face.one_after_last());
       }
-      do {
-        customdata_weld(&mesh.corner_data,
-                        &result->corner_data,
-                        group_buffer.data(),
-                        iter.group_len,
-                        loop_cur);
-        dst_corner_verts[loop_cur] = vert_final_map[iter.v];
-        dst_corner_edges[loop_cur] = edge_final_map[iter.e];
-        loop_cur++;
-      } while (weld_iter_loop_of_poly_next(iter));
-    }
-
-    CustomData_copy_data(&mesh.face_data, &result->face_data, i, r_i, 1);
-    dst_face_offsets[r_i] = loop_start;
-    r_i++;
-  }
-
-  /* New Polygons. */
-  for (const int i : weld_mesh.wpoly.index_range().take_back(weld_mesh.wpoly_new_len)) {
-    const WeldPoly &wp = weld_mesh.wpoly[i];
-    const int loop_start = loop_cur;
-    WeldLoopOfPolyIter iter;
-    if (!weld_iter_loop_of_poly_begin(iter,
-                                      wp,
-                                      weld_mesh.wloop,
-                                      src_corner_verts,
-                                      src_corner_edges,
-                                      weld_mesh.loop_map,
-                                      group_buffer.data()))
-    {
-      continue;
-    }
 
-    if (wp.poly_dst != OUT_OF_CONTEXT) {
-      continue;
+      if (i < src_faces.size()) {
+        CustomData_copy_data(&mesh.face_data, &result->face_data, i, r_i, 1);
+      }
+      dst_face_offsets[r_i] = dst_face.start();
     }
-    do {
-      customdata_weld(
-          &mesh.corner_data, &result->corner_data, group_buffer.data(), iter.group_len, loop_cur);
-      dst_corner_verts[loop_cur] = vert_final_map[iter.v];
-      dst_corner_edges[loop_cur] = edge_final_map[iter.e];
-      loop_cur++;
-    } while (weld_iter_loop_of_poly_next(iter));
-
-    dst_face_offsets[r_i] = loop_start;
-    r_i++;
-  }
-
-  BLI_assert(int(r_i) == result_nfaces);
-  BLI_assert(loop_cur == result_nloops);
+  });
 
   debug_randomize_mesh_order(result);
 
@@ -0,0 +1,382 @@
+/* SPDX-FileCopyrightText: 2025 Blender Authors
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later */
+
+#include <cfloat>
+#include <climits>
+#include <cstring>
+#include <map>
+
+#include "atomic_ops.h"
+
+#include "BLI_array.hh"
+#include "BLI_enumerable_thread_specific.hh"
+#include "BLI_index_mask.hh"
+#include "BLI_task.hh"
+#include "BLI_vector.hh"
+
+#include "GEO_shortest_paths.hh"
+
+namespace blender::geometry {
+
+/**
+ * Read a cost that may be lowered by other threads at the same time. The intern atomic API has no
+ * float load, so the bits are loaded atomically instead, like in #atomic_cas_float.
+ */
+static float load_cost(const float &cost)
+{
+  const uint32_t bits = atomic_load_uint32(reinterpret_cast<const uint32_t *>(&cost));
+  float value;
+  memcpy(&value, &bits, sizeof(float));
+  return value;
+}
+
+/** Lower the cost if the new cost is lower, returns true if the cost was changed. */
+static bool cost_lower_atomic(float &cost, const float new_cost)
+{
+  float old_cost = load_cost(cost);
+  while (new_cost < old_cost) {
+    const float prev_cost = atomic_cas_float(&cost, old_cost, new_cost);
+    if (prev_cost == old_cost) {
+      return true;
+    }
+    old_cost = prev_cost;
+  }
+  return false;
+}
+
+static void index_lower_atomic(int &index, const int new_index)
+{
+  int old_index = atomic_load_int32(&index);
+  while (new_index < old_index) {
+    const int prev_index = atomic_cas_int32(&index, old_index, new_index);
+    if (prev_index == old_index) {
+      return;
+    }
+    old_index = prev_index;
+  }
+}
+
+/** Append the vertices gathered by all threads. */
+static void append_thread_vectors(threading::EnumerableThreadSpecific<Vector<int>> &thread_verts,
+                                  Vector<int> &r_verts)
+{
+  for (Vector<int> &verts : thread_verts) {
+    r_verts.extend(verts);
+    verts.clear();
+  }
+}
+
+class DeltaStepping {
+  OffsetIndices<int> offsets_;
+  Span<int> neighbors_;
+  Span<float> neighbor_costs_;
+  MutableSpan<float> costs_;
+
+  /**
+   * The range of costs of every bucket. Edges with a cost up to the bucket size are "light"
+   * edges, which can lead to a vertex in the same bucket. "Heavy" edges always lead to a later
+   * bucket, so they only have to be followed once all costs in a bucket are final.
+   */
+  float bucket_size_;
+  /** Vertices whose cost was lowered to a cost in the bucket, may contain outdated entries. */
+  std::map<int64_t, Vector<int>> buckets_;
+
+  /** Used to only process every vertex once per iteration, even if it was added many times. */
+  Array<int> vert_light_iteration_;
+  Array<int> vert_heavy_iteration_;
+  int iteration_ = 0;
+
+  threading::EnumerableThreadSpecific<Vector<int>> thread_verts_;
+
+ public:
+  DeltaStepping(const OffsetIndices<int> offsets,
+                const Span<int> neighbors,
+                const Span<float> neighbor_costs,
+                MutableSpan<float> costs)
+      : offsets_(offsets),
+        neighbors_(neighbors),
+        neighbor_costs_(neighbor_costs),
+        costs_(costs),
+        vert_light_iteration_(costs.size(), -1),
+        vert_heavy_iteration_(costs.size(), -1)
+  {
+    bucket_size_ = this->calc_bucket_size();
+  }
+
+  void run(const IndexMask &start_verts)
+  {
+    start_verts.foreach_index([&](const int vert) { this->add_vert(vert); });
+
+    while (!buckets_.empty()) {
+      const int64_t bucket = buckets_.begin()->first;
+      Vector<int> candidates = std::move(buckets_.begin()->second);
+      buckets_.erase(buckets_.begin());
+
+      Vector<int> settled_verts;
+      while (!candidates.is_empty()) {
+        /* Follow light edges until no cost in the bucket changes anymore. */
+        while (!candidates.is_empty()) {
+          const Vector<int> verts = this->take_verts(
+              bucket, candidates, vert_light_iteration_, iteration_++);
+          candidates.clear();
+          settled_verts.extend(verts);
+          this->relax(verts, true, bucket, candidates);
+        }
+        /* Costs in the bucket are final, unless a heavy edge still leads to the same bucket
+         * because of floating point precision. */
+        const Vector<int> verts = this->take_verts(
+            bucket, settled_verts, vert_heavy_iteration_, iteration_++);
+        settled_verts.clear();
+        this->relax(verts, false, bucket, candidates);
+      }
+    }
+  }
+
+ private:
+  float calc_bucket_size() const
+  {
+    /* The average edge cost is used, so that the vertices in a bucket are roughly the next "ring"
+     * of vertices around the vertices in the previous bucket. */
+    const std::pair<double, int64_t> sum = threading::parallel_reduce(
+        neighbor_costs_.index_range(),
+        4096,
+        std::pair<double, int64_t>(0.0, 0),
+        [&](const IndexRange range, std::pair<double, int64_t> sum) {
+          for (const float cost : neighbor_costs_.slice(range)) {
+            if (cost > 0.0f) {
+              sum.first += cost;
+              sum.second++;
+            }
+          }
+          return sum;
+        },
+        [](const std::pair<double, int64_t> a, const std::pair<double, int64_t> b) {
+          return std::pair<double, int64_t>(a.first + b.first, a.second + b.second);
+        });
+    if (sum.second == 0) {
+      return 1.0f;
+    }
+    return std::max(float(sum.first / double(sum.second)), FLT_MIN);
+  }
+
+  int64_t bucket_of_cost(const float cost) const
+  {
+    return int64_t(std::min(double(cost) / double(bucket_size_), double(INT64_MAX / 2)));
+  }
+
+  void add_vert(const int vert)
+  {
+    buckets_[this->bucket_of_cost(load_cost(costs_[vert]))].append(vert);
+  }
+
+  /**
+   * Gather the vertices that are still in the bucket, without duplicates. Vertices whose cost
+   * was lowered to an earlier bucket have been processed already.
+   */
+  Vector<int> take_verts(const int64_t bucket,
+                         const Span<int> candidates,
+                         MutableSpan<int> vert_iterations,
+                         const int iteration)
+  {
+    threading::parallel_for(candidates.index_range(), 4096, [&](const IndexRange range) {
+      Vector<int> &verts = thread_verts_.local();
+      for (const int vert : candidates.slice(range)) {
+        if (this->bucket_of_cost(load_cost(costs_[vert])) != bucket) {
+          continue;
+        }
+        const int old_iteration = atomic_load_int32(&vert_iterations[vert]);
+        if (old_iteration == iteration) {
+          continue;
+        }
+        if (atomic_cas_int32(&vert_iterations[vert], old_iteration, iteration) == old_iteration) {
+          verts.append(vert);
+        }
+      }
+    });
+    Vector<int> verts;
+    append_thread_vectors(thread_verts_, verts);
+    return verts;
+  }
+
+  /**
+   * Lower the costs of the neighbors of the vertices across light or heavy edges. Neighbors whose
+   * cost changed are added to their bucket, or to \a r_candidates if it is the current bucket.
+   */
+  void relax(const Span<int> verts,
+             const bool light_edges,
+             const int64_t bucket,
+             Vector<int> &r_candidates)
+  {
+    threading::parallel_for(verts.index_range(), 256, [&](const IndexRange range) {
+      Vector<int> &changed_verts = thread_verts_.local();
+      for (const int vert : verts.slice(range)) {
+        const float cost = load_cost(costs_[vert]);
+        for (const int i : offsets_[vert]) {
+          const float edge_cost = neighbor_costs_[i];
+          if ((edge_cost <= bucket_size_) != light_edges) {
+            continue;
+          }
+          const int neighbor = neighbors_[i];
+          if (cost_lower_atomic(costs_[neighbor], cost + edge_cost)) {
+            changed_verts.append(neighbor);
+          }
+        }
+      }
+    });
+    for (Vector<int> &changed_verts : thread_verts_) {
+      for (const int vert : changed_verts) {
+        if (this->bucket_of_cost(load_cost(costs_[vert])) == bucket) {
+          r_candidates.append(vert);
+        }
+        else {
+          this->add_vert(vert);
+        }
+      }
+      changed_verts.clear();
+    }
+  }
+};
+
+/**
+ * Choose the previous vertex of every vertex on its path. Usually that is a neighbor with a lower
+ * cost, but with edges that have no cost, it can be a neighbor with the same cost. In that case
+ * the vertices with the same cost are connected in breadth-first order starting at the vertices
+ * that are connected already, to avoid creating cycles.
+ */
+static void calc_next_verts(const OffsetIndices<int> offsets,
+                            const Span<int> neighbors,
+                            const Span<float> neighbor_costs,
+                            const IndexMask &start_verts,
+                            const Span<float> costs,
+                            MutableSpan<int> r_next_verts)
+{
+  /* Zero for vertices that don't need a previous vertex or already have one, -1 otherwise. */
+  Array<int> vert_rounds(costs.size());
+  Array<bool> is_start(costs.size(), false);
+  start_verts.to_bools(is_start);
+
+  threading::parallel_for(costs.index_range(), 2048, [&](const IndexRange range) {
+    for (const int vert : range) {
+      r_next_verts[vert] = -1;
+      vert_rounds[vert] = 0;
+      const float cost = costs[vert];
+      if (is_start[vert] || cost == FLT_MAX) {
+        continue;
+      }
+      int best_vert = -1;
+      for (const int i : offsets[vert]) {
+        const int neighbor = neighbors[i];
+        const float neighbor_cost = costs[neighbor];
+        if (neighbor_cost >= cost || neighbor_cost + neighbor_costs[i] != cost) {
+          continue;
+        }
+        if (best_vert == -1 || neighbor_cost < costs[best_vert] ||
+            (neighbor_cost == costs[best_vert] && neighbor < best_vert))
+        {
+          best_vert = neighbor;
+        }
+      }
+      r_next_verts[vert] = best_vert;
+      vert_rounds[vert] = best_vert == -1 ? -1 : 0;
+    }
+  });
+
+  IndexMaskMemory memory;
+  const IndexMask unconnected_verts = IndexMask::from_predicate(
+      costs.index_range(), GrainSize(4096), memory, [&](const int vert) {
+        return vert_rounds[vert] == -1;
+      });
+  if (unconnected_verts.is_empty()) {
+    return;
+  }
+
+  auto is_same_cost_neighbor = [&](const int vert, const int i) {
+    const float neighbor_cost = costs[neighbors[i]];
+    return neighbor_cost == costs[vert] && neighbor_cost + neighbor_costs[i] == costs[vert];
+  };
+
+  /* The first round starts at the connected vertices. */
+  unconnected_verts.foreach_index(GrainSize(1024), [&](const int vert) {
+    int best_vert = INT_MAX;
+    for (const int i : offsets[vert]) {
+      if (vert_rounds[neighbors[i]] == 0 && is_same_cost_neighbor(vert, i)) {
+        best_vert = std::min(best_vert, neighbors[i]);
+      }
+    }
+    r_next_verts[vert] = best_vert;
+  });
+  Vector<int> frontier;
+  unconnected_verts.foreach_index([&](const int vert) {
+    if (r_next_verts[vert] != INT_MAX) {
+      vert_rounds[vert] = 1;
+      frontier.append(vert);
+    }
+  });
+
+  threading::EnumerableThreadSpecific<Vector<int>> thread_verts;
+  for (int round = 2; !frontier.is_empty(); round++) {
+    threading::parallel_for(frontier.index_range(), 256, [&](const IndexRange range) {
+      Vector<int> &next_frontier = thread_verts.local();
+      for (const int vert : frontier.as_span().slice(range)) {
+        for (const int i : offsets[vert]) {
+          const int neighbor = neighbors[i];
+          const int neighbor_round = atomic_load_int32(&vert_rounds[neighbor]);
+          if (!ELEM(neighbor_round, -1, round) || !is_same_cost_neighbor(vert, i)) {
+            continue;
+          }
+          const int old_round = atomic_cas_int32(&vert_rounds[neighbor], -1, round);
+          if (old_round == -1) {
+            next_frontier.append(neighbor);
+          }
+          index_lower_atomic(r_next_verts[neighbor], vert);
+        }
+      }
+    });
+    frontier.clear();
+    append_thread_vectors(thread_verts, frontier);
+  }
+
+  /* All vertices with a cost are connected to a start vertex by definition, this is just to be
+   * safe when costs are not finite. */
+  unconnected_verts.foreach_index(GrainSize(4096), [&](const int vert) {
+    if (r_next_verts[vert] == INT_MAX) {
+      r_next_verts[vert] = -1;
+    }
+  });
+}
+
+void shortest_paths(const Span<int2> edges,
+                    const GroupedSpan<int> vert_to_edge_map,
+                    const Span<float> edge_costs,
+                    const IndexMask &start_verts,
+                    MutableSpan<float> r_costs,
+                    MutableSpan<int> r_next_verts)
+{
+  const OffsetIndices<int> offsets = vert_to_edge_map.offsets;
+
+  /* Though it uses more memory, storing the adjacent vertex and the cost across each edge
+   * beforehand is noticeably faster. */
+  Array<int> neighbors(vert_to_edge_map.data.size());
+  Array<float> neighbor_costs(vert_to_edge_map.data.size());
+  threading::parallel_for(vert_to_edge_map.index_range(), 2048, [&](const IndexRange range) {
+    for (const int vert : range) {
+      r_costs[vert] = FLT_MAX;
+      for (const int i : offsets[vert]) {
+        const int edge = vert_to_edge_map.data[i];
+        neighbors[i] = edges[edge][0] == vert ? edges[edge][1] : edges[edge][0];
+        neighbor_costs[i] = std::max(0.0f, edge_costs[edge]);
+      }
+    }
+  });
+  start_verts.foreach_index(GrainSize(4096), [&](const int vert) { r_costs[vert] = 0.0f; });
+
+  DeltaStepping delta_stepping(offsets, neighbors, neighbor_costs, r_costs);
+  delta_stepping.run(start_verts);
+
+  if (!r_next_verts.is_empty()) {
+    calc_next_verts(offsets, neighbors, neighbor_costs, start_verts, r_costs, r_next_verts);
+  }
+}
+
+}  // namespace blender::geometry
@@ -6,6 +6,9 @@
  * \ingroup eduv
  */
 
+#include <array>
+#include <atomic>
+
 #include "GEO_uv_pack.hh"
 
 #include "BKE_global.hh"
@@ -22,6 +25,7 @@
 #include "BLI_polyfill_2d.h"
 #include "BLI_polyfill_2d_beautify.h"
 #include "BLI_rect.h"
+#include "BLI_task.hh"
 #include "BLI_vector.hh"
 
 #include "DNA_scene_types.h"
@@ -1128,6 +1132,16 @@ static void pack_island_box_pack_2d(const Span<std::unique_ptr<UVAABBIsland>> aa
   MEM_freeN(box_array);
 }
 
+/**
+ * Where the previous queries of an #Occupancy found it occupied, used to answer the next queries
+ * faster. Every search keeps its own hint, so that searches can run concurrently.
+ */
+struct OccupancyHint {
+  float2 witness = float2(-1.0f); /* Witness to a previously known occupied pixel. */
+  float witness_distance = 0.0f;  /* Signed distance to nearest placed island. */
+  uint triangle = 0;              /* Hint to a previously suspected overlapping triangle. */
+};
+
 /**
  * Helper class for the `xatlas` strategy.
  * Accelerates geometry queries by approximating exact queries with a bitmap.
@@ -1147,24 +1161,22 @@ class Occupancy {
                        const float2 &uv1,
                        const float2 &uv2,
                        const float margin,
-                       const bool write) const;
+                       const bool write,
+                       OccupancyHint &hint) const;
 
   /* Write or Query an island on the bitmap. */
   float trace_island(const PackIsland *island,
                      const UVPhi phi,
                      const float scale,
                      const float margin,
-                     const bool write) const;
+                     const bool write,
+                     OccupancyHint &hint) const;
 
   int bitmap_radix;              /* Width and Height of `bitmap`. */
   float bitmap_scale_reciprocal; /* == 1.0f / `bitmap_scale`. */
  private:
   mutable Array<float> bitmap_;
 
-  mutable float2 witness_;         /* Witness to a previously known occupied pixel. */
-  mutable float witness_distance_; /* Signed distance to nearest placed island. */
-  mutable uint triangle_hint_;     /* Hint to a previously suspected overlapping triangle. */
-
   const float terminal = 1048576.0f; /* 4 * bitmap_radix < terminal < INT_MAX / 4. */
 };
 
@@ -1186,13 +1198,7 @@ void Occupancy::increase_scale()
 
 void Occupancy::clear()
 {
-  for (int i = 0; i < bitmap_radix * bitmap_radix; i++) {
-    bitmap_[i] = terminal;
-  }
-  witness_.x = -1;
-  witness_.y = -1;
-  witness_distance_ = 0.0f;
-  triangle_hint_ = 0;
+  bitmap_.fill(terminal);
 }
 
 static float signed_distance_fat_triangle(const float2 probe,
@@ -1220,7 +1226,8 @@ float Occupancy::trace_triangle(const float2 &uv0,
                                 const float2 &uv1,
                                 const float2 &uv2,
                                 const float margin,
-                                const bool write) const
+                                const bool write,
+                                OccupancyHint &hint) const
 {
   const float x0 = min_fff(uv0.x, uv1.x, uv2.x);
   const float y0 = min_fff(uv0.y, uv1.y, uv2.y);
@@ -1241,10 +1248,10 @@ float Occupancy::trace_triangle(const float2 &uv0,
   epsilon = std::max(epsilon, 2 * margin * bitmap_scale_reciprocal);
 
   if (!write) {
-    if (ix0 <= witness_.x && witness_.x < ix1) {
-      if (iy0 <= witness_.y && witness_.y < iy1) {
-        const float distance = signed_distance_fat_triangle(witness_, uv0s, uv1s, uv2s);
-        const float extent = epsilon - distance - witness_distance_;
+    if (ix0 <= hint.witness.x && hint.witness.x < ix1) {
+      if (iy0 <= hint.witness.y && hint.witness.y < iy1) {
+        const float distance = signed_distance_fat_triangle(hint.witness, uv0s, uv1s, uv2s);
+        const float extent = epsilon - distance - hint.witness_distance;
         const float pixel_round_off = -0.1f; /* Go faster on nearly-axis aligned edges. */
         if (extent > pixel_round_off) {
           return std::max(0.0f, extent); /* Witness observes occupied. */
@@ -1268,8 +1275,8 @@ float Occupancy::trace_triangle(const float2 &uv0,
       }
       const float extent = epsilon - distance - *hotspot;
       if (extent > 0.0f) {
-        witness_ = probe;
-        witness_distance_ = *hotspot;
+        hint.witness = probe;
+        hint.witness_distance = *hotspot;
         return extent; /* Occupied. */
       }
     }
@@ -1310,7 +1317,8 @@ float Occupancy::trace_island(const PackIsland *island,
                               const UVPhi phi,
                               const float scale,
                               const float margin,
-                              const bool write) const
+                              const bool write,
+                              OccupancyHint &hint) const
 {
   const float2 diagonal_support = island->get_diagonal_support(scale, phi.rotation, margin);
 
@@ -1334,17 +1342,18 @@ float Occupancy::trace_island(const PackIsland *island,
   const uint vert_count = uint(
       island->triangle_vertices_.size()); /* `uint` is faster than `int`. */
   for (uint i = 0; i < vert_count; i += 3) {
-    const uint j = (i + triangle_hint_) % vert_count;
+    const uint j = (i + hint.triangle) % vert_count;
     float2 uv0;
     float2 uv1;
     float2 uv2;
     mul_v2_m2v2(uv0, matrix, island->triangle_vertices_[j]);
     mul_v2_m2v2(uv1, matrix, island->triangle_vertices_[j + 1]);
     mul_v2_m2v2(uv2, matrix, island->triangle_vertices_[j + 2]);
-    const float extent = trace_triangle(uv0 + delta, uv1 + delta, uv2 + delta, margin, write);
+    const float extent = trace_triangle(
+        uv0 + delta, uv1 + delta, uv2 + delta, margin, write, hint);
 
     if (!write && extent >= 0.0f) {
-      triangle_hint_ = j;
+      hint.triangle = j;
       return extent; /* Occupied. */
     }
   }
@@ -1358,7 +1367,8 @@ static UVPhi find_best_fit_for_island(const PackIsland *island,
                                       const int angle_90_multiple,
                                       /* TODO: const bool reflect, */
                                       const float margin,
-                                      const float target_aspect_y)
+                                      const float target_aspect_y,
+                                      OccupancyHint &hint)
 {
   /* Discussion: Different xatlas implementation make different choices here, either
    * fixing the output bitmap size before packing begins, or sometimes allowing
@@ -1400,7 +1410,7 @@ static UVPhi find_best_fit_for_island(const PackIsland *island,
   int t = int(ceilf((2 * support_diagonal.x + margin) * occupancy.bitmap_scale_reciprocal));
   while (t < scan_line_x) { /* "less-than" */
     phi.translation = float2(t * bitmap_scale, scan_line_y * bitmap_scale) - support_diagonal;
-    const float extent = occupancy.trace_island(island, phi, scale, margin, false);
+    const float extent = occupancy.trace_island(island, phi, scale, margin, false, hint);
     if (extent < 0.0f) {
       return phi; /* Success. */
     }
@@ -1411,7 +1421,7 @@ static UVPhi find_best_fit_for_island(const PackIsland *island,
   t = int(ceilf((2 * support_diagonal.y + margin) * occupancy.bitmap_scale_reciprocal));
   while (t <= scan_line_y) { /* "less-than-or-equal" */
     phi.translation = float2(scan_line_x * bitmap_scale, t * bitmap_scale) - support_diagonal;
-    const float extent = occupancy.trace_island(island, phi, scale, margin, false);
+    const float extent = occupancy.trace_island(island, phi, scale, margin, false, hint);
     if (extent < 0.0f) {
       return phi; /* Success. */
     }
@@ -1602,6 +1612,13 @@ static bool rotate_inside_square(const Span<std::unique_ptr<UVAABBIsland>> islan
   return true; /* `r_phis` and `r_extent` were modified. */
 }
 
+/** Extent of a layout that is computed in parallel with #pack_island_xatlas. */
+struct ConcurrentExtent {
+  /** Set once #extent is valid. */
+  std::atomic<bool> is_ready = false;
+  rctf extent;
+};
+
 /**
  * Pack irregular islands using the `xatlas` strategy, and optional D4 transforms.
  *
@@ -1617,6 +1634,11 @@ static bool rotate_inside_square(const Span<std::unique_ptr<UVAABBIsland>> islan
  * Performance of "xatlas" would normally be `O(n^4)` (or worse!), however, in our
  * implementation, `bitmap_radix` is a constant, which reduces the time complexity to `O(n^3)`.
  * => if `n` can ever be large, `bitmap_radix` will need to vary accordingly.
+ *
+ * Runs in parallel with another packer, which publishes its layout extent in \a other_extent
+ * when it is done. From then on, that extent bounds the search like \a r_extent does.
+ * The number of progress steps made is returned in \a r_progress_steps, so that the progress can
+ * be reported by the calling thread.
  */
 
 static int64_t pack_island_xatlas(const Span<std::unique_ptr<UVAABBIsland>> island_indices,
@@ -1624,14 +1646,20 @@ static int64_t pack_island_xatlas(const Span<std::unique_ptr<UVAABBIsland>> isla
                                   const float scale,
                                   const float margin,
                                   const UVPackIsland_Params &params,
+                                  const ConcurrentExtent &other_extent,
                                   MutableSpan<UVPhi> r_phis,
-                                  rctf *r_extent)
+                                  rctf *r_extent,
+                                  int *r_progress_steps)
 {
   if (params.shape_method == ED_UVPACK_SHAPE_AABB) {
     return 0; /* Not yet supported. */
   }
+  /* The best layout found by other packers so far. */
+  rctf best_extent = *r_extent;
+  bool use_other_extent = false;
   Array<UVPhi> phis(r_phis.size());
   Occupancy occupancy(guess_initial_scale(islands, scale, margin));
+  OccupancyHint hint;
   rctf extent = {0.0f, 0.0f, 0.0f, 0.0f};
 
   /* A heuristic to improve final layout efficiency by making an
@@ -1651,19 +1679,23 @@ static int64_t pack_island_xatlas(const Span<std::unique_ptr<UVAABBIsland>> isla
 
   while (i < island_indices.size()) {
 
-    if (params.stop && G.is_break) {
-      *params.stop = true;
-    }
-    if (params.isCancelled()) {
+    if (G.is_break || params.isCancelled()) {
       break;
     }
 
+    if (!use_other_extent && other_extent.is_ready.load(std::memory_order_acquire)) {
+      use_other_extent = true;
+      if (is_larger(best_extent, other_extent.extent, params)) {
+        best_extent = other_extent.extent;
+      }
+    }
+
     while (traced_islands < i) {
       /* Trace an island that's been solved. (Greedy.) */
       const int64_t island_index = island_indices[traced_islands]->index;
       PackIsland *island = islands[island_index];
       const float island_scale = island->can_scale_(params) ? scale : 1.0f;
-      occupancy.trace_island(island, phis[island_index], island_scale, margin, true);
+      occupancy.trace_island(island, phis[island_index], island_scale, margin, true, hint);
       traced_islands++;
     }
 
@@ -1692,16 +1724,34 @@ static int64_t pack_island_xatlas(const Span<std::unique_ptr<UVAABBIsland>> isla
       placed_can_rotate = false;
     }
 
-    for (int angle_90_multiple = 0; angle_90_multiple < max_90_multiple; angle_90_multiple++) {
-      phi = find_best_fit_for_island(island,
-                                     scan_line,
-                                     occupancy,
-                                     island_scale,
-                                     angle_90_multiple,
-                                     margin,
-                                     params.target_aspect_y);
-      if (phi.is_valid()) {
-        break;
+    phi = find_best_fit_for_island(
+        island, scan_line, occupancy, island_scale, 0, margin, params.target_aspect_y, hint);
+    if (!phi.is_valid() && max_90_multiple > 1) {
+      /* The other rotations are searched in parallel, all starting from the same hint. Like in a
+       * serial search the first rotation that fits is used, so the layout doesn't depend on
+       * threading. */
+      std::array<UVPhi, 4> rotation_phis;
+      std::array<OccupancyHint, 4> rotation_hints;
+      rotation_hints.fill(hint);
+      threading::parallel_for(IndexRange(1, max_90_multiple - 1), 1, [&](const IndexRange range) {
+        for (const int angle_90_multiple : range) {
+          rotation_phis[angle_90_multiple] = find_best_fit_for_island(
+              island,
+              scan_line,
+              occupancy,
+              island_scale,
+              angle_90_multiple,
+              margin,
+              params.target_aspect_y,
+              rotation_hints[angle_90_multiple]);
+        }
+      });
+      for (const int angle_90_multiple : IndexRange(1, max_90_multiple - 1)) {
+        phi = rotation_phis[angle_90_multiple];
+        hint = rotation_hints[angle_90_multiple];
+        if (phi.is_valid()) {
+          break;
+        }
       }
     }
 
@@ -1730,6 +1780,7 @@ static int64_t pack_island_xatlas(const Span<std::unique_ptr<UVAABBIsland>> isla
       /* Enlarge search parameters. */
       scan_line = 0;
       occupancy.increase_scale();
+      hint = {};
       traced_islands = 0; /* Will trigger a re-trace of previously solved islands. */
       continue;
     }
@@ -1745,6 +1796,7 @@ static int64_t pack_island_xatlas(const Span<std::unique_ptr<UVAABBIsland>> isla
         scan_line = 0;
         traced_islands = 0;
         occupancy.clear();
+        hint = {};
         continue;
       }
     }
@@ -1755,7 +1807,7 @@ static int64_t pack_island_xatlas(const Span<std::unique_ptr<UVAABBIsland>> isla
     extent.xmax = std::max(top_right.x, extent.xmax);
     extent.ymax = std::max(top_right.y, extent.ymax);
 
-    if (!is_larger(*r_extent, extent, params)) {
+    if (!is_larger(best_extent, extent, params)) {
       if (i >= square_milestone) {
         return 0; /* Early exit, we already have a better layout. */
       }
@@ -1769,19 +1821,12 @@ static int64_t pack_island_xatlas(const Span<std::unique_ptr<UVAABBIsland>> isla
       scan_line = std::max(0, scan_line - 25); /* `-25` must by odd. */
     }
 
-    if (params.progress) {
-      /* We don't (yet) have a good model for how long the pack operation is going
-       * to take, so just update the progress a little bit. */
-      const float previous_progress = *params.progress;
-      *params.do_update = true;
-      const float reduction = island_indices.size() / (island_indices.size() + 0.5f);
-      *params.progress = 1.0f - (1.0f - previous_progress) * reduction;
-    }
+    (*r_progress_steps)++;
   }
 
   /* TODO: if (i != island_indices.size()) { ??? } */
 
-  if (!is_larger(*r_extent, extent, params)) {
+  if (!is_larger(best_extent, extent, params)) {
     return 0;
   }
 
@@ -1956,15 +2001,62 @@ static float pack_islands_scale_margin(const Span<PackIsland *> islands,
     pack_islands_optimal_pack(slow_aabbs, params, r_phis, &extent);
   }
 
-  /* Call box_pack_2d (slow for large N.) */
-  if (locked_island_count == 0) { /* box_pack_2d doesn't yet support locked islands. */
-    pack_island_box_pack_2d(slow_aabbs, params, r_phis, &extent);
-  }
-
-  /* Call xatlas (slow for large N.) */
-  int64_t max_xatlas = pack_island_xatlas(
-      slow_aabbs, islands, scale, margin, params, r_phis, &extent);
-  if (max_xatlas) {
+  /* Call box_pack_2d and xatlas (both slow for large N.) in parallel, each writing to its own
+   * layout. Once box_pack_2d is done, xatlas stops as soon as it can't improve on its layout
+   * anymore. The xatlas layout is compared to the box_pack_2d layout afterwards, as if they were
+   * called one after the other. */
+  /* box_pack_2d doesn't yet support locked islands. */
+  const bool use_box_pack = locked_island_count == 0;
+  Array<UVPhi> box_pack_phis(use_box_pack ? r_phis.size() : 0);
+  ConcurrentExtent box_pack_extent;
+  box_pack_extent.extent = extent;
+  Array<UVPhi> xatlas_phis(r_phis.size());
+  rctf xatlas_extent = extent;
+  int64_t max_xatlas = 0;
+  int xatlas_progress_steps = 0;
+  threading::parallel_invoke(
+      slow_aabbs.size() > 16,
+      [&]() {
+        if (use_box_pack) {
+          pack_island_box_pack_2d(slow_aabbs, params, box_pack_phis, &box_pack_extent.extent);
+        }
+        box_pack_extent.is_ready.store(true, std::memory_order_release);
+      },
+      [&]() {
+        max_xatlas = pack_island_xatlas(slow_aabbs,
+                                        islands,
+                                        scale,
+                                        margin,
+                                        params,
+                                        box_pack_extent,
+                                        xatlas_phis,
+                                        &xatlas_extent,
+                                        &xatlas_progress_steps);
+      });
+
+  if (params.stop && G.is_break) {
+    *params.stop = true;
+  }
+  if (params.progress && xatlas_progress_steps > 0) {
+    /* We don't (yet) have a good model for how long the pack operation is going
+     * to take, so just update the progress a little bit for every island xatlas placed. */
+    const float reduction = slow_aabbs.size() / (slow_aabbs.size() + 0.5f);
+    *params.progress = 1.0f -
+                       (1.0f - *params.progress) * powf(reduction, float(xatlas_progress_steps));
+    *params.do_update = true;
+  }
+
+  if (use_box_pack && is_larger(extent, box_pack_extent.extent, params)) {
+    extent = box_pack_extent.extent;
+    for (const std::unique_ptr<UVAABBIsland> &aabb : slow_aabbs) {
+      r_phis[aabb->index] = box_pack_phis[aabb->index];
+    }
+  }
+  if (max_xatlas && is_larger(extent, xatlas_extent, params)) {
+    extent = xatlas_extent;
+    for (const std::unique_ptr<UVAABBIsland> &aabb : slow_aabbs.take_front(max_xatlas)) {
+      r_phis[aabb->index] = xatlas_phis[aabb->index];
+    }
     slow_aabbs = aabbs.as_span().take_front(max_xatlas);
   }
 
@@ -2265,15 +2357,18 @@ class OverlapMerger {
 
 static void finalize_geometry(const Span<PackIsland *> islands, const UVPackIsland_Params &params)
 {
-  MemArena *arena = BLI_memarena_new(BLI_MEMARENA_STD_BUFSIZE, __func__);
-  Heap *heap = BLI_heap_new();
-  for (const int64_t i : islands.index_range()) {
-    islands[i]->finalize_geometry_(params, arena, heap);
-    BLI_memarena_clear(arena);
-  }
-
-  BLI_heap_free(heap, nullptr);
-  BLI_memarena_free(arena);
+  /* Islands are independent, each thread uses its own arena and heap. */
+  threading::parallel_for(islands.index_range(), 64, [&](const IndexRange range) {
+    MemArena *arena = BLI_memarena_new(BLI_MEMARENA_STD_BUFSIZE, __func__);
+    Heap *heap = BLI_heap_new();
+    for (const int64_t i : range) {
+      islands[i]->finalize_geometry_(params, arena, heap);
+      BLI_memarena_clear(arena);
+    }
+
+    BLI_heap_free(heap, nullptr);
+    BLI_memarena_free(arena);
+  });
 }
 
 float pack_islands(const Span<PackIsland *> islands, const UVPackIsland_Params &params)
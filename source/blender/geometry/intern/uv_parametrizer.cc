@@ -12,6 +12,7 @@
 #include "GEO_uv_parametrizer.hh"
 
 #include "BLI_array.hh"
+#include "BLI_array_utils.hh"
 #include "BLI_convexhull_2d.h"
 #include "BLI_ghash.h"
 #include "BLI_math_geom.h"
@@ -21,6 +22,7 @@
 #include "BLI_polyfill_2d.h"
 #include "BLI_polyfill_2d_beautify.h"
 #include "BLI_rand.h"
+#include "BLI_task.hh"
 
 #ifdef WITH_UV_SLIM
 #  include "slim_matrix_transfer.h"
@@ -4060,28 +4062,51 @@ void uv_parametrizer_construct_end(ParamHandle *phandle,
   phandle->state = PHANDLE_STATE_CONSTRUCTED;
 }
 
+/**
+ * Call a function for every chart in parallel. Charts don't share any elements or solver state,
+ * so they can be processed independently. The largest charts are started first, so that they
+ * don't end up being solved alone at the end.
+ */
+static void p_charts_foreach_parallel(ParamHandle *phandle,
+                                      const FunctionRef<void(int chart_index)> fn)
+{
+  Array<int> order(phandle->ncharts);
+  array_utils::fill_index_range<int>(order);
+  std::stable_sort(order.begin(), order.end(), [&](const int a, const int b) {
+    return phandle->charts[a]->nfaces > phandle->charts[b]->nfaces;
+  });
+  threading::parallel_for(order.index_range(), 1, [&](const IndexRange range) {
+    for (const int i : range) {
+      fn(order[i]);
+    }
+  });
+}
+
 void uv_parametrizer_lscm_begin(ParamHandle *phandle, bool live, bool abf)
 {
   BLI_assert(phandle->state == PHANDLE_STATE_CONSTRUCTED);
   phandle->state = PHANDLE_STATE_LSCM;
 
-  for (int i = 0; i < phandle->ncharts; i++) {
+  p_charts_foreach_parallel(phandle, [&](const int i) {
     for (PFace *f = phandle->charts[i]->faces; f; f = f->nextlink) {
       p_face_backup_uvs(f);
     }
     p_chart_lscm_begin(phandle->charts[i], live, abf);
-  }
+  });
 }
 
 void uv_parametrizer_lscm_solve(ParamHandle *phandle, int *count_changed, int *count_failed)
 {
   BLI_assert(phandle->state == PHANDLE_STATE_LSCM);
 
-  for (int i = 0; i < phandle->ncharts; i++) {
+  /* Whether each chart was solved, empty for charts that are skipped. */
+  Array<std::optional<bool>> results(phandle->ncharts);
+
+  p_charts_foreach_parallel(phandle, [&](const int i) {
     PChart *chart = phandle->charts[i];
 
     if (!chart->context) {
-      continue;
+      return;
     }
     const bool result = p_chart_lscm_solve(phandle, chart);
 
@@ -4098,7 +4123,14 @@ void uv_parametrizer_lscm_solve(ParamHandle *phandle, int *count_changed, int *c
       p_chart_lscm_end(chart);
     }
 
-    if (result) {
+    results[i] = result;
+  });
+
+  for (const std::optional<bool> &result : results) {
+    if (!result.has_value()) {
+      continue;
+    }
+    if (*result) {
       if (count_changed != nullptr) {
         *count_changed += 1;
       }
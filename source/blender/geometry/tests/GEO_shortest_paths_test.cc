@@ -0,0 +1,188 @@
+/* SPDX-FileCopyrightText: 2025 Blender Authors
+ *
+ * SPDX-License-Identifier: Apache-2.0 */
+
+#include <cfloat>
+#include <queue>
+
+#include "BLI_array.hh"
+#include "BLI_index_mask.hh"
+#include "BLI_offset_indices.hh"
+#include "BLI_rand.hh"
+#include "BLI_vector.hh"
+
+#include "GEO_shortest_paths.hh"
+
+#include "testing/testing.h"
+
+namespace blender::geometry::tests {
+
+struct TestGraph {
+  int verts_num = 0;
+  Vector<int2> edges;
+  Vector<float> edge_costs;
+  Array<int> vert_to_edge_offsets;
+  Array<int> vert_to_edge_indices;
+
+  GroupedSpan<int> vert_to_edge_map() const
+  {
+    return {OffsetIndices<int>(vert_to_edge_offsets), vert_to_edge_indices};
+  }
+};
+
+/**
+ * A grid of vertices with random edge costs, with some of the edges removed so that there are
+ * vertices that can't be reached.
+ */
+static TestGraph create_test_graph(const int size, const bool with_zero_costs, const uint32_t seed)
+{
+  RandomNumberGenerator rng(seed);
+  TestGraph graph;
+  graph.verts_num = size * size;
+  auto add_edge = [&](const int v1, const int v2) {
+    if (rng.get_float() < 0.1f) {
+      return;
+    }
+    graph.edges.append(int2(v1, v2));
+    if (with_zero_costs && rng.get_float() < 0.3f) {
+      graph.edge_costs.append(0.0f);
+    }
+    else {
+      graph.edge_costs.append(rng.get_float() * 2.0f - 0.1f);
+    }
+  };
+  for (const int y : IndexRange(size)) {
+    for (const int x : IndexRange(size)) {
+      if (x + 1 < size) {
+        add_edge(y * size + x, y * size + x + 1);
+      }
+      if (y + 1 < size) {
+        add_edge(y * size + x, (y + 1) * size + x);
+      }
+    }
+  }
+
+  graph.vert_to_edge_offsets.reinitialize(graph.verts_num + 1);
+  graph.vert_to_edge_offsets.fill(0);
+  for (const int2 &edge : graph.edges) {
+    graph.vert_to_edge_offsets[edge[0]]++;
+    graph.vert_to_edge_offsets[edge[1]]++;
+  }
+  offset_indices::accumulate_counts_to_offsets(graph.vert_to_edge_offsets);
+  graph.vert_to_edge_indices.reinitialize(graph.vert_to_edge_offsets.last());
+  Array<int> counts(graph.verts_num, 0);
+  for (const int edge : graph.edges.index_range()) {
+    for (const int vert : {graph.edges[edge][0], graph.edges[edge][1]}) {
+      graph.vert_to_edge_indices[graph.vert_to_edge_offsets[vert] + counts[vert]++] = edge;
+    }
+  }
+  return graph;
+}
+
+/** Dijkstra's algorithm as reference. */
+static Array<float> reference_costs(const TestGraph &graph, const Span<int> start_verts)
+{
+  const GroupedSpan<int> vert_to_edge = graph.vert_to_edge_map();
+  Array<float> costs(graph.verts_num, FLT_MAX);
+  Array<bool> visited(graph.verts_num, false);
+  using VertPriority = std::pair<float, int>;
+  std::priority_queue<VertPriority, std::vector<VertPriority>, std::greater<VertPriority>> queue;
+  for (const int vert : start_verts) {
+    costs[vert] = 0.0f;
+    queue.emplace(0.0f, vert);
+  }
+  while (!queue.empty()) {
+    const int vert = queue.top().second;
+    queue.pop();
+    if (visited[vert]) {
+      continue;
+    }
+    visited[vert] = true;
+    for (const int edge : vert_to_edge[vert]) {
+      const int neighbor = graph.edges[edge][0] == vert ? graph.edges[edge][1] :
+                                                          graph.edges[edge][0];
+      const float cost = costs[vert] + std::max(0.0f, graph.edge_costs[edge]);
+      if (!visited[neighbor] && cost < costs[neighbor]) {
+        costs[neighbor] = cost;
+        queue.emplace(cost, neighbor);
+      }
+    }
+  }
+  return costs;
+}
+
+static void test_shortest_paths(const TestGraph &graph, const Span<int> start_verts)
+{
+  IndexMaskMemory memory;
+  const IndexMask start_mask = IndexMask::from_indices(start_verts, memory);
+  Array<float> costs(graph.verts_num);
+  Array<int> next_verts(graph.verts_num);
+  shortest_paths(
+      graph.edges, graph.vert_to_edge_map(), graph.edge_costs, start_mask, costs, next_verts);
+
+  const Array<float> expected_costs = reference_costs(graph, start_verts);
+  EXPECT_EQ(costs.as_span(), expected_costs.as_span());
+
+  Array<bool> is_start(graph.verts_num, false);
+  start_mask.to_bools(is_start);
+  for (const int vert : IndexRange(graph.verts_num)) {
+    if (is_start[vert] || costs[vert] == FLT_MAX) {
+      EXPECT_EQ(next_verts[vert], -1);
+      continue;
+    }
+    /* Following the path back has to lead to a start vertex. */
+    int path_vert = vert;
+    for ([[maybe_unused]] const int i : IndexRange(graph.verts_num)) {
+      if (next_verts[path_vert] == -1) {
+        break;
+      }
+      path_vert = next_verts[path_vert];
+    }
+    EXPECT_TRUE(is_start[path_vert]);
+
+    /* The previous vertex has to be a neighbor that leads to the same cost. */
+    const int next_vert = next_verts[vert];
+    bool found = false;
+    for (const int edge : graph.vert_to_edge_map()[vert]) {
+      const int2 edge_verts = graph.edges[edge];
+      if (ELEM(next_vert, edge_verts[0], edge_verts[1]) &&
+          costs[next_vert] + std::max(0.0f, graph.edge_costs[edge]) == costs[vert])
+      {
+        found = true;
+      }
+    }
+    EXPECT_TRUE(found);
+  }
+}
+
+TEST(shortest_paths, Empty)
+{
+  const TestGraph graph = create_test_graph(0, false, 0);
+  test_shortest_paths(graph, {});
+}
+
+TEST(shortest_paths, NoStartVerts)
+{
+  const TestGraph graph = create_test_graph(10, false, 0);
+  test_shortest_paths(graph, {});
+}
+
+TEST(shortest_paths, SingleStart)
+{
+  const TestGraph graph = create_test_graph(100, false, 1);
+  test_shortest_paths(graph, {5050});
+}
+
+TEST(shortest_paths, MultipleStarts)
+{
+  const TestGraph graph = create_test_graph(200, false, 2);
+  test_shortest_paths(graph, {0, 17, 20000, 39999});
+}
+
+TEST(shortest_paths, ZeroCosts)
+{
+  const TestGraph graph = create_test_graph(200, true, 3);
+  test_shortest_paths(graph, {3, 12345});
+}
+
+}  // namespace blender::geometry::tests
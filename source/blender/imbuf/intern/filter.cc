@@ -6,11 +6,13 @@
  * \ingroup imbuf
  */
 
+#include <atomic>
 #include <cmath>
 
 #include "MEM_guardedalloc.h"
 
 #include "BLI_math_base.h"
+#include "BLI_task.hh"
 #include "BLI_utildefines.h"
 
 #include "IMB_filter.hh"
@@ -316,6 +318,119 @@ static int check_pixel_assigned(
   return res;
 }
 
+/**
+ * Extend the assigned pixels of the source buffer into the unassigned pixels of the given rows
+ * next to them, writing the result to the destination buffer. Returns true if any pixel was
+ * assigned.
+ */
+static bool filter_extend_rows(const void *srcbuf,
+                               const char *srcmask,
+                               void *dstbuf,
+                               char *dstmask,
+                               const int width,
+                               const int height,
+                               const bool is_float,
+                               const float weight[9],
+                               const blender::IndexRange rows)
+{
+  const int depth = 4; /* always 4 channels */
+  const int n = 1;
+  bool rows_pixel_assigned = false;
+  for (const int y : rows) {
+    for (int x = 0; x < width; x++) {
+      const int index = filter_make_index(x, y, width, height);
+
+      /* only update unassigned pixels */
+      if (check_pixel_assigned(srcbuf, srcmask, index, depth, is_float)) {
+        continue;
+      }
+
+      if (!(check_pixel_assigned(srcbuf,
+                                 srcmask,
+                                 filter_make_index(x - 1, y, width, height),
+                                 depth,
+                                 is_float) ||
+            check_pixel_assigned(srcbuf,
+                                 srcmask,
+                                 filter_make_index(x + 1, y, width, height),
+                                 depth,
+                                 is_float) ||
+            check_pixel_assigned(srcbuf,
+                                 srcmask,
+                                 filter_make_index(x, y - 1, width, height),
+                                 depth,
+                                 is_float) ||
+            check_pixel_assigned(srcbuf,
+                                 srcmask,
+                                 filter_make_index(x, y + 1, width, height),
+                                 depth,
+                                 is_float)))
+      {
+        continue;
+      }
+
+      float tmp[4];
+      float wsum = 0;
+      float acc[4] = {0, 0, 0, 0};
+      int k = 0;
+
+      for (int i = -n; i <= n; i++) {
+        for (int j = -n; j <= n; j++) {
+          if (i != 0 || j != 0) {
+            const int tmpindex = filter_make_index(x + i, y + j, width, height);
+
+            if (check_pixel_assigned(srcbuf, srcmask, tmpindex, depth, is_float)) {
+              if (is_float) {
+                for (int c = 0; c < depth; c++) {
+                  tmp[c] = ((const float *)srcbuf)[depth * tmpindex + c];
+                }
+              }
+              else {
+                for (int c = 0; c < depth; c++) {
+                  tmp[c] = float(((const uchar *)srcbuf)[depth * tmpindex + c]);
+                }
+              }
+
+              wsum += weight[k];
+
+              for (int c = 0; c < depth; c++) {
+                acc[c] += weight[k] * tmp[c];
+              }
+            }
+          }
+          k++;
+        }
+      }
+
+      if (wsum != 0) {
+        for (int c = 0; c < depth; c++) {
+          acc[c] /= wsum;
+        }
+
+        if (is_float) {
+          for (int c = 0; c < depth; c++) {
+            ((float *)dstbuf)[depth * index + c] = acc[c];
+          }
+        }
+        else {
+          for (int c = 0; c < depth; c++) {
+            ((uchar *)dstbuf)[depth * index + c] = acc[c] > 255 ?
+                                                       255 :
+                                                       (acc[c] < 0 ? 0 :
+                                                                     uchar(roundf(acc[c])));
+          }
+        }
+
+        if (dstmask != nullptr) {
+          dstmask[index] = FILTER_MASK_MARGIN; /* assigned */
+        }
+        rows_pixel_assigned = true;
+      }
+    }
+  }
+  return rows_pixel_assigned;
+}
+
 void IMB_filter_extend(ImBuf *ibuf, char *mask, int filter)
 {
   const int width = ibuf->x;
@@ -330,16 +445,16 @@ void IMB_filter_extend(ImBuf *ibuf, char *mask, int filter)
   void *srcbuf = ibuf->float_buffer.data ? (void *)ibuf->float_buffer.data :
                                            (void *)ibuf->byte_buffer.data;
   char *srcmask = mask;
-  int cannot_early_out = 1, r, n, k, i, j, c;
+  bool cannot_early_out = true;
   float weight[25];
 
   /* build a weights buffer */
-  n = 1;
 
 #if 0
-  k = 0;
-  for (i = -n; i <= n; i++) {
-    for (j = -n; j <= n; j++) {
+  const int n = 1;
+  int k = 0;
+  for (int i = -n; i <= n; i++) {
+    for (int j = -n; j <= n; j++) {
       weight[k++] = sqrt(float(i) * i + j * j);
     }
   }
@@ -355,87 +470,20 @@ void IMB_filter_extend(ImBuf *ibuf, char *mask, int filter)
   weight[7] = 2;
   weight[8] = 1;
 
-  /* run passes */
-  for (r = 0; cannot_early_out == 1 && r < filter; r++) {
-    int x, y;
-    cannot_early_out = 0;
-
-    for (y = 0; y < height; y++) {
-      for (x = 0; x < width; x++) {
-        const int index = filter_make_index(x, y, width, height);
-
-        /* only update unassigned pixels */
-        if (!check_pixel_assigned(srcbuf, srcmask, index, depth, is_float)) {
-          float tmp[4];
-          float wsum = 0;
-          float acc[4] = {0, 0, 0, 0};
-          k = 0;
-
-          if (check_pixel_assigned(
-                  srcbuf, srcmask, filter_make_index(x - 1, y, width, height), depth, is_float) ||
-              check_pixel_assigned(
-                  srcbuf, srcmask, filter_make_index(x + 1, y, width, height), depth, is_float) ||
-              check_pixel_assigned(
-                  srcbuf, srcmask, filter_make_index(x, y - 1, width, height), depth, is_float) ||
-              check_pixel_assigned(
-                  srcbuf, srcmask, filter_make_index(x, y + 1, width, height), depth, is_float))
-          {
-            for (i = -n; i <= n; i++) {
-              for (j = -n; j <= n; j++) {
-                if (i != 0 || j != 0) {
-                  const int tmpindex = filter_make_index(x + i, y + j, width, height);
-
-                  if (check_pixel_assigned(srcbuf, srcmask, tmpindex, depth, is_float)) {
-                    if (is_float) {
-                      for (c = 0; c < depth; c++) {
-                        tmp[c] = ((const float *)srcbuf)[depth * tmpindex + c];
-                      }
-                    }
-                    else {
-                      for (c = 0; c < depth; c++) {
-                        tmp[c] = float(((const uchar *)srcbuf)[depth * tmpindex + c]);
-                      }
-                    }
-
-                    wsum += weight[k];
-
-                    for (c = 0; c < depth; c++) {
-                      acc[c] += weight[k] * tmp[c];
-                    }
-                  }
-                }
-                k++;
-              }
-            }
-
-            if (wsum != 0) {
-              for (c = 0; c < depth; c++) {
-                acc[c] /= wsum;
-              }
-
-              if (is_float) {
-                for (c = 0; c < depth; c++) {
-                  ((float *)dstbuf)[depth * index + c] = acc[c];
-                }
-              }
-              else {
-                for (c = 0; c < depth; c++) {
-                  ((uchar *)dstbuf)[depth * index + c] = acc[c] > 255 ?
-                                                             255 :
-                                                             (acc[c] < 0 ? 0 :
-                                                                           uchar(roundf(acc[c])));
-                }
-              }
+  /* run passes, every pass only reads the source buffers and only writes the destination buffers,
+   * so rows are processed in parallel. */
+  for (int r = 0; cannot_early_out && r < filter; r++) {
+    std::atomic<bool> any_pixel_assigned = false;
 
-              if (dstmask != nullptr) {
-                dstmask[index] = FILTER_MASK_MARGIN; /* assigned */
-              }
-              cannot_early_out = 1;
-            }
+    blender::threading::parallel_for(
+        blender::IndexRange(height), 16, [&](const blender::IndexRange rows) {
+          if (filter_extend_rows(
+                  srcbuf, srcmask, dstbuf, dstmask, width, height, is_float, weight, rows))
+          {
+            any_pixel_assigned = true;
           }
-        }
-      }
-    }
+        });
+    cannot_early_out = any_pixel_assigned;
 
     /* keep the original buffer up to date. */
     memcpy(srcbuf, dstbuf, bsize);
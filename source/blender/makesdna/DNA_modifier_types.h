@@ -2536,6 +2536,8 @@ typedef struct NodesModifierData {
 
 typedef enum NodesModifierFlag {
   NODES_MODIFIER_HIDE_DATABLOCK_SELECTOR = (1 << 0),
+  /** Reuse outputs of expensive nodes from previous evaluations, see #node_output_cache. */
+  NODES_MODIFIER_CACHE_NODE_OUTPUTS = (1 << 1),
 } NodesModifierFlag;
 
 typedef struct MeshToVolumeModifierData {
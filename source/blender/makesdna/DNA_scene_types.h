@@ -866,6 +866,7 @@ typedef enum eCompositorDevice {
 typedef enum eCompositorPrecision {
   SCE_COMPOSITOR_PRECISION_AUTO = 0,
   SCE_COMPOSITOR_PRECISION_FULL = 1,
+  SCE_COMPOSITOR_PRECISION_HALF = 2,
 } eCompositorPrecision;
 
 /** \} */
@@ -1120,10 +1120,14 @@ typedef struct UserDef {
 
   float collection_instance_empty_size;
   char text_flag;
-  char _pad10[1];
+  /** Number of threads prefetching sequencer frames. */
+  char sequencer_prefetch_workers;
+  /** Number of strips building proxies at the same time. */
+  char sequencer_proxy_workers;
 
   char file_preview_type; /* eUserpref_File_Preview_Type */
   char statusbar_flag;    /* eUserpref_StatusBar_Flag */
+  char _pad10[7];
 
   struct WalkNavigation walk_navigation;
 
@@ -8106,6 +8106,15 @@ static void rna_def_modifier_nodes(BlenderRNA *brna)
   RNA_def_property_flag(prop, PROP_NO_DEG_UPDATE);
   RNA_def_property_update(prop, NC_OBJECT | ND_MODIFIER, nullptr);
 
+  prop = RNA_def_property(srna, "use_node_output_cache", PROP_BOOLEAN, PROP_NONE);
+  RNA_def_property_boolean_sdna(prop, nullptr, "flag", NODES_MODIFIER_CACHE_NODE_OUTPUTS);
+  RNA_def_property_ui_text(
+      prop,
+      "Cache Node Outputs",
+      "Reuse the outputs of expensive nodes like booleans when they are evaluated again with the "
+      "same inputs, at the cost of hashing their inputs and keeping the outputs in memory");
+  RNA_def_property_update(prop, 0, "rna_Modifier_update");
+
   prop = RNA_def_property(srna, "node_warnings", PROP_COLLECTION, PROP_NONE);
   RNA_def_property_collection_funcs(prop,
                                     "rna_NodesModifier_node_warnings_iterator_begin",
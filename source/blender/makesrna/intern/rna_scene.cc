@@ -6793,6 +6793,12 @@ static void rna_def_scene_render_data(BlenderRNA *brna)
        "Auto",
        "Full precision for final renders, half precision otherwise"},
       {SCE_COMPOSITOR_PRECISION_FULL, "FULL", 0, "Full", "Full precision"},
+      {SCE_COMPOSITOR_PRECISION_HALF,
+       "HALF",
+       0,
+       "Half",
+       "Half precision for all intermediate results, including final renders, reducing memory "
+       "usage"},
       {0, nullptr, 0, nullptr, nullptr},
   };
 
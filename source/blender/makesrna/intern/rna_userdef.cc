@@ -6208,6 +6208,20 @@ static void rna_def_userdef_system(BlenderRNA *brna)
   RNA_def_property_enum_sdna(prop, nullptr, "sequencer_proxy_setup");
   RNA_def_property_ui_text(prop, "Proxy Setup", "When and how proxies are created");
 
+  prop = RNA_def_property(srna, "sequencer_proxy_workers", PROP_INT, PROP_NONE);
+  RNA_def_property_int_sdna(prop, nullptr, "sequencer_proxy_workers");
+  RNA_def_property_range(prop, 1, 64);
+  RNA_def_property_ui_text(
+      prop, "Proxy Workers", "Number of strips for which proxies are built at the same time");
+
+  prop = RNA_def_property(srna, "sequencer_prefetch_workers", PROP_INT, PROP_NONE);
+  RNA_def_property_int_sdna(prop, nullptr, "sequencer_prefetch_workers");
+  RNA_def_property_range(prop, 1, 64);
+  RNA_def_property_ui_text(prop,
+                           "Prefetch Workers",
+                           "Number of frames rendered at the same time when prefetching, every "
+                           "worker keeps its own copy of the scene");
+
   prop = RNA_def_property(srna, "scrollback", PROP_INT, PROP_UNSIGNED);
   RNA_def_property_int_sdna(prop, nullptr, "scrollback");
   RNA_def_property_range(prop, 32, 32768);
@@ -303,6 +303,10 @@ static bool logging_enabled(const ModifierEvalContext *ctx)
   if ((ctx->flag & MOD_APPLY_ORCO) != 0) {
     return false;
   }
+  if (G.geometry_nodes_trace_filepath[0] != '\0') {
+    /* Only execution times are recorded in #geo_log::NodeTimingTrace. */
+    return false;
+  }
   return true;
 }
 
@@ -1817,6 +1821,7 @@ static void modifyGeometry(ModifierData *md,
   nodes::GeoNodesModifierData modifier_eval_data{};
   modifier_eval_data.depsgraph = ctx->depsgraph;
   modifier_eval_data.self_object = ctx->object;
+  modifier_eval_data.use_node_output_cache = nmd->flag & NODES_MODIFIER_CACHE_NODE_OUTPUTS;
   auto eval_log = std::make_unique<geo_log::GeoModifierLog>();
   call_data.modifier_data = &modifier_eval_data;
 
@@ -2397,6 +2402,11 @@ static void draw_manage_panel(const bContext *C,
                               PointerRNA *modifier_ptr,
                               NodesModifierData &nmd)
 {
+  uiLayout *col = uiLayoutColumn(layout, false);
+  uiLayoutSetPropSep(col, true);
+  uiLayoutSetPropDecorate(col, false);
+  uiItemR(col, modifier_ptr, "use_node_output_cache", UI_ITEM_NONE, nullptr, ICON_NONE);
+
   if (uiLayout *panel_layout = uiLayoutPanelProp(
           C, layout, modifier_ptr, "open_bake_panel", IFACE_("Bake")))
   {
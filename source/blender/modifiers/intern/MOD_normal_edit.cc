@@ -516,6 +516,7 @@ static Mesh *normalEditModifier_do(NormalEditModifierData *enmd,
                                              corner_verts,
                                              corner_edges,
                                              result->corner_to_face_map(),
+                                             result->vert_to_corner_map(),
                                              result->vert_normals(),
                                              result->face_normals(),
                                              sharp_edges.span,
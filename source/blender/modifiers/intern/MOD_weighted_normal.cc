@@ -81,6 +81,7 @@ struct WeightedNormalData {
   blender::Span<int> corner_verts;
   blender::Span<int> corner_edges;
   blender::Span<int> loop_to_face;
+  blender::GroupedSpan<int> vert_to_corner_map;
   blender::MutableSpan<blender::short2> clnors;
   bool has_clnors; /* True if clnors already existed, false if we had to create them. */
 
@@ -227,6 +228,7 @@ static void apply_weights_vertex_normal(WeightedNormalModifierData *wnmd,
                                     corner_verts,
                                     corner_edges,
                                     loop_to_face,
+                                    wn_data->vert_to_corner_map,
                                     wn_data->vert_normals,
                                     wn_data->face_normals,
                                     wn_data->sharp_edges,
@@ -355,6 +357,7 @@ static void apply_weights_vertex_normal(WeightedNormalModifierData *wnmd,
                                                corner_verts,
                                                corner_edges,
                                                loop_to_face,
+                                               wn_data->vert_to_corner_map,
                                                wn_data->vert_normals,
                                                face_normals,
                                                wn_data->sharp_edges,
@@ -536,6 +539,7 @@ static Mesh *modify_mesh(ModifierData *md, const ModifierEvalContext *ctx, Mesh
   wn_data.corner_verts = corner_verts;
   wn_data.corner_edges = corner_edges;
   wn_data.loop_to_face = loop_to_face_map;
+  wn_data.vert_to_corner_map = result->vert_to_corner_map();
   wn_data.clnors = {clnors, mesh->corners_num};
   wn_data.has_clnors = has_clnors;
 
@@ -164,6 +164,8 @@ struct GeoNodesModifierData {
   const Object *self_object = nullptr;
   /** Depsgraph that is evaluating the modifier. */
   Depsgraph *depsgraph = nullptr;
+  /** Outputs of expensive nodes may be reused from earlier evaluations, see #node_output_cache. */
+  bool use_node_output_cache = false;
 };
 
 struct GeoNodesOperatorDepsgraphs {
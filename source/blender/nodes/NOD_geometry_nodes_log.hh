@@ -24,6 +24,9 @@
  *   contain and cache preprocessed data produced during logging. The log combines data from all
  *   thread-local loggers to provide simple access. Importantly, the (preprocessed) log is only
  *   created when it is actually used by UI code.
+ *
+ * When nobody inspects the evaluation, e.g. on render farms, #NodeTimingTrace can be used instead
+ * of the full log. It only records node execution times.
  */
 
 #pragma once
@@ -397,4 +400,23 @@ class GeoModifierLog {
   static const ViewerNodeLog *find_viewer_node_log_for_path(const ViewerPath &viewer_path);
 };
 
+/**
+ * Low-overhead alternative to #GeoModifierLog that only records how long nodes take to execute.
+ * It is enabled with the `--debug-geometry-nodes-trace <filepath>` command line argument, which
+ * also disables the full log. The type is only defined in the implementation file.
+ */
+class NodeTimingTrace;
+
+/**
+ * Get the trace that node execution times should be recorded in, or null if it is not enabled.
+ * The trace is written to its file when Blender exits.
+ */
+NodeTimingTrace *get_node_timing_trace();
+
+void log_node_execution(NodeTimingTrace &trace,
+                        const bNodeTree &tree,
+                        const bNode &node,
+                        TimePoint start,
+                        TimePoint end);
+
 }  // namespace blender::nodes::geo_eval_log
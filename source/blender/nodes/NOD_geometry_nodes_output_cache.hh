@@ -0,0 +1,70 @@
+/* SPDX-FileCopyrightText: 2025 Blender Authors
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later */
+
+/** \file
+ * \ingroup nodes
+ *
+ * Outputs of some expensive geometry nodes (booleans, scattering, subdivision, ...) are cached
+ * in the global #memory_cache, so that they don't have to be recomputed when the node is evaluated
+ * again with the same inputs. This is mainly useful for animated node trees, where these nodes
+ * are often in a part of the tree that does not change over time.
+ *
+ * The cache key is a hash of the content of all inputs and of the node properties. Content hashes
+ * are used instead of the identity of the input data, because the inputs are typically computed
+ * again by cheaper nodes in every evaluation. The cached outputs are shared with the evaluation
+ * using implicit sharing, so using them does not require a copy. Since the cache keeps a reference
+ * to the outputs, nodes that modify them later have to copy the data though. Therefore the cache
+ * is only used when enabled in the modifier (#NODES_MODIFIER_CACHE_NODE_OUTPUTS).
+ */
+
+#pragma once
+
+#include <optional>
+
+#include "BLI_function_ref.hh"
+
+#include "FN_lazy_function.hh"
+
+struct bNode;
+
+namespace blender::bke {
+struct GeometrySet;
+}
+namespace blender::nodes {
+struct GeoNodesLFUserData;
+}
+namespace blender::nodes::geo_eval_log {
+class GeoTreeLogger;
+}
+
+namespace blender::nodes::node_output_cache {
+
+/**
+ * True if the outputs of the node only depend on its inputs and properties, and if it is
+ * generally expensive enough to be worth caching. Nodes with inputs that depend on the scene
+ * time are not cached, because their inputs are different in every frame.
+ */
+bool is_node_cacheable(const bNode &node);
+
+/**
+ * Execute the node by calling \a execute_fn, unless outputs for the same inputs are cached
+ * already. In that case the cached outputs are used instead. All inputs have to be available
+ * already. \a execute_fn has to use the params it is called with, which may wrap \a params to
+ * gather the outputs. Warnings of the node are remembered in the cache as well and are added to
+ * the \a tree_logger again when the cached outputs are used.
+ */
+void execute_node_cached(const bNode &node,
+                         lf::Params &params,
+                         const GeoNodesLFUserData &user_data,
+                         geo_eval_log::GeoTreeLogger *tree_logger,
+                         FunctionRef<void(lf::Params &params)> execute_fn);
+
+/**
+ * Hash of the content of the geometry, as it is used in the keys of nodes with geometry inputs.
+ * Returns none if the geometry contains data that can't be hashed, in which case these nodes are
+ * not cached.
+ */
+std::optional<uint64_t> hash_geometry_content(const bke::GeometrySet &geometry);
+
+}  // namespace blender::nodes::node_output_cache
@@ -3,6 +3,8 @@
  * SPDX-License-Identifier: GPL-2.0-or-later */
 
 #include <algorithm>
+#include <limits>
+#include <mutex>
 #include <numeric>
 
 #include "NOD_rna_define.hh"
@@ -101,10 +103,18 @@ static void node_gather_link_searches(GatherLinkSearchOpParams &params)
   }
 }
 
-template<typename T> static T compute_sum(const Span<T> data)
-{
-  return std::accumulate(data.begin(), data.end(), T());
-}
+/** Statistics that can be computed separately for parts of the data and combined afterwards. */
+template<typename T> struct ReducedStatistics {
+  T sum = T(0.0f);
+  T min = T(std::numeric_limits<float>::infinity());
+  T max = T(-std::numeric_limits<float>::infinity());
+  int64_t count = 0;
+
+  static ReducedStatistics combine(const ReducedStatistics &a, const ReducedStatistics &b)
+  {
+    return {a.sum + b.sum, math::min(a.min, b.min), math::max(a.max, b.max), a.count + b.count};
+  }
+};
 
 static float compute_variance(const Span<float> data, const float mean)
 {
@@ -136,6 +146,67 @@ static float median_of_sorted_span(const Span<float> data)
   return median;
 }
 
+/**
+ * Evaluate the field for the selected elements and add their sum, minimum and maximum to
+ * \a statistics. The field is evaluated in chunks, so that no arrays for the entire domain have
+ * to be allocated. The values themselves are only appended to \a r_data if it is not null,
+ * because only some statistics need all of them at once.
+ */
+template<typename T>
+static void reduce_selected_values(const GeometryComponent &component,
+                                   const AttrDomain domain,
+                                   const Field<bool> &selection_field,
+                                   const Field<T> &input_field,
+                                   ReducedStatistics<T> &statistics,
+                                   Vector<T> *r_data)
+{
+  const bke::GeometryFieldContext field_context{component, domain};
+  fn::FieldEvaluator selection_evaluator{field_context,
+                                         component.attribute_domain_size(domain)};
+  selection_evaluator.set_selection(selection_field);
+  selection_evaluator.evaluate();
+  const IndexMask selection = selection_evaluator.get_evaluated_selection_as_mask();
+
+  MutableSpan<T> selected_data;
+  if (r_data) {
+    const int next_data_index = r_data->size();
+    r_data->resize(next_data_index + selection.size());
+    selected_data = r_data->as_mutable_span().slice(next_data_index, selection.size());
+  }
+
+  /* Chunks are evaluated in parallel. Their results are combined in order afterwards, so that
+   * the sum does not depend on the order in which the chunks are finished. */
+  std::mutex mutex;
+  Vector<std::pair<int64_t, ReducedStatistics<T>>> statistics_by_chunk;
+  fn::evaluate_fields_chunked(
+      {input_field}, selection, field_context, [&](const fn::FieldsChunk &chunk) {
+        const VArraySpan<T> values{chunk.values[0].typed<T>()};
+        if (r_data) {
+          array_utils::gather(Span<T>(values),
+                              chunk.mask,
+                              selected_data.slice(chunk.mask_start, chunk.mask.size()));
+        }
+        /* Chunks are reduced serially, so that their sums are reproducible. */
+        ReducedStatistics<T> chunk_statistics;
+        chunk.mask.foreach_index([&](const int64_t i) {
+          const T value = values[i];
+          chunk_statistics.sum += value;
+          chunk_statistics.min = math::min(chunk_statistics.min, value);
+          chunk_statistics.max = math::max(chunk_statistics.max, value);
+        });
+        chunk_statistics.count = chunk.mask.size();
+        std::lock_guard lock{mutex};
+        statistics_by_chunk.append({chunk.mask_start, chunk_statistics});
+      });
+
+  std::sort(statistics_by_chunk.begin(),
+            statistics_by_chunk.end(),
+            [](const auto &a, const auto &b) { return a.first < b.first; });
+  for (const auto &item : statistics_by_chunk) {
+    statistics = ReducedStatistics<T>::combine(statistics, item.second);
+  }
+}
+
 static void node_geo_exec(GeoNodeExecParams params)
 {
   GeometrySet geometry_set = params.get_input<GeometrySet>("Geometry");
@@ -146,9 +217,16 @@ static void node_geo_exec(GeoNodeExecParams params)
 
   const Field<bool> selection_field = params.get_input<Field<bool>>("Selection");
 
+  /* The median and the variance need all values, the other statistics are reduced per chunk. */
+  const bool median_required = params.output_is_required("Median");
+  const bool variance_required = params.output_is_required("Standard Deviation") ||
+                                 params.output_is_required("Variance");
+  const bool data_required = median_required || variance_required;
+
   switch (data_type) {
     case CD_PROP_FLOAT: {
       const Field<float> input_field = params.get_input<Field<float>>("Attribute");
+      ReducedStatistics<float> statistics;
       Vector<float> data;
       for (const GeometryComponent *component : components) {
         const std::optional<AttributeAccessor> attributes = component->attributes();
@@ -156,19 +234,12 @@ static void node_geo_exec(GeoNodeExecParams params)
           continue;
         }
         if (attributes->domain_supported(domain)) {
-          const bke::GeometryFieldContext field_context{*component, domain};
-          fn::FieldEvaluator data_evaluator{field_context, attributes->domain_size(domain)};
-          data_evaluator.add(input_field);
-          data_evaluator.set_selection(selection_field);
-          data_evaluator.evaluate();
-          const VArray<float> component_data = data_evaluator.get_evaluated<float>(0);
-          const IndexMask selection = data_evaluator.get_evaluated_selection_as_mask();
-
-          const int next_data_index = data.size();
-          data.resize(next_data_index + selection.size());
-          MutableSpan<float> selected_data = data.as_mutable_span().slice(next_data_index,
-                                                                          selection.size());
-          array_utils::gather(component_data, selection, selected_data);
+          reduce_selected_values(*component,
+                                 domain,
+                                 selection_field,
+                                 input_field,
+                                 statistics,
+                                 data_required ? &data : nullptr);
         }
       }
 
@@ -180,43 +251,29 @@ static void node_geo_exec(GeoNodeExecParams params)
       float range = 0.0f;
       float standard_deviation = 0.0f;
       float variance = 0.0f;
-      const bool sort_required = params.output_is_required("Min") ||
-                                 params.output_is_required("Max") ||
-                                 params.output_is_required("Range") ||
-                                 params.output_is_required("Median");
-      const bool sum_required = params.output_is_required("Sum") ||
-                                params.output_is_required("Mean");
-      const bool variance_required = params.output_is_required("Standard Deviation") ||
-                                     params.output_is_required("Variance");
-
-      if (data.size() != 0) {
-        if (sort_required) {
+
+      if (statistics.count != 0) {
+        sum = statistics.sum;
+        mean = sum / statistics.count;
+        min = statistics.min;
+        max = statistics.max;
+        range = max - min;
+        if (median_required) {
           std::sort(data.begin(), data.end());
           median = median_of_sorted_span(data);
-
-          min = data.first();
-          max = data.last();
-          range = max - min;
         }
-        if (sum_required || variance_required) {
-          sum = compute_sum<float>(data);
-          mean = sum / data.size();
-
-          if (variance_required) {
-            variance = compute_variance(data, mean);
-            standard_deviation = std::sqrt(variance);
-          }
+        if (variance_required) {
+          variance = compute_variance(data, mean);
+          standard_deviation = std::sqrt(variance);
         }
       }
 
-      if (sum_required) {
-        params.set_output("Sum", sum);
-        params.set_output("Mean", mean);
-      }
-      if (sort_required) {
-        params.set_output("Min", min);
-        params.set_output("Max", max);
-        params.set_output("Range", range);
+      params.set_output("Sum", sum);
+      params.set_output("Mean", mean);
+      params.set_output("Min", min);
+      params.set_output("Max", max);
+      params.set_output("Range", range);
+      if (median_required) {
         params.set_output("Median", median);
       }
       if (variance_required) {
@@ -227,6 +284,7 @@ static void node_geo_exec(GeoNodeExecParams params)
     }
     case CD_PROP_FLOAT3: {
       const Field<float3> input_field = params.get_input<Field<float3>>("Attribute");
+      ReducedStatistics<float3> statistics;
       Vector<float3> data;
       for (const GeometryComponent *component : components) {
         const std::optional<AttributeAccessor> attributes = component->attributes();
@@ -234,19 +292,12 @@ static void node_geo_exec(GeoNodeExecParams params)
           continue;
         }
         if (attributes->domain_supported(domain)) {
-          const bke::GeometryFieldContext field_context{*component, domain};
-          fn::FieldEvaluator data_evaluator{field_context, attributes->domain_size(domain)};
-          data_evaluator.add(input_field);
-          data_evaluator.set_selection(selection_field);
-          data_evaluator.evaluate();
-          const VArray<float3> component_data = data_evaluator.get_evaluated<float3>(0);
-          const IndexMask selection = data_evaluator.get_evaluated_selection_as_mask();
-
-          const int next_data_index = data.size();
-          data.resize(data.size() + selection.size());
-          MutableSpan<float3> selected_data = data.as_mutable_span().slice(next_data_index,
-                                                                           selection.size());
-          array_utils::gather(component_data, selection, selected_data);
+          reduce_selected_values(*component,
+                                 domain,
+                                 selection_field,
+                                 input_field,
+                                 statistics,
+                                 data_required ? &data : nullptr);
         }
       }
 
@@ -258,31 +309,23 @@ static void node_geo_exec(GeoNodeExecParams params)
       float3 mean{0};
       float3 variance{0};
       float3 standard_deviation{0};
-      const bool sort_required = params.output_is_required("Min") ||
-                                 params.output_is_required("Max") ||
-                                 params.output_is_required("Range") ||
-                                 params.output_is_required("Median");
-      const bool sum_required = params.output_is_required("Sum") ||
-                                params.output_is_required("Mean");
-      const bool variance_required = params.output_is_required("Standard Deviation") ||
-                                     params.output_is_required("Variance");
-
-      Array<float> data_x;
-      Array<float> data_y;
-      Array<float> data_z;
-      if (sort_required || variance_required) {
-        data_x.reinitialize(data.size());
-        data_y.reinitialize(data.size());
-        data_z.reinitialize(data.size());
-        for (const int i : data.index_range()) {
-          data_x[i] = data[i].x;
-          data_y[i] = data[i].y;
-          data_z[i] = data[i].z;
-        }
+
+      Array<float> data_x(data.size());
+      Array<float> data_y(data.size());
+      Array<float> data_z(data.size());
+      for (const int i : data.index_range()) {
+        data_x[i] = data[i].x;
+        data_y[i] = data[i].y;
+        data_z[i] = data[i].z;
       }
 
-      if (data.size() != 0) {
-        if (sort_required) {
+      if (statistics.count != 0) {
+        sum = statistics.sum;
+        mean = sum / statistics.count;
+        min = statistics.min;
+        max = statistics.max;
+        range = max - min;
+        if (median_required) {
           std::sort(data_x.begin(), data_x.end());
           std::sort(data_y.begin(), data_y.end());
           std::sort(data_z.begin(), data_z.end());
@@ -291,34 +334,23 @@ static void node_geo_exec(GeoNodeExecParams params)
           const float y_median = median_of_sorted_span(data_y);
           const float z_median = median_of_sorted_span(data_z);
           median = float3(x_median, y_median, z_median);
-
-          min = float3(data_x.first(), data_y.first(), data_z.first());
-          max = float3(data_x.last(), data_y.last(), data_z.last());
-          range = max - min;
         }
-        if (sum_required || variance_required) {
-          sum = compute_sum(data.as_span());
-          mean = sum / data.size();
-
-          if (variance_required) {
-            const float x_variance = compute_variance(data_x, mean.x);
-            const float y_variance = compute_variance(data_y, mean.y);
-            const float z_variance = compute_variance(data_z, mean.z);
-            variance = float3(x_variance, y_variance, z_variance);
-            standard_deviation = float3(
-                std::sqrt(variance.x), std::sqrt(variance.y), std::sqrt(variance.z));
-          }
+        if (variance_required) {
+          const float x_variance = compute_variance(data_x, mean.x);
+          const float y_variance = compute_variance(data_y, mean.y);
+          const float z_variance = compute_variance(data_z, mean.z);
+          variance = float3(x_variance, y_variance, z_variance);
+          standard_deviation = float3(
+              std::sqrt(variance.x), std::sqrt(variance.y), std::sqrt(variance.z));
         }
       }
 
-      if (sum_required) {
-        params.set_output("Sum", sum);
-        params.set_output("Mean", mean);
-      }
-      if (sort_required) {
-        params.set_output("Min", min);
-        params.set_output("Max", max);
-        params.set_output("Range", range);
+      params.set_output("Sum", sum);
+      params.set_output("Mean", mean);
+      params.set_output("Min", min);
+      params.set_output("Max", max);
+      params.set_output("Range", range);
+      if (median_required) {
         params.set_output("Median", median);
       }
       if (variance_required) {
@@ -2,17 +2,15 @@
  *
  * SPDX-License-Identifier: GPL-2.0-or-later */
 
-#include <queue>
-
 #include "BLI_array_utils.hh"
-#include "BLI_map.hh"
 #include "BLI_math_vector_types.hh"
-#include "BLI_set.hh"
 #include "BLI_task.hh"
 
 #include "BKE_mesh.hh"
 #include "BKE_mesh_mapping.hh"
 
+#include "GEO_shortest_paths.hh"
+
 #include "node_geometry_util.hh"
 
 namespace blender::nodes::node_geo_input_shortest_edge_paths_cc {
@@ -25,62 +23,6 @@ static void node_declare(NodeDeclarationBuilder &b)
   b.add_output<decl::Float>("Total Cost").field_source().reference_pass_all();
 }
 
-using VertPriority = std::pair<float, int>;
-
-static void shortest_paths(const Mesh &mesh,
-                           const GroupedSpan<int> vert_to_edge,
-                           const IndexMask end_selection,
-                           const VArray<float> &input_cost,
-                           MutableSpan<int> r_next_index,
-                           MutableSpan<float> r_cost)
-{
-  const Span<int2> edges = mesh.edges();
-  Array<bool> visited(mesh.verts_num, false);
-
-  std::priority_queue<VertPriority, std::vector<VertPriority>, std::greater<VertPriority>> queue;
-
-  end_selection.foreach_index([&](const int start_vert_i) {
-    r_cost[start_vert_i] = 0.0f;
-    queue.emplace(0.0f, start_vert_i);
-  });
-
-  /* Though it uses more memory, calculating the adjacent vertex
-   * across each edge beforehand is noticeably faster. */
-  Array<int> other_vertex(vert_to_edge.data.size());
-  threading::parallel_for(vert_to_edge.index_range(), 2048, [&](const IndexRange range) {
-    for (const int vert_i : range) {
-      for (const int edge_i : vert_to_edge.offsets[vert_i]) {
-        other_vertex[edge_i] = bke::mesh::edge_other_vert(edges[vert_to_edge.data[edge_i]],
-                                                          vert_i);
-      }
-    }
-  });
-
-  while (!queue.empty()) {
-    const float cost_i = queue.top().first;
-    const int vert_i = queue.top().second;
-    queue.pop();
-    if (visited[vert_i]) {
-      continue;
-    }
-    visited[vert_i] = true;
-    for (const int index : vert_to_edge.offsets[vert_i]) {
-      const int edge_i = vert_to_edge.data[index];
-      const int neighbor_vert_i = other_vertex[index];
-      if (visited[neighbor_vert_i]) {
-        continue;
-      }
-      const float edge_cost = std::max(0.0f, input_cost[edge_i]);
-      const float new_neighbor_cost = cost_i + edge_cost;
-      if (new_neighbor_cost < r_cost[neighbor_vert_i]) {
-        r_cost[neighbor_vert_i] = new_neighbor_cost;
-        r_next_index[neighbor_vert_i] = vert_i;
-        queue.emplace(new_neighbor_cost, neighbor_vert_i);
-      }
-    }
-  }
-}
-
 class ShortestEdgePathsNextVertFieldInput final : public bke::MeshFieldInput {
  private:
   Field<bool> end_selection_;
@@ -103,7 +45,7 @@ class ShortestEdgePathsNextVertFieldInput final : public bke::MeshFieldInput {
     fn::FieldEvaluator edge_evaluator{edge_context, mesh.edges_num};
     edge_evaluator.add(cost_);
     edge_evaluator.evaluate();
-    const VArray<float> input_cost = edge_evaluator.get_evaluated<float>(0);
+    const VArraySpan<float> input_cost = edge_evaluator.get_evaluated<float>(0);
 
     const bke::MeshFieldContext point_context{mesh, AttrDomain::Point};
     fn::FieldEvaluator point_evaluator{point_context, mesh.verts_num};
@@ -111,8 +53,7 @@ class ShortestEdgePathsNextVertFieldInput final : public bke::MeshFieldInput {
     point_evaluator.evaluate();
     const IndexMask end_selection = point_evaluator.get_evaluated_as_mask(0);
 
-    Array<int> next_index(mesh.verts_num, -1);
-    Array<float> cost(mesh.verts_num, FLT_MAX);
+    Array<int> next_index(mesh.verts_num);
 
     if (end_selection.is_empty()) {
       array_utils::fill_index_range<int>(next_index);
@@ -125,7 +66,8 @@ class ShortestEdgePathsNextVertFieldInput final : public bke::MeshFieldInput {
     Array<int> vert_to_edge_indices;
     const GroupedSpan<int> vert_to_edge = bke::mesh::build_vert_to_edge_map(
         edges, mesh.verts_num, vert_to_edge_offset_data, vert_to_edge_indices);
-    shortest_paths(mesh, vert_to_edge, end_selection, input_cost, next_index, cost);
+    Array<float> cost(mesh.verts_num);
+    geometry::shortest_paths(edges, vert_to_edge, input_cost, end_selection, cost, next_index);
 
     threading::parallel_for(next_index.index_range(), 1024, [&](const IndexRange range) {
       for (const int i : range) {
@@ -187,7 +129,7 @@ class ShortestEdgePathsCostFieldInput final : public bke::MeshFieldInput {
     fn::FieldEvaluator edge_evaluator{edge_context, mesh.edges_num};
     edge_evaluator.add(cost_);
     edge_evaluator.evaluate();
-    const VArray<float> input_cost = edge_evaluator.get_evaluated<float>(0);
+    const VArraySpan<float> input_cost = edge_evaluator.get_evaluated<float>(0);
 
     const bke::MeshFieldContext point_context{mesh, AttrDomain::Point};
     fn::FieldEvaluator point_evaluator{point_context, mesh.verts_num};
@@ -200,15 +142,14 @@ class ShortestEdgePathsCostFieldInput final : public bke::MeshFieldInput {
           VArray<float>::ForSingle(0.0f, mesh.verts_num), AttrDomain::Point, domain);
     }
 
-    Array<int> next_index(mesh.verts_num, -1);
-    Array<float> cost(mesh.verts_num, FLT_MAX);
+    Array<float> cost(mesh.verts_num);
 
     const Span<int2> edges = mesh.edges();
     Array<int> vert_to_edge_offset_data;
     Array<int> vert_to_edge_indices;
     const GroupedSpan<int> vert_to_edge = bke::mesh::build_vert_to_edge_map(
         edges, mesh.verts_num, vert_to_edge_offset_data, vert_to_edge_indices);
-    shortest_paths(mesh, vert_to_edge, end_selection, input_cost, next_index, cost);
+    geometry::shortest_paths(edges, vert_to_edge, input_cost, end_selection, cost, {});
 
     threading::parallel_for(cost.index_range(), 1024, [&](const IndexRange range) {
       for (const int i : range) {
@@ -59,8 +59,13 @@ static void geo_proximity_init(bNodeTree * /*tree*/, bNode *node)
 class ProximityFunction : public mf::MultiFunction {
  private:
   struct BVHTrees {
-    BVHTreeFromMesh mesh_bvh = {};
-    BVHTreeFromPointCloud pointcloud_bvh = {};
+    /** Tree of mesh edges, the other elements use wide trees. */
+    BVHTreeFromMesh edges_bvh = {};
+    bvh::PointBVH mesh_points_bvh;
+    bvh::PointBVH pointcloud_bvh;
+    bvh::TriangleBVH tris_bvh;
+    /** Cached tree of all mesh triangles, used instead of #tris_bvh when there is one group. */
+    const bvh::TriangleBVH *all_tris_bvh = nullptr;
   };
 
   GeometrySet target_;
@@ -99,11 +104,8 @@ class ProximityFunction : public mf::MultiFunction {
   ~ProximityFunction()
   {
     for (BVHTrees &trees : bvh_trees_) {
-      if (trees.mesh_bvh.tree) {
-        free_bvhtree_from_mesh(&trees.mesh_bvh);
-      }
-      if (trees.pointcloud_bvh.tree) {
-        free_bvhtree_from_pointcloud(&trees.pointcloud_bvh);
+      if (trees.edges_bvh.tree) {
+        free_bvhtree_from_mesh(&trees.edges_bvh);
       }
     }
   }
@@ -132,8 +134,8 @@ class ProximityFunction : public mf::MultiFunction {
             if (group_mask.is_empty()) {
               continue;
             }
-            BVHTreeFromPointCloud &bvh = bvh_trees_[group_i].pointcloud_bvh;
-            BKE_bvhtree_from_pointcloud_get(pointcloud, group_mask, bvh);
+            bvh_trees_[group_i].pointcloud_bvh = bvh::PointBVH(group_mask,
+                                                               pointcloud.positions());
           }
         },
         threading::individual_task_sizes(
@@ -166,18 +168,23 @@ class ProximityFunction : public mf::MultiFunction {
             if (group_mask.is_empty()) {
               continue;
             }
-            BVHTreeFromMesh &bvh = bvh_trees_[group_i].mesh_bvh;
+            BVHTrees &trees = bvh_trees_[group_i];
             switch (type_) {
               case GEO_NODE_PROX_TARGET_POINTS: {
-                BKE_bvhtree_from_mesh_verts_init(mesh, group_mask, bvh);
+                trees.mesh_points_bvh = bvh::PointBVH(group_mask, mesh.vert_positions());
                 break;
               }
               case GEO_NODE_PROX_TARGET_EDGES: {
-                BKE_bvhtree_from_mesh_edges_init(mesh, group_mask, bvh);
+                BKE_bvhtree_from_mesh_edges_init(mesh, group_mask, trees.edges_bvh);
                 break;
               }
               case GEO_NODE_PROX_TARGET_FACES: {
-                BKE_bvhtree_from_mesh_tris_init(mesh, group_mask, bvh);
+                if (group_mask.size() == mesh.faces_num) {
+                  trees.all_tris_bvh = &bke::bvh_corner_tris_wide(mesh);
+                }
+                else {
+                  trees.tris_bvh = bke::bvh_corner_tris_wide(mesh, group_mask);
+                }
                 break;
               }
             }
@@ -213,7 +220,7 @@ class ProximityFunction : public mf::MultiFunction {
     MutableSpan<bool> is_valid_span = params.uninitialized_single_output_if_required<bool>(
         4, "Is Valid");
 
-    mask.foreach_index([&](const int i) {
+    mask.foreach_index(GrainSize(512), [&](const int i) {
       const float3 sample_position = sample_positions[i];
       const int sample_id = sample_ids[i];
       const int group_index = group_indices_.index_of_try(sample_id);
@@ -230,28 +237,37 @@ class ProximityFunction : public mf::MultiFunction {
         return;
       }
       const BVHTrees &trees = bvh_trees_[group_index];
-      BVHTreeNearest nearest;
-      /* Take mesh and pointcloud bvh tree into account. The final result is the closer of the two.
-       * The first bvhtree query will set `nearest.dist_sq` which is then passed into the second
-       * query as a maximum distance. */
+      /* Take all trees of the group into account. The final result is the closest of them, each
+       * query is limited to the distance found by the previous ones. */
+      bvh::NearestHit nearest;
       nearest.dist_sq = FLT_MAX;
-      if (trees.mesh_bvh.tree != nullptr) {
-        BLI_bvhtree_find_nearest(trees.mesh_bvh.tree,
+      if (trees.edges_bvh.tree != nullptr) {
+        BVHTreeNearest edge_nearest;
+        edge_nearest.index = -1;
+        edge_nearest.dist_sq = FLT_MAX;
+        BLI_bvhtree_find_nearest(trees.edges_bvh.tree,
                                  sample_position,
-                                 &nearest,
-                                 trees.mesh_bvh.nearest_callback,
-                                 const_cast<BVHTreeFromMesh *>(&trees.mesh_bvh));
+                                 &edge_nearest,
+                                 trees.edges_bvh.nearest_callback,
+                                 const_cast<BVHTreeFromMesh *>(&trees.edges_bvh));
+        nearest.dist_sq = edge_nearest.dist_sq;
+        nearest.position = edge_nearest.co;
       }
-      if (trees.pointcloud_bvh.tree != nullptr) {
-        BLI_bvhtree_find_nearest(trees.pointcloud_bvh.tree,
-                                 sample_position,
-                                 &nearest,
-                                 trees.pointcloud_bvh.nearest_callback,
-                                 const_cast<BVHTreeFromPointCloud *>(&trees.pointcloud_bvh));
+      for (const bvh::PointBVH *tree : {&trees.mesh_points_bvh, &trees.pointcloud_bvh}) {
+        const bvh::NearestHit hit = tree->find_nearest(sample_position, nearest.dist_sq);
+        if (hit.index != -1) {
+          nearest = hit;
+        }
+      }
+      const bvh::TriangleBVH &tris_bvh = trees.all_tris_bvh ? *trees.all_tris_bvh :
+                                                                trees.tris_bvh;
+      const bvh::NearestHit hit = tris_bvh.find_nearest(sample_position, nearest.dist_sq);
+      if (hit.index != -1) {
+        nearest = hit;
       }
 
       if (!positions.is_empty()) {
-        positions[i] = nearest.co;
+        positions[i] = nearest.position;
       }
       if (!is_valid_span.is_empty()) {
         is_valid_span[i] = true;
@@ -99,44 +99,29 @@ static void raycast_to_mesh(const IndexMask &mask,
                             const MutableSpan<float3> r_hit_normals,
                             const MutableSpan<float> r_hit_distances)
 {
-  BVHTreeFromMesh tree_data;
-  BKE_bvhtree_from_mesh_get(&tree_data, &mesh, BVHTREE_FROM_CORNER_TRIS, 4);
-  BLI_SCOPED_DEFER([&]() { free_bvhtree_from_mesh(&tree_data); });
+  const bvh::TriangleBVH &tree = bke::bvh_corner_tris_wide(mesh);
 
-  if (tree_data.tree == nullptr) {
-    return;
-  }
-  /* We shouldn't be rebuilding the BVH tree when calling this function in parallel. */
-  BLI_assert(tree_data.cached);
-
-  mask.foreach_index([&](const int i) {
-    const float ray_length = ray_lengths[i];
-    const float3 ray_origin = ray_origins[i];
-    const float3 ray_direction = ray_directions[i];
-
-    BVHTreeRayHit hit;
-    hit.index = -1;
-    hit.dist = ray_length;
-    if (BLI_bvhtree_ray_cast(tree_data.tree,
-                             ray_origin,
-                             ray_direction,
-                             0.0f,
-                             &hit,
-                             tree_data.raycast_callback,
-                             &tree_data) != -1)
-    {
+  const VArraySpan<float3> origins(ray_origins);
+  const VArraySpan<float3> directions(ray_directions);
+  const VArraySpan<float> lengths(ray_lengths);
+  Array<bvh::RayHit> hits(mask.min_array_size());
+  tree.ray_cast(mask, origins, directions, lengths, hits);
+
+  mask.foreach_index(GrainSize(4096), [&](const int i) {
+    const bvh::RayHit &hit = hits[i];
+    if (hit.index != -1) {
       if (!r_hit.is_empty()) {
-        r_hit[i] = hit.index >= 0;
+        r_hit[i] = true;
       }
       if (!r_hit_indices.is_empty()) {
         /* The caller must be able to handle invalid indices anyway, so don't clamp this value. */
         r_hit_indices[i] = hit.index;
       }
       if (!r_hit_positions.is_empty()) {
-        r_hit_positions[i] = hit.co;
+        r_hit_positions[i] = hit.position;
       }
       if (!r_hit_normals.is_empty()) {
-        r_hit_normals[i] = hit.no;
+        r_hit_normals[i] = hit.normal;
       }
       if (!r_hit_distances.is_empty()) {
         r_hit_distances[i] = hit.dist;
@@ -156,7 +141,7 @@ static void raycast_to_mesh(const IndexMask &mask,
         r_hit_normals[i] = float3(0.0f, 0.0f, 0.0f);
       }
       if (!r_hit_distances.is_empty()) {
-        r_hit_distances[i] = ray_length;
+        r_hit_distances[i] = lengths[i];
       }
     }
   });
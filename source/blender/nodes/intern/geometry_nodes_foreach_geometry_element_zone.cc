@@ -331,14 +331,21 @@ class LazyFunctionForForeachGeometryElementZone : public LazyFunction {
         output_bnode_.storage);
     auto &eval_storage = *static_cast<ForeachGeometryElementEvalStorage *>(context.storage);
     geo_eval_log::GeoTreeLogger *tree_logger = local_user_data.try_get_tree_logger(user_data);
+    geo_eval_log::NodeTimingTrace *trace = geo_eval_log::get_node_timing_trace();
 
     /* Measure execution time of the entire zone. */
     const geo_eval_log::TimePoint start_time = geo_eval_log::Clock::now();
     BLI_SCOPED_DEFER([&]() {
-      if (tree_logger) {
+      if (tree_logger || trace) {
         const geo_eval_log::TimePoint end_time = geo_eval_log::Clock::now();
-        tree_logger->node_execution_times.append(*tree_logger->allocator,
-                                                 {output_bnode_.identifier, start_time, end_time});
+        if (tree_logger) {
+          tree_logger->node_execution_times.append(
+              *tree_logger->allocator, {output_bnode_.identifier, start_time, end_time});
+        }
+        if (trace) {
+          geo_eval_log::log_node_execution(
+              *trace, output_bnode_.owner_tree(), output_bnode_, start_time, end_time);
+        }
       }
     });
 
@@ -22,6 +22,7 @@
 
 #include "NOD_geometry_exec.hh"
 #include "NOD_geometry_nodes_lazy_function.hh"
+#include "NOD_geometry_nodes_output_cache.hh"
 #include "NOD_multi_function.hh"
 #include "NOD_node_declaration.hh"
 
@@ -138,13 +139,16 @@ class LazyFunctionForGeometryNode : public LazyFunction {
    * does not have to execute.
    */
   Vector<bool> is_attribute_output_bsocket_;
+  /** The outputs of some nodes are cached, see #node_output_cache. */
+  bool is_cacheable_;
 
  public:
   LazyFunctionForGeometryNode(const bNode &node,
                               GeometryNodesLazyFunctionGraphInfo &own_lf_graph_info)
       : node_(node),
         own_lf_graph_info_(own_lf_graph_info),
-        is_attribute_output_bsocket_(node.output_sockets().size(), false)
+        is_attribute_output_bsocket_(node.output_sockets().size(), false),
+        is_cacheable_(node_output_cache::is_node_cacheable(node))
   {
     BLI_assert(node.typeinfo->geometry_node_execute != nullptr);
     debug_name_ = node.name;
@@ -243,23 +247,36 @@ class LazyFunctionForGeometryNode : public LazyFunction {
       return this->anonymous_attribute_name_for_output(*user_data, i);
     };
 
-    GeoNodeExecParams geo_params{
-        node_,
-        params,
-        context,
-        own_lf_graph_info_.mapping.lf_input_index_for_output_bsocket_usage,
-        own_lf_graph_info_.mapping.lf_input_index_for_attribute_propagation_to_output,
-        get_anonymous_attribute_name};
+    auto execute_node = [&](lf::Params &lf_params) {
+      GeoNodeExecParams geo_params{
+          node_,
+          lf_params,
+          context,
+          own_lf_graph_info_.mapping.lf_input_index_for_output_bsocket_usage,
+          own_lf_graph_info_.mapping.lf_input_index_for_attribute_propagation_to_output,
+          get_anonymous_attribute_name};
+      node_.typeinfo->geometry_node_execute(geo_params);
+    };
 
+    geo_eval_log::GeoTreeLogger *tree_logger = local_user_data.try_get_tree_logger(*user_data);
     geo_eval_log::TimePoint start_time = geo_eval_log::Clock::now();
-    node_.typeinfo->geometry_node_execute(geo_params);
+    if (is_cacheable_ && user_data->call_data->modifier_data &&
+        user_data->call_data->modifier_data->use_node_output_cache)
+    {
+      node_output_cache::execute_node_cached(node_, params, *user_data, tree_logger, execute_node);
+    }
+    else {
+      execute_node(params);
+    }
     geo_eval_log::TimePoint end_time = geo_eval_log::Clock::now();
 
-    if (geo_eval_log::GeoTreeLogger *tree_logger = local_user_data.try_get_tree_logger(*user_data))
-    {
+    if (tree_logger) {
       tree_logger->node_execution_times.append(*tree_logger->allocator,
                                                {node_.identifier, start_time, end_time});
     }
+    if (geo_eval_log::NodeTimingTrace *trace = geo_eval_log::get_node_timing_trace()) {
+      geo_eval_log::log_node_execution(*trace, node_.owner_tree(), node_, start_time, end_time);
+    }
   }
 
   std::string input_name(const int index) const override
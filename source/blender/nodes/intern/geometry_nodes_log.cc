@@ -2,12 +2,21 @@
  *
  * SPDX-License-Identifier: GPL-2.0-or-later */
 
+#include <array>
+#include <atomic>
+
 #include "NOD_geometry_nodes_lazy_function.hh"
 #include "NOD_geometry_nodes_log.hh"
 
+#include "BLI_array.hh"
+#include "BLI_math_bits.h"
+#include "BLI_serialize.hh"
+
+#include "BKE_blender.hh"
 #include "BKE_compute_contexts.hh"
 #include "BKE_curves.hh"
 #include "BKE_geometry_nodes_gizmos_transforms.hh"
+#include "BKE_global.hh"
 #include "BKE_node_runtime.hh"
 #include "BKE_node_socket_value.hh"
 #include "BKE_type_conversions.hh"
@@ -786,6 +795,219 @@ const ViewerNodeLog *GeoModifierLog::find_viewer_node_log_for_path(const ViewerP
   return viewer_log;
 }
 
+/**
+ * Every thread keeps a histogram of the execution times of each node, and the most recent
+ * executions are stored in a fixed size ring buffer. When Blender exits, both are written to a
+ * file in the Chrome trace format, which can be viewed in `chrome://tracing` or Perfetto.
+ */
+class NodeTimingTrace {
+ public:
+  /**
+   * Bucket zero counts executions shorter than a microsecond, bucket `i` those shorter than
+   * `2^i` microseconds. The last bucket also counts all longer executions.
+   */
+  static constexpr int histogram_buckets_num = 24;
+
+  struct NodeTimings {
+    std::string tree_name;
+    std::string node_name;
+    int64_t executions_num = 0;
+    std::chrono::nanoseconds total_time{};
+    std::array<int64_t, histogram_buckets_num> histogram{};
+  };
+
+ private:
+  /** Identifies a node by the session UID of its tree and its identifier. */
+  using NodeKey = std::pair<uint32_t, int32_t>;
+
+  struct Event {
+    NodeKey node_key;
+    int thread_index;
+    TimePoint start;
+    TimePoint end;
+  };
+
+  struct LocalData {
+    int thread_index;
+    Map<NodeKey, NodeTimings> timings_by_node;
+  };
+
+  std::string filepath_;
+  TimePoint start_time_;
+  std::atomic<int> threads_num_ = 0;
+  threading::EnumerableThreadSpecific<LocalData> data_per_thread_;
+  /** Ring buffer of the most recent node executions. */
+  Array<Event> events_;
+  /** Number of executions that have been recorded, the ring buffer only has the last ones. */
+  std::atomic<int64_t> events_num_ = 0;
+
+ public:
+  NodeTimingTrace(std::string filepath, int64_t events_capacity);
+
+  void log_node_execution(const bNodeTree &tree,
+                          const bNode &node,
+                          TimePoint start,
+                          TimePoint end);
+
+  /**
+   * Combine the timings of all threads, sorted by the total time of the nodes. Must not be called
+   * while nodes are evaluated.
+   */
+  Vector<NodeTimings> get_node_timings();
+  /** Create the JSON data of the trace, must not be called while nodes are evaluated. */
+  std::shared_ptr<io::serialize::DictionaryValue> serialize_chrome_trace();
+  void write_chrome_trace_file();
+};
+
+NodeTimingTrace::NodeTimingTrace(std::string filepath, const int64_t events_capacity)
+    : filepath_(std::move(filepath)),
+      start_time_(Clock::now()),
+      data_per_thread_([this]() { return LocalData{threads_num_.fetch_add(1), {}}; }),
+      events_(events_capacity, NoInitialization())
+{
+}
+
+NodeTimingTrace *get_node_timing_trace()
+{
+  static NodeTimingTrace *trace = []() -> NodeTimingTrace * {
+    if (G.geometry_nodes_trace_filepath[0] == '\0') {
+      return nullptr;
+    }
+    NodeTimingTrace *trace = MEM_new<NodeTimingTrace>(
+        __func__, G.geometry_nodes_trace_filepath, 1 << 16);
+    BKE_blender_atexit_register(
+        [](void *user_data) {
+          NodeTimingTrace *trace = static_cast<NodeTimingTrace *>(user_data);
+          trace->write_chrome_trace_file();
+          MEM_delete(trace);
+        },
+        trace);
+    return trace;
+  }();
+  return trace;
+}
+
+void NodeTimingTrace::log_node_execution(const bNodeTree &tree,
+                                         const bNode &node,
+                                         const TimePoint start,
+                                         const TimePoint end)
+{
+  const NodeKey node_key{tree.id.session_uid, node.identifier};
+  LocalData &local_data = data_per_thread_.local();
+
+  NodeTimings &timings = local_data.timings_by_node.lookup_or_add_cb(node_key, [&]() {
+    NodeTimings timings;
+    timings.tree_name = tree.id.name + 2;
+    timings.node_name = node.name;
+    return timings;
+  });
+  const std::chrono::nanoseconds duration = end - start;
+  const uint64_t duration_us = std::chrono::duration_cast<std::chrono::microseconds>(duration)
+                                   .count();
+  const int bucket = duration_us == 0 ? 0 : 64 - int(bitscan_reverse_uint64(duration_us));
+  timings.histogram[std::min(bucket, histogram_buckets_num - 1)]++;
+  timings.executions_num++;
+  timings.total_time += duration;
+
+  const int64_t event_index = events_num_.fetch_add(1, std::memory_order_relaxed);
+  events_[event_index % events_.size()] = {node_key, local_data.thread_index, start, end};
+}
+
+Vector<NodeTimingTrace::NodeTimings> NodeTimingTrace::get_node_timings()
+{
+  Map<NodeKey, NodeTimings> timings_by_node;
+  for (const LocalData &local_data : data_per_thread_) {
+    for (const auto item : local_data.timings_by_node.items()) {
+      const NodeTimings &local_timings = item.value;
+      NodeTimings &timings = timings_by_node.lookup_or_add_cb(item.key, [&]() {
+        NodeTimings timings;
+        timings.tree_name = local_timings.tree_name;
+        timings.node_name = local_timings.node_name;
+        return timings;
+      });
+      timings.executions_num += local_timings.executions_num;
+      timings.total_time += local_timings.total_time;
+      for (const int i : IndexRange(histogram_buckets_num)) {
+        timings.histogram[i] += local_timings.histogram[i];
+      }
+    }
+  }
+  Vector<NodeTimings> result;
+  result.reserve(timings_by_node.size());
+  for (NodeTimings &timings : timings_by_node.values()) {
+    result.append(std::move(timings));
+  }
+  std::sort(result.begin(), result.end(), [](const NodeTimings &a, const NodeTimings &b) {
+    return a.total_time > b.total_time;
+  });
+  return result;
+}
+
+std::shared_ptr<io::serialize::DictionaryValue> NodeTimingTrace::serialize_chrome_trace()
+{
+  using namespace io::serialize;
+  const auto to_microseconds = [](const std::chrono::nanoseconds duration) {
+    return std::chrono::duration<double, std::micro>(duration).count();
+  };
+
+  Map<NodeKey, const NodeTimings *> timings_by_node;
+  for (const LocalData &local_data : data_per_thread_) {
+    for (const auto item : local_data.timings_by_node.items()) {
+      timings_by_node.add(item.key, &item.value);
+    }
+  }
+
+  auto io_root = std::make_shared<DictionaryValue>();
+  io_root->append_str("displayTimeUnit", "ms");
+  ArrayValue &io_events = *io_root->append_array("traceEvents");
+  const int64_t events_num = events_num_.load();
+  const int64_t first_event = std::max<int64_t>(0, events_num - events_.size());
+  for (const int64_t event_index : IndexRange::from_begin_end(first_event, events_num)) {
+    const Event &event = events_[event_index % events_.size()];
+    const NodeTimings &timings = *timings_by_node.lookup(event.node_key);
+    DictionaryValue &io_event = *io_events.append_dict();
+    io_event.append_str("name", timings.node_name);
+    io_event.append_str("cat", timings.tree_name);
+    io_event.append_str("ph", "X");
+    io_event.append_double("ts", to_microseconds(event.start - start_time_));
+    io_event.append_double("dur", to_microseconds(event.end - event.start));
+    io_event.append_int("pid", 0);
+    io_event.append_int("tid", event.thread_index);
+  }
+
+  /* Not part of the trace format, viewers ignore unknown keys. */
+  ArrayValue &io_nodes = *io_root->append_array("geometryNodesTimings");
+  for (const NodeTimings &timings : this->get_node_timings()) {
+    DictionaryValue &io_node = *io_nodes.append_dict();
+    io_node.append_str("tree", timings.tree_name);
+    io_node.append_str("node", timings.node_name);
+    io_node.append_int("executions", timings.executions_num);
+    io_node.append_double("total_us", to_microseconds(timings.total_time));
+    ArrayValue &io_histogram = *io_node.append_array("histogram_us_pow2");
+    for (const int64_t count : timings.histogram) {
+      io_histogram.append(std::make_shared<IntValue>(count));
+    }
+  }
+  return io_root;
+}
+
+void NodeTimingTrace::write_chrome_trace_file()
+{
+  io::serialize::write_json_file(filepath_, *this->serialize_chrome_trace());
+  if (!G.quiet) {
+    printf("Geometry nodes trace written to \"%s\"\n", filepath_.c_str());
+  }
+}
+
+void log_node_execution(NodeTimingTrace &trace,
+                        const bNodeTree &tree,
+                        const bNode &node,
+                        const TimePoint start,
+                        const TimePoint end)
+{
+  trace.log_node_execution(tree, node, start, end);
+}
+
 int node_warning_type_icon(const NodeWarningType type)
 {
   switch (type) {
@@ -0,0 +1,615 @@
+/* SPDX-FileCopyrightText: 2025 Blender Authors
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later */
+
+#include <xxhash.h>
+
+#include "NOD_geometry_nodes_lazy_function.hh"
+#include "NOD_geometry_nodes_log.hh"
+#include "NOD_geometry_nodes_output_cache.hh"
+#include "NOD_node_declaration.hh"
+
+#include "BLI_generic_key.hh"
+#include "BLI_memory_cache.hh"
+#include "BLI_memory_counter.hh"
+#include "BLI_set.hh"
+#include "BLI_stack.hh"
+
+#include "BKE_anonymous_attribute_id.hh"
+#include "BKE_curves.hh"
+#include "BKE_customdata.hh"
+#include "BKE_geometry_set.hh"
+#include "BKE_instances.hh"
+#include "BKE_node.hh"
+#include "BKE_node_runtime.hh"
+#include "BKE_node_socket_value.hh"
+
+#include "DNA_curves_types.h"
+#include "DNA_material_types.h"
+#include "DNA_mesh_types.h"
+#include "DNA_node_types.h"
+#include "DNA_pointcloud_types.h"
+
+#include "MEM_guardedalloc.h"
+
+namespace blender::nodes::node_output_cache {
+
+using bke::GeometrySet;
+using bke::SocketValueVariant;
+
+struct CacheableNodeType {
+  int type;
+  /** Size of the DNA struct in #bNode::storage, zero if the node has no storage. */
+  int64_t storage_size;
+};
+
+/**
+ * Nodes that are expensive compared to hashing their inputs. Their outputs must only depend on
+ * their inputs and on the node properties hashed in #compute_key.
+ */
+static const CacheableNodeType cacheable_node_types[] = {
+    {GEO_NODE_CONVEX_HULL, 0},
+    {GEO_NODE_DISTRIBUTE_POINTS_ON_FACES, 0},
+    {GEO_NODE_DUAL_MESH, 0},
+    {GEO_NODE_MESH_BOOLEAN, 0},
+    {GEO_NODE_MESH_TO_VOLUME, sizeof(NodeGeometryMeshToVolume)},
+    {GEO_NODE_SUBDIVIDE_MESH, 0},
+    {GEO_NODE_SUBDIVISION_SURFACE, sizeof(NodeGeometrySubdivisionSurface)},
+    {GEO_NODE_TRIANGULATE, 0},
+};
+
+static const CacheableNodeType *find_cacheable_node_type(const bNode &node)
+{
+  for (const CacheableNodeType &node_type : cacheable_node_types) {
+    if (node_type.type == node.type) {
+      return &node_type;
+    }
+  }
+  return nullptr;
+}
+
+static bool tree_depends_on_time(const bNodeTree &tree, Set<const bNodeTree *> &checked_trees);
+
+static bool node_depends_on_time(const bNode &node, Set<const bNodeTree *> &checked_trees)
+{
+  if (ELEM(node.type,
+           GEO_NODE_INPUT_SCENE_TIME,
+           GEO_NODE_SIMULATION_INPUT,
+           GEO_NODE_SIMULATION_OUTPUT,
+           GEO_NODE_BAKE))
+  {
+    return true;
+  }
+  if (node.is_group()) {
+    if (const bNodeTree *group = reinterpret_cast<const bNodeTree *>(node.id)) {
+      return tree_depends_on_time(*group, checked_trees);
+    }
+  }
+  return false;
+}
+
+static bool tree_depends_on_time(const bNodeTree &tree, Set<const bNodeTree *> &checked_trees)
+{
+  if (!checked_trees.add(&tree)) {
+    return false;
+  }
+  tree.ensure_topology_cache();
+  for (const bNode *node : tree.all_nodes()) {
+    if (node_depends_on_time(*node, checked_trees)) {
+      return true;
+    }
+  }
+  return false;
+}
+
+/**
+ * True if any node linked to the inputs of the node, directly or indirectly, changes over time.
+ * The inputs of such nodes change in every frame, so caching their outputs would only fill the
+ * cache. Inputs of the node group itself are not checked, because they are not known here.
+ */
+static bool node_inputs_depend_on_time(const bNode &node)
+{
+  Set<const bNodeTree *> checked_trees;
+  Set<const bNode *> checked_nodes;
+  Stack<const bNode *> nodes_to_check;
+  nodes_to_check.push(&node);
+  while (!nodes_to_check.is_empty()) {
+    const bNode &node_to_check = *nodes_to_check.pop();
+    for (const bNodeSocket *input : node_to_check.input_sockets()) {
+      for (const bNodeSocket *origin : input->directly_linked_sockets()) {
+        const bNode &origin_node = origin->owner_node();
+        if (!checked_nodes.add(&origin_node)) {
+          continue;
+        }
+        if (node_depends_on_time(origin_node, checked_trees)) {
+          return true;
+        }
+        nodes_to_check.push(&origin_node);
+      }
+    }
+  }
+  return false;
+}
+
+bool is_node_cacheable(const bNode &node)
+{
+  if (find_cacheable_node_type(node) == nullptr) {
+    return false;
+  }
+  return !node_inputs_depend_on_time(node);
+}
+
+/**
+ * Identifies the outputs of a node evaluation by a 128 bit hash of everything that they depend on.
+ */
+class NodeOutputsKey : public GenericKey {
+ public:
+  uint64_t hash_low = 0;
+  uint64_t hash_high = 0;
+
+  uint64_t hash() const override
+  {
+    return this->hash_low;
+  }
+
+  BLI_STRUCT_EQUALITY_OPERATORS_2(NodeOutputsKey, hash_low, hash_high)
+
+  bool equal_to(const GenericKey &other) const override
+  {
+    if (const auto *other_typed = dynamic_cast<const NodeOutputsKey *>(&other)) {
+      return *this == *other_typed;
+    }
+    return false;
+  }
+
+  std::unique_ptr<GenericKey> to_storable() const override
+  {
+    return std::make_unique<NodeOutputsKey>(*this);
+  }
+};
+
+class CachedNodeOutputs : public memory_cache::CachedValue {
+ public:
+  /**
+   * Copies of the values the node set for its lazy-function outputs. Outputs that were not set
+   * by the node (e.g. because they were set before the node executed) are null.
+   */
+  Array<GMutablePointer> outputs;
+  /** Warnings the node added during its execution, only gathered when the node was logged. */
+  Vector<geo_eval_log::NodeWarning> warnings;
+
+  CachedNodeOutputs(const int64_t outputs_num) : outputs(outputs_num) {}
+
+  ~CachedNodeOutputs() override
+  {
+    for (GMutablePointer value : this->outputs) {
+      if (value.get() != nullptr) {
+        value.destruct();
+        MEM_freeN(value.get());
+      }
+    }
+  }
+
+  void count_memory(MemoryCounter &memory) const override
+  {
+    for (const GMutablePointer value : this->outputs) {
+      if (value.get() == nullptr) {
+        continue;
+      }
+      if (value.type()->is<GeometrySet>()) {
+        value.get<GeometrySet>()->count_memory(memory);
+      }
+      else {
+        memory.add(value.type()->size());
+      }
+    }
+  }
+};
+
+/**
+ * Forwards everything to the params of the evaluation, but keeps a copy of every output value
+ * when it is set, because the value may be moved away right after.
+ */
+class OutputCapturingParams : public lf::Params {
+ private:
+  lf::Params &base_params_;
+  MutableSpan<GMutablePointer> captured_outputs_;
+
+ public:
+  OutputCapturingParams(lf::Params &base_params, MutableSpan<GMutablePointer> captured_outputs)
+      : lf::Params(base_params.fn_, false),
+        base_params_(base_params),
+        captured_outputs_(captured_outputs)
+  {
+  }
+
+  void *try_get_input_data_ptr_impl(const int index) const override
+  {
+    return base_params_.try_get_input_data_ptr(index);
+  }
+
+  void *try_get_input_data_ptr_or_request_impl(const int index) override
+  {
+    return base_params_.try_get_input_data_ptr_or_request(index);
+  }
+
+  void *get_output_data_ptr_impl(const int index) override
+  {
+    return base_params_.get_output_data_ptr(index);
+  }
+
+  void output_set_impl(const int index) override
+  {
+    const CPPType &type = *fn_.outputs()[index].type;
+    void *buffer = MEM_mallocN_aligned(type.size(), type.alignment(), __func__);
+    type.copy_construct(base_params_.get_output_data_ptr(index), buffer);
+    captured_outputs_[index] = {type, buffer};
+    base_params_.output_set(index);
+  }
+
+  bool output_was_set_impl(const int index) const override
+  {
+    return base_params_.output_was_set(index);
+  }
+
+  lf::ValueUsage get_output_usage_impl(const int index) const override
+  {
+    return base_params_.get_output_usage(index);
+  }
+
+  void set_input_unused_impl(const int index) override
+  {
+    base_params_.set_input_unused(index);
+  }
+
+  bool try_enable_multi_threading_impl() override
+  {
+    return base_params_.try_enable_multi_threading();
+  }
+};
+
+/** Gathers hashes of everything the outputs depend on, which are combined into the key. */
+class InputHasher {
+ private:
+  Vector<uint64_t, 64> hashes_;
+
+ public:
+  void add(const uint64_t value)
+  {
+    hashes_.append(value);
+  }
+
+  void add_data(const void *data, const int64_t size_in_bytes)
+  {
+    const XXH128_hash_t hash = XXH3_128bits(data, size_t(size_in_bytes));
+    hashes_.append(hash.low64);
+    hashes_.append(hash.high64);
+  }
+
+  void add_string(const StringRef str)
+  {
+    this->add(uint64_t(str.size()));
+    this->add_data(str.data(), str.size());
+  }
+
+  NodeOutputsKey finish() const
+  {
+    const XXH128_hash_t hash = XXH3_128bits(hashes_.data(), hashes_.as_span().size_in_bytes());
+    NodeOutputsKey key;
+    key.hash_low = hash.low64;
+    key.hash_high = hash.high64;
+    return key;
+  }
+};
+
+static void hash_attributes(const bke::AttributeAccessor attributes, InputHasher &hasher)
+{
+  attributes.foreach_attribute([&](const bke::AttributeIter &iter) {
+    hasher.add_string(iter.name);
+    hasher.add(uint64_t(iter.domain));
+    hasher.add(uint64_t(iter.data_type));
+    /* Attribute types are trivial, so comparing their bytes is enough. */
+    const GVArraySpan values(iter.get().varray);
+    hasher.add_data(values.data(), values.size_in_bytes());
+  });
+}
+
+/**
+ * Hash the custom data layers that are not accessible as generic attributes, like custom normals
+ * or original indices. Returns false if a layer can't be compared by its bytes.
+ */
+static bool hash_custom_data_layers(const CustomData &data,
+                                    const int elems_num,
+                                    InputHasher &hasher)
+{
+  for (const CustomDataLayer &layer : Span(data.layers, data.totlayer)) {
+    const eCustomDataType type = eCustomDataType(layer.type);
+    /* Vertex group weights are hashed as attributes. */
+    if (CD_TYPE_AS_MASK(type) & (CD_MASK_PROP_ALL | CD_MASK_MDEFORMVERT)) {
+      continue;
+    }
+    if (CustomData_layertype_is_dynamic(type)) {
+      return false;
+    }
+    hasher.add(uint64_t(type));
+    hasher.add_string(layer.name);
+    hasher.add_data(layer.data, int64_t(CustomData_sizeof(type)) * elems_num);
+  }
+  return true;
+}
+
+static void hash_materials(const Span<const Material *> materials, InputHasher &hasher)
+{
+  hasher.add(uint64_t(materials.size()));
+  for (const Material *material : materials) {
+    /* Unlike pointers, session UIDs are not reused when a material is freed. */
+    hasher.add(material ? uint64_t(material->id.session_uid) : 0);
+  }
+}
+
+/**
+ * Hash the content of the geometry. Returns false if the geometry contains data that is not
+ * supported or that may change without changing the geometry (like referenced objects).
+ */
+static bool hash_geometry(const GeometrySet &geometry, InputHasher &hasher)
+{
+  if (geometry.has_volume() || geometry.has_grease_pencil() ||
+      geometry.has_component<bke::GeometryComponentEditData>())
+  {
+    return false;
+  }
+  hasher.add_string(geometry.name);
+  if (const Mesh *mesh = geometry.get_mesh()) {
+    hasher.add(uint64_t(bke::GeometryComponent::Type::Mesh));
+    hasher.add(uint64_t(mesh->verts_num));
+    hasher.add(uint64_t(mesh->edges_num));
+    hasher.add(uint64_t(mesh->faces_num));
+    hasher.add(uint64_t(mesh->corners_num));
+    hasher.add_data(mesh->face_offsets().data(), mesh->face_offsets().size_in_bytes());
+    hash_attributes(mesh->attributes(), hasher);
+    if (!hash_custom_data_layers(mesh->vert_data, mesh->verts_num, hasher) ||
+        !hash_custom_data_layers(mesh->edge_data, mesh->edges_num, hasher) ||
+        !hash_custom_data_layers(mesh->face_data, mesh->faces_num, hasher) ||
+        !hash_custom_data_layers(mesh->corner_data, mesh->corners_num, hasher))
+    {
+      return false;
+    }
+    hash_materials({mesh->mat, mesh->totcol}, hasher);
+  }
+  if (const PointCloud *pointcloud = geometry.get_pointcloud()) {
+    hasher.add(uint64_t(bke::GeometryComponent::Type::PointCloud));
+    hasher.add(uint64_t(pointcloud->totpoint));
+    hash_attributes(pointcloud->attributes(), hasher);
+    if (!hash_custom_data_layers(pointcloud->pdata, pointcloud->totpoint, hasher)) {
+      return false;
+    }
+    hash_materials({pointcloud->mat, pointcloud->totcol}, hasher);
+  }
+  if (const Curves *curves_id = geometry.get_curves()) {
+    const bke::CurvesGeometry &curves = curves_id->geometry.wrap();
+    hasher.add(uint64_t(bke::GeometryComponent::Type::Curve));
+    hasher.add(uint64_t(curves.points_num()));
+    hasher.add(uint64_t(curves.curves_num()));
+    hasher.add_data(curves.offsets().data(), curves.offsets().size_in_bytes());
+    hash_attributes(curves.attributes(), hasher);
+    if (!hash_custom_data_layers(curves.point_data, curves.points_num(), hasher) ||
+        !hash_custom_data_layers(curves.curve_data, curves.curves_num(), hasher))
+    {
+      return false;
+    }
+    hash_materials({curves_id->mat, curves_id->totcol}, hasher);
+  }
+  if (const bke::Instances *instances = geometry.get_instances()) {
+    hasher.add(uint64_t(bke::GeometryComponent::Type::Instance));
+    hasher.add(uint64_t(instances->instances_num()));
+    hash_attributes(instances->attributes(), hasher);
+    if (!hash_custom_data_layers(
+            instances->custom_data_attributes(), instances->instances_num(), hasher))
+    {
+      return false;
+    }
+    hasher.add(uint64_t(instances->references().size()));
+    for (const bke::InstanceReference &reference : instances->references()) {
+      hasher.add(uint64_t(reference.type()));
+      if (reference.type() == bke::InstanceReference::Type::GeometrySet) {
+        if (!hash_geometry(reference.geometry_set(), hasher)) {
+          return false;
+        }
+      }
+      else if (reference.type() != bke::InstanceReference::Type::None) {
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+static bool hash_socket_value(const SocketValueVariant &value, InputHasher &hasher)
+{
+  if (value.is_context_dependent_field() || value.is_volume_grid()) {
+    return false;
+  }
+  SocketValueVariant single_value_variant = value;
+  single_value_variant.convert_to_single();
+  const GPointer single_value = single_value_variant.get_single_ptr();
+  const CPPType &single_type = *single_value.type();
+  if (single_type.is_trivial()) {
+    hasher.add_data(single_value.get(), single_type.size());
+    return true;
+  }
+  if (single_type.is<std::string>()) {
+    hasher.add_string(*single_value.get<std::string>());
+    return true;
+  }
+  if (single_type.is_hashable()) {
+    hasher.add(single_type.hash(single_value.get()));
+    return true;
+  }
+  return false;
+}
+
+static bool hash_input(const CPPType &type, const void *value, InputHasher &hasher)
+{
+  if (type.is<GeometrySet>()) {
+    return hash_geometry(*static_cast<const GeometrySet *>(value), hasher);
+  }
+  if (type.is<SocketValueVariant>()) {
+    return hash_socket_value(*static_cast<const SocketValueVariant *>(value), hasher);
+  }
+  /* Multi-input sockets. The order of the values matters, e.g. for the Mesh Boolean node. */
+  if (type.is<Vector<GeometrySet>>()) {
+    const Vector<GeometrySet> &geometries = *static_cast<const Vector<GeometrySet> *>(value);
+    hasher.add(uint64_t(geometries.size()));
+    for (const GeometrySet &geometry : geometries) {
+      if (!hash_geometry(geometry, hasher)) {
+        return false;
+      }
+    }
+    return true;
+  }
+  if (type.is<Vector<SocketValueVariant>>()) {
+    const Vector<SocketValueVariant> &values = *static_cast<const Vector<SocketValueVariant> *>(
+        value);
+    hasher.add(uint64_t(values.size()));
+    for (const SocketValueVariant &socket_value : values) {
+      if (!hash_socket_value(socket_value, hasher)) {
+        return false;
+      }
+    }
+    return true;
+  }
+  if (type.is<bool>()) {
+    hasher.add(uint64_t(*static_cast<const bool *>(value)));
+    return true;
+  }
+  if (type.is<bke::AnonymousAttributeSet>()) {
+    const bke::AnonymousAttributeSet &set = *static_cast<const bke::AnonymousAttributeSet *>(
+        value);
+    if (!set.names) {
+      hasher.add(0);
+      return true;
+    }
+    /* The order of the names in the set is arbitrary, so use an order-independent combination. */
+    uint64_t names_hash = 0;
+    for (const std::string &name : *set.names) {
+      names_hash += XXH3_64bits(name.data(), name.size());
+    }
+    hasher.add(uint64_t(set.names->size()) + 1);
+    hasher.add(names_hash);
+    return true;
+  }
+  return false;
+}
+
+static bool has_anonymous_attribute_outputs(const bNode &node)
+{
+  const aal::RelationsInNode *relations = node.declaration()->anonymous_attribute_relations();
+  return relations != nullptr && !relations->available_relations.is_empty();
+}
+
+static std::optional<NodeOutputsKey> compute_key(const bNode &node,
+                                                 const lf::Params &params,
+                                                 const GeoNodesLFUserData &user_data,
+                                                 const bool gather_warnings)
+{
+  const CacheableNodeType &node_type = *find_cacheable_node_type(node);
+  InputHasher hasher;
+  hasher.add(uint64_t(node.type));
+  hasher.add(uint64_t(node.custom1));
+  hasher.add(uint64_t(node.custom2));
+  hasher.add_data(&node.custom3, sizeof(float));
+  hasher.add_data(&node.custom4, sizeof(float));
+  if (node_type.storage_size > 0) {
+    hasher.add_data(node.storage, node_type.storage_size);
+  }
+  hasher.add(uint64_t(gather_warnings));
+  if (has_anonymous_attribute_outputs(node)) {
+    /* The names of the attributes created by the node depend on where it is evaluated. */
+    const ComputeContextHash &context_hash = user_data.compute_context->hash();
+    hasher.add(context_hash.v1);
+    hasher.add(context_hash.v2);
+    hasher.add(uint64_t(node.identifier));
+    hasher.add_string(user_data.call_data->self_object()->id.name);
+  }
+
+  const lf::LazyFunction &fn = params.fn_;
+  /* Nodes may compute only some outputs, so the cached outputs are only valid if the same outputs
+   * are requested. */
+  for (const int i : fn.outputs().index_range()) {
+    hasher.add(uint64_t(params.get_output_usage(i)));
+    hasher.add(uint64_t(params.output_was_set(i)));
+  }
+  for (const int i : fn.inputs().index_range()) {
+    const void *value = params.try_get_input_data_ptr(i);
+    BLI_assert(value != nullptr);
+    if (!hash_input(*fn.inputs()[i].type, value, hasher)) {
+      return std::nullopt;
+    }
+  }
+  return hasher.finish();
+}
+
+void execute_node_cached(const bNode &node,
+                         lf::Params &params,
+                         const GeoNodesLFUserData &user_data,
+                         geo_eval_log::GeoTreeLogger *tree_logger,
+                         const FunctionRef<void(lf::Params &params)> execute_fn)
+{
+  BLI_assert(is_node_cacheable(node));
+  const std::optional<NodeOutputsKey> key = compute_key(
+      node, params, user_data, tree_logger != nullptr);
+  if (!key) {
+    execute_fn(params);
+    return;
+  }
+
+  bool newly_computed = false;
+  const std::shared_ptr<const CachedNodeOutputs> cached_outputs =
+      memory_cache::get<CachedNodeOutputs>(*key, [&]() {
+        newly_computed = true;
+        auto value = std::make_unique<CachedNodeOutputs>(params.fn_.outputs().size());
+        OutputCapturingParams capturing_params{params, value->outputs};
+        execute_fn(capturing_params);
+        if (tree_logger) {
+          for (const geo_eval_log::GeoTreeLogger::WarningWithNode &warning :
+               tree_logger->node_warnings)
+          {
+            if (warning.node_id == node.identifier) {
+              value->warnings.append(warning.warning);
+            }
+          }
+        }
+        return value;
+      });
+  if (newly_computed) {
+    /* The outputs have been set already. */
+    return;
+  }
+
+  for (const int i : cached_outputs->outputs.index_range()) {
+    const GMutablePointer value = cached_outputs->outputs[i];
+    if (value.get() == nullptr || params.output_was_set(i)) {
+      continue;
+    }
+    /* Geometry is copied cheaply, because its data is shared with the cached geometry. */
+    value.type()->copy_construct(value.get(), params.get_output_data_ptr(i));
+    params.output_set(i);
+  }
+  if (tree_logger) {
+    for (const geo_eval_log::NodeWarning &warning : cached_outputs->warnings) {
+      tree_logger->node_warnings.append(*tree_logger->allocator,
+                                        {node.identifier, warning});
+    }
+  }
+}
+
+std::optional<uint64_t> hash_geometry_content(const GeometrySet &geometry)
+{
+  InputHasher hasher;
+  if (!hash_geometry(geometry, hasher)) {
+    return std::nullopt;
+  }
+  return hasher.finish().hash();
+}
+
+}  // namespace blender::nodes::node_output_cache
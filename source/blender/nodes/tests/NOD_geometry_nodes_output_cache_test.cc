@@ -0,0 +1,151 @@
+/* SPDX-FileCopyrightText: 2025 Blender Authors
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later */
+
+#include "testing/testing.h"
+
+#include "BLI_listbase.h"
+#include "BLI_string.h"
+
+#include "BKE_attribute.hh"
+#include "BKE_customdata.hh"
+#include "BKE_deform.hh"
+#include "BKE_geometry_set.hh"
+#include "BKE_idtype.hh"
+#include "BKE_instances.hh"
+#include "BKE_lib_id.hh"
+#include "BKE_mesh.h"
+#include "BKE_mesh.hh"
+
+#include "DNA_mesh_types.h"
+#include "DNA_meshdata_types.h"
+#include "DNA_object_types.h"
+
+#include "GEO_mesh_primitive_grid.hh"
+
+#include "NOD_geometry_nodes_output_cache.hh"
+
+#include "MEM_guardedalloc.h"
+
+namespace blender::nodes::node_output_cache::tests {
+
+using bke::GeometrySet;
+
+class geometry_nodes_output_cache : public testing::Test {
+ protected:
+  static void SetUpTestSuite()
+  {
+    BKE_idtype_init();
+  }
+};
+
+static Mesh *create_test_mesh()
+{
+  return geometry::create_grid_mesh(4, 3, 1.0f, 1.0f, std::nullopt);
+}
+
+static uint64_t hash_mesh(const Mesh &mesh)
+{
+  const std::optional<uint64_t> hash = hash_geometry_content(
+      GeometrySet::from_mesh(BKE_mesh_copy_for_eval(mesh)));
+  EXPECT_TRUE(hash.has_value());
+  return hash.value_or(0);
+}
+
+TEST_F(geometry_nodes_output_cache, equal_content_hit)
+{
+  Mesh *mesh_a = create_test_mesh();
+  Mesh *mesh_b = create_test_mesh();
+  /* Separately computed geometry with the same content uses the same cached outputs. */
+  EXPECT_EQ(hash_mesh(*mesh_a), hash_mesh(*mesh_b));
+  BKE_id_free(nullptr, mesh_a);
+  BKE_id_free(nullptr, mesh_b);
+}
+
+TEST_F(geometry_nodes_output_cache, changed_attribute_miss)
+{
+  Mesh *mesh = create_test_mesh();
+  const uint64_t hash = hash_mesh(*mesh);
+  mesh->vert_positions_for_write()[2].z = 1.0f;
+  mesh->tag_positions_changed();
+  EXPECT_NE(hash, hash_mesh(*mesh));
+  BKE_id_free(nullptr, mesh);
+}
+
+TEST_F(geometry_nodes_output_cache, custom_normals_invalidate)
+{
+  Mesh *mesh = create_test_mesh();
+  const uint64_t hash = hash_mesh(*mesh);
+
+  short2 *clnors = static_cast<short2 *>(CustomData_add_layer(
+      &mesh->corner_data, CD_CUSTOMLOOPNORMAL, CD_SET_DEFAULT, mesh->corners_num));
+  const uint64_t hash_with_normals = hash_mesh(*mesh);
+  EXPECT_NE(hash, hash_with_normals);
+
+  clnors[3] = short2(100, -100);
+  EXPECT_NE(hash_with_normals, hash_mesh(*mesh));
+  BKE_id_free(nullptr, mesh);
+}
+
+TEST_F(geometry_nodes_output_cache, original_indices_invalidate)
+{
+  Mesh *mesh = create_test_mesh();
+  int *orig_indices = static_cast<int *>(CustomData_add_layer(
+      &mesh->vert_data, CD_ORIGINDEX, CD_SET_DEFAULT, mesh->verts_num));
+  for (const int vert : IndexRange(mesh->verts_num)) {
+    orig_indices[vert] = vert;
+  }
+  const uint64_t hash = hash_mesh(*mesh);
+  orig_indices[0] = ORIGINDEX_NONE;
+  EXPECT_NE(hash, hash_mesh(*mesh));
+  BKE_id_free(nullptr, mesh);
+}
+
+TEST_F(geometry_nodes_output_cache, vertex_groups_invalidate)
+{
+  Mesh *mesh = create_test_mesh();
+  bDeformGroup *group = MEM_cnew<bDeformGroup>(__func__);
+  STRNCPY(group->name, "Group");
+  BLI_addtail(&mesh->vertex_group_names, group);
+  MutableSpan<MDeformVert> dverts = mesh->deform_verts_for_write();
+  BKE_defvert_ensure_index(&dverts[1], 0)->weight = 0.5f;
+  const uint64_t hash = hash_mesh(*mesh);
+
+  BKE_defvert_ensure_index(&dverts[1], 0)->weight = 0.25f;
+  EXPECT_NE(hash, hash_mesh(*mesh));
+  BKE_id_free(nullptr, mesh);
+}
+
+TEST_F(geometry_nodes_output_cache, instanced_geometry_invalidate)
+{
+  Mesh *mesh = create_test_mesh();
+  const auto hash_instanced_mesh = [&]() {
+    bke::Instances *instances = new bke::Instances();
+    const int handle = instances->add_reference(
+        bke::InstanceReference{GeometrySet::from_mesh(BKE_mesh_copy_for_eval(*mesh))});
+    instances->add_instance(handle, float4x4::identity());
+    const std::optional<uint64_t> hash = hash_geometry_content(
+        GeometrySet::from_instances(instances));
+    EXPECT_TRUE(hash.has_value());
+    return hash.value_or(0);
+  };
+  const uint64_t hash = hash_instanced_mesh();
+  EXPECT_EQ(hash, hash_instanced_mesh());
+
+  mesh->vert_positions_for_write()[0].x = -1.0f;
+  mesh->tag_positions_changed();
+  EXPECT_NE(hash, hash_instanced_mesh());
+  BKE_id_free(nullptr, mesh);
+}
+
+TEST_F(geometry_nodes_output_cache, unsupported_layer_not_cached)
+{
+  Mesh *mesh = create_test_mesh();
+  /* Multi-resolution displacement layers store pointers to their data. */
+  CustomData_add_layer(&mesh->corner_data, CD_MDISPS, CD_SET_DEFAULT, mesh->corners_num);
+  EXPECT_FALSE(
+      hash_geometry_content(GeometrySet::from_mesh(BKE_mesh_copy_for_eval(*mesh))).has_value());
+  BKE_id_free(nullptr, mesh);
+}
+
+}  // namespace blender::nodes::node_output_cache::tests
@@ -40,7 +40,7 @@ typedef struct MultiresBakeRender {
 
   int raytrace_structure; /* Optimization structure to be used for AO baking */
   int octree_resolution;  /* Resolution of octree when using octree optimization structure */
-  int threads;            /* Number of threads to be used for baking */
+  int threads;            /* Unused, baking runs on the threads of the task scheduler. */
 
   float user_scale; /* User scale used to scale displacement when baking derivative map. */
 
@@ -346,6 +346,8 @@ class Context : public realtime_compositor::Context {
         }
       case SCE_COMPOSITOR_PRECISION_FULL:
         return realtime_compositor::ResultPrecision::Full;
+      case SCE_COMPOSITOR_PRECISION_HALF:
+        return realtime_compositor::ResultPrecision::Half;
     }
 
     BLI_assert_unreachable();
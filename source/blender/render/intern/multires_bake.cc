@@ -7,6 +7,7 @@
  */
 
 #include <cstring>
+#include <mutex>
 
 #include "MEM_guardedalloc.h"
 
@@ -16,7 +17,8 @@
 #include "BLI_math_color.h"
 #include "BLI_math_geom.h"
 #include "BLI_math_matrix.h"
-#include "BLI_threads.h"
+#include "BLI_math_vector.hh"
+#include "BLI_task.hh"
 
 #include "BKE_attribute.hh"
 #include "BKE_ccg.hh"
@@ -101,6 +103,8 @@ using MFlushPixel = void (*)(const MResolvePixelData *data, const int x, const i
 
 struct MBakeRast {
   int w, h;
+  /** Pixels outside of the tile being baked are skipped. */
+  int tile_xmin, tile_ymin, tile_xmax, tile_ymax;
   char *texels;
   const MResolvePixelData *data;
   MFlushPixel flush_pixel;
@@ -152,6 +156,8 @@ static void init_bake_rast(MBakeRast *bake_rast,
   bake_rast->texels = userdata->mask_buffer;
   bake_rast->w = ibuf->x;
   bake_rast->h = ibuf->y;
+  bake_rast->tile_xmax = ibuf->x;
+  bake_rast->tile_ymax = ibuf->y;
   bake_rast->data = data;
   bake_rast->flush_pixel = flush_pixel;
   bake_rast->do_update = do_update;
@@ -228,9 +234,10 @@ static void flush_pixel(const MResolvePixelData *data, const int x, const int y)
 static void set_rast_triangle(const MBakeRast *bake_rast, const int x, const int y)
 {
   const int w = bake_rast->w;
-  const int h = bake_rast->h;
 
-  if (x >= 0 && x < w && y >= 0 && y < h) {
+  if (x >= bake_rast->tile_xmin && x < bake_rast->tile_xmax && y >= bake_rast->tile_ymin &&
+      y < bake_rast->tile_ymax)
+  {
     if ((bake_rast->texels[y * w + x]) == 0) {
       bake_rast->texels[y * w + x] = FILTER_MASK_USED;
       flush_pixel(bake_rast->data, x, y);
@@ -256,16 +263,18 @@ static void rasterize_half(const MBakeRast *bake_rast,
 {
   const int s_stable = fabsf(t1_s - t0_s) > FLT_EPSILON ? 1 : 0;
   const int l_stable = fabsf(t1_l - t0_l) > FLT_EPSILON ? 1 : 0;
-  const int w = bake_rast->w;
-  const int h = bake_rast->h;
+  const int xmin = bake_rast->tile_xmin;
+  const int xmax = bake_rast->tile_xmax;
+  const int ymin = bake_rast->tile_ymin;
+  const int ymax = bake_rast->tile_ymax;
   int y, y0, y1;
 
-  if (y1_in <= 0 || y0_in >= h) {
+  if (y1_in <= ymin || y0_in >= ymax) {
     return;
   }
 
-  y0 = y0_in < 0 ? 0 : y0_in;
-  y1 = y1_in >= h ? h : y1_in;
+  y0 = y0_in < ymin ? ymin : y0_in;
+  y1 = y1_in >= ymax ? ymax : y1_in;
 
   for (y = y0; y < y1; y++) {
     /*-b(x-x0) + a(y-y0) = 0 */
@@ -280,9 +289,9 @@ static void rasterize_half(const MBakeRast *bake_rast,
     iXl = int(ceilf(x_l));
     iXr = int(ceilf(x_r));
 
-    if (iXr > 0 && iXl < w) {
-      iXl = iXl < 0 ? 0 : iXl;
-      iXr = iXr >= w ? w : iXr;
+    if (iXr > xmin && iXl < xmax) {
+      iXl = iXl < xmin ? xmin : iXl;
+      iXr = iXr >= xmax ? xmax : iXr;
 
       for (x = iXl; x < iXr; x++) {
         set_rast_triangle(bake_rast, x, y);
@@ -349,15 +358,25 @@ static int multiresbake_test_break(MultiresBakeRender *bkr)
 
 /* **** Threading routines **** */
 
-struct MultiresBakeQueue {
-  int cur_tri;
-  int tot_tri;
-  SpinLock spin;
+/**
+ * The image is baked in square tiles of pixels which are baked in parallel. Every tile rasterizes
+ * the triangles overlapping it in their original order and only writes its own pixels, so no
+ * locking is needed and the result is the same as when rasterizing all triangles one after the
+ * other. Neighbor triangles are mostly baked by the same thread, which keeps the accessed parts of
+ * the meshes in the cache.
+ */
+static constexpr int BAKE_TILE_SIZE = 64;
+
+struct MultiresBakeTiles {
+  int tiles_x, tiles_y;
+  /** Triangles overlapping each tile, in their original order. */
+  blender::Array<blender::Vector<int>> tile_tris;
+  /** Number of triangles of which each tile is the first tile, for progress reports. */
+  blender::Array<int> tile_first_tris_num;
 };
 
 struct MultiresBakeThread {
   /* this data is actually shared between all the threads */
-  MultiresBakeQueue *queue;
   MultiresBakeRender *bkr;
   Image *image;
   void *bake_data;
@@ -371,46 +390,72 @@ struct MultiresBakeThread {
   float height_min, height_max;
 };
 
-static int multires_bake_queue_next_tri(MultiresBakeQueue *queue)
+/** Find the tiles overlapped by the triangles that are baked into the image. */
+static void multires_bake_bin_tris(const MultiresBakeRender *bkr,
+                                   const MResolvePixelData &data,
+                                   const Image *image,
+                                   MultiresBakeTiles &tiles)
 {
-  int face = -1;
+  using namespace blender;
+  tiles.tiles_x = (data.w + BAKE_TILE_SIZE - 1) / BAKE_TILE_SIZE;
+  tiles.tiles_y = (data.h + BAKE_TILE_SIZE - 1) / BAKE_TILE_SIZE;
+  tiles.tile_tris.reinitialize(tiles.tiles_x * tiles.tiles_y);
+  tiles.tile_first_tris_num = Array<int>(tiles.tile_tris.size(), 0);
+
+  for (const int tri_index : data.corner_tris.index_range()) {
+    const int3 &tri = data.corner_tris[tri_index];
+    const int face_i = data.tri_faces[tri_index];
+    const short mat_nr = data.material_indices == nullptr ? 0 : data.material_indices[face_i];
+    const Image *tri_image = mat_nr < bkr->ob_image.len ? bkr->ob_image.array[mat_nr] : nullptr;
+    if (tri_image != image) {
+      continue;
+    }
 
-  /* TODO: it could worth making it so thread will handle neighbor faces
-   *       for better memory cache utilization
-   */
+    /* Pixel bounds of the triangle as rasterized by #bake_rasterize, with a pixel of padding to
+     * account for rounding. */
+    float2 min(FLT_MAX), max(-FLT_MAX);
+    for (const int i : IndexRange(3)) {
+      const float2 st = (data.uv_map[tri[i]] - float2(data.uv_offset)) *
+                            float2(data.w, data.h) -
+                        0.5f;
+      min = math::min(min, st);
+      max = math::max(max, st);
+    }
+    const int xmin = std::max(int(floorf(min.x)) - 1, 0);
+    const int ymin = std::max(int(floorf(min.y)) - 1, 0);
+    const int xmax = std::min(int(ceilf(max.x)) + 1, data.w - 1);
+    const int ymax = std::min(int(ceilf(max.y)) + 1, data.h - 1);
+    if (xmin > xmax || ymin > ymax) {
+      continue;
+    }
 
-  BLI_spin_lock(&queue->spin);
-  if (queue->cur_tri < queue->tot_tri) {
-    face = queue->cur_tri;
-    queue->cur_tri++;
+    const int tile_xmin = xmin / BAKE_TILE_SIZE;
+    const int tile_ymin = ymin / BAKE_TILE_SIZE;
+    for (int tile_y = tile_ymin; tile_y <= ymax / BAKE_TILE_SIZE; tile_y++) {
+      for (int tile_x = tile_xmin; tile_x <= xmax / BAKE_TILE_SIZE; tile_x++) {
+        tiles.tile_tris[tile_y * tiles.tiles_x + tile_x].append(tri_index);
+      }
+    }
+    tiles.tile_first_tris_num[tile_ymin * tiles.tiles_x + tile_xmin]++;
   }
-  BLI_spin_unlock(&queue->spin);
-
-  return face;
 }
 
-static void *do_multires_bake_thread(void *data_v)
+static void do_multires_bake_tile(MultiresBakeThread *handle,
+                                  const MultiresBakeTiles &tiles,
+                                  const int tile_index)
 {
-  MultiresBakeThread *handle = (MultiresBakeThread *)data_v;
   MResolvePixelData *data = &handle->data;
   MBakeRast *bake_rast = &handle->bake_rast;
-  MultiresBakeRender *bkr = handle->bkr;
-  int tri_index;
-
-  while ((tri_index = multires_bake_queue_next_tri(handle->queue)) >= 0) {
-    const blender::int3 &tri = data->corner_tris[tri_index];
-    const int face_i = data->tri_faces[tri_index];
-    const short mat_nr = data->material_indices == nullptr ? 0 : data->material_indices[face_i];
 
-    if (multiresbake_test_break(bkr)) {
-      break;
-    }
-
-    Image *tri_image = mat_nr < bkr->ob_image.len ? bkr->ob_image.array[mat_nr] : nullptr;
-    if (tri_image != handle->image) {
-      continue;
-    }
+  const int tile_x = tile_index % tiles.tiles_x;
+  const int tile_y = tile_index / tiles.tiles_x;
+  bake_rast->tile_xmin = tile_x * BAKE_TILE_SIZE;
+  bake_rast->tile_ymin = tile_y * BAKE_TILE_SIZE;
+  bake_rast->tile_xmax = std::min(bake_rast->tile_xmin + BAKE_TILE_SIZE, bake_rast->w);
+  bake_rast->tile_ymax = std::min(bake_rast->tile_ymin + BAKE_TILE_SIZE, bake_rast->h);
 
+  for (const int tri_index : tiles.tile_tris[tile_index]) {
+    const blender::int3 &tri = data->corner_tris[tri_index];
     data->tri_index = tri_index;
 
     float uv[3][2];
@@ -419,31 +464,7 @@ static void *do_multires_bake_thread(void *data_v)
     sub_v2_v2v2(uv[2], data->uv_map[tri[2]], data->uv_offset);
 
     bake_rasterize(bake_rast, uv[0], uv[1], uv[2]);
-
-    /* tag image buffer for refresh */
-    if (data->ibuf->float_buffer.data) {
-      data->ibuf->userflags |= IB_RECT_INVALID;
-    }
-
-    data->ibuf->userflags |= IB_DISPLAY_BUFFER_INVALID;
-
-    /* update progress */
-    BLI_spin_lock(&handle->queue->spin);
-    bkr->baked_faces++;
-
-    if (bkr->do_update) {
-      *bkr->do_update = true;
-    }
-
-    if (bkr->progress) {
-      *bkr->progress = (float(bkr->baked_objects) +
-                        float(bkr->baked_faces) / handle->num_total_faces) /
-                       bkr->tot_obj;
-    }
-    BLI_spin_unlock(&handle->queue->spin);
   }
-
-  return nullptr;
 }
 
 /* some of arrays inside ccgdm are lazy-initialized, which will generally
@@ -484,17 +505,12 @@ static void do_multires_bake(MultiresBakeRender *bkr,
     return;
   }
 
-  MultiresBakeQueue queue;
-
   const Span<float2> uv_map(
       reinterpret_cast<const float2 *>(dm->getLoopDataArray(dm, CD_PROP_FLOAT2)),
       dm->getNumLoops(dm));
 
   float *pvtangent = nullptr;
 
-  ListBase threads;
-  int i, tot_thread = bkr->threads > 0 ? bkr->threads : BLI_system_thread_count();
-
   void *bake_data = nullptr;
 
   Mesh *temp_mesh = BKE_mesh_new_nomain(
@@ -573,75 +589,81 @@ static void do_multires_bake(MultiresBakeRender *bkr,
     bake_data = initBakeData(bkr, ibuf);
   }
 
-  if (tot_thread > 1) {
-    BLI_threadpool_init(&threads, do_multires_bake_thread, tot_thread);
-  }
+  init_ccgdm_arrays(bkr->hires_dm);
 
-  Array<MultiresBakeThread> handles(tot_thread);
+  /* Data shared by all threads, every thread makes its own copy. */
+  MultiresBakeThread shared_handle{};
+  shared_handle.bkr = bkr;
+  shared_handle.image = ima;
+  shared_handle.num_total_faces = corner_tris.size() * BLI_listbase_count(&ima->tiles);
+  shared_handle.bake_data = bake_data;
+
+  shared_handle.data.vert_positions = positions;
+  shared_handle.data.faces = faces;
+  shared_handle.data.corner_verts = corner_verts;
+  shared_handle.data.corner_tris = corner_tris;
+  shared_handle.data.tri_faces = tri_faces;
+  shared_handle.data.vert_normals = vert_normals;
+  shared_handle.data.face_normals = face_normals;
+  shared_handle.data.material_indices = static_cast<const int *>(
+      CustomData_get_layer_named(&dm->polyData, CD_PROP_INT32, "material_index"));
+  shared_handle.data.sharp_faces = static_cast<const bool *>(
+      CustomData_get_layer_named(&dm->polyData, CD_PROP_BOOL, "sharp_face"));
+  shared_handle.data.uv_map = uv_map;
+  BKE_image_get_tile_uv(ima, tile->tile_number, shared_handle.data.uv_offset);
+  shared_handle.data.pvtangent = pvtangent;
+  shared_handle.data.w = ibuf->x;
+  shared_handle.data.h = ibuf->y;
+  shared_handle.data.hires_dm = bkr->hires_dm;
+  shared_handle.data.lvl = lvl;
+  shared_handle.data.pass_data = passKnownData;
+  shared_handle.data.bake_data = bake_data;
+  shared_handle.data.ibuf = ibuf;
+
+  MultiresBakeTiles tiles;
+  multires_bake_bin_tris(bkr, shared_handle.data, ima, tiles);
+
+  std::mutex mutex;
+  threading::parallel_for(tiles.tile_tris.index_range(), 1, [&](const IndexRange range) {
+    MultiresBakeThread handle = shared_handle;
+    handle.data.thread_data = &handle;
+    handle.height_min = FLT_MAX;
+    handle.height_max = -FLT_MAX;
+    init_bake_rast(&handle.bake_rast, ibuf, &handle.data, flush_pixel, bkr->do_update);
+
+    for (const int tile_index : range) {
+      if (multiresbake_test_break(bkr)) {
+        break;
+      }
 
-  init_ccgdm_arrays(bkr->hires_dm);
+      do_multires_bake_tile(&handle, tiles, tile_index);
+
+      /* update progress */
+      std::scoped_lock lock(mutex);
+      bkr->baked_faces += tiles.tile_first_tris_num[tile_index];
+
+      if (bkr->do_update) {
+        *bkr->do_update = true;
+      }
 
-  /* faces queue */
-  queue.cur_tri = 0;
-  queue.tot_tri = corner_tris.size();
-  BLI_spin_init(&queue.spin);
-
-  /* fill in threads handles */
-  for (i = 0; i < tot_thread; i++) {
-    MultiresBakeThread *handle = &handles[i];
-
-    handle->bkr = bkr;
-    handle->image = ima;
-    handle->num_total_faces = queue.tot_tri * BLI_listbase_count(&ima->tiles);
-    handle->queue = &queue;
-
-    handle->data.vert_positions = positions;
-    handle->data.faces = faces;
-    handle->data.corner_verts = corner_verts;
-    handle->data.corner_tris = corner_tris;
-    handle->data.tri_faces = tri_faces;
-    handle->data.vert_normals = vert_normals;
-    handle->data.face_normals = face_normals;
-    handle->data.material_indices = static_cast<const int *>(
-        CustomData_get_layer_named(&dm->polyData, CD_PROP_INT32, "material_index"));
-    handle->data.sharp_faces = static_cast<const bool *>(
-        CustomData_get_layer_named(&dm->polyData, CD_PROP_BOOL, "sharp_face"));
-    handle->data.uv_map = uv_map;
-    BKE_image_get_tile_uv(ima, tile->tile_number, handle->data.uv_offset);
-    handle->data.pvtangent = pvtangent;
-    handle->data.w = ibuf->x;
-    handle->data.h = ibuf->y;
-    handle->data.hires_dm = bkr->hires_dm;
-    handle->data.lvl = lvl;
-    handle->data.pass_data = passKnownData;
-    handle->data.thread_data = handle;
-    handle->data.bake_data = bake_data;
-    handle->data.ibuf = ibuf;
-
-    handle->height_min = FLT_MAX;
-    handle->height_max = -FLT_MAX;
-
-    init_bake_rast(&handle->bake_rast, ibuf, &handle->data, flush_pixel, bkr->do_update);
-
-    if (tot_thread > 1) {
-      BLI_threadpool_insert(&threads, handle);
+      if (bkr->progress) {
+        *bkr->progress = (float(bkr->baked_objects) +
+                          float(bkr->baked_faces) / handle.num_total_faces) /
+                         bkr->tot_obj;
+      }
     }
-  }
 
-  /* run threads */
-  if (tot_thread > 1) {
-    BLI_threadpool_end(&threads);
-  }
-  else {
-    do_multires_bake_thread(&handles[0]);
-  }
+    std::scoped_lock lock(mutex);
+    result->height_min = min_ff(result->height_min, handle.height_min);
+    result->height_max = max_ff(result->height_max, handle.height_max);
+  });
 
-  for (i = 0; i < tot_thread; i++) {
-    result->height_min = min_ff(result->height_min, handles[i].height_min);
-    result->height_max = max_ff(result->height_max, handles[i].height_max);
+  /* tag image buffer for refresh */
+  if (ibuf->float_buffer.data) {
+    ibuf->userflags |= IB_RECT_INVALID;
   }
 
-  BLI_spin_end(&queue.spin);
+  ibuf->userflags |= IB_DISPLAY_BUFFER_INVALID;
 
   /* finalize baking */
   if (freeBakeData) {
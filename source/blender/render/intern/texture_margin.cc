@@ -10,6 +10,7 @@
 #include "BLI_math_geom.h"
 #include "BLI_math_vector.hh"
 #include "BLI_math_vector_types.hh"
+#include "BLI_task.hh"
 #include "BLI_vector.hh"
 
 #include "BKE_attribute.hh"
@@ -28,7 +29,9 @@
 #include "RE_texture_margin.h"
 
 #include <algorithm>
+#include <array>
 #include <cmath>
+#include <optional>
 #include <valarray>
 
 namespace blender::render::texturemargin {
@@ -49,10 +52,6 @@ class TextureMarginMap {
   int w_, h_;
   float uv_offset_[2];
   Vector<uint32_t> pixel_data_;
-  ZSpan zspan_;
-  uint32_t value_to_store_;
-  bool write_mask_;
-  char *mask_;
 
   OffsetIndices<int> faces_;
   Span<int> corner_edges_;
@@ -78,16 +77,9 @@ class TextureMarginMap {
 
     pixel_data_.resize(w_ * h_, 0xFFFFFFFF);
 
-    zbuf_alloc_span(&zspan_, w_, h_);
-
     build_tables();
   }
 
-  ~TextureMarginMap()
-  {
-    zbuf_free_span(&zspan_);
-  }
-
   inline void set_pixel(int x, int y, uint32_t value)
   {
     BLI_assert(x < w_);
@@ -104,42 +96,96 @@ class TextureMarginMap {
     return pixel_data_[y * w_ + x];
   }
 
-  void rasterize_tri(float *v1, float *v2, float *v3, uint32_t value, char *mask, bool writemask)
+  /**
+   * Rasterize triangles in UV pixel coordinates, storing the face index of every triangle.
+   * The map is split into bands of rows rasterized in parallel. Every band rasterizes the
+   * triangles overlapping it in their original order, so pixels covered by several triangles get
+   * the same face as when rasterizing all triangles one after the other.
+   */
+  void rasterize_tris(const Span<std::array<float2, 3>> tri_coords,
+                      const Span<int> tri_faces,
+                      char *mask,
+                      const bool writemask)
   {
-    /* NOTE: This is not thread safe, because the value to be written by the rasterizer is
-     * a class member. If this is ever made multi-threaded each thread needs to get its own. */
-    value_to_store_ = value;
-    mask_ = mask;
-    write_mask_ = writemask;
-    zspan_scanconvert(
-        &zspan_, this, &(v1[0]), &(v2[0]), &(v3[0]), TextureMarginMap::zscan_store_pixel);
+    const int band_rows = 64;
+    const int bands_num = (h_ + band_rows - 1) / band_rows;
+
+    /* Rows touched by a triangle are rounded from its coordinates, so add a row of padding. */
+    Array<Vector<int>> band_tris(bands_num);
+    for (const int i : tri_coords.index_range()) {
+      const std::array<float2, 3> &tri = tri_coords[i];
+      const float ymin = std::min({tri[0].y, tri[1].y, tri[2].y});
+      const float ymax = std::max({tri[0].y, tri[1].y, tri[2].y});
+      const int band_first = std::max(int(std::floor(ymin)) - 1, 0) / band_rows;
+      const int band_last = std::min(int(std::ceil(ymax)) + 1, h_ - 1) / band_rows;
+      for (int band = band_first; band <= band_last; band++) {
+        band_tris[band].append(i);
+      }
+    }
+
+    threading::parallel_for(IndexRange(bands_num), 1, [&](const IndexRange bands) {
+      ZSpan zspan;
+      zbuf_alloc_span(&zspan, w_, h_);
+      for (const int band : bands) {
+        BandRasterizer rasterizer;
+        rasterizer.map = this;
+        rasterizer.mask = mask;
+        rasterizer.write_mask = writemask;
+        rasterizer.rows = IndexRange(band * band_rows, std::min(band_rows, h_ - band * band_rows));
+        for (const int i : band_tris[band]) {
+          std::array<float2, 3> tri = tri_coords[i];
+          rasterizer.value = tri_faces[i];
+          zspan_scanconvert(&zspan,
+                            &rasterizer,
+                            tri[0],
+                            tri[1],
+                            tri[2],
+                            TextureMarginMap::zscan_store_pixel);
+        }
+      }
+      zbuf_free_span(&zspan);
+    });
   }
 
+ private:
+  /** Rasterization state of a band of rows, every thread has its own. */
+  struct BandRasterizer {
+    TextureMarginMap *map;
+    char *mask;
+    bool write_mask;
+    IndexRange rows;
+    uint32_t value;
+  };
+
   static void zscan_store_pixel(
-      void *map, int x, int y, [[maybe_unused]] float u, [[maybe_unused]] float v)
+      void *handle, int x, int y, [[maybe_unused]] float u, [[maybe_unused]] float v)
   {
-    /* NOTE: Not thread safe, see comment above. */
-    TextureMarginMap *m = static_cast<TextureMarginMap *>(map);
-    if (m->mask_) {
-      if (m->write_mask_) {
-        /* if there is a mask and write_mask_ is true, write to the mask */
-        m->mask_[y * m->w_ + x] = 1;
-        m->set_pixel(x, y, m->value_to_store_);
+    BandRasterizer *r = static_cast<BandRasterizer *>(handle);
+    if (!r->rows.contains(y)) {
+      return;
+    }
+    TextureMarginMap *m = r->map;
+    if (r->mask) {
+      if (r->write_mask) {
+        /* if there is a mask and write_mask is true, write to the mask */
+        r->mask[y * m->w_ + x] = 1;
+        m->set_pixel(x, y, r->value);
       }
       else {
-        /* if there is a mask and write_mask_ is false, read the mask
+        /* if there is a mask and write_mask is false, read the mask
          * to decide if the map needs to be written
          */
-        if (m->mask_[y * m->w_ + x] != 0) {
-          m->set_pixel(x, y, m->value_to_store_);
+        if (r->mask[y * m->w_ + x] != 0) {
+          m->set_pixel(x, y, r->value);
         }
       }
     }
     else {
-      m->set_pixel(x, y, m->value_to_store_);
+      m->set_pixel(x, y, r->value);
     }
   }
 
+ public:
 /* The map contains 2 kinds of pixels: DijkstraPixels and face indices. The top bit determines
  * what kind it is. With the top bit set, it is a 'dijkstra' pixel. The bottom 4 bits encode the
  * direction of the shortest path and the remaining 27 bits are used to store the distance. If
@@ -167,22 +213,38 @@ class TextureMarginMap {
       return a1.distance > a2.distance;
     };
 
-    Vector<DijkstraActivePixel> active_pixels;
-    for (int y = 0; y < h_; y++) {
-      for (int x = 0; x < w_; x++) {
-        if (DijkstraPixelIsUnset(get_pixel(x, y))) {
-          for (int i = 0; i < 8; i++) {
-            int xx = x - directions[i][0];
-            int yy = y - directions[i][1];
-
-            if (xx >= 0 && xx < w_ && yy >= 0 && yy < w_ && !IsDijkstraPixel(get_pixel(xx, yy))) {
-              set_pixel(x, y, PackDijkstraPixel(distances[i], i));
-              active_pixels.append(DijkstraActivePixel(distances[i], x, y));
-              break;
+    /* Seeding only depends on face pixels, so seeds are found for all rows in parallel. They are
+     * stored row by row afterwards, which keeps the order of the active pixels. */
+    struct SeedPixel {
+      int x, y;
+      int direction;
+    };
+    Array<Vector<SeedPixel>> row_seed_pixels(h_);
+    threading::parallel_for(IndexRange(h_), 16, [&](const IndexRange rows) {
+      for (const int y : rows) {
+        for (int x = 0; x < w_; x++) {
+          if (DijkstraPixelIsUnset(get_pixel(x, y))) {
+            for (int i = 0; i < 8; i++) {
+              int xx = x - directions[i][0];
+              int yy = y - directions[i][1];
+
+              if (xx >= 0 && xx < w_ && yy >= 0 && yy < w_ && !IsDijkstraPixel(get_pixel(xx, yy)))
+              {
+                row_seed_pixels[y].append({x, y, i});
+                break;
+              }
             }
           }
         }
       }
+    });
+
+    Vector<DijkstraActivePixel> active_pixels;
+    for (const Vector<SeedPixel> &pixels : row_seed_pixels) {
+      for (const SeedPixel &p : pixels) {
+        set_pixel(p.x, p.y, PackDijkstraPixel(distances[p.direction], p.direction));
+        active_pixels.append(DijkstraActivePixel(distances[p.direction], p.x, p.y));
+      }
     }
 
     /* Not strictly needed because at this point it already is a heap. */
@@ -218,86 +280,117 @@ class TextureMarginMap {
    * Walk over the map and for margin pixels follow the direction stored in the bottom 3
    * bits back to the face.
    * Then look up the pixel from the next face.
+   *
+   * Looking up the source location of margin pixels only reads the map, so it is done for a block
+   * of rows in parallel. Sources can be next to margin pixels written before them, so the image is
+   * then written in order.
    */
   void lookup_pixels(ImBuf *ibuf, char *mask, int maxPolygonSteps)
   {
     float4 *ibuf_ptr_fl = reinterpret_cast<float4 *>(ibuf->float_buffer.data);
     uchar4 *ibuf_ptr_ch = reinterpret_cast<uchar4 *>(ibuf->byte_buffer.data);
-    size_t pixel_index = 0;
-    for (int y = 0; y < h_; y++) {
-      for (int x = 0; x < w_; x++) {
-        uint32_t dp = pixel_data_[pixel_index];
-        if (IsDijkstraPixel(dp) && !DijkstraPixelIsUnset(dp)) {
-          int dist = DijkstraPixelGetDistance(dp);
-          int direction = DijkstraPixelGetDirection(dp);
-
-          int xx = x;
-          int yy = y;
-
-          /* Follow the dijkstra directions to find the face this margin pixels belongs to. */
-          while (dist > 0) {
-            xx -= directions[direction][0];
-            yy -= directions[direction][1];
-            dp = get_pixel(xx, yy);
-            dist -= distances[direction];
-            BLI_assert(!dist || (dist == DijkstraPixelGetDistance(dp)));
-            direction = DijkstraPixelGetDirection(dp);
-          }
-
-          uint32_t face = get_pixel(xx, yy);
-
-          BLI_assert(!IsDijkstraPixel(face));
-
-          float destX, destY;
-
-          int other_poly;
-          bool found_pixel_in_polygon = false;
-          if (lookup_pixel_polygon_neighborhood(x, y, &face, &destX, &destY, &other_poly)) {
-
-            for (int i = 0; i < maxPolygonSteps; i++) {
-              /* Force to pixel grid. */
-              int nx = int(round(destX));
-              int ny = int(round(destY));
-              uint32_t polygon_from_map = get_pixel(nx, ny);
-              if (other_poly == polygon_from_map) {
-                found_pixel_in_polygon = true;
-                break;
-              }
-
-              float dist_to_edge;
-              /* Look up again, but starting from the face we were expected to land in. */
-              if (!lookup_pixel(nx, ny, other_poly, &destX, &destY, &other_poly, &dist_to_edge)) {
-                found_pixel_in_polygon = false;
-                break;
-              }
+    const int block_rows = 64;
+    Array<std::optional<float2>> sources(int64_t(block_rows) * w_);
+
+    for (int block_y = 0; block_y < h_; block_y += block_rows) {
+      const IndexRange rows(block_y, std::min(block_rows, h_ - block_y));
+      threading::parallel_for(rows, 1, [&](const IndexRange range) {
+        for (const int y : range) {
+          for (int x = 0; x < w_; x++) {
+            const size_t pixel_index = size_t(y) * w_ + x;
+            const uint32_t dp = pixel_data_[pixel_index];
+            std::optional<float2> &source = sources[int64_t(y - block_y) * w_ + x];
+            source = std::nullopt;
+            if (IsDijkstraPixel(dp) && !DijkstraPixelIsUnset(dp)) {
+              source = lookup_margin_pixel_source(x, y, maxPolygonSteps);
             }
-
-            if (found_pixel_in_polygon) {
-              if (ibuf_ptr_fl) {
-                ibuf_ptr_fl[pixel_index] = imbuf::interpolate_bilinear_border_fl(
-                    ibuf, destX, destY);
-              }
-              if (ibuf_ptr_ch) {
-                ibuf_ptr_ch[pixel_index] = imbuf::interpolate_bilinear_border_byte(
-                    ibuf, destX, destY);
-              }
-              /* Add our new pixels to the assigned pixel map. */
+            else {
+              /* These are not margin pixels, make sure the extend filter which is run after this
+               * step leaves them alone.
+               */
               mask[pixel_index] = 1;
             }
           }
         }
-        else if (DijkstraPixelIsUnset(dp) || !IsDijkstraPixel(dp)) {
-          /* These are not margin pixels, make sure the extend filter which is run after this step
-           * leaves them alone.
-           */
+      });
+
+      for (const int y : rows) {
+        for (int x = 0; x < w_; x++) {
+          const std::optional<float2> &source = sources[int64_t(y - block_y) * w_ + x];
+          if (!source) {
+            continue;
+          }
+          const size_t pixel_index = size_t(y) * w_ + x;
+          if (ibuf_ptr_fl) {
+            ibuf_ptr_fl[pixel_index] = imbuf::interpolate_bilinear_border_fl(
+                ibuf, source->x, source->y);
+          }
+          if (ibuf_ptr_ch) {
+            ibuf_ptr_ch[pixel_index] = imbuf::interpolate_bilinear_border_byte(
+                ibuf, source->x, source->y);
+          }
+          /* Add our new pixels to the assigned pixel map. */
           mask[pixel_index] = 1;
         }
-        pixel_index++;
       }
     }
   }
 
  private:
+  /**
+   * Find the location in a neighboring face to copy the margin pixel from, if there is one.
+   */
+  std::optional<float2> lookup_margin_pixel_source(const int x,
+                                                   const int y,
+                                                   const int maxPolygonSteps) const
+  {
+    uint32_t dp = get_pixel(x, y);
+    int dist = DijkstraPixelGetDistance(dp);
+    int direction = DijkstraPixelGetDirection(dp);
+
+    int xx = x;
+    int yy = y;
+
+    /* Follow the dijkstra directions to find the face this margin pixels belongs to. */
+    while (dist > 0) {
+      xx -= directions[direction][0];
+      yy -= directions[direction][1];
+      dp = get_pixel(xx, yy);
+      dist -= distances[direction];
+      BLI_assert(!dist || (dist == DijkstraPixelGetDistance(dp)));
+      direction = DijkstraPixelGetDirection(dp);
+    }
+
+    uint32_t face = get_pixel(xx, yy);
+
+    BLI_assert(!IsDijkstraPixel(face));
+
+    float destX, destY;
+
+    int other_poly;
+    if (!lookup_pixel_polygon_neighborhood(x, y, &face, &destX, &destY, &other_poly)) {
+      return std::nullopt;
+    }
+
+    for (int i = 0; i < maxPolygonSteps; i++) {
+      /* Force to pixel grid. */
+      int nx = int(round(destX));
+      int ny = int(round(destY));
+      uint32_t polygon_from_map = get_pixel(nx, ny);
+      if (other_poly == polygon_from_map) {
+        return float2(destX, destY);
+      }
+
+      float dist_to_edge;
+      /* Look up again, but starting from the face we were expected to land in. */
+      if (!lookup_pixel(nx, ny, other_poly, &destX, &destY, &other_poly, &dist_to_edge)) {
+        return std::nullopt;
+      }
+    }
+
+    return std::nullopt;
+  }
+
   float2 uv_to_xy(const float2 &mloopuv) const
   {
     float2 ret;
@@ -335,8 +428,12 @@ class TextureMarginMap {
    * face we need can be the one next to the one the Dijkstra map provides. To prevent missing
    * pixels also check the neighboring polygons.
    */
-  bool lookup_pixel_polygon_neighborhood(
-      float x, float y, uint32_t *r_start_poly, float *r_destx, float *r_desty, int *r_other_poly)
+  bool lookup_pixel_polygon_neighborhood(float x,
+                                         float y,
+                                         uint32_t *r_start_poly,
+                                         float *r_destx,
+                                         float *r_desty,
+                                         int *r_other_poly) const
   {
     float found_dist;
     if (lookup_pixel(x, y, *r_start_poly, r_destx, r_desty, r_other_poly, &found_dist)) {
@@ -389,7 +486,7 @@ class TextureMarginMap {
                     float *r_destx,
                     float *r_desty,
                     int *r_other_poly,
-                    float *r_dist_to_edge)
+                    float *r_dist_to_edge) const
   {
     float2 point(x, y);
 
@@ -525,26 +622,28 @@ static void generate_margin(ImBuf *ibuf,
     draw_new_mask = true;
   }
 
-  for (const int i : corner_tris.index_range()) {
-    const int3 tri = corner_tris[i];
-    float vec[3][2];
+  Array<std::array<float2, 3>> tri_coords(corner_tris.size());
+  threading::parallel_for(corner_tris.index_range(), 4096, [&](const IndexRange range) {
+    for (const int i : range) {
+      const int3 tri = corner_tris[i];
 
-    for (int a = 0; a < 3; a++) {
-      const float *uv = mloopuv[tri[a]];
+      for (int a = 0; a < 3; a++) {
+        const float *uv = mloopuv[tri[a]];
 
-      /* NOTE(@ideasman42): workaround for pixel aligned UVs which are common and can screw up
-       * our intersection tests where a pixel gets in between 2 faces or the middle of a quad,
-       * camera aligned quads also have this problem but they are less common.
-       * Add a small offset to the UVs, fixes bug #18685. */
-      vec[a][0] = (uv[0] - uv_offset[0]) * float(ibuf->x) - (0.5f + 0.001f);
-      vec[a][1] = (uv[1] - uv_offset[1]) * float(ibuf->y) - (0.5f + 0.002f);
-    }
+        /* NOTE(@ideasman42): workaround for pixel aligned UVs which are common and can screw up
+         * our intersection tests where a pixel gets in between 2 faces or the middle of a quad,
+         * camera aligned quads also have this problem but they are less common.
+         * Add a small offset to the UVs, fixes bug #18685. */
+        tri_coords[i][a].x = (uv[0] - uv_offset[0]) * float(ibuf->x) - (0.5f + 0.001f);
+        tri_coords[i][a].y = (uv[1] - uv_offset[1]) * float(ibuf->y) - (0.5f + 0.002f);
+      }
 
-    /* NOTE: we need the top bit for the dijkstra distance map. */
-    BLI_assert(tri_faces[i] < 0x80000000);
+      /* NOTE: we need the top bit for the dijkstra distance map. */
+      BLI_assert(tri_faces[i] < 0x80000000);
+    }
+  });
 
-    map.rasterize_tri(vec[0], vec[1], vec[2], tri_faces[i], mask, draw_new_mask);
-  }
+  map.rasterize_tris(tri_coords, tri_faces, mask, draw_new_mask);
 
   char *tmpmask = (char *)MEM_dupallocN(mask);
   /* Extend (with averaging) by 2 pixels. Those will be overwritten, but it
@@ -20,6 +20,7 @@ struct StripElem;
 
 enum eSeqTaskId {
   SEQ_TASK_MAIN_RENDER,
+  /** Prefetch workers use consecutive IDs starting with this one. */
   SEQ_TASK_PREFETCH_RENDER,
 };
 
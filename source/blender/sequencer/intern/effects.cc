@@ -3284,6 +3284,8 @@ static void calc_text_runtime(const Sequence *seq,
   apply_text_alignment(data, r_runtime, image_size);
 }
 
+static ThreadMutex text_effect_font_mutex = BLI_MUTEX_INITIALIZER;
+
 static ImBuf *do_text_effect(const SeqRenderData *context,
                              Sequence *seq,
                              float /*timeline_frame*/,
@@ -3301,6 +3303,9 @@ static ImBuf *do_text_effect(const SeqRenderData *context,
   const int font_flags = ((data->flag & SEQ_TEXT_BOLD) ? BLF_BOLD : 0) |
                          ((data->flag & SEQ_TEXT_ITALIC) ? BLF_ITALIC : 0);
 
+  /* BLF keeps the size, flags and output buffer in the font, which is shared by the strips of all
+   * prefetch workers. */
+  BLI_mutex_lock(&text_effect_font_mutex);
   const int font = text_effect_font_init(context, seq, font_flags);
 
   TextVarsRuntime runtime;
@@ -3328,6 +3333,7 @@ static ImBuf *do_text_effect(const SeqRenderData *context,
       fill_rect_alpha_under(out, data->box_color, minx, miny, maxx, maxy);
     }
   }
+  BLI_mutex_unlock(&text_effect_font_mutex);
 
   return out;
 }
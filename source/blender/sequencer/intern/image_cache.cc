@@ -21,6 +21,7 @@
 
 #include "BLI_fileops_types.h"
 #include "BLI_ghash.h"
+#include "BLI_map.hh"
 #include "BLI_mempool.h"
 #include "BLI_threads.h"
 
@@ -67,7 +68,11 @@ struct SeqCache {
   ThreadMutex iterator_mutex;
   BLI_mempool *keys_pool;
   BLI_mempool *items_pool;
-  SeqCacheKey *last_key;
+  /**
+   * Last key put into the cache by every render task (see #SeqCacheKey.task_id). Prefetch workers
+   * render frames concurrently, so every task builds its own chain of linked keys.
+   */
+  blender::Map<int, SeqCacheKey *> last_keys;
   SeqDiskCache *disk_cache;
 };
 
@@ -208,41 +213,61 @@ static int get_stored_types_flag(Scene *scene, SeqCacheKey *key)
   return flag;
 }
 
-static void seq_cache_put_ex(Scene *scene, SeqCacheKey *key, ImBuf *ibuf)
+/** Remove the key from the chains of linked keys that render tasks are still building. */
+static void seq_cache_last_keys_remove(SeqCache *cache, const SeqCacheKey *key)
+{
+  for (SeqCacheKey *&last_key : cache->last_keys.values()) {
+    if (last_key == key) {
+      last_key = nullptr;
+    }
+  }
+}
+
+/**
+ * Insert the key unless an equal key is in the cache already, which can happen when multiple
+ * render tasks need the same image. Has to be called with the cache locked.
+ * \return True if the key was inserted and is owned by the cache now.
+ */
+static bool seq_cache_put_ex(Scene *scene, SeqCacheKey *key, ImBuf *ibuf)
 {
   SeqCache *cache = seq_cache_get_from_scene(scene);
+  if (BLI_ghash_haskey(cache->hash, key)) {
+    return false;
+  }
+
   SeqCacheItem *item;
   item = static_cast<SeqCacheItem *>(BLI_mempool_alloc(cache->items_pool));
   item->cache_owner = cache;
   item->ibuf = ibuf;
 
   const int stored_types_flag = get_stored_types_flag(scene, key);
+  SeqCacheKey *&last_key = cache->last_keys.lookup_or_add(key->task_id, nullptr);
 
   /* Item stored for later use. */
   if (stored_types_flag & key->type) {
     key->is_temp_cache = false;
-    key->link_prev = cache->last_key;
+    key->link_prev = last_key;
   }
 
-  BLI_assert(!BLI_ghash_haskey(cache->hash, key));
   BLI_ghash_insert(cache->hash, key, item);
   IMB_refImBuf(ibuf);
 
   /* Store pointer to last cached key. */
-  SeqCacheKey *temp_last_key = cache->last_key;
-  cache->last_key = key;
+  SeqCacheKey *temp_last_key = last_key;
+  last_key = key;
 
   /* Set last_key's reference to this key so we can look up chain backwards.
-   * Item is already put in cache, so cache->last_key points to current key.
+   * Item is already put in cache, so last_key points to current key.
    */
   if (!key->is_temp_cache && temp_last_key) {
-    temp_last_key->link_next = cache->last_key;
+    temp_last_key->link_next = key;
   }
 
   /* Reset linking. */
   if (key->type == SEQ_CACHE_STORE_FINAL_OUT) {
-    cache->last_key = nullptr;
+    last_key = nullptr;
   }
+  return true;
 }
 
 static ImBuf *seq_cache_get_ex(SeqCache *cache, SeqCacheKey *key)
@@ -356,7 +381,7 @@ static void seq_cache_recycle_linked(Scene *scene, SeqCacheKey *base)
 
     seq_cache_key_unlink(base);
     BLI_ghash_remove(cache->hash, base, seq_cache_keyfree, seq_cache_valfree);
-    BLI_assert(base != cache->last_key);
+    seq_cache_last_keys_remove(cache, base);
     base = prev;
   }
 
@@ -375,7 +400,7 @@ static void seq_cache_recycle_linked(Scene *scene, SeqCacheKey *base)
 
     seq_cache_key_unlink(base);
     BLI_ghash_remove(cache->hash, base, seq_cache_keyfree, seq_cache_valfree);
-    BLI_assert(base != cache->last_key);
+    seq_cache_last_keys_remove(cache, base);
     base = next;
   }
 }
@@ -490,11 +515,10 @@ static void seq_cache_create(Main *bmain, Scene *scene)
 {
   BLI_mutex_lock(&cache_create_lock);
   if (scene->ed->cache == nullptr) {
-    SeqCache *cache = static_cast<SeqCache *>(MEM_callocN(sizeof(SeqCache), "SeqCache"));
+    SeqCache *cache = MEM_new<SeqCache>("SeqCache");
     cache->keys_pool = BLI_mempool_create(sizeof(SeqCacheKey), 0, 64, BLI_MEMPOOL_NOP);
     cache->items_pool = BLI_mempool_create(sizeof(SeqCacheItem), 0, 64, BLI_MEMPOOL_NOP);
     cache->hash = BLI_ghash_new(seq_cache_hashhash, seq_cache_hashcmp, "SeqCache hash");
-    cache->last_key = nullptr;
     cache->bmain = bmain;
     BLI_mutex_init(&cache->iterator_mutex);
     scene->ed->cache = cache;
@@ -564,9 +588,7 @@ void seq_cache_free_temp_cache(Scene *scene, short id, int timeline_frame)
       {
         seq_cache_key_unlink(key);
         BLI_ghash_remove(cache->hash, key, seq_cache_keyfree, seq_cache_valfree);
-        if (key == cache->last_key) {
-          cache->last_key = nullptr;
-        }
+        seq_cache_last_keys_remove(cache, key);
       }
     }
   }
@@ -589,7 +611,7 @@ void seq_cache_destruct(Scene *scene)
     seq_disk_cache_free(cache->disk_cache);
   }
 
-  MEM_freeN(cache);
+  MEM_delete(cache);
   scene->ed->cache = nullptr;
 }
 
@@ -615,7 +637,7 @@ void SEQ_cache_cleanup(Scene *scene)
     /* NOTE: no need to call #seq_cache_key_unlink as all keys are removed. */
     BLI_ghash_remove(cache->hash, key, seq_cache_keyfree, seq_cache_valfree);
   }
-  cache->last_key = nullptr;
+  cache->last_keys.clear();
   seq_cache_unlock(scene);
 }
 
@@ -680,7 +702,7 @@ void seq_cache_cleanup_sequence(Scene *scene,
       BLI_ghash_remove(cache->hash, key, seq_cache_keyfree, seq_cache_valfree);
     }
   }
-  cache->last_key = nullptr;
+  cache->last_keys.clear();
   seq_cache_unlock(scene);
 }
 
@@ -737,8 +759,12 @@ ImBuf *seq_cache_get(const SeqRenderData *context, Sequence *seq, float timeline
 
     /* Store read image in RAM. Only recycle item for final type. */
     if (key.type != SEQ_CACHE_STORE_FINAL_OUT || seq_cache_recycle_item(scene)) {
+      seq_cache_lock(scene);
       SeqCacheKey *new_key = seq_cache_allocate_key(cache, context, seq, timeline_frame, type);
-      seq_cache_put_ex(scene, new_key, ibuf);
+      if (!seq_cache_put_ex(scene, new_key, ibuf)) {
+        BLI_mempool_free(cache->keys_pool, new_key);
+      }
+      seq_cache_unlock(scene);
     }
   }
 
@@ -765,9 +791,15 @@ bool seq_cache_put_if_possible(
     return true;
   }
 
-  if (scene->ed->cache) {
-    seq_cache_set_temp_cache_linked(scene, scene->ed->cache->last_key);
-    scene->ed->cache->last_key = nullptr;
+  if (SeqCache *cache = scene->ed->cache) {
+    /* Only the chain of this render task, other tasks may still be adding to theirs. */
+    seq_cache_lock(scene);
+    SeqCacheKey **last_key = cache->last_keys.lookup_ptr(context->task_id);
+    if (last_key) {
+      seq_cache_set_temp_cache_linked(scene, *last_key);
+      *last_key = nullptr;
+    }
+    seq_cache_unlock(scene);
   }
 
   return false;
@@ -791,21 +823,20 @@ void seq_cache_put(
     BLI_assert(seq != nullptr);
   }
 
-  /* Prevent reinserting, it breaks cache key linking. */
-  ImBuf *test = seq_cache_get(context, seq, timeline_frame, type);
-  if (test) {
-    IMB_freeImBuf(test);
-    return;
-  }
-
   if (!scene->ed->cache) {
     seq_cache_create(context->bmain, scene);
   }
 
+  /* Check for an existing key and insert under the same lock. Prefetch workers may render the
+   * same image concurrently, and reinserting breaks cache key linking. */
   seq_cache_lock(scene);
   SeqCache *cache = seq_cache_get_from_scene(scene);
   SeqCacheKey *key = seq_cache_allocate_key(cache, context, seq, timeline_frame, type);
-  seq_cache_put_ex(scene, key, i);
+  if (!seq_cache_put_ex(scene, key, i)) {
+    BLI_mempool_free(cache->keys_pool, key);
+    seq_cache_unlock(scene);
+    return;
+  }
   seq_cache_unlock(scene);
 
   if (!key->is_temp_cache) {
@@ -861,7 +892,7 @@ void SEQ_cache_iterate(
     interrupt = callback_iter(userdata, key->seq, timeline_frame, key->type);
   }
 
-  cache->last_key = nullptr;
+  cache->last_keys.clear();
   seq_cache_unlock(scene);
 }
 
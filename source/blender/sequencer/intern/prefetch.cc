@@ -6,6 +6,7 @@
  * \ingroup bke
  */
 
+#include <algorithm>
 #include <cstddef>
 #include <cstdlib>
 #include <cstring>
@@ -16,6 +17,7 @@
 #include "DNA_screen_types.h"
 #include "DNA_sequence_types.h"
 #include "DNA_space_types.h"
+#include "DNA_userdef_types.h"
 
 #include "BLI_listbase.h"
 #include "BLI_threads.h"
@@ -46,34 +48,50 @@
 #include "prefetch.hh"
 #include "render.hh"
 
+struct PrefetchJob;
+
+/**
+ * Renders frames claimed from the prefetch area in its own thread. Every worker evaluates its own
+ * copy of the scene, so workers render different frames concurrently.
+ */
+struct PrefetchWorker {
+  PrefetchJob *pfjob;
+
+  Main *bmain_eval;
+  Scene *scene_eval;
+  Depsgraph *depsgraph;
+
+  /* context */
+  SeqRenderData context;
+  SeqRenderData context_cpy;
+
+  /* Frame being rendered. */
+  float timeline_frame;
+};
+
 struct PrefetchJob {
   PrefetchJob *next, *prev;
 
   Main *bmain;
-  Main *bmain_eval;
   Scene *scene;
-  Scene *scene_eval;
-  Depsgraph *depsgraph;
 
   ThreadMutex prefetch_suspend_mutex;
   ThreadCondition prefetch_suspend_cond;
 
   ListBase threads;
-
-  /* context */
-  SeqRenderData context;
-  SeqRenderData context_cpy;
-  ListBase *seqbasep;
-  ListBase *seqbasep_cpy;
+  PrefetchWorker *workers;
+  int workers_num;
 
   /* prefetch area */
   float cfra;
+  /* Frames claimed by workers, protected by `prefetch_suspend_mutex`. */
   int num_frames_prefetched;
 
   /* Control: */
   /* Set by prefetch. */
   bool running;
-  bool waiting;
+  int running_workers_num;
+  int waiting_workers_num;
   bool stop;
   /* Set from outside. */
   bool is_scrubbing;
@@ -117,7 +135,9 @@ static bool seq_prefetch_job_is_waiting(Scene *scene)
     return false;
   }
 
-  return pfjob->waiting;
+  /* Suspended when no worker is rendering. */
+  return pfjob->waiting_workers_num > 0 &&
+         pfjob->waiting_workers_num == pfjob->running_workers_num;
 }
 
 static Sequence *sequencer_prefetch_get_original_sequence(Sequence *seq, ListBase *seqbase)
@@ -148,7 +168,14 @@ SeqRenderData *seq_prefetch_get_original_context(const SeqRenderData *context)
 {
   PrefetchJob *pfjob = seq_prefetch_job_get(context->scene);
 
-  return &pfjob->context;
+  for (PrefetchWorker &worker : blender::MutableSpan(pfjob->workers, pfjob->workers_num)) {
+    if (worker.scene_eval == context->scene) {
+      return &worker.context;
+    }
+  }
+
+  BLI_assert_unreachable();
+  return nullptr;
 }
 
 static bool seq_prefetch_is_cache_full(Scene *scene)
@@ -166,9 +193,9 @@ static float seq_prefetch_cfra(PrefetchJob *pfjob)
 {
   return pfjob->cfra + pfjob->num_frames_prefetched;
 }
-static AnimationEvalContext seq_prefetch_anim_eval_context(PrefetchJob *pfjob)
+static AnimationEvalContext seq_prefetch_anim_eval_context(PrefetchWorker *worker)
 {
-  return BKE_animsys_eval_context_construct(pfjob->depsgraph, seq_prefetch_cfra(pfjob));
+  return BKE_animsys_eval_context_construct(worker->depsgraph, worker->timeline_frame);
 }
 
 void seq_prefetch_get_time_range(Scene *scene, int *r_start, int *r_end)
@@ -179,37 +206,38 @@ void seq_prefetch_get_time_range(Scene *scene, int *r_start, int *r_end)
   *r_end = seq_prefetch_cfra(pfjob);
 }
 
-static void seq_prefetch_free_depsgraph(PrefetchJob *pfjob)
+static void seq_prefetch_free_depsgraph(PrefetchWorker *worker)
 {
-  if (pfjob->depsgraph != nullptr) {
-    DEG_graph_free(pfjob->depsgraph);
+  if (worker->depsgraph != nullptr) {
+    DEG_graph_free(worker->depsgraph);
   }
-  pfjob->depsgraph = nullptr;
-  pfjob->scene_eval = nullptr;
+  worker->depsgraph = nullptr;
+  worker->scene_eval = nullptr;
 }
 
-static void seq_prefetch_update_depsgraph(PrefetchJob *pfjob)
+static void seq_prefetch_update_depsgraph(PrefetchWorker *worker)
 {
-  DEG_evaluate_on_framechange(pfjob->depsgraph, seq_prefetch_cfra(pfjob));
+  DEG_evaluate_on_framechange(worker->depsgraph, worker->timeline_frame);
 }
 
-static void seq_prefetch_init_depsgraph(PrefetchJob *pfjob)
+static void seq_prefetch_init_depsgraph(PrefetchWorker *worker)
 {
-  Main *bmain = pfjob->bmain_eval;
-  Scene *scene = pfjob->scene;
+  Main *bmain = worker->bmain_eval;
+  Scene *scene = worker->pfjob->scene;
   ViewLayer *view_layer = BKE_view_layer_default_render(scene);
 
-  pfjob->depsgraph = DEG_graph_new(bmain, scene, view_layer, DAG_EVAL_RENDER);
-  DEG_debug_name_set(pfjob->depsgraph, "SEQUENCER PREFETCH");
+  worker->depsgraph = DEG_graph_new(bmain, scene, view_layer, DAG_EVAL_RENDER);
+  DEG_debug_name_set(worker->depsgraph, "SEQUENCER PREFETCH");
 
   /* Make sure there is a correct evaluated scene pointer. */
-  DEG_graph_build_for_render_pipeline(pfjob->depsgraph);
+  DEG_graph_build_for_render_pipeline(worker->depsgraph);
 
   /* Update immediately so we have proper evaluated scene. */
-  seq_prefetch_update_depsgraph(pfjob);
+  worker->timeline_frame = seq_prefetch_cfra(worker->pfjob);
+  seq_prefetch_update_depsgraph(worker);
 
-  pfjob->scene_eval = DEG_get_evaluated_scene(pfjob->depsgraph);
-  pfjob->scene_eval->ed->cache_flag = 0;
+  worker->scene_eval = DEG_get_evaluated_scene(worker->depsgraph);
+  worker->scene_eval->ed->cache_flag = 0;
 }
 
 static void seq_prefetch_update_area(PrefetchJob *pfjob)
@@ -256,7 +284,7 @@ void SEQ_prefetch_stop(Scene *scene)
   pfjob->stop = true;
 
   while (pfjob->running) {
-    BLI_condition_notify_one(&pfjob->prefetch_suspend_cond);
+    BLI_condition_notify_all(&pfjob->prefetch_suspend_cond);
   }
 }
 
@@ -265,32 +293,38 @@ static void seq_prefetch_update_context(const SeqRenderData *context)
   PrefetchJob *pfjob;
   pfjob = seq_prefetch_job_get(context->scene);
 
-  SEQ_render_new_render_data(pfjob->bmain_eval,
-                             pfjob->depsgraph,
-                             pfjob->scene_eval,
-                             context->rectx,
-                             context->recty,
-                             context->preview_render_size,
-                             false,
-                             &pfjob->context_cpy);
-  pfjob->context_cpy.is_prefetch_render = true;
-  pfjob->context_cpy.task_id = SEQ_TASK_PREFETCH_RENDER;
-
-  SEQ_render_new_render_data(pfjob->bmain,
-                             pfjob->depsgraph,
-                             pfjob->scene,
-                             context->rectx,
-                             context->recty,
-                             context->preview_render_size,
-                             false,
-                             &pfjob->context);
-  pfjob->context.is_prefetch_render = false;
-
-  /* Same ID as prefetch context, because context will be swapped, but we still
-   * want to assign this ID to cache entries created in this thread.
-   * This is to allow "temp cache" work correctly for both threads.
-   */
-  pfjob->context.task_id = SEQ_TASK_PREFETCH_RENDER;
+  for (const int i : blender::IndexRange(pfjob->workers_num)) {
+    PrefetchWorker &worker = pfjob->workers[i];
+    /* Every worker frees temp cache entries of other frames, so their IDs must differ. */
+    const eSeqTaskId task_id = eSeqTaskId(SEQ_TASK_PREFETCH_RENDER + i);
+
+    SEQ_render_new_render_data(worker.bmain_eval,
+                               worker.depsgraph,
+                               worker.scene_eval,
+                               context->rectx,
+                               context->recty,
+                               context->preview_render_size,
+                               false,
+                               &worker.context_cpy);
+    worker.context_cpy.is_prefetch_render = true;
+    worker.context_cpy.task_id = task_id;
+
+    SEQ_render_new_render_data(pfjob->bmain,
+                               worker.depsgraph,
+                               pfjob->scene,
+                               context->rectx,
+                               context->recty,
+                               context->preview_render_size,
+                               false,
+                               &worker.context);
+    worker.context.is_prefetch_render = false;
+
+    /* Same ID as prefetch context, because context will be swapped, but we still
+     * want to assign this ID to cache entries created in this thread.
+     * This is to allow "temp cache" work correctly for both threads.
+     */
+    worker.context.task_id = task_id;
+  }
 }
 
 static void seq_prefetch_update_scene(Scene *scene)
@@ -302,21 +336,27 @@ static void seq_prefetch_update_scene(Scene *scene)
   }
 
   pfjob->scene = scene;
-  seq_prefetch_free_depsgraph(pfjob);
-  seq_prefetch_init_depsgraph(pfjob);
+  for (PrefetchWorker &worker : blender::MutableSpan(pfjob->workers, pfjob->workers_num)) {
+    seq_prefetch_free_depsgraph(&worker);
+    seq_prefetch_init_depsgraph(&worker);
+  }
 }
 
 static void seq_prefetch_update_active_seqbase(PrefetchJob *pfjob)
 {
   MetaStack *ms_orig = SEQ_meta_stack_active_get(SEQ_editing_get(pfjob->scene));
-  Editing *ed_eval = SEQ_editing_get(pfjob->scene_eval);
 
-  if (ms_orig != nullptr) {
-    Sequence *meta_eval = seq_prefetch_get_original_sequence(ms_orig->parseq, pfjob->scene_eval);
-    SEQ_seqbase_active_set(ed_eval, &meta_eval->seqbase);
-  }
-  else {
-    SEQ_seqbase_active_set(ed_eval, &ed_eval->seqbase);
+  for (PrefetchWorker &worker : blender::MutableSpan(pfjob->workers, pfjob->workers_num)) {
+    Editing *ed_eval = SEQ_editing_get(worker.scene_eval);
+
+    if (ms_orig != nullptr) {
+      Sequence *meta_eval = seq_prefetch_get_original_sequence(ms_orig->parseq,
+                                                               worker.scene_eval);
+      SEQ_seqbase_active_set(ed_eval, &meta_eval->seqbase);
+    }
+    else {
+      SEQ_seqbase_active_set(ed_eval, &ed_eval->seqbase);
+    }
   }
 }
 
@@ -324,9 +364,40 @@ static void seq_prefetch_resume(Scene *scene)
 {
   PrefetchJob *pfjob = seq_prefetch_job_get(scene);
 
-  if (pfjob && pfjob->waiting) {
-    BLI_condition_notify_one(&pfjob->prefetch_suspend_cond);
+  if (pfjob && pfjob->waiting_workers_num > 0) {
+    BLI_condition_notify_all(&pfjob->prefetch_suspend_cond);
+  }
+}
+
+static void *seq_prefetch_frames(void *worker_v);
+
+static void seq_prefetch_workers_init(PrefetchJob *pfjob, const int workers_num)
+{
+  pfjob->workers_num = workers_num;
+  pfjob->workers = static_cast<PrefetchWorker *>(
+      MEM_calloc_arrayN(workers_num, sizeof(PrefetchWorker), "PrefetchWorker"));
+  for (PrefetchWorker &worker : blender::MutableSpan(pfjob->workers, pfjob->workers_num)) {
+    worker.pfjob = pfjob;
+    worker.bmain_eval = BKE_main_new();
+  }
+
+  BLI_threadpool_init(&pfjob->threads, seq_prefetch_frames, workers_num);
+}
+
+static void seq_prefetch_workers_free(PrefetchJob *pfjob)
+{
+  for (PrefetchWorker &worker : blender::MutableSpan(pfjob->workers, pfjob->workers_num)) {
+    BLI_threadpool_remove(&pfjob->threads, &worker);
+  }
+  BLI_threadpool_end(&pfjob->threads);
+
+  for (PrefetchWorker &worker : blender::MutableSpan(pfjob->workers, pfjob->workers_num)) {
+    seq_prefetch_free_depsgraph(&worker);
+    BKE_main_free(worker.bmain_eval);
   }
+  MEM_freeN(pfjob->workers);
+  pfjob->workers = nullptr;
+  pfjob->workers_num = 0;
 }
 
 void seq_prefetch_free(Scene *scene)
@@ -338,22 +409,19 @@ void seq_prefetch_free(Scene *scene)
 
   SEQ_prefetch_stop(scene);
 
-  BLI_threadpool_remove(&pfjob->threads, pfjob);
-  BLI_threadpool_end(&pfjob->threads);
+  seq_prefetch_workers_free(pfjob);
   BLI_mutex_end(&pfjob->prefetch_suspend_mutex);
   BLI_condition_end(&pfjob->prefetch_suspend_cond);
-  seq_prefetch_free_depsgraph(pfjob);
-  BKE_main_free(pfjob->bmain_eval);
   MEM_freeN(pfjob);
   scene->ed->prefetch_job = nullptr;
 }
 
-static bool seq_prefetch_seq_has_disk_cache(PrefetchJob *pfjob,
+static bool seq_prefetch_seq_has_disk_cache(PrefetchWorker *worker,
                                             Sequence *seq,
                                             bool can_have_final_image)
 {
-  SeqRenderData *ctx = &pfjob->context_cpy;
-  float cfra = seq_prefetch_cfra(pfjob);
+  SeqRenderData *ctx = &worker->context_cpy;
+  float cfra = worker->timeline_frame;
 
   ImBuf *ibuf = seq_cache_get(ctx, seq, cfra, SEQ_CACHE_STORE_PREPROCESSED);
   if (ibuf != nullptr) {
@@ -380,28 +448,28 @@ static bool seq_prefetch_seq_has_disk_cache(PrefetchJob *pfjob,
   return false;
 }
 
-static bool seq_prefetch_scene_strip_is_rendered(PrefetchJob *pfjob,
+static bool seq_prefetch_scene_strip_is_rendered(PrefetchWorker *worker,
                                                  ListBase *channels,
                                                  ListBase *seqbase,
                                                  blender::Span<Sequence *> scene_strips,
                                                  bool is_recursive_check)
 {
-  float cfra = seq_prefetch_cfra(pfjob);
+  float cfra = worker->timeline_frame;
   blender::Vector<Sequence *> strips = seq_get_shown_sequences(
-      pfjob->scene_eval, channels, seqbase, cfra, 0);
+      worker->scene_eval, channels, seqbase, cfra, 0);
 
   /* Iterate over rendered strips. */
   for (Sequence *seq : strips) {
     if (seq->type == SEQ_TYPE_META &&
         seq_prefetch_scene_strip_is_rendered(
-            pfjob, &seq->channels, &seq->seqbase, scene_strips, true))
+            worker, &seq->channels, &seq->seqbase, scene_strips, true))
     {
       return true;
     }
 
     /* Disable prefetching 3D scene strips, but check for disk cache. */
     if (seq->type == SEQ_TYPE_SCENE && (seq->flag & SEQ_SCENE_STRIPS) == 0 &&
-        !seq_prefetch_seq_has_disk_cache(pfjob, seq, !is_recursive_check))
+        !seq_prefetch_seq_has_disk_cache(worker, seq, !is_recursive_check))
     {
       return true;
     }
@@ -429,10 +497,12 @@ static blender::VectorSet<Sequence *> query_scene_strips(ListBase *seqbase)
 
 /* Prefetch must avoid rendering scene strips, because rendering in background locks UI and can
  * make it unresponsive for long time periods. */
-static bool seq_prefetch_must_skip_frame(PrefetchJob *pfjob, ListBase *channels, ListBase *seqbase)
+static bool seq_prefetch_must_skip_frame(PrefetchWorker *worker,
+                                         ListBase *channels,
+                                         ListBase *seqbase)
 {
   blender::VectorSet<Sequence *> scene_strips = query_scene_strips(seqbase);
-  if (seq_prefetch_scene_strip_is_rendered(pfjob, channels, seqbase, scene_strips, false)) {
+  if (seq_prefetch_scene_strip_is_rendered(worker, channels, seqbase, scene_strips, false)) {
     return true;
   }
   return false;
@@ -441,35 +511,60 @@ static bool seq_prefetch_must_skip_frame(PrefetchJob *pfjob, ListBase *channels,
 static bool seq_prefetch_need_suspend(PrefetchJob *pfjob)
 {
   return seq_prefetch_is_cache_full(pfjob->scene) || pfjob->is_scrubbing ||
-         (seq_prefetch_cfra(pfjob) >= pfjob->scene->r.efra);
+         (seq_prefetch_cfra(pfjob) > pfjob->scene->r.efra);
 }
 
-static void seq_prefetch_do_suspend(PrefetchJob *pfjob)
+static bool seq_prefetch_is_stopped(PrefetchJob *pfjob)
 {
+  return !(pfjob->scene->ed->cache_flag & SEQ_CACHE_PREFETCH_ENABLE) || pfjob->stop;
+}
+
+/**
+ * Claim the next frame of the prefetch area for the worker. Suspend the worker while there is
+ * nothing to be prefetched. Returns false when the worker should stop.
+ */
+static bool seq_prefetch_claim_frame(PrefetchWorker *worker)
+{
+  PrefetchJob *pfjob = worker->pfjob;
+
   BLI_mutex_lock(&pfjob->prefetch_suspend_mutex);
-  while (seq_prefetch_need_suspend(pfjob) &&
-         (pfjob->scene->ed->cache_flag & SEQ_CACHE_PREFETCH_ENABLE) && !pfjob->stop)
-  {
-    pfjob->waiting = true;
+  seq_prefetch_update_area(pfjob);
+  while (seq_prefetch_need_suspend(pfjob) && !seq_prefetch_is_stopped(pfjob)) {
+    pfjob->waiting_workers_num++;
     BLI_condition_wait(&pfjob->prefetch_suspend_cond, &pfjob->prefetch_suspend_mutex);
+    pfjob->waiting_workers_num--;
     seq_prefetch_update_area(pfjob);
   }
-  pfjob->waiting = false;
+
+  bool is_claimed = !seq_prefetch_is_stopped(pfjob);
+
+  /* Avoid "collision" with main thread, but make sure to fetch at least few frames */
+  if (pfjob->num_frames_prefetched > 5 && (seq_prefetch_cfra(pfjob) - pfjob->scene->r.cfra) < 2) {
+    is_claimed = false;
+  }
+
+  if (is_claimed) {
+    worker->timeline_frame = seq_prefetch_cfra(pfjob);
+    pfjob->num_frames_prefetched++;
+  }
   BLI_mutex_unlock(&pfjob->prefetch_suspend_mutex);
+
+  return is_claimed;
 }
 
-static void *seq_prefetch_frames(void *job)
+static void *seq_prefetch_frames(void *worker_v)
 {
-  PrefetchJob *pfjob = (PrefetchJob *)job;
+  PrefetchWorker *worker = static_cast<PrefetchWorker *>(worker_v);
+  PrefetchJob *pfjob = worker->pfjob;
 
-  while (seq_prefetch_cfra(pfjob) <= pfjob->scene->r.efra) {
-    pfjob->scene_eval->ed->prefetch_job = nullptr;
+  while (seq_prefetch_claim_frame(worker)) {
+    worker->scene_eval->ed->prefetch_job = nullptr;
 
-    seq_prefetch_update_depsgraph(pfjob);
-    AnimData *adt = BKE_animdata_from_id(&pfjob->context_cpy.scene->id);
-    AnimationEvalContext anim_eval_context = seq_prefetch_anim_eval_context(pfjob);
+    seq_prefetch_update_depsgraph(worker);
+    AnimData *adt = BKE_animdata_from_id(&worker->context_cpy.scene->id);
+    AnimationEvalContext anim_eval_context = seq_prefetch_anim_eval_context(worker);
     BKE_animsys_evaluate_animdata(
-        &pfjob->context_cpy.scene->id, adt, &anim_eval_context, ADT_RECALC_ALL, false);
+        &worker->context_cpy.scene->id, adt, &anim_eval_context, ADT_RECALC_ALL, false);
 
     /* This is quite hacky solution:
      * We need cross-reference original scene with copy for cache.
@@ -477,43 +572,28 @@ static void *seq_prefetch_frames(void *job)
      * Scene copy don't reference original scene. Perhaps, this could be done by depsgraph.
      * Set to nullptr before return!
      */
-    pfjob->scene_eval->ed->prefetch_job = pfjob;
-
-    ListBase *seqbase = SEQ_active_seqbase_get(SEQ_editing_get(pfjob->scene_eval));
-    ListBase *channels = SEQ_channels_displayed_get(SEQ_editing_get(pfjob->scene_eval));
-    if (seq_prefetch_must_skip_frame(pfjob, channels, seqbase)) {
-      pfjob->num_frames_prefetched++;
-      /* Break instead of keep looping if the job should be terminated. */
-      if (!(pfjob->scene->ed->cache_flag & SEQ_CACHE_PREFETCH_ENABLE) || pfjob->stop) {
-        break;
-      }
+    worker->scene_eval->ed->prefetch_job = pfjob;
+
+    ListBase *seqbase = SEQ_active_seqbase_get(SEQ_editing_get(worker->scene_eval));
+    ListBase *channels = SEQ_channels_displayed_get(SEQ_editing_get(worker->scene_eval));
+    if (seq_prefetch_must_skip_frame(worker, channels, seqbase)) {
       continue;
     }
 
-    ImBuf *ibuf = SEQ_render_give_ibuf(&pfjob->context_cpy, seq_prefetch_cfra(pfjob), 0);
-    seq_cache_free_temp_cache(pfjob->scene, pfjob->context.task_id, seq_prefetch_cfra(pfjob));
+    ImBuf *ibuf = SEQ_render_give_ibuf(&worker->context_cpy, worker->timeline_frame, 0);
+    seq_cache_free_temp_cache(pfjob->scene, worker->context.task_id, worker->timeline_frame);
     IMB_freeImBuf(ibuf);
+  }
 
-    /* Suspend thread if there is nothing to be prefetched. */
-    seq_prefetch_do_suspend(pfjob);
-
-    /* Avoid "collision" with main thread, but make sure to fetch at least few frames */
-    if (pfjob->num_frames_prefetched > 5 && (seq_prefetch_cfra(pfjob) - pfjob->scene->r.cfra) < 2)
-    {
-      break;
-    }
-
-    if (!(pfjob->scene->ed->cache_flag & SEQ_CACHE_PREFETCH_ENABLE) || pfjob->stop) {
-      break;
-    }
+  seq_cache_free_temp_cache(pfjob->scene, worker->context.task_id, worker->timeline_frame);
+  worker->scene_eval->ed->prefetch_job = nullptr;
 
-    seq_prefetch_update_area(pfjob);
-    pfjob->num_frames_prefetched++;
+  BLI_mutex_lock(&pfjob->prefetch_suspend_mutex);
+  pfjob->running_workers_num--;
+  if (pfjob->running_workers_num == 0) {
+    pfjob->running = false;
   }
-
-  seq_cache_free_temp_cache(pfjob->scene, pfjob->context.task_id, seq_prefetch_cfra(pfjob));
-  pfjob->running = false;
-  pfjob->scene_eval->ed->prefetch_job = nullptr;
+  BLI_mutex_unlock(&pfjob->prefetch_suspend_mutex);
 
   return nullptr;
 }
@@ -527,21 +607,28 @@ static PrefetchJob *seq_prefetch_start_ex(const SeqRenderData *context, float cf
       pfjob = (PrefetchJob *)MEM_callocN(sizeof(PrefetchJob), "PrefetchJob");
       context->scene->ed->prefetch_job = pfjob;
 
-      BLI_threadpool_init(&pfjob->threads, seq_prefetch_frames, 1);
       BLI_mutex_init(&pfjob->prefetch_suspend_mutex);
       BLI_condition_init(&pfjob->prefetch_suspend_cond);
 
-      pfjob->bmain_eval = BKE_main_new();
       pfjob->scene = context->scene;
-      seq_prefetch_init_depsgraph(pfjob);
     }
   }
   pfjob->bmain = context->bmain;
 
+  /* Workers are only changed here, when none of them is running. */
+  const int workers_num = std::max(int(U.sequencer_prefetch_workers), 1);
+  if (pfjob->workers_num != workers_num) {
+    if (pfjob->workers != nullptr) {
+      seq_prefetch_workers_free(pfjob);
+    }
+    seq_prefetch_workers_init(pfjob, workers_num);
+  }
+
   pfjob->cfra = cfra;
   pfjob->num_frames_prefetched = 1;
 
-  pfjob->waiting = false;
+  pfjob->waiting_workers_num = 0;
+  pfjob->running_workers_num = pfjob->workers_num;
   pfjob->stop = false;
   pfjob->running = true;
 
@@ -549,8 +636,10 @@ static PrefetchJob *seq_prefetch_start_ex(const SeqRenderData *context, float cf
   seq_prefetch_update_context(context);
   seq_prefetch_update_active_seqbase(pfjob);
 
-  BLI_threadpool_remove(&pfjob->threads, pfjob);
-  BLI_threadpool_insert(&pfjob->threads, pfjob);
+  for (PrefetchWorker &worker : blender::MutableSpan(pfjob->workers, pfjob->workers_num)) {
+    BLI_threadpool_remove(&pfjob->threads, &worker);
+    BLI_threadpool_insert(&pfjob->threads, &worker);
+  }
 
   return pfjob;
 }
@@ -8,6 +8,9 @@
  * \ingroup bke
  */
 
+#include <algorithm>
+#include <atomic>
+
 #include "MEM_guardedalloc.h"
 
 #include "DNA_scene_types.h"
@@ -18,6 +21,7 @@
 #include "BLI_listbase.h"
 #include "BLI_path_utils.hh"
 #include "BLI_string.h"
+#include "BLI_task.hh"
 
 #ifdef WIN32
 #  include "BLI_winstuff.h"
@@ -251,67 +255,84 @@ ImBuf *seq_proxy_fetch(const SeqRenderData *context, Sequence *seq, int timeline
   return nullptr;
 }
 
+static const int proxy_render_sizes[] = {25, 50, 75, 100};
+static const int proxy_size_flags[] = {IMB_PROXY_25, IMB_PROXY_50, IMB_PROXY_75, IMB_PROXY_100};
+
+/**
+ * Build proxies of all requested sizes for one frame. The strip is rendered once and scaled down
+ * for every size.
+ */
 static void seq_proxy_build_frame(const SeqRenderData *context,
                                   SeqRenderState *state,
                                   Sequence *seq,
                                   int timeline_frame,
-                                  int proxy_render_size,
+                                  int size_flags,
                                   const bool overwrite)
 {
-  char filepath[PROXY_MAXFILE];
-  int quality;
-  int rectx, recty;
-  ImBuf *ibuf_tmp, *ibuf;
   Scene *scene = context->scene;
+  ImBuf *ibuf_render = nullptr;
 
-  if (!seq_proxy_get_filepath(scene,
-                              seq,
-                              timeline_frame,
-                              eSpaceSeq_Proxy_RenderSize(proxy_render_size),
-                              filepath,
-                              context->view_id))
-  {
-    return;
-  }
+  for (const int i : blender::IndexRange(ARRAY_SIZE(proxy_render_sizes))) {
+    const int proxy_render_size = proxy_render_sizes[i];
+    if ((size_flags & proxy_size_flags[i]) == 0) {
+      continue;
+    }
 
-  if (!overwrite && BLI_exists(filepath)) {
-    return;
-  }
+    char filepath[PROXY_MAXFILE];
+    if (!seq_proxy_get_filepath(scene,
+                                seq,
+                                timeline_frame,
+                                eSpaceSeq_Proxy_RenderSize(proxy_render_size),
+                                filepath,
+                                context->view_id))
+    {
+      continue;
+    }
 
-  ibuf_tmp = seq_render_strip(context, state, seq, timeline_frame);
+    if (!overwrite && BLI_exists(filepath)) {
+      continue;
+    }
 
-  rectx = (proxy_render_size * ibuf_tmp->x) / 100;
-  recty = (proxy_render_size * ibuf_tmp->y) / 100;
+    if (ibuf_render == nullptr) {
+      ibuf_render = seq_render_strip(context, state, seq, timeline_frame);
+    }
 
-  if (ibuf_tmp->x != rectx || ibuf_tmp->y != recty) {
-    ibuf = IMB_dupImBuf(ibuf_tmp);
-    IMB_metadata_copy(ibuf, ibuf_tmp);
-    IMB_freeImBuf(ibuf_tmp);
-    IMB_scale(ibuf, rectx, recty, IMBScaleFilter::Nearest, false);
-  }
-  else {
-    ibuf = ibuf_tmp;
-  }
+    const int rectx = (proxy_render_size * ibuf_render->x) / 100;
+    const int recty = (proxy_render_size * ibuf_render->y) / 100;
 
-  /* depth = 32 is intentionally left in, otherwise ALPHA channels
-   * won't work... */
-  quality = seq->strip->proxy->quality;
-  ibuf->ftype = IMB_FTYPE_JPG;
-  ibuf->foptions.quality = quality;
+    ImBuf *ibuf;
+    if (ibuf_render->x != rectx || ibuf_render->y != recty) {
+      ibuf = IMB_dupImBuf(ibuf_render);
+      IMB_metadata_copy(ibuf, ibuf_render);
+      IMB_scale(ibuf, rectx, recty, IMBScaleFilter::Nearest, false);
+    }
+    else {
+      /* Full size is the last one, so the rendered image can be changed for saving. */
+      ibuf = ibuf_render;
+      IMB_refImBuf(ibuf);
+    }
 
-  /* unsupported feature only confuses other s/w */
-  if (ibuf->planes == 32) {
-    ibuf->planes = 24;
-  }
+    /* depth = 32 is intentionally left in, otherwise ALPHA channels
+     * won't work... */
+    ibuf->ftype = IMB_FTYPE_JPG;
+    ibuf->foptions.quality = seq->strip->proxy->quality;
+
+    /* unsupported feature only confuses other s/w */
+    if (ibuf->planes == 32) {
+      ibuf->planes = 24;
+    }
+
+    BLI_file_ensure_parent_dir_exists(filepath);
 
-  BLI_file_ensure_parent_dir_exists(filepath);
+    const bool ok = IMB_saveiff(ibuf, filepath, IB_rect);
+    if (ok == false) {
+      perror(filepath);
+    }
 
-  const bool ok = IMB_saveiff(ibuf, filepath, IB_rect);
-  if (ok == false) {
-    perror(filepath);
+    IMB_freeImBuf(ibuf);
   }
 
-  IMB_freeImBuf(ibuf);
+  IMB_freeImBuf(ibuf_render);
 }
 
 /**
@@ -510,7 +531,6 @@ void SEQ_proxy_rebuild(SeqIndexBuildContext *context, wmJobWorkerStatus *worker_
   Sequence *seq = context->seq;
   Scene *scene = context->scene;
   Main *bmain = context->bmain;
-  int timeline_frame;
 
   if (seq->type == SEQ_TYPE_MOVIE) {
     if (context->index_context) {
@@ -543,34 +563,28 @@ void SEQ_proxy_rebuild(SeqIndexBuildContext *context, wmJobWorkerStatus *worker_
   render_context.is_proxy_render = true;
   render_context.view_id = context->view_id;
 
-  SeqRenderState state;
-
-  for (timeline_frame = SEQ_time_left_handle_frame_get(scene, seq);
-       timeline_frame < SEQ_time_right_handle_frame_get(scene, seq);
-       timeline_frame++)
-  {
-    if (context->size_flags & IMB_PROXY_25) {
-      seq_proxy_build_frame(&render_context, &state, seq, timeline_frame, 25, overwrite);
-    }
-    if (context->size_flags & IMB_PROXY_50) {
-      seq_proxy_build_frame(&render_context, &state, seq, timeline_frame, 50, overwrite);
-    }
-    if (context->size_flags & IMB_PROXY_75) {
-      seq_proxy_build_frame(&render_context, &state, seq, timeline_frame, 75, overwrite);
-    }
-    if (context->size_flags & IMB_PROXY_100) {
-      seq_proxy_build_frame(&render_context, &state, seq, timeline_frame, 100, overwrite);
-    }
-
-    worker_status->progress = float(timeline_frame - SEQ_time_left_handle_frame_get(scene, seq)) /
-                              (SEQ_time_right_handle_frame_get(scene, seq) -
-                               SEQ_time_left_handle_frame_get(scene, seq));
-    worker_status->do_update = true;
-
-    if (worker_status->stop || G.is_break) {
-      break;
-    }
-  }
+  /* Frames are independent, so they are rendered and written in parallel. Every thread uses its
+   * own render state. */
+  const int frame_start = SEQ_time_left_handle_frame_get(scene, seq);
+  const int frames_num = SEQ_time_right_handle_frame_get(scene, seq) - frame_start;
+  std::atomic<int> frames_done = 0;
+  blender::threading::parallel_for(
+      blender::IndexRange(frame_start, std::max(frames_num, 0)),
+      1,
+      [&](const blender::IndexRange range) {
+        SeqRenderState state;
+        for (const int timeline_frame : range) {
+          if (worker_status->stop || G.is_break) {
+            break;
+          }
+
+          seq_proxy_build_frame(
+              &render_context, &state, seq, timeline_frame, context->size_flags, overwrite);
+
+          worker_status->progress = float(frames_done.fetch_add(1) + 1) / frames_num;
+          worker_status->do_update = true;
+        }
+      });
 }
 
 void SEQ_proxy_rebuild_finish(SeqIndexBuildContext *context, bool stop)
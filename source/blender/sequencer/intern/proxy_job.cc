@@ -8,10 +8,21 @@
  * \ingroup bke
  */
 
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+
 #include "MEM_guardedalloc.h"
 
 #include "DNA_scene_types.h"
 #include "DNA_sequence_types.h"
+#include "DNA_userdef_types.h"
+
+#include "BLI_listbase.h"
+#include "BLI_task.h"
+#include "BLI_vector.hh"
 
 #include "BKE_context.hh"
 
@@ -31,21 +42,128 @@ static void proxy_freejob(void *pjv)
   MEM_freeN(pj);
 }
 
+/**
+ * Contexts of the job queue are built by several workers, each of them takes the next context
+ * when it is done with the previous one. Contexts can be added to the queue while building.
+ */
+struct ProxyBuildQueue {
+  std::mutex mutex;
+  ListBase *contexts;
+  /* The next context is read from this link when claiming, so that contexts added after it was
+   * claimed are still built. */
+  LinkData *last_claimed_link = nullptr;
+  /* Status of the job, its cancellation applies to all workers. */
+  const wmJobWorkerStatus *job_status;
+  /* Status of every started context, so the progress of all of them can be combined. */
+  blender::Vector<std::unique_ptr<wmJobWorkerStatus>> statuses;
+  int finished_workers_num = 0;
+  /* Notified when a worker finishes. */
+  std::condition_variable worker_finished_cond;
+};
+
+/** Has to be called with the queue mutex locked. */
+static LinkData *proxy_queue_claim_next_link(ProxyBuildQueue *queue)
+{
+  if (queue->job_status->stop) {
+    return nullptr;
+  }
+  LinkData *link = queue->last_claimed_link ?
+                       queue->last_claimed_link->next :
+                       static_cast<LinkData *>(queue->contexts->first);
+  if (link != nullptr) {
+    queue->last_claimed_link = link;
+  }
+  return link;
+}
+
+static SeqIndexBuildContext *proxy_queue_next_context(ProxyBuildQueue *queue,
+                                                      wmJobWorkerStatus **r_status)
+{
+  std::scoped_lock lock(queue->mutex);
+  LinkData *link = proxy_queue_claim_next_link(queue);
+  if (link == nullptr) {
+    return nullptr;
+  }
+
+  queue->statuses.append(std::make_unique<wmJobWorkerStatus>());
+  *r_status = queue->statuses.last().get();
+  return static_cast<SeqIndexBuildContext *>(link->data);
+}
+
+static void proxy_task_func(TaskPool *__restrict pool, void * /*task_data*/)
+{
+  ProxyBuildQueue *queue = static_cast<ProxyBuildQueue *>(BLI_task_pool_user_data(pool));
+  wmJobWorkerStatus *status = nullptr;
+
+  while (SeqIndexBuildContext *context = proxy_queue_next_context(queue, &status)) {
+    SEQ_proxy_rebuild(context, status);
+    status->progress = 1.0f;
+  }
+
+  {
+    std::scoped_lock lock(queue->mutex);
+    queue->finished_workers_num++;
+  }
+  queue->worker_finished_cond.notify_one();
+}
+
 /* Only this runs inside thread. */
 static void proxy_startjob(void *pjv, wmJobWorkerStatus *worker_status)
 {
   ProxyJob *pj = static_cast<ProxyJob *>(pjv);
+  const int workers_num = std::max(int(U.sequencer_proxy_workers), 1);
+
+  ProxyBuildQueue queue;
+  queue.contexts = &pj->queue;
+  queue.job_status = worker_status;
+
+  /* Without threads the tasks would run right away when pushed, before cancellation could be
+   * forwarded to them. */
+  if (workers_num > 1 && BLI_task_scheduler_num_threads() > 1) {
+    TaskPool *task_pool = BLI_task_pool_create(&queue, TASK_PRIORITY_LOW);
+    for (int i = 0; i < workers_num; i++) {
+      BLI_task_pool_push(task_pool, proxy_task_func, nullptr, false, nullptr);
+    }
 
-  LISTBASE_FOREACH (LinkData *, link, &pj->queue) {
-    SeqIndexBuildContext *context = static_cast<SeqIndexBuildContext *>(link->data);
+    /* Wait for the workers to finish. Cancellation and progress are not signaled, so wake up
+     * regularly to forward cancellation to the workers and to report the combined progress. */
+    {
+      std::unique_lock lock(queue.mutex);
+      while (!queue.worker_finished_cond.wait_for(lock, std::chrono::milliseconds(100), [&]() {
+        return queue.finished_workers_num == workers_num;
+      }))
+      {
+        float progress = 0.0f;
+        for (const std::unique_ptr<wmJobWorkerStatus> &status : queue.statuses) {
+          status->stop = worker_status->stop;
+          progress += status->progress;
+        }
+        worker_status->progress = progress / std::max(BLI_listbase_count(&pj->queue), 1);
+        worker_status->do_update = true;
+      }
+    }
 
-    SEQ_proxy_rebuild(context, worker_status);
+    BLI_task_pool_work_and_wait(task_pool);
+    BLI_task_pool_free(task_pool);
+  }
 
-    if (worker_status->stop) {
-      pj->stop = true;
-      fprintf(stderr, "Canceling proxy rebuild on users request...\n");
+  /* Build the remaining contexts on this thread: all of them with a single worker, otherwise the
+   * ones added after the workers finished. */
+  while (true) {
+    LinkData *link;
+    {
+      std::scoped_lock lock(queue.mutex);
+      link = proxy_queue_claim_next_link(&queue);
+    }
+    if (link == nullptr) {
       break;
     }
+    SEQ_proxy_rebuild(static_cast<SeqIndexBuildContext *>(link->data), worker_status);
+  }
+
+  if (worker_status->stop) {
+    pj->stop = true;
+    fprintf(stderr, "Canceling proxy rebuild on users request...\n");
   }
 }
 
@@ -96,6 +96,8 @@
 #include "IMB_metadata.hh"
 #include "IMB_thumbs.hh"
 
+#include "COM_compositor.hh"
+
 #include "ED_asset.hh"
 #include "ED_datafiles.h"
 #include "ED_fileselect.hh"
@@ -683,6 +685,10 @@ static void wm_file_read_pre(bool use_data, bool /*use_userdef*/)
 {
   if (use_data) {
     BLI_timer_on_file_load();
+#ifdef WITH_COMPOSITOR_CPU
+    /* Cached compositor outputs belong to the previous file. */
+    COM_clear_caches();
+#endif
   }
 
   /* Always do this as both startup and preferences may have loaded in many font's
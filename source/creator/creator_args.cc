@@ -748,6 +748,7 @@ static void print_help(bArgs *ba, bool all)
   BLI_args_print_arg_doc(ba, "--debug-depsgraph-time");
   BLI_args_print_arg_doc(ba, "--debug-depsgraph-pretty");
   BLI_args_print_arg_doc(ba, "--debug-depsgraph-uid");
+  BLI_args_print_arg_doc(ba, "--debug-geometry-nodes-trace");
   BLI_args_print_arg_doc(ba, "--debug-ghost");
   BLI_args_print_arg_doc(ba, "--debug-wintab");
   BLI_args_print_arg_doc(ba, "--debug-gpu");
@@ -1434,6 +1435,23 @@ static int arg_handle_debug_gpu_scope_capture_set(int argc, const char **argv, v
   return 0;
 }
 
+static const char arg_handle_debug_geometry_nodes_trace_set_doc[] =
+    "<filepath>\n"
+    "\tOnly record how long geometry nodes take to execute and write it to a file on exit,\n"
+    "\tin the Chrome trace format. Disables the logging used by the node editor.";
+static int arg_handle_debug_geometry_nodes_trace_set(int argc,
+                                                     const char **argv,
+                                                     void * /*data*/)
+{
+  const char *arg_id = "--debug-geometry-nodes-trace";
+  if (argc > 1) {
+    STRNCPY(G.geometry_nodes_trace_filepath, argv[1]);
+    return 1;
+  }
+  fprintf(stderr, "\nError: '%s' no args given.\n", arg_id);
+  return 0;
+}
+
 static const char arg_handle_debug_gpu_renderdoc_set_doc[] =
     "\n"
     "\tEnable Renderdoc integration for GPU frame grabbing and debugging.";
@@ -2803,6 +2821,11 @@ void main_args_setup(bContext *C, bArgs *ba, bool all)
                "--debug-depsgraph-uid",
                CB_EX(arg_handle_debug_mode_generic_set, depsgraph_uid),
                (void *)G_DEBUG_DEPSGRAPH_UID);
+  BLI_args_add(ba,
+               nullptr,
+               "--debug-geometry-nodes-trace",
+               CB(arg_handle_debug_geometry_nodes_trace_set),
+               nullptr);
   BLI_args_add(ba,
                nullptr,
                "--debug-gpu-force-workarounds",
@@ -0,0 +1,46 @@
+# SPDX-FileCopyrightText: 2024 Blender Authors
+#
+# SPDX-License-Identifier: Apache-2.0
+
+import api
+
+
+def _run(args):
+    import bpy
+    import time
+
+    scene = bpy.context.scene
+    scene.render.use_bake_multires = True
+    scene.render.bake_type = args['bake_type']
+
+    # Bake the selected objects with multires modifiers into the images of their materials.
+    start_time = time.time()
+    bpy.ops.object.bake_image()
+    elapsed_time = time.time() - start_time
+
+    result = {'time': elapsed_time}
+    return result
+
+
+class MultiresBakeTest(api.Test):
+    def __init__(self, filepath, bake_type):
+        self.filepath = filepath
+        self.bake_type = bake_type
+
+    def name(self):
+        return f"{self.filepath.stem}_{self.bake_type.lower()}"
+
+    def category(self):
+        return "multires_bake"
+
+    def run(self, env, device_id):
+        args = {'bake_type': self.bake_type}
+        result, _ = env.run_in_blender(_run, args, [self.filepath])
+        return result
+
+
+def generate(env):
+    filepaths = env.find_blend_files('multires_bake/*')
+    return [MultiresBakeTest(filepath, bake_type)
+            for filepath in filepaths
+            for bake_type in ('NORMALS', 'DISPLACEMENT')]